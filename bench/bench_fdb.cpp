@@ -0,0 +1,93 @@
+// multi-threaded benchmark of MAC_FDB : learn / lookup / age under mixed load
+// usage : bench_fdb [max_threads] [seconds_per_run] [table_size]
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include "../gia_fdb.h"
+
+using namespace std;
+
+struct fdb_mix {
+    const char *name;
+    u32i learnPct; // the rest are lookups
+    bool ager; // separate thread does incremental aging
+};
+
+static u64i next_rnd(u64i &state) { state += 0x9E3779B97F4A7C15; return hashmnp::mix64(state); }
+
+static double run_mix(MAC_FDB &fdb, const fdb_mix &mix, u32i threads, double secs, u64i population, u64i *aged) {
+    atomic<bool> stop {false};
+    atomic<u32i> clock {1};
+    vector<u64i> ops(threads, 0);
+    vector<thread> pool;
+    for (u32i tid = 0; tid < threads; tid++) {
+        pool.emplace_back([&, tid]() {
+            u64i state = tid * 0x1234567 + 1;
+            u64i cnt {0};
+            u32i port;
+            while (!stop.load(memory_order_relaxed)) {
+                for (u32i idx = 0; idx < 256; idx++) {
+                    u64i rnd = next_rnd(state);
+                    u64i pair = rnd % population;
+                    MAC_Addr mac {0x020000000000 | pair};
+                    u16i vlan = pair & 7;
+                    if ((rnd >> 56) % 100 < mix.learnPct) fdb.learn(mac, vlan, (rnd >> 48) & 0x3F, clock.load(memory_order_relaxed));
+                    else fdb.lookup(mac, vlan, &port);
+                }
+                cnt += 256;
+            }
+            ops[tid] = cnt;
+        });
+    }
+    thread ager;
+    *aged = 0;
+    if (mix.ager) {
+        ager = thread([&]() {
+            while (!stop.load(memory_order_relaxed)) {
+                u32i now = clock.fetch_add(1, memory_order_relaxed) + 1;
+                *aged += fdb.age(now, 200, 4096);
+                this_thread::sleep_for(chrono::microseconds(500));
+            }
+        });
+    }
+    this_thread::sleep_for(chrono::duration<double>(secs));
+    stop.store(true);
+    for (auto && thr : pool) thr.join();
+    if (ager.joinable()) ager.join();
+    u64i total {0};
+    for (auto && cnt : ops) total += cnt;
+    return double(total) / secs;
+}
+
+int main(int argc, char *argv[]) {
+    u32i maxThreads = (argc > 1) ? atoi(argv[1]) : thread::hardware_concurrency();
+    double secs = (argc > 2) ? atof(argv[2]) : 1.0;
+    u64i tableSize = (argc > 3) ? atoll(argv[3]) : 1 << 20;
+    if (maxThreads == 0) maxThreads = 1;
+    const fdb_mix mixes[] = {
+        {"lookup only", 0, false},
+        {"learn 10%", 10, false},
+        {"learn 10% + aging", 10, true},
+        {"learn only", 100, false},
+    };
+    cout << "table size " << tableSize << ", population " << tableSize / 2 << " MAC/VLAN pairs" << endl;
+    for (auto && mix : mixes) {
+        for (u32i threads = 1; threads <= maxThreads; threads *= 2) {
+            MAC_FDB fdb {tableSize};
+            if (!fdb.valid()) return 1;
+            u64i state {42};
+            for (u64i idx = 0; idx < tableSize / 2; idx++) {
+                u64i rnd = next_rnd(state);
+                u64i pair = rnd % (tableSize / 2);
+                fdb.learn(MAC_Addr(0x020000000000 | pair), pair & 7, 1, 1);
+            }
+            u64i aged;
+            double rate = run_mix(fdb, mix, threads, secs, tableSize / 2, &aged);
+            cout << mix.name << " : threads " << threads << ", " << u64i(rate / 1e6 * 10) / 10.0 << " Mops/s, " << 1e9 * threads / rate << " ns/op";
+            if (mix.ager) cout << ", aged out " << aged;
+            cout << ", entries " << fdb.size() << endl;
+        }
+    }
+    return 0;
+}
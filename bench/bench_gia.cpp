@@ -0,0 +1,468 @@
+// single-threaded benchmark of parsers, formatters, predicates and operators over generated datasets
+// usage : gia_bench [--filter substring] [--time seconds] [--size rows] [--seed n] [--json file] [--list]
+// results of two commits on one machine can be compared by diffing json files
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include "../gia_ipmnp.h"
+#include "../gia_ipcol.h"
+#include "../gia_ipdual.h"
+#include "../gia_nat64.h"
+#include "../gia_hhh.h"
+#include "../gia_anon.h"
+#include "../gia_shard.h"
+
+using namespace std;
+
+static atomic<u64i> allocs {0}; // every operator new in process, bench is single-threaded
+
+void* operator new(size_t size) {
+    allocs.fetch_add(1, memory_order_relaxed);
+    if (void *ptr = malloc(size ? size : 1)) return ptr;
+    throw bad_alloc();
+}
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+struct bench_opts {
+    string filter;
+    double secs {0.2}; // per benchmark
+    size_t size {4096}; // rows in each dataset
+    u64i seed {42};
+    string json;
+    bool list {false};
+};
+
+struct bench_result {
+    string group, name, dataset;
+    u64i ops;
+    double nsPerOp, mops, mbps, allocsPerOp;
+};
+
+struct datasets {
+    vector<IPv4_Addr> v4Rnd, v4Seq;
+    vector<IPv6_Addr> v6Rnd, v6Seq, v6Rfc;
+    vector<MAC_Addr> macRnd, macSeq;
+    vector<string> v4RndStr, v4SeqStr, v4BadStr, v6RndStr, v6SeqStr, v6RfcStr, v6BadStr, macColonStr, macDashStr, macDotStr, mixedStr;
+};
+
+static volatile u64i sink; // keeps results alive
+
+class Bench_Runner {
+    bench_opts opts;
+    vector<bench_result> results;
+public:
+    Bench_Runner(const bench_opts &_opts) : opts(_opts) {};
+    // pass processes whole dataset of n rows and returns checksum, bytes - text processed by one pass
+    void run(const char *group, const char *name, const char *dataset, size_t n, size_t bytes, const function<u64i()> &pass) {
+        string full = string(group) + "/" + name + "/" + dataset;
+        if (!opts.filter.empty() && (full.find(opts.filter) == string::npos)) return;
+        if (opts.list) {
+            cout << full << endl;
+            return;
+        }
+        sink = pass(); // warm up caches and branch predictors
+        u64i passes {0}, before = allocs.load(memory_order_relaxed);
+        auto start = chrono::steady_clock::now();
+        double elapsed {0};
+        do {
+            sink = pass();
+            passes++;
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        } while (elapsed < opts.secs);
+        u64i allocated = allocs.load(memory_order_relaxed) - before;
+        u64i ops = passes * n;
+        bench_result res {group, name, dataset, ops, elapsed * 1e9 / ops, ops / elapsed / 1e6, bytes * passes / elapsed / 1e6, double(allocated) / ops};
+        printf("%-10s %-22s %-12s %9.2f ns/op %9.2f Mops/s", group, name, dataset, res.nsPerOp, res.mops);
+        if (bytes) printf(" %8.1f MB/s", res.mbps);
+        else printf("%14s", "");
+        printf(" %6.2f allocs/op\n", res.allocsPerOp);
+        results.push_back(res);
+    }
+    bool write_json() const {
+        if (opts.json.empty()) return true;
+        ofstream out(opts.json);
+        if (!out) return false;
+        const char *levels[] = {"scalar", "avx2", "avx512"};
+        out << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"simd\": \"" << levels[colmnp::detect()] << "\",\n";
+        out << "  \"size\": " << opts.size << ",\n  \"seed\": " << opts.seed << ",\n  \"secs\": " << opts.secs << ",\n  \"results\": [\n";
+        for (size_t idx = 0; idx < results.size(); idx++) {
+            const bench_result &res = results[idx];
+            out << "    {\"group\": \"" << res.group << "\", \"name\": \"" << res.name << "\", \"dataset\": \"" << res.dataset << "\", \"ops\": " << res.ops;
+            out << ", \"ns_per_op\": " << res.nsPerOp << ", \"mops\": " << res.mops << ", \"mb_per_s\": " << res.mbps << ", \"allocs_per_op\": " << res.allocsPerOp << "}";
+            out << ((idx + 1 < results.size()) ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return bool(out);
+    }
+};
+
+static size_t text_bytes(const vector<string> &strs) {
+    size_t ret {0};
+    for (auto && str : strs) ret += str.size();
+    return ret;
+}
+
+static string mutate(string str, mt19937_64 &rng) { // broken but plausible text for validators
+    const char junk[] = "g:.:-1x 9Z%";
+    switch (rng() % 4) {
+        case 0: str[rng() % str.size()] = junk[rng() % (sizeof(junk) - 1)]; break;
+        case 1: str.insert(rng() % str.size(), 1, junk[rng() % (sizeof(junk) - 1)]); break;
+        case 2: str.erase(rng() % str.size(), 1); break;
+        default: str += str.substr(0, rng() % 5);
+    }
+    return str;
+}
+
+static void generate(const bench_opts &opts, datasets *ds) {
+    mt19937_64 rng(opts.seed);
+    const char *rfc5952[] = { // zero runs of different length and position, leading zeros, case, embedded IPv4
+        "::", "::1", "1::", "2001:db8::1", "2001:db8:0:0:1:0:0:1", "2001:0db8:0000:0000:0000:0000:0000:0001", "2001:db8:0:1:1:1:1:1",
+        "1:0:0:2:0:0:0:3", "FE80::1", "fe80::21a:2bff:fe3c:4d5e", "::ffff:192.0.2.1", "64:ff9b::198.51.100.7", "2001:DB8:AAAA:BBBB:CCCC:DDDD:EEEE:FFFF",
+        "ff02::1:ff00:1", "0:0:0:0:0:0:0:0", "1:2:3:4:5:6:7::", "::2:3:4:5:6:7:8", "2001:db8::a:0:0:0:1"};
+    for (size_t idx = 0; idx < opts.size; idx++) {
+        ds->v4Rnd.push_back(IPv4_Addr(u32i(rng())));
+        ds->v4Seq.push_back(IPv4_Addr(0x0A000000 + u32i(idx)));
+        u64i hi = rng(), lo = rng();
+        switch (rng() % 4) { // random addresses have zero hextets sometimes, so compression is exercised
+            case 0: lo &= 0xFFFF; break;
+            case 1: hi &= 0xFFFFFFFF00000000; break;
+            case 2: hi = (hi & 0xFFFF000000000000) | 0x0000000000001; break;
+        }
+        if (((lo >> 32) & 0xFFFF) == 0xFFFF) lo ^= 0x100000000; // ::ffff:0:0/96 only in rfc set
+        ds->v6Rnd.push_back(IPv6_Addr(hi, lo));
+        ds->v6Seq.push_back(IPv6_Addr(0x20010DB800000000, idx + 1));
+        IPv6_Addr rfc;
+        v6mnp::valid_addr(rfc5952[idx % (sizeof(rfc5952) / sizeof(rfc5952[0]))], &rfc);
+        ds->v6Rfc.push_back(rfc);
+        ds->macRnd.push_back(MAC_Addr(rng()));
+        ds->macSeq.push_back(MAC_Addr(0x001A2B000000 + idx));
+    }
+    for (size_t idx = 0; idx < opts.size; idx++) {
+        ds->v4RndStr.push_back(ds->v4Rnd[idx].to_str());
+        ds->v4SeqStr.push_back(ds->v4Seq[idx].to_str());
+        ds->v4BadStr.push_back(mutate(ds->v4RndStr[idx], rng));
+        ds->v6RndStr.push_back(ds->v6Rnd[idx].to_str(v6mnp::IETF_VIEW));
+        ds->v6SeqStr.push_back(ds->v6Seq[idx].to_str(v6mnp::IETF_VIEW));
+        ds->v6RfcStr.push_back(rfc5952[idx % (sizeof(rfc5952) / sizeof(rfc5952[0]))]);
+        ds->v6BadStr.push_back(mutate(ds->v6RndStr[idx], rng));
+        ds->macColonStr.push_back(ds->macRnd[idx].to_str(1, true, ':'));
+        ds->macDashStr.push_back(ds->macRnd[idx].to_str(1, false, '-'));
+        ds->macDotStr.push_back(ds->macRnd[idx].to_str(2, false, '.'));
+        switch (idx % 4) {
+            case 0: ds->mixedStr.push_back(ds->v4RndStr[idx]); break;
+            case 1: ds->mixedStr.push_back(ds->v6RndStr[idx]); break;
+            case 2: ds->mixedStr.push_back(ds->macColonStr[idx]); break;
+            default: ds->mixedStr.push_back(ds->v6RfcStr[idx]);
+        }
+    }
+}
+
+static void bench_parsers(Bench_Runner &run, const datasets &ds) {
+    auto v4 = [&](const char *name, const char *dsName, const vector<string> &strs, const function<u64i(const string&)> &func) {
+        run.run("parse", name, dsName, strs.size(), text_bytes(strs), [&]() { u64i sum {0}; for (auto && str : strs) sum += func(str); return sum; });
+    };
+    auto valid4 = [](const string &str) { IPv4_Addr ip; return v4mnp::valid_addr(str, &ip) + u64i(ip()); };
+    v4("v4.valid_addr", "random", ds.v4RndStr, valid4);
+    v4("v4.valid_addr", "sequential", ds.v4SeqStr, valid4);
+    v4("v4.valid_addr", "invalid", ds.v4BadStr, valid4);
+    v4("v4.to_u32i", "random", ds.v4RndStr, [](const string &str) { return u64i(v4mnp::to_u32i(str)); });
+    v4("v4.valid_mask", "random", ds.v4RndStr, [](const string &str) { return u64i(v4mnp::valid_mask(str)); });
+    v4("IPv4_Addr(str)", "random", ds.v4RndStr, [](const string &str) { return u64i(IPv4_Addr(str)()); });
+    auto valid6 = [](const string &str) { IPv6_Addr ip; return v6mnp::valid_addr(str, &ip) + ip().ls; };
+    v4("v6.valid_addr", "random", ds.v6RndStr, valid6);
+    v4("v6.valid_addr", "sequential", ds.v6SeqStr, valid6);
+    v4("v6.valid_addr", "rfc5952", ds.v6RfcStr, valid6);
+    v4("v6.valid_addr", "invalid", ds.v6BadStr, valid6);
+    v4("v6.to_u128i", "random", ds.v6RndStr, [](const string &str) { return v6mnp::to_u128i(str).ms; });
+    v4("v6.valid_mask", "random", ds.v6RndStr, [](const string &str) { return u64i(v6mnp::valid_mask(str)); });
+    v4("IPv6_Addr(str)", "rfc5952", ds.v6RfcStr, [](const string &str) { return IPv6_Addr(str)().ms; });
+    v4("mac.valid_addr", "colon", ds.macColonStr, [](const string &str) { MAC_Addr mac; return macmnp::valid_addr(str, 1, ':', &mac) + mac(); });
+    v4("mac.valid_addr", "dash", ds.macDashStr, [](const string &str) { MAC_Addr mac; return macmnp::valid_addr(str, 1, '-', &mac) + mac(); });
+    v4("mac.valid_addr", "dotted", ds.macDotStr, [](const string &str) { MAC_Addr mac; return macmnp::valid_addr(str, 2, '.', &mac) + mac(); });
+    v4("mac.to_48bits", "colon", ds.macColonStr, [](const string &str) { return macmnp::to_48bits(str, 1, ':'); });
+    v4("dual.valid_addr", "mixed", ds.mixedStr, [](const string &str) { IP_Addr ip; return dualmnp::valid_addr(str, &ip) + ip().ls; });
+    v4("auto_family", "mixed", ds.mixedStr, [](const string &str) { // family is guessed the way log and text ingest do it
+        if (str.find(':') == string::npos) return u64i(v4mnp::valid_addr(str));
+        if ((str.size() == 17) && (str[2] == ':') && macmnp::valid_addr(str, 1, ':')) return u64i(2);
+        return u64i(v6mnp::valid_addr(str)) * 3;
+    });
+}
+
+static void bench_formatters(Bench_Runner &run, const datasets &ds) {
+    auto fmt = [&](const char *name, const char *dsName, size_t n, const function<string(size_t)> &func) {
+        size_t bytes {0};
+        for (size_t idx = 0; idx < n; idx++) bytes += func(idx).size();
+        run.run("format", name, dsName, n, bytes, [&]() { u64i sum {0}; for (size_t idx = 0; idx < n; idx++) sum += func(idx).size(); return sum; });
+    };
+    fmt("v4.to_str", "random", ds.v4Rnd.size(), [&](size_t idx) { return ds.v4Rnd[idx].to_str(); });
+    fmt("v4.to_str", "sequential", ds.v4Seq.size(), [&](size_t idx) { return ds.v4Seq[idx].to_str(); });
+    const pair<const char*, u32i> views[] = {{"v6.to_str.ietf", v6mnp::IETF_VIEW}, {"v6.to_str.upper", v6mnp::UPPER_VIEW}, {"v6.to_str.leadzrs", v6mnp::LEADZRS_VIEW}, {"v6.to_str.expand", v6mnp::EXPAND_VIEW}, {"v6.to_str.full", v6mnp::FULL_VIEW}};
+    for (auto && view : views) {
+        u32i flags = view.second;
+        fmt(view.first, "random", ds.v6Rnd.size(), [&, flags](size_t idx) { return ds.v6Rnd[idx].to_str(flags); });
+    }
+    fmt("v6.to_str.ietf", "sequential", ds.v6Seq.size(), [&](size_t idx) { return ds.v6Seq[idx].to_str(v6mnp::IETF_VIEW); });
+    fmt("v6.to_str.ietf", "rfc5952", ds.v6Rfc.size(), [&](size_t idx) { return ds.v6Rfc[idx].to_str(v6mnp::IETF_VIEW); });
+    fmt("mac.to_str.colon", "random", ds.macRnd.size(), [&](size_t idx) { return ds.macRnd[idx].to_str(1, true, ':'); });
+    fmt("mac.to_str.dash", "random", ds.macRnd.size(), [&](size_t idx) { return ds.macRnd[idx].to_str(1, false, '-'); });
+    fmt("mac.to_str.dotted", "random", ds.macRnd.size(), [&](size_t idx) { return ds.macRnd[idx].to_str(2, false, '.'); });
+    run.run("format", "v4.to_media_tx", "random", ds.v4Rnd.size(), 0, [&]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += ip.to_media_tx()[0]; return sum; });
+    run.run("format", "v6.to_media_tx", "random", ds.v6Rnd.size(), 0, [&]() { u64i sum {0}; for (auto && ip : ds.v6Rnd) sum += ip.to_media_tx()[0]; return sum; });
+    run.run("format", "mac.to_media_tx", "random", ds.macRnd.size(), 0, [&]() { u64i sum {0}; for (auto && mac : ds.macRnd) sum += mac.to_media_tx()[0]; return sum; });
+}
+
+static void bench_predicates(Bench_Runner &run, const datasets &ds) {
+    const pair<const char*, bool (IPv4_Addr::*)() const> v4preds[] = {
+        {"v4.is_unknown", &IPv4_Addr::is_unknown}, {"v4.is_this_host", &IPv4_Addr::is_this_host}, {"v4.is_private", &IPv4_Addr::is_private},
+        {"v4.is_loopback", &IPv4_Addr::is_loopback}, {"v4.is_link_local", &IPv4_Addr::is_link_local}, {"v4.is_lim_bcast", &IPv4_Addr::is_lim_bcast},
+        {"v4.is_mcast", &IPv4_Addr::is_mcast}, {"v4.is_ssm_blk", &IPv4_Addr::is_ssm_blk}, {"v4.is_lan_cblock", &IPv4_Addr::is_lan_cblock},
+        {"v4.is_inter_cblock", &IPv4_Addr::is_inter_cblock}, {"v4.is_adhoc_blk1", &IPv4_Addr::is_adhoc_blk1}, {"v4.is_adhoc_blk2", &IPv4_Addr::is_adhoc_blk2},
+        {"v4.is_adhoc_blk3", &IPv4_Addr::is_adhoc_blk3}, {"v4.is_sdp_sap", &IPv4_Addr::is_sdp_sap}, {"v4.is_glop_blk", &IPv4_Addr::is_glop_blk},
+        {"v4.is_adm_scp_blk", &IPv4_Addr::is_adm_scp_blk}, {"v4.is_ubm", &IPv4_Addr::is_ubm}, {"v4.is_ucast", &IPv4_Addr::is_ucast},
+        {"v4.is_as112", &IPv4_Addr::is_as112}, {"v4.is_global_ucast", &IPv4_Addr::is_global_ucast}, {"v4.is_shared", &IPv4_Addr::is_shared},
+        {"v4.is_reserved", &IPv4_Addr::is_reserved}, {"v4.is_docum", &IPv4_Addr::is_docum}, {"v4.is_benchm", &IPv4_Addr::is_benchm},
+        {"v4.is_ietf", &IPv4_Addr::is_ietf}, {"v4.is_dslite", &IPv4_Addr::is_dslite}, {"v4.is_amt", &IPv4_Addr::is_amt},
+        {"v4.is_dirdeleg", &IPv4_Addr::is_dirdeleg}, {"v4.can_be_mask", &IPv4_Addr::can_be_mask}};
+    for (auto && pred : v4preds) {
+        auto func = pred.second;
+        run.run("predicate", pred.first, "random", ds.v4Rnd.size(), 0, [&, func]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += (ip.*func)(); return sum; });
+    }
+    const pair<const char*, bool (IPv6_Addr::*)() const> v6preds[] = {
+        {"v6.is_unspec", &IPv6_Addr::is_unspec}, {"v6.is_loopback", &IPv6_Addr::is_loopback}, {"v6.is_glob_ucast", &IPv6_Addr::is_glob_ucast},
+        {"v6.is_mcast", &IPv6_Addr::is_mcast}, {"v6.is_uniq_local", &IPv6_Addr::is_uniq_local}, {"v6.is_link_local", &IPv6_Addr::is_link_local},
+        {"v6.is_mapped_ipv4", &IPv6_Addr::is_mapped_ipv4}, {"v6.is_wknown_pfx", &IPv6_Addr::is_wknown_pfx}, {"v6.is_lu_trans", &IPv6_Addr::is_lu_trans},
+        {"v6.is_ietf", &IPv6_Addr::is_ietf}, {"v6.is_teredo", &IPv6_Addr::is_teredo}, {"v6.is_benchm", &IPv6_Addr::is_benchm},
+        {"v6.is_amt", &IPv6_Addr::is_amt}, {"v6.is_as112", &IPv6_Addr::is_as112}, {"v6.is_orchv2", &IPv6_Addr::is_orchv2},
+        {"v6.is_docum", &IPv6_Addr::is_docum}, {"v6.is_6to4", &IPv6_Addr::is_6to4}, {"v6.can_be_mask", &IPv6_Addr::can_be_mask}};
+    for (auto && pred : v6preds) {
+        auto func = pred.second;
+        run.run("predicate", pred.first, "rfc5952", ds.v6Rfc.size(), 0, [&, func]() { u64i sum {0}; for (auto && ip : ds.v6Rfc) sum += (ip.*func)(); return sum; });
+    }
+    const pair<const char*, bool (MAC_Addr::*)() const> macpreds[] = {
+        {"mac.is_ucast", &MAC_Addr::is_ucast}, {"mac.is_mcast", &MAC_Addr::is_mcast}, {"mac.is_bcast", &MAC_Addr::is_bcast},
+        {"mac.is_uaa", &MAC_Addr::is_uaa}, {"mac.is_laa", &MAC_Addr::is_laa}};
+    for (auto && pred : macpreds) {
+        auto func = pred.second;
+        run.run("predicate", pred.first, "random", ds.macRnd.size(), 0, [&, func]() { u64i sum {0}; for (auto && mac : ds.macRnd) sum += (mac.*func)(); return sum; });
+    }
+}
+
+static void bench_operators(Bench_Runner &run, const datasets &ds) {
+    size_t n = ds.v4Rnd.size();
+    run.run("operator", "v4.inc", "sequential", n, 0, [&]() { u64i sum {0}; for (auto ip : ds.v4Seq) { ip++; sum += ip(); } return sum; });
+    run.run("operator", "v4.add_sub", "random", n, 0, [&]() { u64i sum {0}; for (auto ip : ds.v4Rnd) { ip += 77; ip -= IPv4_Addr(3); sum += ip(); } return sum; });
+    run.run("operator", "v4.and_or_mask", "random", n, 0, [&]() { u64i sum {0}; IPv4_Mask mask = v4mnp::gen_mask(24); for (auto ip : ds.v4Rnd) { ip &= mask; ip |= 1; sum += ip(); } return sum; });
+    run.run("operator", "v4.shift", "random", n, 0, [&]() { u64i sum {0}; for (auto ip : ds.v4Rnd) { ip <<= 3; ip >>= 5; sum += ip(); } return sum; });
+    run.run("operator", "v4.compare", "random", n, 0, [&]() { u64i sum {0}; for (size_t idx = 1; idx < n; idx++) sum += (ds.v4Rnd[idx] < ds.v4Rnd[idx - 1]) + (ds.v4Rnd[idx] == ds.v4Seq[idx]); return sum; });
+    run.run("operator", "v4.octet", "random", n, 0, [&]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += ip[v4mnp::oct1] + ip[v4mnp::oct4]; return sum; });
+    run.run("operator", "v4.gen_mask_len", "sequential", n, 0, [&]() { u64i sum {0}; for (size_t idx = 0; idx < n; idx++) sum += v4mnp::mask_len(v4mnp::gen_mask(idx & 31)()); return sum; });
+    run.run("operator", "v6.inc_dec", "sequential", n, 0, [&]() { u64i sum {0}; for (auto ip : ds.v6Seq) { ip++; ip++; ip--; sum += ip().ls; } return sum; });
+    run.run("operator", "v6.add_sub", "random", n, 0, [&]() { u64i sum {0}; for (auto ip : ds.v6Rnd) { ip += 0xFFFFFFFFFFull; ip -= ds.v6Seq[0]; sum += ip().ms; } return sum; });
+    run.run("operator", "v6.shift", "random", n, 0, [&]() { u64i sum {0}; for (auto && ip : ds.v6Rnd) sum += (ip << 13)().ms + (ip >> 70)().ls; return sum; });
+    run.run("operator", "v6.and_or_mask", "random", n, 0, [&]() { u64i sum {0}; IPv6_Mask mask = v6mnp::gen_mask(56); for (auto ip : ds.v6Rnd) { ip &= mask; ip |= ds.v6Seq[0]; sum += ip().ms; } return sum; });
+    run.run("operator", "v6.compare", "random", n, 0, [&]() { u64i sum {0}; for (size_t idx = 1; idx < n; idx++) sum += (ds.v6Rnd[idx] < ds.v6Rnd[idx - 1]) + (ds.v6Rnd[idx] >= ds.v6Seq[idx]) + (ds.v6Rnd[idx] == ds.v6Rfc[idx]); return sum; });
+    run.run("operator", "v6.gen_mask_len", "sequential", n, 0, [&]() { u64i sum {0}; for (size_t idx = 0; idx < n; idx++) sum += v6mnp::mask_len(v6mnp::gen_mask(idx & 127)); return sum; });
+    run.run("operator", "v6.gen_link_local", "random", n, 0, [&]() { u64i sum {0}; for (auto && mac : ds.macRnd) sum += v6mnp::gen_link_local(mac)().ls; return sum; });
+    run.run("operator", "dual.compare_hash", "random", n, 0, [&]() {
+        u64i sum {0};
+        for (size_t idx = 1; idx < n; idx++) {
+            IP_Addr cur = (idx & 1) ? IP_Addr(ds.v4Rnd[idx]) : IP_Addr(ds.v6Rnd[idx]), prev = (idx & 2) ? IP_Addr(ds.v4Rnd[idx - 1]) : IP_Addr(ds.v6Rnd[idx - 1]);
+            sum += (cur < prev) + (cur == prev) + cur.is_v4() + cur.hash();
+        }
+        return sum;
+    });
+    run.run("operator", "mac.add_and", "random", n, 0, [&]() { u64i sum {0}; for (auto mac : ds.macRnd) { mac += 5; mac &= 0xFFFFFF000000ull; sum += mac(); } return sum; });
+    run.run("operator", "mac.compare", "random", n, 0, [&]() { u64i sum {0}; for (size_t idx = 1; idx < n; idx++) sum += (ds.macRnd[idx] < ds.macRnd[idx - 1]) + (ds.macRnd[idx] == ds.macSeq[idx]); return sum; });
+    run.run("operator", "mac.oui_nic", "random", n, 0, [&]() { u64i sum {0}; for (auto && mac : ds.macRnd) sum += mac.get_oui() ^ mac.get_nic(); return sum; });
+    run.run("operator", "mac.gen_mcast", "random", n, 0, [&]() { u64i sum {0}; for (size_t idx = 0; idx < n; idx++) sum += macmnp::gen_mcast(ds.v4Rnd[idx])() + macmnp::gen_mcast(ds.v6Rnd[idx])(); return sum; });
+    run.run("operator", "wire.round_trip", "random", n, 0, [&]() {
+        u64i sum {0};
+        u8i buf[16];
+        for (size_t idx = 0; idx < n; idx++) {
+            ds.v6Rnd[idx].to_wire(buf);
+            ds.v4Rnd[idx].to_wire(buf);
+            sum += IPv6_Addr::from_wire(buf)().ls + IPv4_Addr::from_wire(buf)();
+        }
+        return sum;
+    });
+}
+
+static void bench_xlat(Bench_Runner &run, const datasets &ds) { // address translation and synthesis
+    size_t n = ds.v4Rnd.size();
+    NAT64_Xlat wkp, pfx40(IPv6_Addr(0x20010DB810000000ull, 0), 40);
+    vector<IPv6_Addr> v6(n);
+    vector<IPv4_Addr> v4(n);
+    vector<u8i> wire4(n * 4), wire6(n * 16), out4(n * 4), out6(n * 16);
+    for (size_t idx = 0; idx < n; idx++) ds.v4Rnd[idx].to_wire(&wire4[idx * 4]);
+    run.run("xlat", "nat64.to_v6.wkp", "random", n, 0, [&]() { wkp.to_v6(ds.v4Rnd.data(), n, v6.data()); return v6[n - 1]().ls; });
+    run.run("xlat", "nat64.to_v6./40", "random", n, 0, [&]() { pfx40.to_v6(ds.v4Rnd.data(), n, v6.data()); return v6[n - 1]().ls; });
+    run.run("xlat", "nat64.to_v4./40", "random", n, 0, [&]() { return pfx40.to_v4(v6.data(), n, v4.data()); });
+    run.run("xlat", "nat64.to_v6_wire./40", "random", n, 0, [&]() { pfx40.to_v6_wire(wire4.data(), n, wire6.data()); return u64i(wire6[n * 16 - 7]); });
+    run.run("xlat", "nat64.to_v4_wire./40", "random", n, 0, [&]() { return pfx40.to_v4_wire(wire6.data(), n, out4.data()); });
+    vector<char> names(n * v6mnp::PTR_SIZE);
+    vector<string> v6Names(n), v4Names(n);
+    for (size_t idx = 0; idx < n; idx++) {
+        ds.v6Rnd[idx].to_ptr_name(names.data());
+        v6Names[idx] = names.data();
+        ds.v4Rnd[idx].to_ptr_name(names.data());
+        v4Names[idx] = names.data();
+    }
+    run.run("xlat", "v4.to_ptr_name", "random", n, 0, [&]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += ip.to_ptr_name(names.data()); return sum; });
+    run.run("xlat", "v6.to_ptr_name", "random", n, 0, [&]() { u64i sum {0}; for (auto && ip : ds.v6Rnd) sum += ip.to_ptr_name(names.data()); return sum; });
+    run.run("xlat", "v6.to_ptr_names", "random", n, 0, [&]() { v6mnp::to_ptr_names(ds.v6Rnd.data(), n, names.data()); return u64i(names[77]); });
+    run.run("xlat", "v6.to_ptr_names", "prefix", n, 0, [&]() { return v6mnp::to_ptr_names(ds.v6Seq[0], 64, names.data(), n); });
+    run.run("xlat", "v6.reverse_full_view", "random", n, 0, [&]() { // what callers did before to_ptr_name()
+        u64i sum {0};
+        for (auto && ip : ds.v6Rnd) {
+            string full = ip.to_str(v6mnp::FULL_VIEW & ~v6mnp::UPPER_VIEW), name;
+            for (auto it = full.rbegin(); it != full.rend(); it++) if (*it != ':') { name.push_back(*it); name.push_back('.'); }
+            name += "ip6.arpa";
+            sum += name.size();
+        }
+        return sum;
+    });
+    run.run("xlat", "v4.from_ptr_name", "random", n, 0, [&]() { u64i sum {0}; IPv4_Addr ip; for (auto && name : v4Names) sum += v4mnp::from_ptr_name(name, &ip) + ip(); return sum; });
+    run.run("xlat", "v6.from_ptr_name", "random", n, 0, [&]() { u64i sum {0}; IPv6_Addr ip; for (auto && name : v6Names) sum += v6mnp::from_ptr_name(name, &ip) + ip().ls; return sum; });
+    vector<MAC_Addr> macs(n);
+    vector<u8i> macWire(n * 6);
+    for (size_t idx = 0; idx < n; idx++) ds.macRnd[idx].to_wire(&macWire[idx * 6]);
+    run.run("xlat", "eui64.gen_link_local", "random", n, 0, [&]() { v6mnp::gen_link_local(ds.macRnd.data(), n, v6.data()); return v6[n - 1]().ls; });
+    run.run("xlat", "eui64.gen_eui64_wire", "random", n, 0, [&]() { v6mnp::gen_eui64_wire(ds.v6Seq[0], macWire.data(), n, wire6.data()); return u64i(wire6[n * 16 - 1]); });
+    run.run("xlat", "eui64.from_eui64", "random", n, 0, [&]() { return macmnp::from_eui64(v6.data(), n, macs.data()); });
+    run.run("xlat", "eui64.from_eui64_wire", "random", n, 0, [&]() { return macmnp::from_eui64_wire(wire6.data(), n, macWire.data()); });
+    run.run("xlat", "mac.gen_mcast.v4", "random", n, 0, [&]() { macmnp::gen_mcast(ds.v4Rnd.data(), n, macs.data()); return macs[n - 1](); });
+    run.run("xlat", "mac.gen_mcast.v6", "random", n, 0, [&]() { macmnp::gen_mcast(ds.v6Rnd.data(), n, macs.data()); return macs[n - 1](); });
+}
+
+static void bench_sketch(Bench_Runner &run, const datasets &ds) { // streaming summaries
+    size_t n = ds.v4Rnd.size();
+    vector<IPv4_Addr> skewed(n);
+    for (size_t idx = 0; idx < n; idx++) skewed[idx] = (idx % 2) ? ds.v4Rnd[idx] : IPv4_Addr(0x0A010000 | u32i(idx % 251)); // half of rows under 10.1/16
+    HHH_Sketch<IPv4_Addr> v4Sampled(1024, true), v4Exact(1024, false);
+    HHH_Sketch<IPv6_Addr> v6Sampled(1024, true);
+    run.run("sketch", "hhh.v4.sampled", "random", n, 0, [&]() { v4Sampled.update(ds.v4Rnd.data(), n); return v4Sampled.count(); });
+    run.run("sketch", "hhh.v4.sampled", "skewed", n, 0, [&]() { v4Sampled.update(skewed.data(), n); return v4Sampled.count(); });
+    run.run("sketch", "hhh.v4.exact", "skewed", n, 0, [&]() { v4Exact.update(skewed.data(), n); return v4Exact.count(); });
+    run.run("sketch", "hhh.v6.sampled", "random", n, 0, [&]() { v6Sampled.update(ds.v6Rnd.data(), n); return v6Sampled.count(); });
+    run.run("sketch", "hhh.v4.query", "skewed", 1, 0, [&]() { return u64i(v4Sampled.query(0.05).size()); });
+}
+
+static void bench_anon(Bench_Runner &run, const datasets &ds) { // prefix-preserving anonymization, caches are warm after first pass
+    size_t n = ds.v4Rnd.size();
+    u8i key[anonmnp::KEY_SIZE];
+    for (u32i idx = 0; idx < anonmnp::KEY_SIZE; idx++) key[idx] = u8i(idx * 37 + 11);
+    Anon_PAn pan16(key, 16), pan24(key, 24), pan0(key, 0, 0);
+    vector<IPv4_Addr> v4(n);
+    vector<IPv6_Addr> v6(n);
+    vector<MAC_Addr> macs(n);
+    run.run("anon", "pan.v4.cache16", "random", n, 0, [&]() { pan16.anonymize(ds.v4Rnd.data(), n, v4.data()); return u64i(v4[n - 1]()); });
+    run.run("anon", "pan.v4.cache24", "random", n, 0, [&]() { pan24.anonymize(ds.v4Rnd.data(), n, v4.data()); return u64i(v4[n - 1]()); });
+    run.run("anon", "pan.v4.nocache", "random", n, 0, [&]() { pan0.anonymize(ds.v4Rnd.data(), n, v4.data()); return u64i(v4[n - 1]()); });
+    run.run("anon", "pan.v4.single", "random", n, 0, [&]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += pan16.anonymize(ip)(); return sum; });
+    run.run("anon", "pan.v6.cache48", "random", n, 0, [&]() { pan16.anonymize(ds.v6Rnd.data(), n, v6.data()); return v6[n - 1]().ls; });
+    run.run("anon", "pan.v6.cache48", "sequential", n, 0, [&]() { pan16.anonymize(ds.v6Seq.data(), n, v6.data()); return v6[n - 1]().ls; });
+    run.run("anon", "pan.mac", "random", n, 0, [&]() { pan16.anonymize(ds.macRnd.data(), n, macs.data()); return macs[n - 1](); });
+}
+
+static void bench_shard(Bench_Runner &run, const datasets &ds) { // assignment of addresses to 16 workers
+    size_t n = ds.v4Rnd.size();
+    vector<u32i> out(n);
+    Jump_Shard jump(16), jump24(16);
+    jump24.set_prefix(24, 64);
+    Rendezvous_Shard hrw, hrwWeighted;
+    for (u32i node = 0; node < 16; node++) {
+        hrw.add_node(node);
+        hrwWeighted.add_node(node, 1.0 + node % 3);
+    }
+    run.run("shard", "modulo.v4", "random", n, 0, [&]() { for (size_t idx = 0; idx < n; idx++) out[idx] = ds.v4Rnd[idx]() % 16; return u64i(out[n - 1]); }); // what callers did before
+    run.run("shard", "jump.v4", "random", n, 0, [&]() { jump.shard(ds.v4Rnd.data(), n, out.data()); return u64i(out[n - 1]); });
+    run.run("shard", "jump.v4./24", "sequential", n, 0, [&]() { jump24.shard(ds.v4Seq.data(), n, out.data()); return u64i(out[n - 1]); });
+    run.run("shard", "jump.v6", "random", n, 0, [&]() { jump.shard(ds.v6Rnd.data(), n, out.data()); return u64i(out[n - 1]); });
+    run.run("shard", "rendezvous.v4", "random", n, 0, [&]() { hrw.shard(ds.v4Rnd.data(), n, out.data()); return u64i(out[n - 1]); });
+    run.run("shard", "rendezvous.v4.weighted", "random", n, 0, [&]() { hrwWeighted.shard(ds.v4Rnd.data(), n, out.data()); return u64i(out[n - 1]); });
+}
+
+static void bench_libc(Bench_Runner &run, const datasets &ds) { // same rows through glibc inet_pton() / inet_ntop(), side by side
+    auto rows = [&](const char *name, const char *dsName, const vector<string> &strs, const function<u64i(const string&)> &func) {
+        run.run("libc", name, dsName, strs.size(), text_bytes(strs), [&]() { u64i sum {0}; for (auto && str : strs) sum += func(str); return sum; });
+    };
+    auto valid4 = [](const string &str) { IPv4_Addr ip; return v4mnp::valid_addr(str, &ip) + u64i(ip()); };
+    auto pton4 = [](const string &str) { in_addr ip {0}; return inet_pton(AF_INET, str.c_str(), &ip) + u64i(ip.s_addr); };
+    auto valid6 = [](const string &str) { IPv6_Addr ip; return v6mnp::valid_addr(str, &ip) + ip().ls; };
+    auto pton6 = [](const string &str) { u8i ip[16] {}; return inet_pton(AF_INET6, str.c_str(), ip) + u64i(ip[15]); };
+    rows("v4.valid_addr", "random", ds.v4RndStr, valid4);
+    rows("v4.inet_pton", "random", ds.v4RndStr, pton4);
+    rows("v4.valid_addr", "invalid", ds.v4BadStr, valid4);
+    rows("v4.inet_pton", "invalid", ds.v4BadStr, pton4);
+    rows("v6.valid_addr", "random", ds.v6RndStr, valid6);
+    rows("v6.inet_pton", "random", ds.v6RndStr, pton6);
+    rows("v6.valid_addr", "rfc5952", ds.v6RfcStr, valid6);
+    rows("v6.inet_pton", "rfc5952", ds.v6RfcStr, pton6);
+    rows("v6.valid_addr", "invalid", ds.v6BadStr, valid6);
+    rows("v6.inet_pton", "invalid", ds.v6BadStr, pton6);
+    size_t n = ds.v4Rnd.size(), bytes4 = text_bytes(ds.v4RndStr), bytes6 = text_bytes(ds.v6RndStr);
+    run.run("libc", "v4.to_str", "random", n, bytes4, [&]() { u64i sum {0}; for (auto && ip : ds.v4Rnd) sum += ip.to_str().size(); return sum; });
+    run.run("libc", "v4.inet_ntop", "random", n, bytes4, [&]() {
+        u64i sum {0};
+        u8i wire[4];
+        char buf[INET_ADDRSTRLEN];
+        for (auto && ip : ds.v4Rnd) {
+            ip.to_wire(wire);
+            sum += strlen(inet_ntop(AF_INET, wire, buf, sizeof(buf)));
+        }
+        return sum;
+    });
+    run.run("libc", "v6.to_str.ietf", "random", n, bytes6, [&]() { u64i sum {0}; for (auto && ip : ds.v6Rnd) sum += ip.to_str(v6mnp::IETF_VIEW).size(); return sum; });
+    run.run("libc", "v6.inet_ntop", "random", n, bytes6, [&]() {
+        u64i sum {0};
+        u8i wire[16];
+        char buf[INET6_ADDRSTRLEN];
+        for (auto && ip : ds.v6Rnd) {
+            ip.to_wire(wire);
+            sum += strlen(inet_ntop(AF_INET6, wire, buf, sizeof(buf)));
+        }
+        return sum;
+    });
+}
+
+int main(int argc, char *argv[]) {
+    bench_opts opts;
+    for (int idx = 1; idx < argc; idx++) {
+        string arg = argv[idx];
+        bool more = (idx + 1 < argc);
+        if ((arg == "--filter") && more) opts.filter = argv[++idx];
+        else if ((arg == "--time") && more) opts.secs = atof(argv[++idx]);
+        else if ((arg == "--size") && more) opts.size = max(2ll, atoll(argv[++idx]));
+        else if ((arg == "--seed") && more) opts.seed = atoll(argv[++idx]);
+        else if ((arg == "--json") && more) opts.json = argv[++idx];
+        else if (arg == "--list") opts.list = true;
+        else {
+            cerr << "usage : " << argv[0] << " [--filter substring] [--time seconds] [--size rows] [--seed n] [--json file] [--list]" << endl;
+            return 2;
+        }
+    }
+    datasets ds;
+    generate(opts, &ds);
+    Bench_Runner run(opts);
+    bench_parsers(run, ds);
+    bench_formatters(run, ds);
+    bench_predicates(run, ds);
+    bench_operators(run, ds);
+    bench_xlat(run, ds);
+    bench_sketch(run, ds);
+    bench_anon(run, ds);
+    bench_shard(run, ds);
+    bench_libc(run, ds);
+    if (!run.write_json()) {
+        cerr << opts.json << " : can not write results" << endl;
+        return 1;
+    }
+    return 0;
+}
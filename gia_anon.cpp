@@ -0,0 +1,265 @@
+#include <iostream>
+#include <memory.h>
+#include "gia_anon.h"
+#include "gia_ipcol.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_ANON_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const size_t BLOCKS {256}; // AES blocks in flight, several addresses at once
+
+// portable AES-128 (FIPS-197), only encryption is needed
+static const u8i SBOX[256] {
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76, 0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15, 0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84, 0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8, 0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73, 0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79, 0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A, 0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF, 0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16};
+
+static u8i xtime(u8i val) { return u8i((val << 1) ^ ((val & 0x80) ? 0x1B : 0)); }
+
+static void expand_key(const u8i *key, u8i *rk) {
+    memcpy(rk, key, 16);
+    u8i rcon {1};
+    for (u32i pos = 16; pos < 176; pos += 4) {
+        u8i tmp[4] {rk[pos - 4], rk[pos - 3], rk[pos - 2], rk[pos - 1]};
+        if (pos % 16 == 0) { // RotWord, SubWord, Rcon
+            u8i first = tmp[0];
+            tmp[0] = u8i(SBOX[tmp[1]] ^ rcon);
+            tmp[1] = SBOX[tmp[2]];
+            tmp[2] = SBOX[tmp[3]];
+            tmp[3] = SBOX[first];
+            rcon = xtime(rcon);
+        }
+        for (u32i idx = 0; idx < 4; idx++) rk[pos + idx] = rk[pos - 16 + idx] ^ tmp[idx];
+    }
+}
+
+static void soft_encrypt(const u8i *rk, u8i *st) {
+    for (u32i idx = 0; idx < 16; idx++) st[idx] ^= rk[idx];
+    for (u32i round = 1; round <= 10; round++) {
+        u8i tmp[16];
+        for (u32i idx = 0; idx < 16; idx++) tmp[idx] = SBOX[st[(idx + 4 * (idx % 4)) % 16]]; // SubBytes and ShiftRows, state is column-major
+        if (round < 10) {
+            for (u32i col = 0; col < 16; col += 4) { // MixColumns
+                u8i a0 = tmp[col], a1 = tmp[col + 1], a2 = tmp[col + 2], a3 = tmp[col + 3], all = a0 ^ a1 ^ a2 ^ a3;
+                tmp[col] ^= all ^ xtime(a0 ^ a1);
+                tmp[col + 1] ^= all ^ xtime(a1 ^ a2);
+                tmp[col + 2] ^= all ^ xtime(a2 ^ a3);
+                tmp[col + 3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+        for (u32i idx = 0; idx < 16; idx++) st[idx] = tmp[idx] ^ rk[round * 16 + idx];
+    }
+}
+
+// only first bit of each ciphertext is needed : msb[i] = 0 or 1
+#ifdef GIA_ANON_X86
+
+__attribute__((target("aes,sse2"))) static void msb_aesni(const u8i *rk, const u8i *blocks, size_t n, u8i *msb) {
+    __m128i key[11];
+    for (u32i round = 0; round < 11; round++) key[round] = _mm_load_si128((const __m128i*)(rk + round * 16));
+    size_t idx {0};
+    for (; idx + 8 <= n; idx += 8) { // eight independent blocks hide latency of aesenc
+        __m128i st[8];
+        for (u32i blk = 0; blk < 8; blk++) st[blk] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(blocks + (idx + blk) * 16)), key[0]);
+        for (u32i round = 1; round < 10; round++) for (u32i blk = 0; blk < 8; blk++) st[blk] = _mm_aesenc_si128(st[blk], key[round]);
+        for (u32i blk = 0; blk < 8; blk++) msb[idx + blk] = u8i(_mm_movemask_epi8(_mm_aesenclast_si128(st[blk], key[10])) & 1);
+    }
+    for (; idx < n; idx++) {
+        __m128i st = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(blocks + idx * 16)), key[0]);
+        for (u32i round = 1; round < 10; round++) st = _mm_aesenc_si128(st, key[round]);
+        msb[idx] = u8i(_mm_movemask_epi8(_mm_aesenclast_si128(st, key[10])) & 1);
+    }
+}
+
+__attribute__((target("vaes,avx512f,avx512bw"))) static size_t msb_vaes(const u8i *rk, const u8i *blocks, size_t n, u8i *msb) {
+    __m512i key[11];
+    for (u32i round = 0; round < 11; round++) key[round] = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)(rk + round * 16)));
+    size_t full = n & ~size_t(15);
+    for (size_t idx = 0; idx < full; idx += 16) { // four blocks per register, four registers in flight
+        __m512i st[4];
+        for (u32i reg = 0; reg < 4; reg++) st[reg] = _mm512_xor_si512(_mm512_loadu_si512((const void*)(blocks + (idx + reg * 4) * 16)), key[0]);
+        for (u32i round = 1; round < 10; round++) for (u32i reg = 0; reg < 4; reg++) st[reg] = _mm512_aesenc_epi128(st[reg], key[round]);
+        for (u32i reg = 0; reg < 4; reg++) {
+            u64i signs = _mm512_movepi8_mask(_mm512_aesenclast_epi128(st[reg], key[10])); // byte 0 of block j is bit 16 * j
+            for (u32i blk = 0; blk < 4; blk++) msb[idx + reg * 4 + blk] = u8i((signs >> (blk * 16)) & 1);
+        }
+    }
+    return full;
+}
+
+#endif // GIA_ANON_X86
+
+static void aes_msb(const u8i *rk, const u8i *blocks, size_t n, u8i *msb) {
+#ifdef GIA_ANON_X86
+    static const bool vaes = __builtin_cpu_supports("vaes");
+    colmnp::enLevel lvl = colmnp::level();
+    if ((lvl != colmnp::Scalar) && Anon_PAn::hw_aes()) {
+        size_t done = ((lvl == colmnp::AVX512) && vaes) ? msb_vaes(rk, blocks, n, msb) : 0;
+        msb_aesni(rk, blocks + done * 16, n - done, msb + done);
+        return;
+    }
+#endif
+    for (size_t idx = 0; idx < n; idx++) {
+        u8i st[16];
+        memcpy(st, blocks + idx * 16, 16);
+        soft_encrypt(rk, st);
+        msb[idx] = st[0] >> 7;
+    }
+}
+
+bool Anon_PAn::hw_aes() {
+#ifdef GIA_ANON_X86
+    static const bool aes = __builtin_cpu_supports("aes");
+    return aes;
+#else
+    return false;
+#endif
+}
+
+Anon_PAn::Anon_PAn(const u8i *key, u32i v4_cache_bits, u32i v6_cache_bits) {
+    expand_key(key, rk);
+    u8i block[16];
+    memcpy(block, key + 16, 16);
+    soft_encrypt(rk, block);
+    memcpy(&padMs, block, 8);
+    memcpy(&padLs, block + 8, 8);
+    padMs = __builtin_bswap64(padMs);
+    padLs = __builtin_bswap64(padLs);
+    if ((v4_cache_bits > anonmnp::V4_CACHE_MAX) || (v6_cache_bits > anonmnp::V6_CACHE_MAX)) lerr = anonmnp::BadCacheBits;
+    v4Bits = min(v4_cache_bits, anonmnp::V4_CACHE_MAX);
+    v6Bits = min(v6_cache_bits, anonmnp::V6_CACHE_MAX);
+    try {
+        v4Memo.assign(size_t(1) << v4Bits, 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        v4Bits = 0; // works without cache
+        v4Memo.assign(1, 0);
+        lerr = anonmnp::STL_Exception;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        v4Bits = 0;
+        v4Memo.assign(1, 0);
+        lerr = anonmnp::STL_Exception;
+    }
+}
+
+void Anon_PAn::otp(const u64i *vals, size_t n, u32i from, u32i to, u64i *otps) const {
+    u32i width = to - from;
+    for (size_t idx = 0; idx < n * 2; idx++) otps[idx] = 0;
+    if (!width) return;
+    alignas(64) u8i blocks[BLOCKS * 16];
+    u8i msb[BLOCKS];
+    size_t group = BLOCKS / width; // rows per cipher call, width is at most 128
+    for (size_t beg = 0; beg < n; beg += group) {
+        size_t end = min(n, beg + group), blk {0};
+        for (size_t row = beg; row < end; row++) {
+            for (u32i pos = from; pos < to; pos++, blk++) { // first pos bits of value, the rest of pad
+                u64i maskMs = (pos >= 64) ? ~0ull : (pos ? ~0ull << (64 - pos) : 0), maskLs = (pos <= 64) ? 0 : ~0ull << (128 - pos);
+                u64i half[2] {__builtin_bswap64((vals[row * 2] & maskMs) | (padMs & ~maskMs)), __builtin_bswap64((vals[row * 2 + 1] & maskLs) | (padLs & ~maskLs))};
+                memcpy(blocks + blk * 16, half, 16);
+            }
+        }
+        aes_msb(rk, blocks, blk, msb);
+        blk = 0;
+        for (size_t row = beg; row < end; row++) {
+            u64i ms {0}, ls {0};
+            for (u32i pos = from; pos < to; pos++, blk++) {
+                if (pos < 64) ms |= u64i(msb[blk]) << (63 - pos);
+                else ls |= u64i(msb[blk]) << (127 - pos);
+            }
+            otps[row * 2] = ms;
+            otps[row * 2 + 1] = ls;
+        }
+    }
+}
+
+u32i Anon_PAn::v4_head(u32i ip) {
+    if (!v4Bits) return 0;
+    u32i &memo = v4Memo[ip >> (32 - v4Bits)];
+    if (!(memo & 1)) {
+        u64i val[2] {u64i(ip) << 32, 0}, ret[2];
+        otp(val, 1, 0, v4Bits, ret);
+        memo = u32i(ret[0] >> 32) | 1; // low bits of otp are zero, v4Bits is at most 24
+    }
+    return memo & ~1u;
+}
+
+u64i Anon_PAn::v6_head(const IPv6_Addr &ip) {
+    if (!v6Bits) return 0;
+    IPv6_Addr pfx = ip;
+    pfx &= v6mnp::gen_mask(v6Bits);
+    if (const u64i *memo = v6Memo.find(pfx)) return *memo;
+    u64i val[2] {pfx().ms, 0}, ret[2];
+    otp(val, 1, 0, v6Bits, ret);
+    if (v6Memo.size() >= v6MemoMax) v6Memo.clear();
+    v6Memo.insert(pfx, ret[0]);
+    return ret[0];
+}
+
+IPv4_Addr Anon_PAn::anonymize(const IPv4_Addr &ip) {
+    IPv4_Addr ret;
+    anonymize(&ip, 1, &ret);
+    return ret;
+}
+
+IPv6_Addr Anon_PAn::anonymize(const IPv6_Addr &ip) {
+    IPv6_Addr ret;
+    anonymize(&ip, 1, &ret);
+    return ret;
+}
+
+MAC_Addr Anon_PAn::anonymize(const MAC_Addr &mac) {
+    MAC_Addr ret;
+    anonymize(&mac, 1, &ret);
+    return ret;
+}
+
+// batches go by chunks, so that blocks of one chunk fill cipher pipeline and fit stack buffers
+void Anon_PAn::anonymize(const IPv4_Addr *in, size_t n, IPv4_Addr *out) {
+    const size_t CHUNK {64};
+    u64i vals[CHUNK * 2], otps[CHUNK * 2];
+    for (size_t beg = 0; beg < n; beg += CHUNK) {
+        size_t cnt = min(CHUNK, n - beg);
+        for (size_t row = 0; row < cnt; row++) { vals[row * 2] = u64i(in[beg + row]()) << 32; vals[row * 2 + 1] = 0; }
+        otp(vals, cnt, v4Bits, 32, otps);
+        for (size_t row = 0; row < cnt; row++) {
+            u32i ip = in[beg + row]();
+            out[beg + row] = IPv4_Addr(ip ^ v4_head(ip) ^ u32i(otps[row * 2] >> 32));
+        }
+    }
+}
+
+void Anon_PAn::anonymize(const IPv6_Addr *in, size_t n, IPv6_Addr *out) {
+    const size_t CHUNK {16};
+    u64i vals[CHUNK * 2], otps[CHUNK * 2];
+    for (size_t beg = 0; beg < n; beg += CHUNK) {
+        size_t cnt = min(CHUNK, n - beg);
+        for (size_t row = 0; row < cnt; row++) { vals[row * 2] = in[beg + row]().ms; vals[row * 2 + 1] = in[beg + row]().ls; }
+        otp(vals, cnt, v6Bits, 128, otps);
+        for (size_t row = 0; row < cnt; row++) {
+            const IPv6_Addr &ip = in[beg + row];
+            out[beg + row] = IPv6_Addr(ip().ms ^ v6_head(ip) ^ otps[row * 2], ip().ls ^ otps[row * 2 + 1]);
+        }
+    }
+}
+
+void Anon_PAn::anonymize(const MAC_Addr *in, size_t n, MAC_Addr *out) {
+    const size_t CHUNK {32};
+    u64i vals[CHUNK * 2], otps[CHUNK * 2];
+    for (size_t beg = 0; beg < n; beg += CHUNK) {
+        size_t cnt = min(CHUNK, n - beg);
+        for (size_t row = 0; row < cnt; row++) { vals[row * 2] = in[beg + row]() << 16; vals[row * 2 + 1] = 0; }
+        otp(vals, cnt, 24, 48, otps); // OUI bits are not touched, but they are prefix of every block
+        for (size_t row = 0; row < cnt; row++) out[beg + row] = MAC_Addr(in[beg + row]() ^ (otps[row * 2] >> 16));
+    }
+}
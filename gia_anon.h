@@ -0,0 +1,45 @@
+#ifndef GIA_ANON_H
+#define GIA_ANON_H
+
+#include "gia_iphash.h"
+
+using namespace std;
+
+// prefix-preserving anonymization of Crypto-PAn (Xu, Fan, Ammar, Moon) : bit i of output is bit i of input xor first bit of
+// AES over input bits 0 .. i-1 followed by secret pad, so addresses with common k-bit prefix get outputs with common k-bit prefix
+
+class anonmnp {
+public:
+    static constexpr u32i KEY_SIZE {32}; // AES-128 key, then 16 bytes which are encrypted into pad
+    static constexpr u32i V4_CACHE_MAX {24}, V6_CACHE_MAX {64};
+    enum enLastError : u8i {NoError = 0, BadCacheBits = 1, STL_Exception = 2};
+};
+
+class Anon_PAn { // caches are filled on the fly, so not thread-safe : instances with the same key give the same mapping
+    alignas(16) u8i rk[176]; // AES-128 round keys
+    u64i padMs {0}, padLs {0}; // bits of block after prefix
+    u32i v4Bits {16}; // top IPv4 bits memoized in v4Memo
+    vector<u32i> v4Memo; // otp of top bits, lowest bit set if filled
+    u32i v6Bits {48}; // top IPv6 bits memoized in v6Memo
+    IP_FlatMap<IPv6_Addr, u64i> v6Memo; // prefix -> otp of its bits
+    size_t v6MemoMax {1 << 20}; // cache is dropped when full
+    anonmnp::enLastError lerr {anonmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func Anon_PAn::Anon_PAn() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func Anon_PAn::Anon_PAn() says: exception."};
+    void otp(const u64i *vals, size_t n, u32i from, u32i to, u64i *otps) const; // vals and otps are pairs ms, ls : bits [from, to) for n values
+    u32i v4_head(u32i ip); // otp of memoized bits
+    u64i v6_head(const IPv6_Addr &ip);
+public:
+    Anon_PAn(const u8i *key, u32i v4_cache_bits = 16, u32i v6_cache_bits = 48); // key of KEY_SIZE bytes, cache of 2^v4_cache_bits words
+    IPv4_Addr anonymize(const IPv4_Addr &ip);
+    IPv6_Addr anonymize(const IPv6_Addr &ip);
+    MAC_Addr anonymize(const MAC_Addr &mac); // OUI is kept, NIC is anonymized under it
+    // batches : AES blocks of several addresses go through cipher together
+    void anonymize(const IPv4_Addr *in, size_t n, IPv4_Addr *out);
+    void anonymize(const IPv6_Addr *in, size_t n, IPv6_Addr *out);
+    void anonymize(const MAC_Addr *in, size_t n, MAC_Addr *out);
+    static bool hw_aes(); // AES-NI is used, if colmnp::level() is not Scalar
+    anonmnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_ANON_H
@@ -0,0 +1,115 @@
+#include "gia_ipmnp.h"
+#include "gia_ipcol.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_EUI64_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// modified EUI-64 (RFC 4291 appendix A) : oui, ff:fe, nic, universal/local bit inverted ; multicast MACs (RFC 1112, RFC 2464)
+
+static const u64i EUI64_FFFE {0x000000FFFE000000}, EUI64_UL {0x0200000000000000};
+
+static u64i iid_of(u64i mac) { return (((mac >> 24) << 40) | EUI64_FFFE | (mac & 0xFFFFFF)) ^ EUI64_UL; }
+
+u64i v6mnp::eui64_iid(const MAC_Addr &mac) {
+    return iid_of(mac());
+}
+
+IPv6_Addr v6mnp::gen_eui64(const IPv6_Addr &prefix, const MAC_Addr &mac) {
+    return IPv6_Addr{prefix.as_u128i.ms, iid_of(mac()), false};
+}
+
+void v6mnp::gen_eui64(const IPv6_Addr &prefix, const MAC_Addr *macs, size_t n, IPv6_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = IPv6_Addr{prefix.as_u128i.ms, iid_of(macs[row]()), false};
+}
+
+void v6mnp::gen_link_local(const MAC_Addr *macs, size_t n, IPv6_Addr *out) {
+    gen_eui64(IPv6_Addr{0xFE80000000000000, 0}, macs, n, out);
+}
+
+bool macmnp::from_eui64(const IPv6_Addr &ip, MAC_Addr *ret) {
+    u64i iid = ip().ls;
+    bool eui = ((iid & 0x000000FFFF000000) == EUI64_FFFE);
+    iid ^= EUI64_UL;
+    if (ret != nullptr) *ret = eui ? MAC_Addr(((iid >> 40) << 24) | (iid & 0xFFFFFF)) : MAC_Addr();
+    return eui;
+}
+
+size_t macmnp::from_eui64(const IPv6_Addr *in, size_t n, MAC_Addr *out) {
+    size_t ret {0};
+    for (size_t row = 0; row < n; row++) ret += from_eui64(in[row], &out[row]);
+    return ret;
+}
+
+void macmnp::gen_mcast(const IPv4_Addr *in, size_t n, MAC_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = MAC_Addr(0x01005E000000ull | (in[row]() & 0x007FFFFF));
+}
+
+void macmnp::gen_mcast(const IPv6_Addr *in, size_t n, MAC_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = MAC_Addr(0x333300000000ull | (in[row]().ls & 0xFFFFFFFF));
+}
+
+// wire rows : one pshufb moves MAC bytes around ff:fe, prefix and ff:fe come from OR, U/L bit from XOR ; two rows per 256-bit register
+#ifdef GIA_EUI64_X86
+
+__attribute__((target("avx2"))) static size_t eui64_avx2(const u8i *prefix, const u8i *macs, size_t n, u8i *out) {
+    const __m256i pattern = _mm256_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, 0, 1, 2, -128, -128, 3, 4, 5,
+                                             -128, -128, -128, -128, -128, -128, -128, -128, 6, 7, 8, -128, -128, 9, 10, 11);
+    u64i hi;
+    memcpy(&hi, prefix, 8);
+    const __m256i base = _mm256_setr_epi64x(hi, 0x000000FEFF000000, hi, 0x000000FEFF000000); // little endian : bytes 11, 12 are ff, fe
+    const __m256i flip = _mm256_setr_epi64x(0, 0x02, 0, 0x02);
+    size_t row {0};
+    for (; (row + 2 <= n) && (row * 6 + 16 <= n * 6); row += 2) { // 16-byte load must stay inside input
+        __m256i src = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(macs + row * 6)));
+        _mm256_storeu_si256((__m256i*)(out + row * 16), _mm256_xor_si256(_mm256_or_si256(_mm256_shuffle_epi8(src, pattern), base), flip));
+    }
+    return row;
+}
+
+__attribute__((target("avx2"))) static size_t uneui64_avx2(const u8i *in, size_t n, u8i *out, size_t *cnt) {
+    const __m256i pattern = _mm256_setr_epi8(8, 9, 10, 13, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+                                             8, 9, 10, 13, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128);
+    const __m256i fffe = _mm256_setr_epi64x(0, 0x000000FEFF000000, 0, 0x000000FEFF000000);
+    const __m256i flip = _mm256_setr_epi64x(0, 0x02, 0, 0x02);
+    size_t full = n & ~size_t(1);
+    for (size_t row = 0; row < full; row += 2) {
+        __m256i src = _mm256_loadu_si256((const __m256i*)(in + row * 16));
+        u32i eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(src, fffe));
+        __m256i macs = _mm256_shuffle_epi8(_mm256_xor_si256(src, flip), pattern);
+        bool firstOk = ((eq & 0x00001800) == 0x00001800), secondOk = ((eq & 0x18000000) == 0x18000000); // bytes 11 and 12 of each row
+        u64i first = firstOk ? u64i(_mm256_extract_epi64(macs, 0)) : 0;
+        u64i second = secondOk ? u64i(_mm256_extract_epi64(macs, 2)) : 0;
+        memcpy(out + row * 6, &first, 6);
+        memcpy(out + row * 6 + 6, &second, 6);
+        *cnt += firstOk + secondOk;
+    }
+    return full;
+}
+
+#endif // GIA_EUI64_X86
+
+void v6mnp::gen_eui64_wire(const IPv6_Addr &prefix, const u8i *macs, size_t n, u8i *out) {
+    u8i pfx[16];
+    prefix.to_wire(pfx);
+    size_t done {0};
+#ifdef GIA_EUI64_X86
+    if (colmnp::level() >= colmnp::AVX2) done = eui64_avx2(pfx, macs, n, out);
+#endif
+    for (size_t row = done; row < n; row++) gen_eui64(prefix, MAC_Addr::from_wire(macs + row * 6)).to_wire(out + row * 16);
+}
+
+size_t macmnp::from_eui64_wire(const u8i *in, size_t n, u8i *out) {
+    size_t done {0}, ret {0};
+#ifdef GIA_EUI64_X86
+    if (colmnp::level() >= colmnp::AVX2) done = uneui64_avx2(in, n, out, &ret);
+#endif
+    for (size_t row = done; row < n; row++) {
+        MAC_Addr mac;
+        ret += from_eui64(IPv6_Addr::from_wire(in + row * 16), &mac);
+        mac.to_wire(out + row * 6);
+    }
+    return ret;
+}
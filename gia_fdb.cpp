@@ -0,0 +1,200 @@
+#include "gia_fdb.h"
+#include "gia_stats.h"
+
+using namespace std;
+
+MAC_FDB::MAC_FDB(size_t capacity, u32i shards_pow2) {
+    if (shards_pow2 > 16) shards_pow2 = 16;
+    u32i cnt = u32i(1) << shards_pow2;
+    size_t perShard = (capacity + cnt - 1) / cnt;
+    size_t cap {16};
+    while (cap / 4 * 3 < perShard) cap *= 2; // load factor of linear probing stays under 3/4
+    try {
+        shards = make_unique<fdb_shard[]>(cnt);
+        for (u32i idx = 0; idx < cnt; idx++) {
+            shards[idx].slots = make_unique<fdb_slot[]>(cap);
+            shards[idx].mask = cap - 1;
+        }
+        shardBits = shards_pow2;
+        shardCnt = cnt;
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        shards.reset();
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        shards.reset();
+    }
+}
+
+void MAC_FDB::write_slot(fdb_slot &slot, u64i key, u32i port, u32i stamp) {
+    u32i seq = slot.seq.load(memory_order_relaxed);
+    slot.seq.store(seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot.key.store(key, memory_order_relaxed);
+    slot.port.store(port, memory_order_relaxed);
+    slot.stamp.store(stamp, memory_order_relaxed);
+    slot.seq.store(seq + 2, memory_order_release);
+}
+
+void MAC_FDB::remove_at(fdb_shard &sh, size_t idx) {
+    u32i ver = sh.version.load(memory_order_relaxed);
+    sh.version.store(ver + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    size_t hole = idx;
+    size_t pos = idx;
+    while (true) {
+        pos = (pos + 1) & sh.mask;
+        fdb_slot &next = sh.slots[pos];
+        u64i key = next.key.load(memory_order_relaxed);
+        if (key == fdbmnp::EMPTY) break;
+        size_t home = hash(key) & sh.mask;
+        if (((pos - home) & sh.mask) >= ((pos - hole) & sh.mask)) { // entry may move back without leaving its probe sequence
+            write_slot(sh.slots[hole], key, next.port.load(memory_order_relaxed), next.stamp.load(memory_order_relaxed));
+            hole = pos;
+        }
+    }
+    write_slot(sh.slots[hole], fdbmnp::EMPTY, 0, 0);
+    sh.used--;
+    sh.version.store(ver + 2, memory_order_release);
+}
+
+fdbmnp::enLearn MAC_FDB::learn(const MAC_Addr &mac, u16i vlan, u32i port, u32i now) {
+    u64i key = fdbmnp::to_key(mac, vlan);
+    u64i hsh = hash(key);
+    fdb_shard &sh = shard_of(hsh);
+    u32i oldPort;
+    {
+        lock_guard<mutex> guard(sh.lock);
+        size_t idx = hsh & sh.mask;
+        while (true) {
+            fdb_slot &slot = sh.slots[idx];
+            u64i cur = slot.key.load(memory_order_relaxed);
+            if (cur == key) {
+                oldPort = slot.port.load(memory_order_relaxed);
+                if (oldPort == port) {
+                    slot.stamp.store(now, memory_order_relaxed); // stamp is not read by lookups, no need to bump sequence
+                    return fdbmnp::Refreshed;
+                }
+                write_slot(slot, key, port, now);
+                break;
+            }
+            if (cur == fdbmnp::EMPTY) {
+                if (sh.used >= (sh.mask + 1) / 4 * 3) return fdbmnp::TableFull;
+                write_slot(slot, key, port, now);
+                sh.used++;
+                return fdbmnp::Learned;
+            }
+            idx = (idx + 1) & sh.mask;
+        }
+    }
+    if (auto func = atomic_load(&onMove)) (*func)(mac, vlan & 0xFFF, oldPort, port);
+    return fdbmnp::Moved;
+}
+
+void MAC_FDB::set_move_func(FDB_MoveFunc func) {
+    shared_ptr<const FDB_MoveFunc> fresh;
+    if (func) {
+        try {
+            fresh = make_shared<const FDB_MoveFunc>(move(func));
+        }
+        catch (...) {
+            cerr << EX_LOW_MEM << endl;
+            return;
+        }
+    }
+    atomic_store(&onMove, fresh);
+}
+
+bool MAC_FDB::lookup(const MAC_Addr &mac, u16i vlan, u32i *port) const {
+    GIA_COUNT(FDB_Lookup);
+    GIA_TIMER(H_FDB_Lookup);
+    u64i key = fdbmnp::to_key(mac, vlan);
+    u64i hsh = hash(key);
+    const fdb_shard &sh = shard_of(hsh);
+    while (true) {
+        u32i ver = sh.version.load(memory_order_acquire);
+        size_t idx = hsh & sh.mask;
+        for (size_t probe = 0; probe <= sh.mask; probe++) {
+            GIA_COUNT(FDB_Probes);
+            const fdb_slot &slot = sh.slots[idx];
+            u32i seq1, seq2, val;
+            u64i cur;
+            do {
+                seq1 = slot.seq.load(memory_order_acquire);
+                cur = slot.key.load(memory_order_relaxed);
+                val = slot.port.load(memory_order_relaxed);
+                atomic_thread_fence(memory_order_acquire);
+                seq2 = slot.seq.load(memory_order_relaxed);
+            } while ((seq1 & 1) || (seq1 != seq2));
+            if (cur == key) {
+                if (port) *port = val;
+                return true;
+            }
+            if (cur == fdbmnp::EMPTY) break;
+            idx = (idx + 1) & sh.mask;
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (!(ver & 1) && (sh.version.load(memory_order_relaxed) == ver)) return GIA_FAIL(FDB_Miss); // no entry was shifted past the probe
+    }
+}
+
+bool MAC_FDB::remove(const MAC_Addr &mac, u16i vlan) {
+    u64i key = fdbmnp::to_key(mac, vlan);
+    u64i hsh = hash(key);
+    fdb_shard &sh = shard_of(hsh);
+    lock_guard<mutex> guard(sh.lock);
+    size_t idx = hsh & sh.mask;
+    while (true) {
+        u64i cur = sh.slots[idx].key.load(memory_order_relaxed);
+        if (cur == fdbmnp::EMPTY) return false;
+        if (cur == key) {
+            remove_at(sh, idx);
+            return true;
+        }
+        idx = (idx + 1) & sh.mask;
+    }
+}
+
+size_t MAC_FDB::age(u32i now, u32i max_age, size_t budget) {
+    size_t removed {0};
+    if (!valid()) return removed;
+    lock_guard<mutex> sweepGuard(sweepLock);
+    while (budget > 0) {
+        fdb_shard &sh = shards[sweepShard];
+        bool passed;
+        {
+            lock_guard<mutex> guard(sh.lock); // held for a limited chunk, so learning is not stalled by long sweeps
+            size_t chunk = (budget < fdbmnp::SWEEP_CHUNK) ? budget : fdbmnp::SWEEP_CHUNK;
+            budget -= chunk;
+            for (; (chunk > 0) && (sh.sweepPos <= sh.mask); chunk--) {
+                fdb_slot &slot = sh.slots[sh.sweepPos];
+                if ((slot.key.load(memory_order_relaxed) != fdbmnp::EMPTY) && (now - slot.stamp.load(memory_order_relaxed) > max_age)) {
+                    remove_at(sh, sh.sweepPos); // slot may now hold shifted entry, check it again
+                    removed++;
+                    continue;
+                }
+                sh.sweepPos++;
+            }
+            budget += chunk; // unused part of chunk
+            passed = sh.sweepPos > sh.mask;
+            if (passed) sh.sweepPos = 0;
+        }
+        if (passed) sweepShard = (sweepShard + 1) & (shardCnt - 1);
+    }
+    return removed;
+}
+
+size_t MAC_FDB::size() const {
+    size_t ret {0};
+    for (u32i idx = 0; idx < shardCnt; idx++) {
+        lock_guard<mutex> guard(shards[idx].lock);
+        ret += shards[idx].used;
+    }
+    return ret;
+}
+
+size_t MAC_FDB::capacity() const {
+    return (shardCnt == 0) ? 0 : size_t(shardCnt) * ((shards[0].mask + 1) / 4 * 3);
+}
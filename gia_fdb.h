@@ -0,0 +1,63 @@
+#ifndef GIA_FDB_H
+#define GIA_FDB_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "gia_iphash.h"
+
+using namespace std;
+
+class fdbmnp {
+public:
+    enum enLearn : u8i {Learned = 0, Refreshed = 1, Moved = 2, TableFull = 3};
+    static constexpr u64i EMPTY {0}; // valid keys always have bit 63 set
+    static constexpr size_t SWEEP_CHUNK {256}; // slots checked by aging under one shard lock
+    static u64i to_key(const MAC_Addr &mac, u16i vlan) { return (u64i(1) << 63) | (u64i(vlan & 0xFFF) << 48) | mac(); };
+    static MAC_Addr key_mac(u64i key) { return MAC_Addr(key); };
+    static u16i key_vlan(u64i key) { return (key >> 48) & 0xFFF; };
+};
+
+using FDB_MoveFunc = function<void(const MAC_Addr &mac, u16i vlan, u32i old_port, u32i new_port)>;
+
+class MAC_FDB { // MAC + VLAN -> port table : lock-free lookups, writes are serialized per shard, fixed capacity like hardware FDB
+    struct fdb_slot { // seqlock protected, sequence is odd while slot is being written
+        atomic<u32i> seq {0};
+        atomic<u32i> port {0};
+        atomic<u32i> stamp {0};
+        atomic<u64i> key {fdbmnp::EMPTY};
+    };
+    struct alignas(64) fdb_shard {
+        mutex lock;
+        unique_ptr<fdb_slot[]> slots;
+        size_t mask {0};
+        size_t used {0};
+        size_t sweepPos {0}; // aging cursor
+        atomic<u32i> version {0}; // odd while removal shifts entries, lookup which missed during shift probes again
+    };
+    unique_ptr<fdb_shard[]> shards;
+    u32i shardCnt {0};
+    u32i shardBits {0};
+    mutex sweepLock;
+    u32i sweepShard {0}; // aging cursor
+    shared_ptr<const FDB_MoveFunc> onMove; // swapped atomically, learn() on other threads keeps callback it has loaded
+    static inline const char EX_LOW_MEM[] = {"func MAC_FDB::MAC_FDB() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func MAC_FDB::MAC_FDB() says: exception."};
+    static u64i hash(u64i key) { return hashmnp::fold(key ^ hashmnp::K1, hashmnp::K2); };
+    fdb_shard& shard_of(u64i hash) const { return shards[(shardBits == 0) ? 0 : (hash >> (64 - shardBits))]; };
+    static void write_slot(fdb_slot &slot, u64i key, u32i port, u32i stamp);
+    void remove_at(fdb_shard &sh, size_t idx); // backward shift, table stays free of tombstones
+public:
+    MAC_FDB(size_t capacity, u32i shards_pow2 = 6); // 2^shards_pow2 shards
+    bool valid() const { return shardCnt != 0; }; // false if memory was not allocated
+    fdbmnp::enLearn learn(const MAC_Addr &mac, u16i vlan, u32i port, u32i now); // now is any monotonic time unit (seconds, ticks)
+    bool lookup(const MAC_Addr &mac, u16i vlan, u32i *port) const; // lock-free, waits only while slot is written or miss overlaps removal in shard
+    bool remove(const MAC_Addr &mac, u16i vlan);
+    size_t age(u32i now, u32i max_age, size_t budget); // checks up to budget slots from where previous call stopped, returns count of removed entries
+    void set_move_func(FDB_MoveFunc func); // called outside of locks, when known MAC appears on other port, may be set while learn() runs
+    size_t size() const;
+    size_t capacity() const;
+};
+
+#endif // GIA_FDB_H
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <iostream>
+#include "gia_hhh.h"
+
+using namespace std;
+
+template <class Addr>
+bool HHH_Sketch<Addr>::init(const vector<u32i> &levels, u32i capacity, bool _sampled, u64i seed) {
+    lerr = hhhmnp::NoError;
+    vector<u32i> lens = levels;
+    bool ascending = !lens.empty() && (lens.back() <= hhhmnp::bits(Addr()));
+    for (size_t idx = 1; idx < lens.size(); idx++) ascending &= (lens[idx - 1] < lens[idx]);
+    if (!ascending) {
+        lerr = hhhmnp::BadLevels;
+        lens = hhhmnp::def_levels(Addr());
+    }
+    cap = max<u32i>(capacity, 1);
+    sampled = _sampled;
+    rng = hashmnp::mix64(seed ^ 0x9E3779B97F4A7C15) | 1; // xorshift state must not be zero
+    total = 0;
+    try {
+        lvls.clear();
+        lvls.resize(lens.size());
+        for (size_t idx = 0; idx < lens.size(); idx++) {
+            lvls[idx].len = lens[idx];
+            lvls[idx].mask = hhhmnp::gen_mask(Addr(), lens[idx]);
+            lvls[idx].bkts.reserve(size_t(cap) + 1); // counts are distinct in buckets, so no reallocation later
+            lvls[idx].freeBkts.reserve(cap);
+            vector<pair<hhh_counter, u64i>> none;
+            rebuild(lvls[idx], none);
+        }
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lvls.clear();
+        lerr = hhhmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        lvls.clear();
+        lerr = hhhmnp::STL_Exception;
+        return false;
+    }
+    return lerr == hhhmnp::NoError;
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::add(hhh_level &lvl, u32i ctr, u64i weight) { // order stays sorted : counter leaves its run from the end and jumps over runs below new count
+    auto swap_pos = [&lvl](u32i posA, u32i posB) {
+        u32i ctrA = lvl.order[posA], ctrB = lvl.order[posB];
+        lvl.order[posA] = ctrB;
+        lvl.order[posB] = ctrA;
+        lvl.ctrs[ctrB].pos = posA;
+        lvl.ctrs[ctrA].pos = posB;
+    };
+    hhh_counter &cur = lvl.ctrs[ctr];
+    hhh_bucket &own = lvl.bkts[cur.bkt];
+    u64i target = own.count + weight;
+    u32i pos = own.last, size = lvl.order.size();
+    swap_pos(cur.pos, pos);
+    if (own.first == own.last) lvl.freeBkts.push_back(cur.bkt);
+    else own.last--;
+    while (pos + 1 < size) {
+        u32i nextIdx = lvl.ctrs[lvl.order[pos + 1]].bkt;
+        hhh_bucket &next = lvl.bkts[nextIdx];
+        if (next.count > target) break;
+        if (next.count == target) { // joins run at its front
+            next.first = pos;
+            cur.bkt = nextIdx;
+            return;
+        }
+        u32i last = next.last; // unit weights never get here
+        swap_pos(pos, last);
+        next.first = pos;
+        next.last = last - 1;
+        pos = last;
+    }
+    u32i bkt = lvl.bkts.size();
+    if (!lvl.freeBkts.empty()) {
+        bkt = lvl.freeBkts.back();
+        lvl.freeBkts.pop_back();
+    }
+    else lvl.bkts.push_back({});
+    lvl.bkts[bkt] = {target, pos, pos};
+    cur.bkt = bkt;
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::touch(hhh_level &lvl, const Addr &ip, u64i weight) {
+    if (u32i *slot = lvl.index.find(ip)) {
+        add(lvl, *slot, weight);
+        return;
+    }
+    u32i ctr = lvl.order[0]; // Space-Saving : new prefix takes counter of smallest one
+    hhh_counter &cur = lvl.ctrs[ctr];
+    u64i least = count_of(lvl, ctr);
+    if (least) lvl.index.erase(traits::from_raw(cur.key)); // zero count counters are free
+    lvl.index.insert(ip, ctr);
+    cur.key = traits::to_raw(ip);
+    cur.err = least;
+    add(lvl, ctr, weight);
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::update(const Addr &ip, u64i weight) {
+    if (lvls.empty() || !weight) return;
+    total += weight;
+    if (sampled) {
+        rng ^= rng << 13; // xorshift64
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        hhh_level &lvl = lvls[u64i(((unsigned __int128)rng * lvls.size()) >> 64)];
+        Addr key = ip;
+        key &= lvl.mask;
+        touch(lvl, key, weight);
+        return;
+    }
+    for (auto && lvl : lvls) {
+        Addr key = ip;
+        key &= lvl.mask;
+        touch(lvl, key, weight);
+    }
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::update(const Addr *arr, size_t n) {
+    for (size_t idx = 0; idx < n; idx++) update(arr[idx], 1);
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::update(const Addr *arr, const u64i *weights, size_t n) {
+    for (size_t idx = 0; idx < n; idx++) update(arr[idx], weights[idx]);
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::rebuild(hhh_level &lvl, vector<pair<hhh_counter, u64i>> &ctrs) {
+    sort(ctrs.begin(), ctrs.end(), [](const pair<hhh_counter, u64i> &a, const pair<hhh_counter, u64i> &b) { return a.second < b.second; });
+    if (ctrs.size() > cap) ctrs.erase(ctrs.begin(), ctrs.end() - cap);
+    u32i spare = cap - ctrs.size(); // free counters with zero count go first
+    lvl.index.clear();
+    lvl.index.reserve(size_t(cap) * 2); // evictions leave tombstones, spare room delays cleanup
+    lvl.ctrs.assign(cap, hhh_counter{raw_t{}, 0, 0, 0});
+    lvl.order.resize(cap);
+    lvl.bkts.clear();
+    lvl.freeBkts.clear();
+    for (u32i pos = 0; pos < cap; pos++) {
+        u64i cnt {0};
+        if (pos >= spare) {
+            lvl.ctrs[pos] = ctrs[pos - spare].first;
+            cnt = ctrs[pos - spare].second;
+            lvl.index.insert(traits::from_raw(lvl.ctrs[pos].key), pos);
+        }
+        if (lvl.bkts.empty() || (lvl.bkts.back().count != cnt)) lvl.bkts.push_back({cnt, pos, pos});
+        lvl.bkts.back().last = pos;
+        lvl.ctrs[pos].pos = pos;
+        lvl.ctrs[pos].bkt = lvl.bkts.size() - 1;
+        lvl.order[pos] = pos;
+    }
+}
+
+template <class Addr>
+bool HHH_Sketch<Addr>::merge(const HHH_Sketch &other) { // mergeable summaries : key missing on one side gets min counter of that side
+    if ((levels() != other.levels()) || (cap != other.cap) || (sampled != other.sampled)) {
+        lerr = hhhmnp::Mismatch;
+        return false;
+    }
+    try {
+        for (size_t num = 0; num < lvls.size(); num++) {
+            hhh_level &mine = lvls[num];
+            const hhh_level &theirs = other.lvls[num];
+            u64i minMine = min_count(mine), minTheirs = other.min_count(theirs);
+            vector<pair<hhh_counter, u64i>> all;
+            all.reserve(size_t(cap) * 2);
+            for (u32i ctr = 0; ctr < cap; ctr++) {
+                u64i cnt = count_of(mine, ctr);
+                if (!cnt) continue;
+                const hhh_counter &cur = mine.ctrs[ctr];
+                const u32i *slot = theirs.index.find(traits::from_raw(cur.key));
+                u64i more = slot ? other.count_of(theirs, *slot) : minTheirs, err = slot ? theirs.ctrs[*slot].err : minTheirs;
+                all.push_back({hhh_counter{cur.key, cur.err + err, 0, 0}, cnt + more});
+            }
+            for (u32i ctr = 0; ctr < cap; ctr++) {
+                u64i cnt = other.count_of(theirs, ctr);
+                const hhh_counter &cur = theirs.ctrs[ctr];
+                if (cnt && !mine.index.contains(traits::from_raw(cur.key))) all.push_back({hhh_counter{cur.key, cur.err + minMine, 0, 0}, cnt + minMine});
+            }
+            rebuild(mine, all);
+        }
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = hhhmnp::STL_Exception;
+        return false;
+    }
+    total += other.total;
+    return true;
+}
+
+template <class Addr>
+u64i HHH_Sketch<Addr>::estimate(const Addr &prefix, u32i mask_len) const {
+    for (auto && lvl : lvls) {
+        if (lvl.len != mask_len) continue;
+        Addr key = prefix;
+        key &= lvl.mask;
+        const u32i *slot = lvl.index.find(key);
+        return (slot ? count_of(lvl, *slot) : min_count(lvl)) * scale();
+    }
+    return 0;
+}
+
+template <class Addr>
+vector<hhh_item<Addr>> HHH_Sketch<Addr>::query(double phi) const {
+    vector<hhh_item<Addr>> ret;
+    double thr = phi * total;
+    auto inside = [](const Addr &ip, const Addr &net, u32i len) { Addr key = ip; key &= hhhmnp::gen_mask(Addr(), len); return key == net; };
+    for (size_t num = lvls.size(); num-- > 0;) { // longest prefixes first, they are subtracted from shorter ones
+        const hhh_level &lvl = lvls[num];
+        size_t longer = ret.size(); // items of previous levels
+        for (u32i idx = 0; idx < cap; idx++) {
+            const hhh_counter &ctr = lvl.ctrs[idx];
+            u64i cnt = count_of(lvl, idx), upper = cnt * scale();
+            if (!cnt) continue;
+            if (upper < thr) continue; // conditioned count is not above it
+            Addr pfx = traits::from_raw(ctr.key);
+            u64i sub {0};
+            for (size_t idx = 0; idx < longer; idx++) {
+                if (!inside(ret[idx].prefix, pfx, lvl.len)) continue;
+                bool direct {true}; // not under other reported subprefix of pfx
+                for (size_t mid = 0; direct && (mid < longer); mid++) direct = !((ret[mid].len < ret[idx].len) && inside(ret[idx].prefix, ret[mid].prefix, ret[mid].len) && inside(ret[mid].prefix, pfx, lvl.len));
+                if (direct) sub += ret[idx].lower;
+            }
+            u64i cond = (upper > sub) ? upper - sub : 0;
+            if (cond >= thr) ret.push_back({pfx, lvl.len, upper, (cnt - ctr.err) * scale(), cond});
+        }
+        sort(ret.begin() + longer, ret.end(), [](const hhh_item<Addr> &a, const hhh_item<Addr> &b) { return a.upper > b.upper; });
+    }
+    return ret;
+}
+
+template <class Addr>
+void HHH_Sketch<Addr>::clear() {
+    vector<pair<hhh_counter, u64i>> none;
+    for (auto && lvl : lvls) rebuild(lvl, none);
+    total = 0;
+}
+
+template <class Addr>
+size_t HHH_Sketch<Addr>::mem_bytes() const {
+    size_t ret {0};
+    for (auto && lvl : lvls) ret += lvl.ctrs.capacity() * sizeof(hhh_counter) + lvl.order.capacity() * sizeof(u32i) + lvl.bkts.capacity() * sizeof(hhh_bucket) + lvl.index.capacity() * (sizeof(raw_t) + sizeof(u32i) + 1);
+    return ret;
+}
+
+template class HHH_Sketch<IPv4_Addr>;
+template class HHH_Sketch<IPv6_Addr>;
@@ -0,0 +1,87 @@
+#ifndef GIA_HHH_H
+#define GIA_HHH_H
+
+#include "gia_iphash.h"
+
+using namespace std;
+
+// hierarchical heavy hitters : prefixes whose own traffic (without reported heavy subprefixes) is above share of stream,
+// one Space-Saving summary per prefix length, in sampled mode each update goes to one random level only (RHHH)
+
+class hhhmnp {
+public:
+    enum enLastError : u8i {NoError = 0, BadLevels = 1, Mismatch = 2, STL_Exception = 3}; // Mismatch - merge of sketches with other levels or capacity
+    static IPv4_Mask gen_mask(const IPv4_Addr&, u32i mask_len) { return v4mnp::gen_mask(mask_len); };
+    static IPv6_Mask gen_mask(const IPv6_Addr&, u32i mask_len) { return v6mnp::gen_mask(mask_len); };
+    static u32i bits(const IPv4_Addr&) { return 32; };
+    static u32i bits(const IPv6_Addr&) { return 128; };
+    static vector<u32i> def_levels(const IPv4_Addr&) { return {8, 16, 24, 32}; };
+    static vector<u32i> def_levels(const IPv6_Addr&) { return {32, 40, 48, 56, 64}; };
+};
+
+template <class Addr>
+struct hhh_item { // one reported prefix, counts are in units of weight
+    Addr prefix;
+    u32i len;
+    u64i upper; // estimate of whole prefix, never below true count in exact mode
+    u64i lower; // never above true count in exact mode
+    u64i cond; // upper minus lower bounds of reported subprefixes
+};
+
+template <class Addr>
+class HHH_Sketch { // fixed memory : levels * capacity counters, not thread-safe, one instance per thread and merge()
+    using traits = ipkey_traits<Addr>;
+    using raw_t = typename traits::raw_t;
+    struct hhh_counter {
+        raw_t key;
+        u64i err; // count of evicted key inherited on replacement
+        u32i pos; // in order
+        u32i bkt;
+    };
+    struct hhh_bucket { // run of counters with equal count (stream-summary)
+        u64i count;
+        u32i first, last;
+    };
+    struct hhh_level {
+        u32i len;
+        Addr mask;
+        IP_FlatMap<Addr, u32i> index; // prefix -> counter
+        vector<hhh_counter> ctrs; // capacity counters, ones with zero count have no prefix
+        vector<u32i> order; // counters by ascending count
+        vector<hhh_bucket> bkts;
+        vector<u32i> freeBkts;
+    };
+    vector<hhh_level> lvls; // ascending prefix lengths
+    u32i cap {0}; // counters per level
+    bool sampled {true};
+    u64i rng {0x9E3779B97F4A7C15};
+    u64i total {0}; // weight of all updates
+    hhhmnp::enLastError lerr {hhhmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func HHH_Sketch::init() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func HHH_Sketch::init() says: exception."};
+    void add(hhh_level &lvl, u32i ctr, u64i weight); // moves counter over runs of smaller counts
+    void touch(hhh_level &lvl, const Addr &ip, u64i weight);
+    void rebuild(hhh_level &lvl, vector<pair<hhh_counter, u64i>> &ctrs); // keeps capacity largest counters
+    u64i count_of(const hhh_level &lvl, u32i ctr) const { return lvl.bkts[lvl.ctrs[ctr].bkt].count; };
+    u64i min_count(const hhh_level &lvl) const { return count_of(lvl, lvl.order[0]); };
+    u64i scale() const { return sampled ? lvls.size() : 1; };
+public:
+    HHH_Sketch(u32i capacity = 1024, bool _sampled = true, u64i seed = 0) { init(hhhmnp::def_levels(Addr()), capacity, _sampled, seed); };
+    HHH_Sketch(const vector<u32i> &levels, u32i capacity, bool _sampled = true, u64i seed = 0) { init(levels, capacity, _sampled, seed); };
+    bool init(const vector<u32i> &levels, u32i capacity, bool _sampled = true, u64i seed = 0); // levels ascending, error of estimate is about total / capacity
+    void update(const Addr &ip, u64i weight = 1);
+    void update(const Addr *arr, size_t n); // batch, weight 1
+    void update(const Addr *arr, const u64i *weights, size_t n); // batch, e.g. bytes of packets
+    bool merge(const HHH_Sketch &other); // sketch of both streams, false on different levels or capacity
+    u64i estimate(const Addr &prefix, u32i mask_len) const; // upper bound for prefix of tracked level, 0 for other lengths
+    vector<hhh_item<Addr>> query(double phi) const; // prefixes with cond >= phi * total, longest first
+    void clear();
+    u64i count() const { return total; };
+    vector<u32i> levels() const { vector<u32i> ret; for (auto && lvl : lvls) ret.push_back(lvl.len); return ret; };
+    u32i capacity() const { return cap; };
+    bool is_sampled() const { return sampled; };
+    size_t mem_bytes() const;
+    hhhmnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_HHH_H
@@ -0,0 +1,343 @@
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include "gia_ingest.h"
+
+using namespace std;
+
+enum enCounter : u32i {BYTES, CHUNKS, READ_NS, READ_WAITS, LINES, ADDRS, BAD, PARSE_NS, PARSE_WAITS, BATCHES, SINK_NS, SINK_WAITS};
+
+static u64i now_ns() {
+    return u64i(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void backoff(u32i *spins) { // busy retry first, then give core away
+    if (++*spins > ingmnp::SPIN) this_thread::yield();
+}
+
+void ingest_batch::clear() {
+    lines = bad = 0;
+    v4.clear();
+    v6.clear();
+    macs.clear();
+    line4.clear();
+    line6.clear();
+    lineMac.clear();
+}
+
+static bool parse_field(const string &tok, u32i family, u32i line, ingest_batch *batch) {
+    size_t colons {0}, dashes {0}, dots {0};
+    for (char sym : tok) {
+        colons += (sym == ':');
+        dashes += (sym == '-');
+        dots += (sym == '.');
+    }
+    bool macLike = ((tok.size() == 17) && ((colons == 5) || (dashes == 5))) || ((tok.size() == 14) && (dots == 2));
+    if ((family == ingmnp::MAC) || ((family == ingmnp::Auto) && (macLike || dashes))) {
+        MAC_Addr mac;
+        bool good = (tok.size() == 14) ? macmnp::valid_addr(tok, 2, '.', &mac) : macmnp::valid_addr(tok, 1, colons ? ':' : '-', &mac);
+        if (good) {
+            batch->macs.push_back(mac);
+            batch->lineMac.push_back(line);
+            return true;
+        }
+        if (family == ingmnp::MAC) return false;
+    }
+    if ((family == ingmnp::IPv6) || ((family == ingmnp::Auto) && colons)) {
+        IPv6_Addr ip;
+        if (!v6mnp::valid_addr(tok, &ip)) return false;
+        batch->v6.push_back(ip);
+        batch->line6.push_back(line);
+        return true;
+    }
+    if ((family == ingmnp::IPv4) || (family == ingmnp::Auto)) {
+        IPv4_Addr ip;
+        if (!v4mnp::valid_addr(tok, &ip)) return false;
+        batch->v4.push_back(ip);
+        batch->line4.push_back(line);
+        return true;
+    }
+    return false;
+}
+
+u32i Ingest_Pipeline::parse_lines(const char *text, size_t len, const ingest_opts &opts, ingest_batch *batch) {
+    thread_local string tok; // keeps capacity between chunks
+    const char *cur = text, *end = text + len;
+    u32i line {0};
+    while (cur < end) {
+        const char *eol = (const char*)memchr(cur, '\n', end - cur);
+        if (eol == nullptr) eol = end;
+        const char *fb = cur, *fe = eol;
+        cur = eol + 1;
+        if ((fe > fb) && (fe[-1] == '\r')) fe--;
+        bool found {true};
+        if (opts.delim) {
+            for (u32i col = 0; col < opts.column; col++) {
+                const char *sep = (const char*)memchr(fb, opts.delim, fe - fb);
+                if (sep == nullptr) {
+                    found = false;
+                    break;
+                }
+                fb = sep + 1;
+            }
+            const char *sep = (const char*)memchr(fb, opts.delim, fe - fb);
+            if (sep) fe = sep;
+        }
+        while ((fb < fe) && ((*fb == ' ') || (*fb == '\t'))) fb++;
+        while ((fe > fb) && ((fe[-1] == ' ') || (fe[-1] == '\t'))) fe--;
+        if (found && (fb == fe) && !opts.delim) { // empty lines are skipped silently
+            line++;
+            continue;
+        }
+        tok.assign(fb, fe);
+        if (!found || !parse_field(tok, opts.family, line, batch)) batch->bad++;
+        line++;
+    }
+    batch->lines += line;
+    return line;
+}
+
+bool Ingest_Pipeline::run(const function<ptrdiff_t(char *buf, size_t len)> &read) {
+    u32i workers = opts.workers ? opts.workers : max(2u, thread::hardware_concurrency()) - 1;
+    u32i inflight = opts.inflight ? max(opts.inflight, 2u) : 2 * workers + 2;
+    size_t bufLen = max<size_t>(opts.buffer, 64);
+    try {
+        pool.clear();
+        pool.resize(inflight);
+        for (auto &&chk : pool) chk.buf.resize(bufLen);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = ingmnp::STL_Exception;
+        pool.clear();
+        return false;
+    }
+    for (auto &&val : cnt) val = 0;
+    stop = false;
+    lerr = ingmnp::NoError;
+    SPSC_Ring<u32i> freeRing(inflight); // sink -> reader
+    MPMC_Ring<u32i> filled(inflight); // reader -> workers
+    MPMC_Ring<u32i> parsed(inflight); // workers -> sink
+    for (u32i idx = 0; idx < inflight; idx++) freeRing.try_push(idx);
+    atomic<bool> readerDone {false};
+    atomic<u32i> live {workers};
+    atomic<bool> ioFail {false}, exFail {false};
+
+    auto reader = [&]() {
+        u64i seq {0};
+        u32i prev {~0u}; // chunk which holds beginning of unfinished line
+        size_t tailBeg {0}, tailEnd {0};
+        u64i busy {0}, waits {0};
+        try {
+            for (bool eof = false; !eof && !stop.load(memory_order_relaxed); ) {
+                u32i idx {0};
+                for (u32i spins = 0; !freeRing.try_pop(&idx); backoff(&spins)) {
+                    if (stop.load(memory_order_relaxed)) break;
+                    waits++;
+                }
+                if (stop.load(memory_order_relaxed)) break;
+                u64i start = now_ns();
+                chunk &chk = pool[idx];
+                size_t fill = tailEnd - tailBeg;
+                if (fill * 2 > chk.buf.size()) chk.buf.resize(fill * 2); // long line does not fit into regular buffer
+                if (fill) memmove(chk.buf.data(), pool[prev].buf.data() + tailBeg, fill); // only reader writes buffers, so tail of previous chunk is intact even if it came back already
+                size_t cut {0}; // bytes up to last line break
+                for (;;) {
+                    while (fill < chk.buf.size()) {
+                        ptrdiff_t got = read(chk.buf.data() + fill, chk.buf.size() - fill);
+                        if (got <= 0) {
+                            if (got < 0) ioFail = true;
+                            eof = true;
+                            break;
+                        }
+                        fill += size_t(got);
+                    }
+                    if (eof) {
+                        cut = fill;
+                        break;
+                    }
+                    const char *nl = (const char*)memrchr(chk.buf.data(), '\n', fill);
+                    if (nl) {
+                        cut = size_t(nl - chk.buf.data()) + 1;
+                        break;
+                    }
+                    chk.buf.resize(chk.buf.size() * 2); // no line break in whole buffer
+                }
+                chk.len = cut;
+                chk.batch.seq = seq++;
+                prev = idx;
+                tailBeg = cut;
+                tailEnd = fill;
+                cnt[BYTES].fetch_add(cut, memory_order_relaxed);
+                cnt[CHUNKS].fetch_add(1, memory_order_relaxed);
+                busy += now_ns() - start;
+                for (u32i spins = 0; !filled.try_push(idx); backoff(&spins)) waits++; // never full : ring holds every chunk
+            }
+        }
+        catch (bad_alloc) {
+            cerr << EX_LOW_MEM << endl;
+            exFail = true;
+            stop = true;
+        }
+        catch (...) {
+            cerr << EX_EXCEPT << endl;
+            exFail = true;
+            stop = true;
+        }
+        cnt[READ_NS].fetch_add(busy, memory_order_relaxed);
+        cnt[READ_WAITS].fetch_add(waits, memory_order_relaxed);
+        readerDone.store(true, memory_order_release);
+    };
+
+    auto worker = [&]() {
+        u64i busy {0}, waits {0};
+        try {
+            for (u32i spins = 0; ; ) {
+                u32i idx {0};
+                if (!filled.try_pop(&idx)) {
+                    if (readerDone.load(memory_order_acquire)) { // reader pushed everything before flag
+                        if (!filled.try_pop(&idx)) break;
+                    } else {
+                        waits++;
+                        backoff(&spins);
+                        continue;
+                    }
+                }
+                spins = 0;
+                chunk &chk = pool[idx];
+                chk.batch.clear();
+                if (!stop.load(memory_order_relaxed)) {
+                    u64i start = now_ns();
+                    parse_lines(chk.buf.data(), chk.len, opts, &chk.batch);
+                    if (classify) classify(chk.batch);
+                    busy += now_ns() - start;
+                    cnt[LINES].fetch_add(chk.batch.lines, memory_order_relaxed);
+                    cnt[ADDRS].fetch_add(chk.batch.v4.size() + chk.batch.v6.size() + chk.batch.macs.size(), memory_order_relaxed);
+                    cnt[BAD].fetch_add(chk.batch.bad, memory_order_relaxed);
+                }
+                while (!parsed.try_push(idx)) backoff(&spins); // never full : ring holds every chunk
+            }
+        }
+        catch (bad_alloc) {
+            cerr << EX_LOW_MEM << endl;
+            exFail = true;
+            stop = true;
+        }
+        catch (...) {
+            cerr << EX_EXCEPT << endl;
+            exFail = true;
+            stop = true;
+        }
+        cnt[PARSE_NS].fetch_add(busy, memory_order_relaxed);
+        cnt[PARSE_WAITS].fetch_add(waits, memory_order_relaxed);
+        live.fetch_sub(1, memory_order_acq_rel);
+    };
+
+    vector<thread> threads;
+    try {
+        threads.reserve(workers + 1);
+        threads.emplace_back(reader);
+        for (u32i num = 0; num < workers; num++) threads.emplace_back(worker);
+    }
+    catch (...) { // system_error if thread can not start : started ones see stop, drain rings and quit
+        cerr << EX_EXCEPT << endl;
+        stop = true;
+        for (auto &&thr : threads) thr.join();
+        lerr = ingmnp::STL_Exception;
+        return false;
+    }
+
+    // sink stage runs in calling thread, out of order chunks wait in slots by sequence number
+    vector<u32i> slots(opts.ordered ? inflight : 0, ~0u);
+    u64i nextSeq {0}, busy {0}, waits {0};
+    auto emit = [&](u32i idx) {
+        chunk &chk = pool[idx];
+        if (!stop.load(memory_order_relaxed) && chk.len) {
+            u64i start = now_ns();
+            bool more {false};
+            try {
+                more = sink(chk.batch);
+            }
+            catch (...) {
+                cerr << EX_EXCEPT << endl;
+                exFail = true;
+            }
+            busy += now_ns() - start;
+            cnt[BATCHES].fetch_add(1, memory_order_relaxed);
+            if (!more) stop = true;
+        }
+        for (u32i spins = 0; !freeRing.try_push(idx); backoff(&spins)); // never full : ring holds every chunk
+    };
+    for (u32i spins = 0; ; ) {
+        u32i idx {0};
+        if (!parsed.try_pop(&idx)) {
+            if (live.load(memory_order_acquire) == 0) {
+                if (!parsed.try_pop(&idx)) break;
+            } else {
+                waits++;
+                backoff(&spins);
+                continue;
+            }
+        }
+        spins = 0;
+        if (!opts.ordered) {
+            emit(idx);
+            continue;
+        }
+        slots[pool[idx].batch.seq % inflight] = idx; // at most inflight chunks exist, so slots never collide
+        while (slots[nextSeq % inflight] != ~0u) {
+            u32i ready = slots[nextSeq % inflight];
+            slots[nextSeq % inflight] = ~0u;
+            nextSeq++;
+            emit(ready);
+        }
+    }
+    for (auto &&thr : threads) thr.join();
+    cnt[SINK_NS].fetch_add(busy, memory_order_relaxed);
+    cnt[SINK_WAITS].fetch_add(waits, memory_order_relaxed);
+    if (exFail) lerr = ingmnp::STL_Exception;
+    else if (ioFail) lerr = ingmnp::IOError;
+    else if (stop) lerr = ingmnp::Stopped;
+    return lerr == ingmnp::NoError;
+}
+
+bool Ingest_Pipeline::run(istream &in) {
+    return run([&in](char *buf, size_t len) -> ptrdiff_t {
+        try {
+            in.read(buf, len);
+        }
+        catch (ios_base::failure &) {} // stream with exceptions() set throws at end of input too, state bits tell the rest
+        if (in.bad()) return -1;
+        return in.gcount();
+    });
+}
+
+bool Ingest_Pipeline::run(int fd) {
+    return run([fd](char *buf, size_t len) -> ptrdiff_t {
+        for (;;) {
+            ssize_t got = ::read(fd, buf, len);
+            if ((got >= 0) || (errno != EINTR)) return got;
+        }
+    });
+}
+
+bool Ingest_Pipeline::run_file(const string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        lerr = ingmnp::IOError;
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    bool ret = run(fd);
+    ::close(fd);
+    return ret;
+}
+
+ingest_stats Ingest_Pipeline::stats() const {
+    ingest_stats ret;
+    u64i *fields[] = {&ret.bytes, &ret.chunks, &ret.readNs, &ret.readWaits, &ret.lines, &ret.addrs, &ret.bad, &ret.parseNs, &ret.parseWaits, &ret.batches, &ret.sinkNs, &ret.sinkWaits};
+    for (u32i idx = 0; idx < 12; idx++) *fields[idx] = cnt[idx].load(memory_order_relaxed);
+    return ret;
+}
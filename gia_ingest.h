@@ -0,0 +1,149 @@
+#ifndef GIA_INGEST_H
+#define GIA_INGEST_H
+
+#include <atomic>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <thread>
+#include "gia_ipcol.h"
+
+using namespace std;
+
+template <class T>
+class SPSC_Ring { // bounded, one producer and one consumer, capacity is power of 2
+    vector<T> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> head {0}; // next to pop
+    alignas(64) atomic<size_t> tail {0}; // next to push
+public:
+    SPSC_Ring(size_t cap) : cells(size_t(1) << (64 - __builtin_clzll((cap < 2) ? 1 : cap - 1))), mask(cells.size() - 1) {};
+    bool try_push(const T &val) {
+        size_t pos = tail.load(memory_order_relaxed);
+        if (pos - head.load(memory_order_acquire) > mask) return false;
+        cells[pos & mask] = val;
+        tail.store(pos + 1, memory_order_release);
+        return true;
+    };
+    bool try_pop(T *val) {
+        size_t pos = head.load(memory_order_relaxed);
+        if (pos == tail.load(memory_order_acquire)) return false;
+        *val = cells[pos & mask];
+        head.store(pos + 1, memory_order_release);
+        return true;
+    };
+    size_t capacity() const { return cells.size(); };
+};
+
+template <class T>
+class MPMC_Ring { // bounded, any producers and consumers, each cell has sequence number (D. Vyukov)
+    struct cell { atomic<size_t> seq; T val; };
+    unique_ptr<cell[]> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> head {0};
+    alignas(64) atomic<size_t> tail {0};
+public:
+    MPMC_Ring(size_t cap) {
+        size_t cnt = size_t(1) << (64 - __builtin_clzll((cap < 2) ? 1 : cap - 1));
+        cells.reset(new cell[cnt]);
+        mask = cnt - 1;
+        for (size_t idx = 0; idx < cnt; idx++) cells[idx].seq.store(idx, memory_order_relaxed);
+    };
+    bool try_push(const T &val) {
+        size_t pos = tail.load(memory_order_relaxed);
+        for (;;) {
+            cell &cl = cells[pos & mask];
+            intptr_t dif = intptr_t(cl.seq.load(memory_order_acquire)) - intptr_t(pos);
+            if (dif == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cl.val = val;
+                    cl.seq.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) return false; // full
+            else pos = tail.load(memory_order_relaxed);
+        }
+    };
+    bool try_pop(T *val) {
+        size_t pos = head.load(memory_order_relaxed);
+        for (;;) {
+            cell &cl = cells[pos & mask];
+            intptr_t dif = intptr_t(cl.seq.load(memory_order_acquire)) - intptr_t(pos + 1);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    *val = cl.val;
+                    cl.seq.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) return false; // empty
+            else pos = head.load(memory_order_relaxed);
+        }
+    };
+    size_t capacity() const { return mask + 1; };
+};
+
+class ingmnp {
+public:
+    enum enFamily : u32i {Auto = 0, IPv4 = 4, IPv6 = 6, MAC = 48};
+    enum enLastError : u8i {NoError = 0, IOError = 1, Stopped = 2, STL_Exception = 3};
+    static constexpr size_t BUFFER {1 << 20}; // default bytes per chunk
+    static constexpr u32i SPIN {64}; // tries before thread yields on full or empty ring
+};
+
+struct ingest_opts {
+    u32i workers {0}; // parse threads, 0 means hardware concurrency - 1
+    size_t buffer {ingmnp::BUFFER};
+    u32i inflight {0}; // chunks in pipeline, 0 means 2 * workers + 2, bounds memory
+    u32i family {ingmnp::Auto};
+    u32i column {0}; // CSV field (from 0) or whole line if delim is 0
+    char delim {0}; // e.g. ',' or '\t', quotes are not interpreted
+    bool ordered {false}; // sink gets chunks in input order
+};
+
+struct ingest_batch { // addresses of one chunk, line numbers are relative to chunk
+    u64i seq {0}; // chunk number in input
+    u32i lines {0};
+    u32i bad {0}; // lines with field which is not address
+    IPv4Column v4;
+    IPv6Column v6;
+    MACColumn macs;
+    vector<u32i> line4, line6, lineMac; // line of each value
+    void clear();
+};
+
+struct ingest_stats { // per stage : items and nanoseconds of work, waits on full or empty rings
+    u64i bytes {0}, chunks {0}, readNs {0}, readWaits {0};
+    u64i lines {0}, addrs {0}, bad {0}, parseNs {0}, parseWaits {0};
+    u64i batches {0}, sinkNs {0}, sinkWaits {0};
+};
+
+using Ingest_Classify = function<void(ingest_batch &batch)>; // runs in parse workers
+using Ingest_Sink = function<bool(const ingest_batch &batch)>; // runs in one thread, false stops pipeline
+
+class Ingest_Pipeline { // reader thread -> parse workers -> sink, chunks are recycled so memory is bounded
+    struct chunk {
+        vector<char> buf;
+        size_t len {0}; // valid bytes, ends at line boundary
+        ingest_batch batch;
+    };
+    ingest_opts opts;
+    Ingest_Classify classify;
+    Ingest_Sink sink;
+    vector<chunk> pool;
+    atomic<u64i> cnt[12]; // ingest_stats fields in order
+    atomic<bool> stop {false};
+    ingmnp::enLastError lerr {ingmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func Ingest_Pipeline::run() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func Ingest_Pipeline::run() says: exception."};
+    bool run(const function<ptrdiff_t(char *buf, size_t len)> &read); // read returns bytes, 0 at the end, -1 on error
+public:
+    Ingest_Pipeline(const ingest_opts &_opts, const Ingest_Sink &_sink, const Ingest_Classify &_classify = nullptr) : opts(_opts), classify(_classify), sink(_sink) { for (auto && val : cnt) val = 0; };
+    bool run(istream &in);
+    bool run(int fd); // e.g. 0 for stdin, pipe or file descriptor
+    bool run_file(const string &path);
+    ingest_stats stats() const;
+    ingmnp::enLastError last_err() const { return lerr; };
+    static u32i parse_lines(const char *text, size_t len, const ingest_opts &opts, ingest_batch *batch); // single chunk in calling thread
+};
+
+#endif // GIA_INGEST_H
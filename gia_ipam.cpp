@@ -0,0 +1,346 @@
+#include "gia_ipam.h"
+#include <algorithm>
+#include <memory.h>
+
+using namespace std;
+
+static const u8i SNAP_MAGIC[4] {'G', 'I', 'A', 'P'};
+static const u8i SNAP_VERSION {1};
+
+static void put_u64i(vector<u8i> &out, u64i val) { // little-endian
+    for (u32i idx = 0; idx < 8; idx++) out.push_back(u8i(val >> (8 * idx)));
+}
+
+static u64i get_u64i(const u8i *ptr) {
+    u64i ret {0};
+    for (u32i idx = 0; idx < 8; idx++) ret |= u64i(ptr[idx]) << (8 * idx);
+    return ret;
+}
+
+static void put_varint(vector<u8i> &out, u64i val) { // LEB128
+    while (val >= 0x80) {
+        out.push_back(u8i(val) | 0x80);
+        val >>= 7;
+    }
+    out.push_back(u8i(val));
+}
+
+static bool get_varint(const u8i *&ptr, const u8i *end, u64i *ret) {
+    u64i val {0};
+    for (u32i shift = 0; (ptr < end) && (shift < 64); shift += 7) {
+        u8i byte = *ptr++;
+        val |= u64i(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) { *ret = val; return true; }
+    }
+    return false;
+}
+
+// snapshot layout : magic[4], version, family (4 or 6), mask_len, max_len, base.ms, base.ls, count, varint deltas of allocated nodes
+static vector<u8i> snap_write(u8i family, u32i mask_len, u32i max_len, u64i ms, u64i ls, const vector<u64i> &nodes) {
+    vector<u8i> ret;
+    ret.reserve(32 + nodes.size() * 2);
+    for (auto && ch : SNAP_MAGIC) ret.push_back(ch);
+    ret.push_back(SNAP_VERSION);
+    ret.push_back(family);
+    ret.push_back(u8i(mask_len));
+    ret.push_back(u8i(max_len));
+    put_u64i(ret, ms);
+    put_u64i(ret, ls);
+    put_u64i(ret, nodes.size());
+    u64i prev {0};
+    for (auto && node : nodes) {
+        put_varint(ret, node - prev);
+        prev = node;
+    }
+    return ret;
+}
+
+static bool snap_read(const vector<u8i> &snap, u8i family, u32i *mask_len, u32i *max_len, u64i *ms, u64i *ls, vector<u64i> *nodes) {
+    if (snap.size() < 32) return false;
+    const u8i *ptr = snap.data();
+    if ((ptr[0] != SNAP_MAGIC[0]) || (ptr[1] != SNAP_MAGIC[1]) || (ptr[2] != SNAP_MAGIC[2]) || (ptr[3] != SNAP_MAGIC[3])) return false;
+    if ((ptr[4] != SNAP_VERSION) || (ptr[5] != family)) return false;
+    *mask_len = ptr[6];
+    *max_len = ptr[7];
+    *ms = get_u64i(ptr + 8);
+    *ls = get_u64i(ptr + 16);
+    u64i cnt = get_u64i(ptr + 24);
+    const u8i *end = ptr + snap.size();
+    ptr += 32;
+    if (cnt > u64i(end - ptr)) return false; // at least one byte per node
+    nodes->clear();
+    nodes->reserve(cnt);
+    u64i node {0}, delta;
+    for (u64i idx = 0; idx < cnt; idx++) {
+        if (!get_varint(ptr, end, &delta)) return false;
+        node += delta;
+        if ((node == 0) || (node >> 62)) return false;
+        nodes->push_back(node);
+    }
+    return ptr == end;
+}
+
+static u32i node_lvl(u64i node) { return 63 - __builtin_clzll(node); }
+
+static ipammnp::enLastError snap_tree(u32i mask_len, u32i max_len, const vector<u64i> &nodes, ipam_tree *out) { // tree of snapshot, built aside from pool
+    if ((max_len < mask_len) || ((max_len - mask_len) > ipammnp::MAX_DEPTH)) return ipammnp::BadSnapshot;
+    if (!out->init(max_len - mask_len)) return ipammnp::STL_Exception;
+    for (auto && node : nodes) {
+        u32i lvl = node_lvl(node);
+        if (out->alloc_at(lvl, node - (u64i(1) << lvl)) != ipammnp::NoError) return ipammnp::BadSnapshot;
+    }
+    return ipammnp::NoError;
+}
+
+bool ipam_tree::init(u32i _depth) {
+    if (_depth > ipammnp::MAX_DEPTH) return false;
+    depth = _depth;
+    used = 0;
+    u64i nodes = u64i(2) << depth;
+    try {
+        freeLvl.assign(nodes, 0);
+        allocBits.assign((nodes + 63) / 64, 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        freeLvl.clear();
+        allocBits.clear();
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        freeLvl.clear();
+        allocBits.clear();
+        return false;
+    }
+    for (u32i lvl = 0; lvl <= depth; lvl++) { // every block is free
+        memset(&freeLvl[u64i(1) << lvl], lvl, u64i(1) << lvl);
+    }
+    return true;
+}
+
+void ipam_tree::update_up(u64i node, u32i lvl) {
+    while (node > 1) {
+        node >>= 1;
+        lvl--;
+        if (is_alloc(node)) return; // ancestors of allocated block are already up to date
+        u8i left = freeLvl[2 * node], right = freeLvl[2 * node + 1];
+        freeLvl[node] = ((left == lvl + 1) && (right == lvl + 1)) ? u8i(lvl) : min(left, right);
+    }
+}
+
+bool ipam_tree::alloc(u32i lvl, u64i *idx) {
+    if (freeLvl.empty() || (lvl > depth) || (freeLvl[1] > lvl)) return false;
+    u64i node {1};
+    for (u32i cur = 0; cur < lvl; cur++) {
+        u8i left = freeLvl[2 * node], right = freeLvl[2 * node + 1];
+        node <<= 1;
+        if (left > lvl) {
+            node++;
+        } else {
+            if ((right <= lvl) && (right > left)) node++; // right one is tighter
+        }
+    }
+    allocBits[node >> 6] |= u64i(1) << (node & 63);
+    freeLvl[node] = ipammnp::NONE;
+    used += u64i(1) << (depth - lvl);
+    update_up(node, lvl);
+    *idx = node - (u64i(1) << lvl);
+    return true;
+}
+
+ipammnp::enLastError ipam_tree::alloc_at(u32i lvl, u64i idx) {
+    if (freeLvl.empty() || (lvl > depth) || (idx >= (u64i(1) << lvl))) return ipammnp::BadPrefix;
+    u64i node = (u64i(1) << lvl) + idx;
+    for (u32i shift = lvl; shift > 0; shift--) {
+        if (is_alloc(node >> shift)) return ipammnp::Busy;
+    }
+    if (freeLvl[node] != lvl) return ipammnp::Busy;
+    allocBits[node >> 6] |= u64i(1) << (node & 63);
+    freeLvl[node] = ipammnp::NONE;
+    used += u64i(1) << (depth - lvl);
+    update_up(node, lvl);
+    return ipammnp::NoError;
+}
+
+ipammnp::enLastError ipam_tree::free(u32i lvl, u64i idx) {
+    if (freeLvl.empty() || (lvl > depth) || (idx >= (u64i(1) << lvl))) return ipammnp::BadPrefix;
+    u64i node = (u64i(1) << lvl) + idx;
+    if (!is_alloc(node)) return ipammnp::NotAllocated;
+    allocBits[node >> 6] &= ~(u64i(1) << (node & 63));
+    freeLvl[node] = u8i(lvl); // descendants stayed free while block was allocated
+    used -= u64i(1) << (depth - lvl);
+    update_up(node, lvl);
+    return ipammnp::NoError;
+}
+
+vector<u64i> ipam_tree::alloc_nodes() const {
+    vector<u64i> ret;
+    for (u64i word = 0; word < allocBits.size(); word++) {
+        u64i bits = allocBits[word];
+        while (bits) {
+            ret.push_back(word * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    return ret;
+}
+
+bool IPv4_Pool::init(const IPv4_Addr &net, u32i mask_len, u32i max_len) {
+    lerr = ipammnp::BadPrefix;
+    if ((mask_len > 32) || (max_len > 32) || (max_len < mask_len) || ((max_len - mask_len) > ipammnp::MAX_DEPTH)) return false;
+    if (!tree.init(max_len - mask_len)) { lerr = ipammnp::STL_Exception; return false; }
+    base = net() & v4mnp::gen_mask(mask_len)();
+    mlen = mask_len;
+    maxlen = max_len;
+    lerr = ipammnp::NoError;
+    return true;
+}
+
+bool IPv4_Pool::to_block(const IPv4_Addr &net, u32i len, u64i *idx) const {
+    if ((len < mlen) || (len > maxlen)) return false;
+    if ((net() & v4mnp::gen_mask(mlen)()) != base) return false; // outside of parent prefix
+    if (net() & ~v4mnp::gen_mask(len)()) return false; // host bits are set
+    *idx = u64i(net() - base) >> (32 - len);
+    return true;
+}
+
+bool IPv4_Pool::alloc(u32i len, IPv4_Addr *ret) {
+    if ((len < mlen) || (len > maxlen)) { lerr = ipammnp::BadPrefix; return false; }
+    u64i idx;
+    if (!tree.alloc(len - mlen, &idx)) { lerr = ipammnp::NoSpace; return false; }
+    if (ret != nullptr) *ret = IPv4_Addr(u32i(base | (idx << (32 - len))));
+    lerr = ipammnp::NoError;
+    return true;
+}
+
+bool IPv4_Pool::alloc(const IPv4_Addr &net, u32i len) {
+    u64i idx;
+    if (!to_block(net, len, &idx)) { lerr = ipammnp::BadPrefix; return false; }
+    lerr = tree.alloc_at(len - mlen, idx);
+    return lerr == ipammnp::NoError;
+}
+
+bool IPv4_Pool::free(const IPv4_Addr &net, u32i len) {
+    u64i idx;
+    if (!to_block(net, len, &idx)) { lerr = ipammnp::BadPrefix; return false; }
+    lerr = tree.free(len - mlen, idx);
+    return lerr == ipammnp::NoError;
+}
+
+vector<pair<IPv4_Addr,u32i>> IPv4_Pool::allocations() const {
+    vector<pair<IPv4_Addr,u32i>> ret;
+    for (auto && node : tree.alloc_nodes()) {
+        u32i lvl = node_lvl(node);
+        u32i len = mlen + lvl;
+        u64i idx = node - (u64i(1) << lvl);
+        ret.push_back({IPv4_Addr(u32i(base | (idx << (32 - len)))), len});
+    }
+    sort(ret.begin(), ret.end(), [](const pair<IPv4_Addr,u32i> &a, const pair<IPv4_Addr,u32i> &b) { return a.first < b.first; });
+    return ret;
+}
+
+vector<u8i> IPv4_Pool::snapshot() const {
+    return snap_write(4, mlen, maxlen, 0, base, tree.alloc_nodes());
+}
+
+bool IPv4_Pool::restore(const vector<u8i> &snap) {
+    u32i mask_len, max_len;
+    u64i ms, ls;
+    vector<u64i> nodes;
+    if (!snap_read(snap, 4, &mask_len, &max_len, &ms, &ls, &nodes) || (ms != 0) || (ls > UINT32_MAX) || (mask_len > 32) || (max_len > 32)) { lerr = ipammnp::BadSnapshot; return false; }
+    ipam_tree fresh; // current allocations stay intact unless whole snapshot is good
+    if ((lerr = snap_tree(mask_len, max_len, nodes, &fresh)) != ipammnp::NoError) return false;
+    tree = move(fresh);
+    base = u32i(ls) & v4mnp::gen_mask(mask_len)();
+    mlen = mask_len;
+    maxlen = max_len;
+    return true;
+}
+
+bool IPv6_Pool::init(const IPv6_Addr &net, u32i mask_len, u32i max_len) {
+    lerr = ipammnp::BadPrefix;
+    if ((mask_len > 128) || (max_len > 128) || (max_len < mask_len) || ((max_len - mask_len) > ipammnp::MAX_DEPTH)) return false;
+    if (!tree.init(max_len - mask_len)) { lerr = ipammnp::STL_Exception; return false; }
+    IPv6_Addr interim {net};
+    interim &= v6mnp::gen_mask(mask_len);
+    bms = interim().ms;
+    bls = interim().ls;
+    mlen = mask_len;
+    maxlen = max_len;
+    lerr = ipammnp::NoError;
+    return true;
+}
+
+bool IPv6_Pool::to_block(const IPv6_Addr &net, u32i len, u64i *idx) const {
+    if ((len < mlen) || (len > maxlen)) return false;
+    IPv6_Addr interim {net};
+    interim &= v6mnp::gen_mask(mlen);
+    if (interim != IPv6_Addr(bms, bls)) return false; // outside of parent prefix
+    interim = net;
+    interim &= v6mnp::gen_mask(len);
+    if (interim != net) return false; // host bits are set
+    interim -= IPv6_Addr(bms, bls);
+    *idx = (interim >> (128 - len))().ls; // depth <= 24, so index fits in least signif. part
+    return true;
+}
+
+IPv6_Addr IPv6_Pool::to_net(u32i len, u64i idx) const {
+    IPv6_Addr ret {IPv6_Addr(0, idx) << (128 - len)};
+    ret |= IPv6_Addr(bms, bls);
+    return ret;
+}
+
+bool IPv6_Pool::alloc(u32i len, IPv6_Addr *ret) {
+    if ((len < mlen) || (len > maxlen)) { lerr = ipammnp::BadPrefix; return false; }
+    u64i idx;
+    if (!tree.alloc(len - mlen, &idx)) { lerr = ipammnp::NoSpace; return false; }
+    if (ret != nullptr) *ret = to_net(len, idx);
+    lerr = ipammnp::NoError;
+    return true;
+}
+
+bool IPv6_Pool::alloc(const IPv6_Addr &net, u32i len) {
+    u64i idx;
+    if (!to_block(net, len, &idx)) { lerr = ipammnp::BadPrefix; return false; }
+    lerr = tree.alloc_at(len - mlen, idx);
+    return lerr == ipammnp::NoError;
+}
+
+bool IPv6_Pool::free(const IPv6_Addr &net, u32i len) {
+    u64i idx;
+    if (!to_block(net, len, &idx)) { lerr = ipammnp::BadPrefix; return false; }
+    lerr = tree.free(len - mlen, idx);
+    return lerr == ipammnp::NoError;
+}
+
+vector<pair<IPv6_Addr,u32i>> IPv6_Pool::allocations() const {
+    vector<pair<IPv6_Addr,u32i>> ret;
+    for (auto && node : tree.alloc_nodes()) {
+        u32i lvl = node_lvl(node);
+        ret.push_back({to_net(mlen + lvl, node - (u64i(1) << lvl)), mlen + lvl});
+    }
+    sort(ret.begin(), ret.end(), [](const pair<IPv6_Addr,u32i> &a, const pair<IPv6_Addr,u32i> &b) { return a.first < b.first; });
+    return ret;
+}
+
+vector<u8i> IPv6_Pool::snapshot() const {
+    return snap_write(6, mlen, maxlen, bms, bls, tree.alloc_nodes());
+}
+
+bool IPv6_Pool::restore(const vector<u8i> &snap) {
+    u32i mask_len, max_len;
+    u64i ms, ls;
+    vector<u64i> nodes;
+    if (!snap_read(snap, 6, &mask_len, &max_len, &ms, &ls, &nodes) || (mask_len > 128) || (max_len > 128)) { lerr = ipammnp::BadSnapshot; return false; }
+    ipam_tree fresh;
+    if ((lerr = snap_tree(mask_len, max_len, nodes, &fresh)) != ipammnp::NoError) return false;
+    tree = move(fresh);
+    IPv6_Addr interim(ms, ls);
+    interim &= v6mnp::gen_mask(mask_len);
+    bms = interim().ms;
+    bls = interim().ls;
+    mlen = mask_len;
+    maxlen = max_len;
+    return true;
+}
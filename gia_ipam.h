@@ -0,0 +1,79 @@
+#ifndef GIA_IPAM_H
+#define GIA_IPAM_H
+
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+class ipammnp {
+public:
+    static const u32i MAX_DEPTH {24}; // max_len - mask_len, tree of 2^25 nodes takes ~36 MiB
+    static const u8i NONE {0xFF}; // no free blocks in subtree
+    enum enLastError : u8i {NoError = 0, BadPrefix = 1, NoSpace = 2, Busy = 3, NotAllocated = 4, BadSnapshot = 5, STL_Exception = 6};
+};
+
+class ipam_tree { // buddy tree : node [1] is root, children of node [n] are [2n] and [2n+1], level of root is 0
+    u32i depth {0};
+    vector<u8i> freeLvl; // per node : level of the largest free block in subtree, or ipammnp::NONE
+    vector<u64i> allocBits; // per node : node is allocated as a whole
+    u64i used {0}; // leaf blocks in use
+    static inline const char EX_LOW_MEM[] = {"func ipam_tree::init() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func ipam_tree::init() says: exception."};
+    bool is_alloc(u64i node) const { return (allocBits[node >> 6] >> (node & 63)) & 1; };
+    void update_up(u64i node, u32i lvl);
+public:
+    bool init(u32i _depth);
+    bool alloc(u32i lvl, u64i *idx); // goes down into child whose largest free block is smaller, leftmost on tie : keeps big blocks whole, not strict best fit
+    ipammnp::enLastError alloc_at(u32i lvl, u64i idx);
+    ipammnp::enLastError free(u32i lvl, u64i idx);
+    u32i what_depth() const { return depth; };
+    u64i used_blocks() const { return used; };
+    u64i total_blocks() const { return u64i(1) << depth; };
+    vector<u64i> alloc_nodes() const; // allocated nodes in ascending order
+};
+
+class IPv4_Pool { // subnet allocator within parent prefix net/mask_len, prefixes from /mask_len up to /max_len
+    ipam_tree tree;
+    u32i base {0};
+    u32i mlen {32};
+    u32i maxlen {32};
+    ipammnp::enLastError lerr {ipammnp::NoError};
+    bool to_block(const IPv4_Addr &net, u32i len, u64i *idx) const;
+public:
+    IPv4_Pool() {};
+    IPv4_Pool(const IPv4_Addr &net, u32i mask_len, u32i max_len) { init(net, mask_len, max_len); };
+    bool init(const IPv4_Addr &net, u32i mask_len, u32i max_len); // drops all allocations
+    bool alloc(u32i len, IPv4_Addr *ret); // free /len from tighter subtree, see ipam_tree::alloc()
+    bool alloc(const IPv4_Addr &net, u32i len); // specific prefix
+    bool free(const IPv4_Addr &net, u32i len);
+    double utilization() const { return double(tree.used_blocks()) / double(tree.total_blocks()); }; // 0.0 - 1.0
+    u64i used_addrs() const { return tree.used_blocks() << (32 - maxlen); };
+    vector<pair<IPv4_Addr,u32i>> allocations() const; // list of allocated prefixes in ascending order
+    vector<u8i> snapshot() const; // compact binary state
+    bool restore(const vector<u8i> &snap); // state from snapshot()
+    ipammnp::enLastError last_err() const { return lerr; };
+};
+
+class IPv6_Pool { // subnet allocator within parent prefix net/mask_len, prefixes from /mask_len up to /max_len
+    ipam_tree tree;
+    u64i bms {0}, bls {0}; // network address of parent prefix
+    u32i mlen {128};
+    u32i maxlen {128};
+    ipammnp::enLastError lerr {ipammnp::NoError};
+    bool to_block(const IPv6_Addr &net, u32i len, u64i *idx) const;
+    IPv6_Addr to_net(u32i len, u64i idx) const;
+public:
+    IPv6_Pool() {};
+    IPv6_Pool(const IPv6_Addr &net, u32i mask_len, u32i max_len) { init(net, mask_len, max_len); };
+    bool init(const IPv6_Addr &net, u32i mask_len, u32i max_len); // drops all allocations
+    bool alloc(u32i len, IPv6_Addr *ret); // free /len from tighter subtree, see ipam_tree::alloc()
+    bool alloc(const IPv6_Addr &net, u32i len); // specific prefix
+    bool free(const IPv6_Addr &net, u32i len);
+    double utilization() const { return double(tree.used_blocks()) / double(tree.total_blocks()); }; // 0.0 - 1.0
+    vector<pair<IPv6_Addr,u32i>> allocations() const; // list of allocated prefixes in ascending order
+    vector<u8i> snapshot() const; // compact binary state
+    bool restore(const vector<u8i> &snap); // state from snapshot()
+    ipammnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_IPAM_H
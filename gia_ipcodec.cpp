@@ -0,0 +1,250 @@
+#include "gia_ipcodec.h"
+#include <memory.h>
+#include <utility>
+
+using namespace std;
+
+struct pak_header {
+    char magic[8];
+    u32i version;
+    u32i family;
+    u8i reserved[48];
+};
+struct pak_trailer { // at the very end, written when all blocks are known
+    u64i count;
+    u64i blocks;
+    u64i dirOffset;
+    u32i family;
+    u32i version;
+    u8i reserved[24];
+    char magic[8];
+};
+static_assert(sizeof(pak_header) == pakmnp::HEADER_LEN, "header must take one cache line");
+static_assert(sizeof(pak_trailer) == 64, "trailer must take one cache line");
+static_assert(sizeof(pak_block) == 48, "block header layout is part of file format");
+
+static const char PAK_MAGIC[8] {'G', 'I', 'A', 'P', 'A', 'K', 0, 0};
+static const char PAK_END[8] {'G', 'I', 'A', 'P', 'A', 'K', 'E', 'N'};
+
+static u32i bit_width(u64i val) { return (val == 0) ? 0 : 64 - __builtin_clzll(val); }
+static u64i lane_words(u32i cnt, u32i width) { return (u64i(cnt) * width + 63) >> 6; }
+
+static void pack_lane(const u64i *vals, u32i cnt, u32i width, u64i *out) { // value n takes bits [n * width, (n + 1) * width)
+    if (width == 0) return;
+    memset(out, 0, lane_words(cnt, width) * 8);
+    for (u32i idx = 0; idx < cnt; idx++) {
+        u64i bit = u64i(idx) * width;
+        u32i off = bit & 63;
+        out[bit >> 6] |= vals[idx] << off;
+        if (off + width > 64) out[(bit >> 6) + 1] |= vals[idx] >> (64 - off);
+    }
+}
+
+template <u32i W>
+static void unpack_lane(const u64i *in, u32i cnt, u64i *out) { // width is constant, so every 64 values take W words with offsets known at compile time
+    if constexpr (W == 0) {
+        memset(out, 0, size_t(cnt) * 8);
+    }
+    else {
+        const u64i mask = (W == 64) ? ~u64i(0) : (u64i(1) << (W & 63)) - 1;
+        u32i full = cnt & ~u32i(63);
+        for (u32i grp = 0; grp < full; grp += 64, in += W, out += 64) {
+#pragma GCC unroll 64
+            for (u32i idx = 0; idx < 64; idx++) {
+                u32i bit = idx * W;
+                u32i off = bit & 63;
+                u64i val = in[bit >> 6] >> off;
+                if (off + W > 64) val |= in[(bit >> 6) + 1] << (64 - off);
+                out[idx] = val & mask;
+            }
+        }
+        for (u32i idx = 0; idx < cnt - full; idx++) { // tail of last block
+            u64i bit = u64i(idx) * W;
+            u32i off = bit & 63;
+            u64i val = in[bit >> 6] >> off;
+            if (off + W > 64) val |= in[(bit >> 6) + 1] << (64 - off);
+            out[idx] = val & mask;
+        }
+    }
+}
+
+using unpack_func = void (*)(const u64i*, u32i, u64i*);
+
+template <size_t... W>
+static constexpr array<unpack_func, sizeof...(W)> make_unpackers(index_sequence<W...>) { return {&unpack_lane<W>...}; }
+
+static constexpr array<unpack_func, 65> UNPACK = make_unpackers(make_index_sequence<65>());
+
+ippak_writer::ippak_writer(ostream &_os, u32i _family) : os(_os), family(_family) {
+    if ((family != pakmnp::IPv4) && (family != pakmnp::IPv6) && (family != pakmnp::MAC)) {
+        lerr = pakmnp::BadFamily;
+        return;
+    }
+    pak_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, PAK_MAGIC, sizeof(hdr.magic));
+    hdr.version = pakmnp::VERSION;
+    hdr.family = family;
+    write(&hdr, sizeof(hdr));
+}
+
+bool ippak_writer::write(const void *data, size_t len) {
+    if (!os.write((const char*)data, len)) {
+        lerr = pakmnp::IOError;
+        return false;
+    }
+    pos += len;
+    return true;
+}
+
+bool ippak_writer::push(u64i ms, u64i ls) {
+    if ((lerr != pakmnp::NoError) || finished) return false;
+    if (total && ((ms < prevMs) || ((ms == prevMs) && (ls < prevLs)))) {
+        lerr = pakmnp::NotSorted;
+        return false;
+    }
+    bufMs[fill] = prevMs = ms;
+    bufLs[fill] = prevLs = ls;
+    total++;
+    if (++fill == pakmnp::BLOCK) return flush_block();
+    return true;
+}
+
+bool ippak_writer::flush_block() {
+    if (fill == 0) return true;
+    pak_block blk;
+    memset(&blk, 0, sizeof(blk));
+    blk.minMs = bufMs[0];
+    blk.minLs = bufLs[0];
+    blk.maxMs = bufMs[fill - 1];
+    blk.maxLs = bufLs[fill - 1];
+    blk.count = fill;
+    u64i lanA[pakmnp::BLOCK], lanB[pakmnp::BLOCK];
+    u64i orA {0}, orB {0};
+    lanA[0] = lanB[0] = 0; // first value is in block header
+    for (u32i idx = 1; idx < fill; idx++) {
+        lanA[idx] = bufMs[idx] - bufMs[idx - 1];
+        lanB[idx] = lanA[idx] ? bufLs[idx] : bufLs[idx] - bufLs[idx - 1];
+        orA |= lanA[idx];
+        orB |= lanB[idx];
+    }
+    blk.widthA = bit_width(orA);
+    blk.widthB = bit_width(orB);
+    u64i wordsA = lane_words(fill, blk.widthA);
+    blk.words = wordsA + lane_words(fill, blk.widthB);
+    try {
+        words.assign(blk.words, 0);
+        dir.push_back(pos);
+    }
+    catch (...) {
+        lerr = pakmnp::STL_Exception;
+        return false;
+    }
+    pack_lane(lanA, fill, blk.widthA, words.data());
+    pack_lane(lanB, fill, blk.widthB, words.data() + wordsA);
+    fill = 0;
+    return write(&blk, sizeof(blk)) && write(words.data(), words.size() * 8);
+}
+
+bool ippak_writer::finish() {
+    if ((lerr != pakmnp::NoError) || finished) return false;
+    if (!flush_block()) return false;
+    pak_trailer trl;
+    memset(&trl, 0, sizeof(trl));
+    trl.count = total;
+    trl.blocks = dir.size();
+    trl.dirOffset = pos;
+    trl.family = family;
+    trl.version = pakmnp::VERSION;
+    memcpy(trl.magic, PAK_END, sizeof(trl.magic));
+    finished = true;
+    if (!write(dir.data(), dir.size() * 8) || !write(&trl, sizeof(trl))) return false;
+    os.flush();
+    return true;
+}
+
+bool ippak_reader::open(const string &path, u32i _family) {
+    base = nullptr;
+    if (!file.open(path)) {
+        lerr = pakmnp::IOError;
+        return false;
+    }
+    file.advise_seq();
+    return view(file.data(), file.size(), _family);
+}
+
+bool ippak_reader::view(const u8i *image, size_t len, u32i _family) {
+    base = nullptr;
+    lerr = pakmnp::BadImage;
+    pak_header hdr;
+    pak_trailer trl;
+    if ((image == nullptr) || (len < sizeof(hdr) + sizeof(trl)) || (uintptr_t(image) & 7)) return false;
+    memcpy(&hdr, image, sizeof(hdr));
+    memcpy(&trl, image + len - sizeof(trl), sizeof(trl));
+    if ((memcmp(hdr.magic, PAK_MAGIC, sizeof(hdr.magic)) != 0) || (memcmp(trl.magic, PAK_END, sizeof(trl.magic)) != 0)) return false;
+    if ((hdr.version != pakmnp::VERSION) || (trl.version != pakmnp::VERSION) || (hdr.family != trl.family)) return false;
+    if (hdr.family != _family) {
+        lerr = pakmnp::BadFamily;
+        return false;
+    }
+    u64i dirEnd = len - sizeof(trl);
+    if ((trl.dirOffset & 7) || (trl.dirOffset < sizeof(hdr)) || (trl.dirOffset > dirEnd) || (trl.blocks != (dirEnd - trl.dirOffset) / 8)) return false;
+    const u64i *offsets = (const u64i*)(image + trl.dirOffset);
+    for (u64i idx = 0; idx < trl.blocks; idx++) { // block headers themselves are checked on decode, so pages are not touched here
+        if ((offsets[idx] & 7) || (offsets[idx] < sizeof(hdr)) || (offsets[idx] + sizeof(pak_block) > trl.dirOffset)) return false;
+        if (idx && (offsets[idx] <= offsets[idx - 1])) return false;
+    }
+    if ((trl.count > trl.blocks * pakmnp::BLOCK) || (trl.count < trl.blocks)) return false;
+    dir = offsets;
+    dataEnd = trl.dirOffset;
+    total = trl.count;
+    blocks = trl.blocks;
+    family = hdr.family;
+    cursor = 0;
+    base = image;
+    lerr = pakmnp::NoError;
+    return true;
+}
+
+u32i ippak_reader::decode(u64i idx, u64i *ms, u64i *ls) const {
+    if ((base == nullptr) || (idx >= blocks)) return 0;
+    const pak_block &blk = block(idx);
+    const u64i *payload = (const u64i*)(&blk + 1);
+    u32i cnt = blk.count;
+    if ((cnt == 0) || (cnt > pakmnp::BLOCK) || (blk.widthA > 64) || (blk.widthB > 64)) return 0;
+    if ((blk.words != lane_words(cnt, blk.widthA) + lane_words(cnt, blk.widthB)) || (u64i(blk.words) * 8 > dataEnd - dir[idx] - sizeof(pak_block))) return 0; // damaged block reads as empty
+    if (blk.widthA == 0) { // single run of ms, it is always so for IPv4 and MAC
+        UNPACK[blk.widthB](payload, cnt, ls);
+        u64i acc = blk.minLs;
+        for (u32i pos = 0; pos < cnt; pos++) {
+            acc += ls[pos];
+            ls[pos] = acc;
+            ms[pos] = blk.minMs;
+        }
+        return cnt;
+    }
+    UNPACK[blk.widthA](payload, cnt, ms);
+    UNPACK[blk.widthB](payload + lane_words(cnt, blk.widthA), cnt, ls);
+    u64i accMs = blk.minMs, accLs = blk.minLs;
+    for (u32i pos = 0; pos < cnt; pos++) {
+        if (ms[pos]) {
+            accMs += ms[pos];
+            accLs = ls[pos];
+        }
+        else accLs += ls[pos];
+        ms[pos] = accMs;
+        ls[pos] = accLs;
+    }
+    return cnt;
+}
+
+u64i ippak_reader::find_block(u64i ms, u64i ls) const {
+    u64i low {0}, high {blocks};
+    while (low < high) {
+        u64i mid = (low + high) / 2;
+        const pak_block &blk = block(mid);
+        if ((blk.maxMs < ms) || ((blk.maxMs == ms) && (blk.maxLs < ls))) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
@@ -0,0 +1,128 @@
+#ifndef GIA_IPCODEC_H
+#define GIA_IPCODEC_H
+
+#include <ostream>
+#include "gia_mmap.h"
+
+using namespace std;
+
+class pakmnp {
+public:
+    static constexpr u32i BLOCK {256}; // values per block
+    static constexpr u32i VERSION {1};
+    static constexpr size_t HEADER_LEN {64};
+    enum enFamily : u32i {IPv4 = 4, IPv6 = 6, MAC = 48};
+    enum enLastError : u8i {NoError = 0, NotSorted = 1, BadImage = 2, BadFamily = 3, IOError = 4, STL_Exception = 5};
+    static constexpr u32i family_of(const IPv4_Addr *) { return IPv4; };
+    static constexpr u32i family_of(const IPv6_Addr *) { return IPv6; };
+    static constexpr u32i family_of(const MAC_Addr *) { return MAC; };
+    static void to_key(const IPv4_Addr &ip, u64i *ms, u64i *ls) { *ms = 0; *ls = ip(); };
+    static void to_key(const IPv6_Addr &ip, u64i *ms, u64i *ls) { *ms = ip().ms; *ls = ip().ls; };
+    static void to_key(const MAC_Addr &mac, u64i *ms, u64i *ls) { *ms = 0; *ls = mac(); };
+    static void from_key(u64i, u64i ls, IPv4_Addr *ret) { *ret = IPv4_Addr(u32i(ls)); };
+    static void from_key(u64i ms, u64i ls, IPv6_Addr *ret) { *ret = IPv6_Addr(ms, ls); };
+    static void from_key(u64i, u64i ls, MAC_Addr *ret) { *ret = MAC_Addr(ls); };
+};
+
+struct pak_block { // block header, bit-packed lanes follow : A - deltas of ms, B - deltas of ls (or ls itself where ms has changed)
+    u64i minMs, minLs; // first value
+    u64i maxMs, maxLs; // last value
+    u32i count;
+    u8i widthA, widthB; // bits per value in lane
+    u16i reserved;
+    u32i words; // payload length in 64-bit words
+    u32i reserved2;
+};
+
+class ippak_writer { // encoder over (ms, ls) keys
+    ostream &os;
+    u32i family;
+    u64i bufMs[pakmnp::BLOCK], bufLs[pakmnp::BLOCK];
+    u32i fill {0};
+    u64i total {0};
+    u64i pos {0}; // bytes written
+    u64i prevMs {0}, prevLs {0};
+    vector<u64i> dir; // block offsets
+    vector<u64i> words;
+    bool finished {false};
+    pakmnp::enLastError lerr {pakmnp::NoError};
+    bool write(const void *data, size_t len);
+    bool flush_block();
+public:
+    ippak_writer(ostream &_os, u32i _family);
+    bool push(u64i ms, u64i ls); // values must be non-decreasing
+    bool finish(); // last block, directory and trailer
+    u64i count() const { return total; };
+    pakmnp::enLastError last_err() const { return lerr; };
+};
+
+class ippak_reader { // decoder over mapped or in-memory image
+    MMap_File file;
+    const u8i *base {nullptr};
+    const u64i *dir {nullptr};
+    u64i total {0};
+    u64i blocks {0};
+    u64i dataEnd {0}; // blocks end where directory starts
+    u64i cursor {0}; // next block for streaming decode
+    u32i family {0};
+    pakmnp::enLastError lerr {pakmnp::NoError};
+public:
+    bool open(const string &path, u32i _family);
+    bool view(const u8i *image, size_t len, u32i _family); // image must outlive reader and be 8-byte aligned
+    u64i count() const { return total; };
+    u64i block_count() const { return blocks; };
+    const pak_block& block(u64i idx) const { return *(const pak_block*)(base + dir[idx]); };
+    u32i decode(u64i idx, u64i *ms, u64i *ls) const; // returns count of values in block
+    u32i next(u64i *ms, u64i *ls) { return (cursor < blocks) ? decode(cursor++, ms, ls) : 0; };
+    void seek(u64i idx) { cursor = idx; };
+    u64i find_block(u64i ms, u64i ls) const; // first block whose last value >= key, or block_count()
+    pakmnp::enLastError last_err() const { return lerr; };
+};
+
+template <class A>
+class IP_PackWriter { // A is IPv4_Addr, IPv6_Addr or MAC_Addr, input must be sorted
+    ippak_writer core;
+public:
+    IP_PackWriter(ostream &os) : core(os, pakmnp::family_of((A*)nullptr)) {};
+    bool push(const A &addr) { u64i ms, ls; pakmnp::to_key(addr, &ms, &ls); return core.push(ms, ls); };
+    bool push(const A *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) if (!push(arr[idx])) return false; return true; };
+    bool finish() { return core.finish(); };
+    u64i count() const { return core.count(); };
+    pakmnp::enLastError last_err() const { return core.last_err(); };
+};
+
+template <class A>
+class IP_PackReader { // streaming decode block by block, or random access by block
+    ippak_reader core;
+    u64i ms[pakmnp::BLOCK], ls[pakmnp::BLOCK];
+    u32i convert(u32i cnt, A *out) const { for (u32i idx = 0; idx < cnt; idx++) pakmnp::from_key(ms[idx], ls[idx], &out[idx]); return cnt; };
+public:
+    bool open(const string &path) { return core.open(path, pakmnp::family_of((A*)nullptr)); };
+    bool view(const u8i *image, size_t len) { return core.view(image, len, pakmnp::family_of((A*)nullptr)); };
+    u64i count() const { return core.count(); };
+    u64i block_count() const { return core.block_count(); };
+    A block_min(u64i idx) const { A ret; pakmnp::from_key(core.block(idx).minMs, core.block(idx).minLs, &ret); return ret; };
+    A block_max(u64i idx) const { A ret; pakmnp::from_key(core.block(idx).maxMs, core.block(idx).maxLs, &ret); return ret; };
+    u32i decode(u64i idx, A *out) { return convert(core.decode(idx, ms, ls), out); }; // out must hold pakmnp::BLOCK values
+    u32i next(A *out) { return convert(core.next(ms, ls), out); }; // 0 at the end
+    void seek(u64i idx) { core.seek(idx); };
+    bool contains(const A &addr); // skips blocks by min/max, decodes one block
+    pakmnp::enLastError last_err() const { return core.last_err(); };
+};
+
+template <class A>
+bool IP_PackReader<A>::contains(const A &addr) {
+    u64i kms, kls;
+    pakmnp::to_key(addr, &kms, &kls);
+    u64i idx = core.find_block(kms, kls);
+    if (idx >= core.block_count()) return false;
+    const pak_block &blk = core.block(idx);
+    if ((kms < blk.minMs) || ((kms == blk.minMs) && (kls < blk.minLs))) return false;
+    u32i cnt = core.decode(idx, ms, ls);
+    for (u32i pos = 0; pos < cnt; pos++) {
+        if ((ms[pos] == kms) && (ls[pos] == kls)) return true;
+    }
+    return false;
+}
+
+#endif // GIA_IPCODEC_H
@@ -0,0 +1,666 @@
+#include "gia_ipcol.h"
+#include "gia_ipwire.h"
+#include <memory.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_COL_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// every kernel processes whole 64-row bitmap words and returns count of rows done, scalar code finishes the tail,
+// so all levels produce identical bitmaps
+
+static void m32_scalar(const u32i *vals, size_t beg, size_t n, const colrule32 *rules, u32i cnt, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) {
+        bool hit {false};
+        for (u32i rul = 0; rul < cnt; rul++) hit |= (vals[idx] & rules[rul].mask) == rules[rul].val;
+        bits[idx >> 6] |= u64i(hit) << (idx & 63);
+    }
+}
+
+static void r32_scalar(const u32i *vals, size_t beg, size_t n, u32i low, u32i high, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) bits[idx >> 6] |= u64i((vals[idx] >= low) && (vals[idx] <= high)) << (idx & 63);
+}
+
+static void m64_scalar(const u64i *vals, size_t beg, size_t n, const colrule64 *rules, u32i cnt, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) {
+        bool hit {false};
+        for (u32i rul = 0; rul < cnt; rul++) hit |= (vals[idx] & rules[rul].mask) == rules[rul].val;
+        bits[idx >> 6] |= u64i(hit) << (idx & 63);
+    }
+}
+
+static void r64_scalar(const u64i *vals, size_t beg, size_t n, u64i low, u64i high, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) bits[idx >> 6] |= u64i((vals[idx] >= low) && (vals[idx] <= high)) << (idx & 63);
+}
+
+static void m128_scalar(const u64i *hi, const u64i *lo, size_t beg, size_t n, const colrule128 *rules, u32i cnt, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) {
+        bool hit {false};
+        for (u32i rul = 0; rul < cnt; rul++) hit |= ((hi[idx] & rules[rul].maskHi) == rules[rul].valHi) && ((lo[idx] & rules[rul].maskLo) == rules[rul].valLo);
+        bits[idx >> 6] |= u64i(hit) << (idx & 63);
+    }
+}
+
+static void r128_scalar(const u64i *hi, const u64i *lo, size_t beg, size_t n, u64i lowHi, u64i lowLo, u64i highHi, u64i highLo, u64i *bits) {
+    for (size_t idx = beg; idx < n; idx++) {
+        bool below = (hi[idx] < lowHi) || ((hi[idx] == lowHi) && (lo[idx] < lowLo));
+        bool above = (hi[idx] > highHi) || ((hi[idx] == highHi) && (lo[idx] > highLo));
+        bits[idx >> 6] |= u64i(!below && !above) << (idx & 63);
+    }
+}
+
+static void w32_scalar(const u32i *vals, size_t beg, size_t n, u8i *out) {
+    for (size_t idx = beg; idx < n; idx++) {
+        u32i val = __builtin_bswap32(vals[idx]);
+        memcpy(out + idx * 4, &val, 4);
+    }
+}
+
+static void w128_scalar(const u64i *hi, const u64i *lo, size_t beg, size_t n, u8i *out) {
+    for (size_t idx = beg; idx < n; idx++) {
+        u64i val[2] {__builtin_bswap64(hi[idx]), __builtin_bswap64(lo[idx])};
+        memcpy(out + idx * 16, val, 16);
+    }
+}
+
+#ifdef GIA_COL_X86
+
+__attribute__((target("avx2"))) static size_t m32_avx2(const u32i *vals, size_t n, const colrule32 *rules, u32i cnt, u64i *bits) {
+    __m256i msk[colmnp::MAX_RULES], val[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        msk[rul] = _mm256_set1_epi32(rules[rul].mask);
+        val[rul] = _mm256_set1_epi32(rules[rul].val);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(vals + row + part * 8));
+            __m256i hit = _mm256_setzero_si256();
+            for (u32i rul = 0; rul < cnt; rul++) hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(_mm256_and_si256(x, msk[rul]), val[rul]));
+            word |= u64i(u32i(_mm256_movemask_ps(_mm256_castsi256_ps(hit)))) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t r32_avx2(const u32i *vals, size_t n, u32i low, u32i high, u64i *bits) {
+    const __m256i sign = _mm256_set1_epi32(0x80000000); // unsigned order through signed compare
+    const __m256i vlow = _mm256_xor_si256(_mm256_set1_epi32(low), sign), vhigh = _mm256_xor_si256(_mm256_set1_epi32(high), sign);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(vals + row + part * 8)), sign);
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(vlow, x), _mm256_cmpgt_epi32(x, vhigh));
+            word |= u64i(u32i(~_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xFF)) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t m64_avx2(const u64i *vals, size_t n, const colrule64 *rules, u32i cnt, u64i *bits) {
+    __m256i msk[colmnp::MAX_RULES], val[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        msk[rul] = _mm256_set1_epi64x(rules[rul].mask);
+        val[rul] = _mm256_set1_epi64x(rules[rul].val);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 16; part++) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(vals + row + part * 4));
+            __m256i hit = _mm256_setzero_si256();
+            for (u32i rul = 0; rul < cnt; rul++) hit = _mm256_or_si256(hit, _mm256_cmpeq_epi64(_mm256_and_si256(x, msk[rul]), val[rul]));
+            word |= u64i(u32i(_mm256_movemask_pd(_mm256_castsi256_pd(hit)))) << (part * 4);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t r64_avx2(const u64i *vals, size_t n, u64i low, u64i high, u64i *bits) {
+    const __m256i sign = _mm256_set1_epi64x(0x8000000000000000);
+    const __m256i vlow = _mm256_xor_si256(_mm256_set1_epi64x(low), sign), vhigh = _mm256_xor_si256(_mm256_set1_epi64x(high), sign);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 16; part++) {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(vals + row + part * 4)), sign);
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(vlow, x), _mm256_cmpgt_epi64(x, vhigh));
+            word |= u64i(u32i(~_mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xF)) << (part * 4);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t m128_avx2(const u64i *hi, const u64i *lo, size_t n, const colrule128 *rules, u32i cnt, u64i *bits) {
+    __m256i mhi[colmnp::MAX_RULES], mlo[colmnp::MAX_RULES], vhi[colmnp::MAX_RULES], vlo[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        mhi[rul] = _mm256_set1_epi64x(rules[rul].maskHi);
+        mlo[rul] = _mm256_set1_epi64x(rules[rul].maskLo);
+        vhi[rul] = _mm256_set1_epi64x(rules[rul].valHi);
+        vlo[rul] = _mm256_set1_epi64x(rules[rul].valLo);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 16; part++) {
+            __m256i xh = _mm256_loadu_si256((const __m256i*)(hi + row + part * 4));
+            __m256i xl = _mm256_loadu_si256((const __m256i*)(lo + row + part * 4));
+            __m256i hit = _mm256_setzero_si256();
+            for (u32i rul = 0; rul < cnt; rul++) {
+                __m256i eqh = _mm256_cmpeq_epi64(_mm256_and_si256(xh, mhi[rul]), vhi[rul]);
+                __m256i eql = _mm256_cmpeq_epi64(_mm256_and_si256(xl, mlo[rul]), vlo[rul]);
+                hit = _mm256_or_si256(hit, _mm256_and_si256(eqh, eql));
+            }
+            word |= u64i(u32i(_mm256_movemask_pd(_mm256_castsi256_pd(hit)))) << (part * 4);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static __m256i lt128_avx2(__m256i ah, __m256i al, __m256i bh, __m256i bl) { // operands are sign-biased
+    return _mm256_or_si256(_mm256_cmpgt_epi64(bh, ah), _mm256_and_si256(_mm256_cmpeq_epi64(ah, bh), _mm256_cmpgt_epi64(bl, al)));
+}
+
+__attribute__((target("avx2"))) static size_t r128_avx2(const u64i *hi, const u64i *lo, size_t n, u64i lowHi, u64i lowLo, u64i highHi, u64i highLo, u64i *bits) {
+    const __m256i sign = _mm256_set1_epi64x(0x8000000000000000);
+    const __m256i lh = _mm256_xor_si256(_mm256_set1_epi64x(lowHi), sign), ll = _mm256_xor_si256(_mm256_set1_epi64x(lowLo), sign);
+    const __m256i hh = _mm256_xor_si256(_mm256_set1_epi64x(highHi), sign), hl = _mm256_xor_si256(_mm256_set1_epi64x(highLo), sign);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 16; part++) {
+            __m256i xh = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(hi + row + part * 4)), sign);
+            __m256i xl = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(lo + row + part * 4)), sign);
+            __m256i out = _mm256_or_si256(lt128_avx2(xh, xl, lh, ll), lt128_avx2(hh, hl, xh, xl));
+            word |= u64i(u32i(~_mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xF)) << (part * 4);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t w32_avx2(const u32i *vals, size_t n, u8i *out) {
+    const __m256i shuf = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t full = n & ~size_t(7);
+    for (size_t row = 0; row < full; row += 8) {
+        _mm256_storeu_si256((__m256i*)(out + row * 4), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(vals + row)), shuf));
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t w128_avx2(const u64i *hi, const u64i *lo, size_t n, u8i *out) {
+    const __m256i shuf = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t full = n & ~size_t(3);
+    for (size_t row = 0; row < full; row += 4) {
+        __m256i xh = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(hi + row)), shuf);
+        __m256i xl = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(lo + row)), shuf);
+        __m256i even = _mm256_unpacklo_epi64(xh, xl); // rows 0 and 2
+        __m256i odd = _mm256_unpackhi_epi64(xh, xl); // rows 1 and 3
+        _mm256_storeu_si256((__m256i*)(out + row * 16), _mm256_permute2x128_si256(even, odd, 0x20));
+        _mm256_storeu_si256((__m256i*)(out + row * 16 + 32), _mm256_permute2x128_si256(even, odd, 0x31));
+    }
+    return full;
+}
+
+#define GIA_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+GIA_AVX512 static size_t m32_avx512(const u32i *vals, size_t n, const colrule32 *rules, u32i cnt, u64i *bits) {
+    __m512i msk[colmnp::MAX_RULES], val[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        msk[rul] = _mm512_set1_epi32(rules[rul].mask);
+        val[rul] = _mm512_set1_epi32(rules[rul].val);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 4; part++) {
+            __m512i x = _mm512_loadu_si512(vals + row + part * 16);
+            __mmask16 hit {0};
+            for (u32i rul = 0; rul < cnt; rul++) hit |= _mm512_cmpeq_epi32_mask(_mm512_and_si512(x, msk[rul]), val[rul]);
+            word |= u64i(hit) << (part * 16);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t r32_avx512(const u32i *vals, size_t n, u32i low, u32i high, u64i *bits) {
+    const __m512i vlow = _mm512_set1_epi32(low), vhigh = _mm512_set1_epi32(high);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 4; part++) {
+            __m512i x = _mm512_loadu_si512(vals + row + part * 16);
+            word |= u64i(_mm512_cmpge_epu32_mask(x, vlow) & _mm512_cmple_epu32_mask(x, vhigh)) << (part * 16);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t m64_avx512(const u64i *vals, size_t n, const colrule64 *rules, u32i cnt, u64i *bits) {
+    __m512i msk[colmnp::MAX_RULES], val[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        msk[rul] = _mm512_set1_epi64(rules[rul].mask);
+        val[rul] = _mm512_set1_epi64(rules[rul].val);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m512i x = _mm512_loadu_si512(vals + row + part * 8);
+            __mmask8 hit {0};
+            for (u32i rul = 0; rul < cnt; rul++) hit |= _mm512_cmpeq_epi64_mask(_mm512_and_si512(x, msk[rul]), val[rul]);
+            word |= u64i(hit) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t r64_avx512(const u64i *vals, size_t n, u64i low, u64i high, u64i *bits) {
+    const __m512i vlow = _mm512_set1_epi64(low), vhigh = _mm512_set1_epi64(high);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m512i x = _mm512_loadu_si512(vals + row + part * 8);
+            word |= u64i(u8i(_mm512_cmpge_epu64_mask(x, vlow) & _mm512_cmple_epu64_mask(x, vhigh))) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t m128_avx512(const u64i *hi, const u64i *lo, size_t n, const colrule128 *rules, u32i cnt, u64i *bits) {
+    __m512i mhi[colmnp::MAX_RULES], mlo[colmnp::MAX_RULES], vhi[colmnp::MAX_RULES], vlo[colmnp::MAX_RULES];
+    for (u32i rul = 0; rul < cnt; rul++) {
+        mhi[rul] = _mm512_set1_epi64(rules[rul].maskHi);
+        mlo[rul] = _mm512_set1_epi64(rules[rul].maskLo);
+        vhi[rul] = _mm512_set1_epi64(rules[rul].valHi);
+        vlo[rul] = _mm512_set1_epi64(rules[rul].valLo);
+    }
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m512i xh = _mm512_loadu_si512(hi + row + part * 8);
+            __m512i xl = _mm512_loadu_si512(lo + row + part * 8);
+            __mmask8 hit {0};
+            for (u32i rul = 0; rul < cnt; rul++) {
+                hit |= _mm512_cmpeq_epi64_mask(_mm512_and_si512(xh, mhi[rul]), vhi[rul]) & _mm512_cmpeq_epi64_mask(_mm512_and_si512(xl, mlo[rul]), vlo[rul]);
+            }
+            word |= u64i(hit) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t r128_avx512(const u64i *hi, const u64i *lo, size_t n, u64i lowHi, u64i lowLo, u64i highHi, u64i highLo, u64i *bits) {
+    const __m512i lh = _mm512_set1_epi64(lowHi), ll = _mm512_set1_epi64(lowLo), hh = _mm512_set1_epi64(highHi), hl = _mm512_set1_epi64(highLo);
+    size_t full = n & ~size_t(63);
+    for (size_t row = 0; row < full; row += 64) {
+        u64i word {0};
+        for (u32i part = 0; part < 8; part++) {
+            __m512i xh = _mm512_loadu_si512(hi + row + part * 8);
+            __m512i xl = _mm512_loadu_si512(lo + row + part * 8);
+            __mmask8 below = _mm512_cmplt_epu64_mask(xh, lh) | (_mm512_cmpeq_epi64_mask(xh, lh) & _mm512_cmplt_epu64_mask(xl, ll));
+            __mmask8 above = _mm512_cmpgt_epu64_mask(xh, hh) | (_mm512_cmpeq_epi64_mask(xh, hh) & _mm512_cmpgt_epu64_mask(xl, hl));
+            word |= u64i(u8i(~(below | above))) << (part * 8);
+        }
+        bits[row >> 6] = word;
+    }
+    return full;
+}
+
+GIA_AVX512 static size_t w32_avx512(const u32i *vals, size_t n, u8i *out) {
+    const __m512i shuf = _mm512_broadcast_i32x4(_mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    size_t full = n & ~size_t(15);
+    for (size_t row = 0; row < full; row += 16) _mm512_storeu_si512(out + row * 4, _mm512_shuffle_epi8(_mm512_loadu_si512(vals + row), shuf));
+    return full;
+}
+
+#endif // GIA_COL_X86
+
+static size_t m32_simd(const u32i *vals, size_t n, const colrule32 *rules, u32i cnt, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return m32_avx512(vals, n, rules, cnt, bits);
+    case colmnp::AVX2: return m32_avx2(vals, n, rules, cnt, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+static size_t r32_simd(const u32i *vals, size_t n, u32i low, u32i high, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return r32_avx512(vals, n, low, high, bits);
+    case colmnp::AVX2: return r32_avx2(vals, n, low, high, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+static size_t m64_simd(const u64i *vals, size_t n, const colrule64 *rules, u32i cnt, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return m64_avx512(vals, n, rules, cnt, bits);
+    case colmnp::AVX2: return m64_avx2(vals, n, rules, cnt, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+static size_t r64_simd(const u64i *vals, size_t n, u64i low, u64i high, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return r64_avx512(vals, n, low, high, bits);
+    case colmnp::AVX2: return r64_avx2(vals, n, low, high, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+static size_t m128_simd(const u64i *hi, const u64i *lo, size_t n, const colrule128 *rules, u32i cnt, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return m128_avx512(hi, lo, n, rules, cnt, bits);
+    case colmnp::AVX2: return m128_avx2(hi, lo, n, rules, cnt, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+static size_t r128_simd(const u64i *hi, const u64i *lo, size_t n, u64i lowHi, u64i lowLo, u64i highHi, u64i highLo, u64i *bits) {
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: return r128_avx512(hi, lo, n, lowHi, lowLo, highHi, highLo, bits);
+    case colmnp::AVX2: return r128_avx2(hi, lo, n, lowHi, lowLo, highHi, highLo, bits);
+    default: break;
+    }
+#endif
+    return 0;
+}
+
+colmnp::enLevel colmnp::detect() {
+#ifdef GIA_COL_X86
+    static const enLevel best = (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) ? AVX512 : __builtin_cpu_supports("avx2") ? AVX2 : Scalar;
+    return best;
+#else
+    return Scalar;
+#endif
+}
+
+bool colmnp::set_level(enLevel lvl) {
+    if (lvl > detect()) return false;
+    forced.store(lvl);
+    return true;
+}
+
+bool colmnp::prepare(vector<u64i> *bits, size_t n) {
+    try {
+        bits->assign(bitmap_words(n), 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        return false;
+    }
+    return true;
+}
+
+size_t colmnp::count(const vector<u64i> &bits) {
+    size_t ret {0};
+    for (auto && word : bits) ret += __builtin_popcountll(word);
+    return ret;
+}
+
+bool colmnp::to_selection(const vector<u64i> &bits, vector<u32i> *sel) {
+    try {
+        sel->clear();
+        sel->reserve(count(bits));
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        return false;
+    }
+    for (size_t word = 0; word < bits.size(); word++) {
+        u64i val = bits[word];
+        while (val) {
+            sel->push_back(u32i((word << 6) | __builtin_ctzll(val)));
+            val &= val - 1;
+        }
+    }
+    return true;
+}
+
+bool colmnp::rules_of(enV4Class cls, vector<colrule32> *rules) {
+    switch (cls) {
+    case V4_Unknown: *rules = {{0xFFFFFFFF, 0x00000000}}; break;
+    case V4_Private: *rules = {{0xFF000000, 0x0A000000}, {0xFFF00000, 0xAC100000}, {0xFFFF0000, 0xC0A80000}}; break;
+    case V4_Loopback: *rules = {{0xFF000000, 0x7F000000}}; break;
+    case V4_LinkLocal: *rules = {{0xFFFF0000, 0xA9FE0000}}; break;
+    case V4_LimBcast: *rules = {{0xFFFFFFFF, 0xFFFFFFFF}}; break;
+    case V4_Mcast: *rules = {{0xF0000000, 0xE0000000}}; break;
+    case V4_Shared: *rules = {{0xFFC00000, 0x64400000}}; break;
+    case V4_Reserved: *rules = {{0xF0000000, 0xF0000000}}; break;
+    case V4_Docum: *rules = {{0xFFFFFF00, 0xC0000200}, {0xFFFFFF00, 0xC6336400}, {0xFFFFFF00, 0xCB007100}}; break;
+    case V4_Benchm: *rules = {{0xFFFE0000, 0xC6120000}}; break;
+    case V4_Ietf: *rules = {{0xFFFFFF00, 0xC0000000}}; break;
+    case V4_Ucast: *rules = {{0x80000000, 0x00000000}, {0xC0000000, 0x80000000}, {0xE0000000, 0xC0000000}, {0xF0000000, 0xF0000000}}; break; // all but 224/4
+    default: return false;
+    }
+    return true;
+}
+
+bool colmnp::rules_of(enV6Class cls, vector<colrule128> *rules) {
+    const u64i ALL {~u64i(0)};
+    switch (cls) {
+    case V6_Unspec: *rules = {{ALL, ALL, 0, 0}}; break;
+    case V6_Loopback: *rules = {{ALL, ALL, 0, 1}}; break; // ::1/128
+    case V6_GlobUcast: *rules = {{0xFFE0000000000000, 0, 0x2000000000000000, 0}}; break; // is_glob_ucast() tests 11 bits
+    case V6_Mcast: *rules = {{0xFF00000000000000, 0, 0xFF00000000000000, 0}}; break;
+    case V6_UniqLocal: *rules = {{0xFE00000000000000, 0, 0xFC00000000000000, 0}}; break;
+    case V6_LinkLocal: *rules = {{0xFFC0000000000000, 0, 0xFE80000000000000, 0}}; break;
+    case V6_MappedIPv4: *rules = {{0, 0x0000FFFF00000000, 0, 0x0000FFFF00000000}}; break; // is_mapped_ipv4() tests sixth hextet only
+    case V6_WknownPfx: *rules = {{ALL, 0xFFFFFFFF00000000, 0x0064FF9B00000000, 0}}; break;
+    case V6_Teredo: *rules = {{0xFFFFFFFF00000000, 0, 0x2001000000000000, 0}}; break;
+    case V6_Docum: *rules = {{0xFFFFFFFF00000000, 0, 0x20010DB800000000, 0}}; break;
+    case V6_6to4: *rules = {{0xFFFF000000000000, 0, 0x2002000000000000, 0}}; break;
+    default: return false;
+    }
+    return true;
+}
+
+bool colmnp::rules_of(enMACClass cls, vector<colrule64> *rules) {
+    switch (cls) {
+    case MAC_Ucast: *rules = {{0x010000000000, 0}}; break;
+    case MAC_Mcast: *rules = {{0x010000000000, 0x010000000000}}; break;
+    case MAC_Bcast: *rules = {{0xFFFFFFFFFFFF, 0xFFFFFFFFFFFF}}; break;
+    case MAC_UAA: *rules = {{0x020000000000, 0}}; break;
+    case MAC_LAA: *rules = {{0x020000000000, 0x020000000000}}; break;
+    default: return false;
+    }
+    return true;
+}
+
+bool IPv4Column::append_wire(const u8i *base, size_t stride, size_t n) {
+    size_t was = vals.size();
+    try {
+        vals.resize(was + n);
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        return false;
+    }
+    wiremnp::v4_from_wire(base, stride, n, vals.data() + was);
+    return true;
+}
+
+void IPv4Column::mask(u32i mask_len) {
+    u32i msk = v4mnp::gen_mask(mask_len)();
+    for (auto && val : vals) val &= msk; // plain loop, compiler vectorizes it for any level
+}
+
+bool IPv4Column::match(const vector<colrule32> &rules, vector<u64i> *bits) const {
+    if ((rules.size() > colmnp::MAX_RULES) || !colmnp::prepare(bits, vals.size())) return false;
+    size_t done = m32_simd(vals.data(), vals.size(), rules.data(), rules.size(), bits->data());
+    m32_scalar(vals.data(), done, vals.size(), rules.data(), rules.size(), bits->data());
+    return true;
+}
+
+bool IPv4Column::in_prefix(const IPv4_Addr &net, u32i mask_len, vector<u64i> *bits) const {
+    u32i msk = v4mnp::gen_mask(mask_len)();
+    return match({{msk, net() & msk}}, bits);
+}
+
+bool IPv4Column::in_range(const IPv4_Addr &low, const IPv4_Addr &high, vector<u64i> *bits) const {
+    if (!colmnp::prepare(bits, vals.size())) return false;
+    size_t done = r32_simd(vals.data(), vals.size(), low(), high(), bits->data());
+    r32_scalar(vals.data(), done, vals.size(), low(), high(), bits->data());
+    return true;
+}
+
+bool IPv4Column::select(colmnp::enV4Class cls, vector<u64i> *bits) const {
+    vector<colrule32> rules;
+    return colmnp::rules_of(cls, &rules) && match(rules, bits);
+}
+
+void IPv4Column::to_wire(u8i *out) const {
+    size_t done {0};
+#ifdef GIA_COL_X86
+    switch (colmnp::level()) {
+    case colmnp::AVX512: done = w32_avx512(vals.data(), vals.size(), out); break;
+    case colmnp::AVX2: done = w32_avx2(vals.data(), vals.size(), out); break;
+    default: break;
+    }
+#endif
+    w32_scalar(vals.data(), done, vals.size(), out);
+}
+
+void IPv4Column::octet(u32i oct, u8i *out) const {
+    u32i shift = (oct & 3) * 8;
+    for (size_t idx = 0; idx < vals.size(); idx++) out[idx] = vals[idx] >> shift;
+}
+
+bool IPv6Column::append_wire(const u8i *base, size_t stride, size_t n) {
+    size_t was = hi.size();
+    try {
+        hi.resize(was + n);
+        lo.resize(was + n);
+    }
+    catch (...) {
+        hi.resize(was);
+        cerr << EX_LOW_MEM << endl;
+        return false;
+    }
+    wiremnp::v6_from_wire(base, stride, n, hi.data() + was, lo.data() + was);
+    return true;
+}
+
+void IPv6Column::mask(u32i mask_len) {
+    IPv6_Mask msk = v6mnp::gen_mask(mask_len);
+    u64i mhi = msk().ms, mlo = msk().ls;
+    for (auto && val : hi) val &= mhi;
+    for (auto && val : lo) val &= mlo;
+}
+
+bool IPv6Column::match(const vector<colrule128> &rules, vector<u64i> *bits) const {
+    if ((rules.size() > colmnp::MAX_RULES) || !colmnp::prepare(bits, hi.size())) return false;
+    size_t done = m128_simd(hi.data(), lo.data(), hi.size(), rules.data(), rules.size(), bits->data());
+    m128_scalar(hi.data(), lo.data(), done, hi.size(), rules.data(), rules.size(), bits->data());
+    return true;
+}
+
+bool IPv6Column::in_prefix(const IPv6_Addr &net, u32i mask_len, vector<u64i> *bits) const {
+    IPv6_Mask msk = v6mnp::gen_mask(mask_len);
+    return match({{msk().ms, msk().ls, net().ms & msk().ms, net().ls & msk().ls}}, bits);
+}
+
+bool IPv6Column::in_range(const IPv6_Addr &low, const IPv6_Addr &high, vector<u64i> *bits) const {
+    if (!colmnp::prepare(bits, hi.size())) return false;
+    size_t done = r128_simd(hi.data(), lo.data(), hi.size(), low().ms, low().ls, high().ms, high().ls, bits->data());
+    r128_scalar(hi.data(), lo.data(), done, hi.size(), low().ms, low().ls, high().ms, high().ls, bits->data());
+    return true;
+}
+
+bool IPv6Column::select(colmnp::enV6Class cls, vector<u64i> *bits) const {
+    vector<colrule128> rules;
+    return colmnp::rules_of(cls, &rules) && match(rules, bits);
+}
+
+void IPv6Column::to_wire(u8i *out) const {
+    size_t done {0};
+#ifdef GIA_COL_X86
+    if (colmnp::level() >= colmnp::AVX2) done = w128_avx2(hi.data(), lo.data(), hi.size(), out);
+#endif
+    w128_scalar(hi.data(), lo.data(), done, hi.size(), out);
+}
+
+bool MACColumn::append_wire(const u8i *base, size_t stride, size_t n) {
+    size_t was = vals.size();
+    try {
+        vals.resize(was + n);
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        return false;
+    }
+    wiremnp::mac_from_wire(base, stride, n, vals.data() + was);
+    return true;
+}
+
+void MACColumn::mask(u32i mask_len) {
+    u64i msk = (mask_len >= 48) ? 0xFFFFFFFFFFFF : (0xFFFFFFFFFFFF << (48 - mask_len)) & 0xFFFFFFFFFFFF;
+    for (auto && val : vals) val &= msk;
+}
+
+bool MACColumn::match(const vector<colrule64> &rules, vector<u64i> *bits) const {
+    if ((rules.size() > colmnp::MAX_RULES) || !colmnp::prepare(bits, vals.size())) return false;
+    size_t done = m64_simd(vals.data(), vals.size(), rules.data(), rules.size(), bits->data());
+    m64_scalar(vals.data(), done, vals.size(), rules.data(), rules.size(), bits->data());
+    return true;
+}
+
+bool MACColumn::in_prefix(const MAC_Addr &net, u32i mask_len, vector<u64i> *bits) const {
+    u64i msk = (mask_len >= 48) ? 0xFFFFFFFFFFFF : (0xFFFFFFFFFFFF << (48 - mask_len)) & 0xFFFFFFFFFFFF;
+    return match({{msk, net() & msk}}, bits);
+}
+
+bool MACColumn::in_range(const MAC_Addr &low, const MAC_Addr &high, vector<u64i> *bits) const {
+    if (!colmnp::prepare(bits, vals.size())) return false;
+    size_t done = r64_simd(vals.data(), vals.size(), low(), high(), bits->data());
+    r64_scalar(vals.data(), done, vals.size(), low(), high(), bits->data());
+    return true;
+}
+
+bool MACColumn::select(colmnp::enMACClass cls, vector<u64i> *bits) const {
+    vector<colrule64> rules;
+    return colmnp::rules_of(cls, &rules) && match(rules, bits);
+}
+
+void MACColumn::to_wire(u8i *out) const {
+    for (size_t idx = 0; idx < vals.size(); idx++) {
+        u64i val = __builtin_bswap64(vals[idx]) >> 16; // first transmitted octet comes first
+        memcpy(out + idx * 6, &val, 6);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef GIA_IPCOL_H
+#define GIA_IPCOL_H
+
+#include <atomic>
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+struct colrule32 { u32i mask, val; }; // (x & mask) == val
+struct colrule64 { u64i mask, val; };
+struct colrule128 { u64i maskHi, maskLo, valHi, valLo; };
+
+class colmnp {
+    static inline atomic<int> forced {-1};
+    static inline const char EX_LOW_MEM[] = {"func colmnp::prepare() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func colmnp::prepare() says: exception."};
+public:
+    enum enLevel : u8i {Scalar = 0, AVX2 = 1, AVX512 = 2}; // AVX512 means AVX-512F + AVX-512BW
+    static constexpr u32i MAX_RULES {16};
+    static enLevel detect(); // best level supported by CPU
+    static enLevel level() { int lvl = forced.load(memory_order_relaxed); return (lvl < 0) ? detect() : enLevel(lvl); };
+    static bool set_level(enLevel lvl); // e.g. Scalar to compare results, false if CPU does not support level
+    static void reset_level() { forced.store(-1); };
+    static size_t bitmap_words(size_t n) { return (n + 63) / 64; };
+    static bool prepare(vector<u64i> *bits, size_t n); // zeroed bitmap for n rows
+    static size_t count(const vector<u64i> &bits); // selected rows
+    static bool to_selection(const vector<u64i> &bits, vector<u32i> *sel); // bitmap to ascending row indexes
+    enum enV4Class : u8i {V4_Unknown = 0, V4_Private, V4_Loopback, V4_LinkLocal, V4_LimBcast, V4_Mcast, V4_Shared, V4_Reserved, V4_Docum, V4_Benchm, V4_Ietf, V4_Ucast};
+    enum enV6Class : u8i {V6_Unspec = 0, V6_Loopback, V6_GlobUcast, V6_Mcast, V6_UniqLocal, V6_LinkLocal, V6_MappedIPv4, V6_WknownPfx, V6_Teredo, V6_Docum, V6_6to4};
+    enum enMACClass : u8i {MAC_Ucast = 0, MAC_Mcast, MAC_Bcast, MAC_UAA, MAC_LAA};
+    static bool rules_of(enV4Class cls, vector<colrule32> *rules); // same ranges as IPv4_Addr::is_...() predicates
+    static bool rules_of(enV6Class cls, vector<colrule128> *rules); // same ranges as IPv6_Addr::is_...() predicates, not RFC prefixes of their comments
+    static bool rules_of(enMACClass cls, vector<colrule64> *rules);
+};
+
+class IPv4Column { // addresses as plain u32i column
+    vector<u32i> vals;
+    static inline const char EX_LOW_MEM[] = {"func IPv4Column::append_wire() says: not enough memory."};
+public:
+    size_t size() const { return vals.size(); };
+    const u32i* data() const { return vals.data(); };
+    void reserve(size_t cnt) { vals.reserve(cnt); };
+    void clear() { vals.clear(); };
+    void push_back(const IPv4_Addr &ip) { vals.push_back(ip()); };
+    void append(const IPv4_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) vals.push_back(arr[idx]()); };
+    bool append_wire(const u8i *base, size_t stride, size_t n); // fields in network order at base + i * stride, see wiremnp
+    IPv4_Addr at(size_t idx) const { return IPv4_Addr(vals[idx]); };
+    void mask(u32i mask_len); // in place, like operator&= with v4mnp::gen_mask()
+    bool match(const vector<colrule32> &rules, vector<u64i> *bits) const; // row is selected if any rule matches, up to colmnp::MAX_RULES
+    bool in_prefix(const IPv4_Addr &net, u32i mask_len, vector<u64i> *bits) const;
+    bool in_range(const IPv4_Addr &low, const IPv4_Addr &high, vector<u64i> *bits) const; // low <= ip <= high
+    bool select(colmnp::enV4Class cls, vector<u64i> *bits) const;
+    void to_wire(u8i *out) const; // 4 bytes per row in network order
+    void octet(u32i oct, u8i *out) const; // oct is v4mnp::enOctets
+};
+
+class IPv6Column { // addresses as two u64i lanes : hi (ms) and lo (ls)
+    vector<u64i> hi, lo;
+    static inline const char EX_LOW_MEM[] = {"func IPv6Column::append_wire() says: not enough memory."};
+public:
+    size_t size() const { return hi.size(); };
+    const u64i* data_hi() const { return hi.data(); };
+    const u64i* data_lo() const { return lo.data(); };
+    void reserve(size_t cnt) { hi.reserve(cnt); lo.reserve(cnt); };
+    void clear() { hi.clear(); lo.clear(); };
+    void push_back(const IPv6_Addr &ip) { hi.push_back(ip().ms); lo.push_back(ip().ls); };
+    void append(const IPv6_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) push_back(arr[idx]); };
+    bool append_wire(const u8i *base, size_t stride, size_t n);
+    IPv6_Addr at(size_t idx) const { return IPv6_Addr(hi[idx], lo[idx]); };
+    void mask(u32i mask_len);
+    bool match(const vector<colrule128> &rules, vector<u64i> *bits) const;
+    bool in_prefix(const IPv6_Addr &net, u32i mask_len, vector<u64i> *bits) const;
+    bool in_range(const IPv6_Addr &low, const IPv6_Addr &high, vector<u64i> *bits) const;
+    bool select(colmnp::enV6Class cls, vector<u64i> *bits) const;
+    void to_wire(u8i *out) const; // 16 bytes per row in network order
+};
+
+class MACColumn { // addresses as u64i column, upper 16 bits are zero
+    vector<u64i> vals;
+    static inline const char EX_LOW_MEM[] = {"func MACColumn::append_wire() says: not enough memory."};
+public:
+    size_t size() const { return vals.size(); };
+    const u64i* data() const { return vals.data(); };
+    void reserve(size_t cnt) { vals.reserve(cnt); };
+    void clear() { vals.clear(); };
+    void push_back(const MAC_Addr &mac) { vals.push_back(mac()); };
+    void append(const MAC_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) vals.push_back(arr[idx]()); };
+    bool append_wire(const u8i *base, size_t stride, size_t n);
+    MAC_Addr at(size_t idx) const { return MAC_Addr(vals[idx]); };
+    void mask(u32i mask_len); // 0 - 48
+    bool match(const vector<colrule64> &rules, vector<u64i> *bits) const;
+    bool in_prefix(const MAC_Addr &net, u32i mask_len, vector<u64i> *bits) const; // e.g. OUI is /24
+    bool in_range(const MAC_Addr &low, const MAC_Addr &high, vector<u64i> *bits) const;
+    bool select(colmnp::enMACClass cls, vector<u64i> *bits) const;
+    void to_wire(u8i *out) const; // 6 bytes per row in transmission order
+};
+
+#endif // GIA_IPCOL_H
@@ -0,0 +1,55 @@
+#include "gia_ipdual.h"
+
+using namespace std;
+
+static unsigned __int128 wide_mask(u32i mask_len) { // mask_len 0-128, in bits of IPv6
+    return (mask_len == 0) ? 0 : ~(unsigned __int128)0 << (128 - min<u32i>(mask_len, 128));
+}
+
+bool dualmnp::valid_addr(const string &ipstr, IP_Addr *ret) {
+    if (ret != nullptr) *ret = IP_Addr();
+    if (ipstr.find(':') == string::npos) {
+        IPv4_Addr ipv4;
+        if (!v4mnp::valid_addr(ipstr, &ipv4)) return false;
+        if (ret != nullptr) *ret = IP_Addr(ipv4);
+        return true;
+    }
+    IPv6_Addr ipv6;
+    if (!v6mnp::valid_addr(ipstr, &ipv6)) return false;
+    if (ret != nullptr) *ret = IP_Addr(ipv6); // "::ffff:1.2.3.4" becomes IPv4 by itself
+    return true;
+}
+
+IP_Addr dualmnp::to_IP(const string &ipstr) {
+    IP_Addr ret;
+    valid_addr(ipstr, &ret);
+    return ret;
+}
+
+IP_Addr dualmnp::gen_mask(u32i mask_len, bool v4) {
+    unsigned __int128 mask = wide_mask(v4 ? 96 + min<u32i>(mask_len, 32) : mask_len);
+    return IP_Addr(u64i(mask >> 64), u64i(mask));
+}
+
+u32i IP_Addr::to_wire(u8i *out) const {
+    if (is_v4()) {
+        v4().to_wire(out);
+        return 4;
+    }
+    v6().to_wire(out);
+    return 16;
+}
+
+IP_Addr IP_Addr::from_wire(const u8i *in, u32i len) {
+    return (len == 4) ? IP_Addr(IPv4_Addr::from_wire(in)) : IP_Addr(IPv6_Addr::from_wire(in));
+}
+
+bool IP_Addr::in_prefix(const IP_Addr &net, u32i mask_len) const {
+    unsigned __int128 mask = wide_mask(min(mask_len, bits()) + 96 * is_v4());
+    return !((wide() ^ net.wide()) & mask); // IPv4 never matches IPv6 network : mapped prefix is compared too
+}
+
+IP_Addr IP_Addr::masked(u32i mask_len) const {
+    unsigned __int128 val = wide() & wide_mask(min(mask_len, bits()) + 96 * is_v4());
+    return IP_Addr(u64i(val >> 64), u64i(val));
+}
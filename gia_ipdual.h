@@ -0,0 +1,76 @@
+#ifndef GIA_IPDUAL_H
+#define GIA_IPDUAL_H
+
+#include "gia_ipmnp.h"
+#include "gia_iphash.h"
+
+using namespace std;
+
+// dual-stack address : 16 bytes, IPv4 is kept as IPv4-mapped ::ffff:a.b.c.d (RFC 4291 2.5.5.2),
+// so one table, set or sort serves both families with one memory layout and w/o branches on family
+
+class IP_Addr;
+
+class dualmnp {
+public:
+    static const u64i MAPPED_MS {0x0000000000000000}, MAPPED_LS {0x0000FFFF00000000}; // ::ffff:0:0/96
+    static bool valid_addr(const string &ipstr, IP_Addr *ret = nullptr); // IPv4 or IPv6 text, family is taken from presence of colon
+    static IP_Addr to_IP(const string &ipstr); // :: if text is bad
+    static IP_Addr gen_mask(u32i mask_len, bool v4); // mask of family, IPv4 mask keeps ::ffff:0:0/96 bits
+};
+
+class IP_Addr {
+    union {
+        u128i as_u128i {0x0, 0x0};
+        u64i  as_u64i[2]; // index [1] is MSB (left part), index [0] is LSB (right part), same as IPv6_Addr
+        u32i  as_u32i[4];
+    };
+    unsigned __int128 wide() const { return ((unsigned __int128)as_u128i.ms << 64) | as_u128i.ls; }; // single compare, no branches
+public:
+    IP_Addr() { as_u128i.ms = 0; as_u128i.ls = 0; }; // ::
+    IP_Addr(u64i left, u64i right) { as_u128i.ms = left; as_u128i.ls = right; };
+    IP_Addr(const IPv4_Addr &ip) { as_u128i.ms = dualmnp::MAPPED_MS; as_u128i.ls = dualmnp::MAPPED_LS | ip(); };
+    IP_Addr(const IPv6_Addr &ip) { as_u128i = ip(); };
+    static IP_Addr from_v4(u32i ipv4) { return IP_Addr(dualmnp::MAPPED_MS, dualmnp::MAPPED_LS | ipv4); };
+    bool is_v4() const { return !(as_u128i.ms | ((as_u128i.ls >> 32) ^ 0xFFFF)); };
+    bool is_v6() const { return !is_v4(); };
+    u32i family() const { return 6 - 2 * is_v4(); }; // 4 or 6
+    u32i bits() const { return 128 - 96 * is_v4(); }; // 32 or 128
+    IPv4_Addr v4() const { return IPv4_Addr(as_u32i[0]); }; // meaningful only if is_v4()
+    IPv6_Addr v6() const { return IPv6_Addr(as_u128i.ms, as_u128i.ls); }; // mapped form for IPv4
+    string to_str(u32i fmt) const { return is_v4() ? v4().to_str() : v6().to_str(fmt); }; // fmt - flags of v6mnp, for IPv6 only
+    string to_str() const { return to_str(v6mnp::what_fmt()); };
+    u32i to_wire(u8i *out) const; // 4 or 16 bytes in network order, returns count
+    static IP_Addr from_wire(const u8i *in, u32i len); // len is 4 or 16
+    u64i hash() const { return hashmnp::hash(as_u128i.ms, as_u128i.ls); };
+    bool is_unspec() const { return !(as_u128i.ms | as_u128i.ls); }; // :: only, 0.0.0.0 is ::ffff:0.0.0.0
+    bool is_loopback() const { return is_v4() ? v4().is_loopback() : v6().is_loopback(); };
+    bool is_mcast() const { return is_v4() ? v4().is_mcast() : v6().is_mcast(); };
+    bool is_link_local() const { return is_v4() ? v4().is_link_local() : v6().is_link_local(); };
+    bool in_prefix(const IP_Addr &net, u32i mask_len) const; // mask_len counts in bits of own family : 0-32 for IPv4, 0-128 for IPv6
+    IP_Addr masked(u32i mask_len) const; // network part, mask_len counts as in in_prefix()
+    void operator&=(const IP_Addr &bitmask) { as_u128i.ms &= bitmask.as_u128i.ms; as_u128i.ls &= bitmask.as_u128i.ls; };
+    void operator|=(const IP_Addr &val) { as_u128i.ms |= val.as_u128i.ms; as_u128i.ls |= val.as_u128i.ls; };
+    bool operator==(const IP_Addr &ip) const { return !((as_u128i.ms ^ ip.as_u128i.ms) | (as_u128i.ls ^ ip.as_u128i.ls)); };
+    bool operator!=(const IP_Addr &ip) const { return !(*this == ip); };
+    bool operator<(const IP_Addr &ip) const { return wide() < ip.wide(); }; // IPv4 block sorts inside IPv6 space at ::ffff:0:0/96
+    bool operator>(const IP_Addr &ip) const { return wide() > ip.wide(); };
+    bool operator<=(const IP_Addr &ip) const { return wide() <= ip.wide(); };
+    bool operator>=(const IP_Addr &ip) const { return wide() >= ip.wide(); };
+    u128i operator()() const { return as_u128i; };
+};
+
+static_assert(sizeof(IP_Addr) == 16, "IP_Addr must stay 16 bytes");
+
+namespace std {
+    template <> struct hash<IP_Addr> { size_t operator()(const IP_Addr &ip) const { return ip.hash(); }; };
+}
+
+template <> struct ipkey_traits<IP_Addr> {
+    using raw_t = ipkey_u128;
+    static raw_t to_raw(const IP_Addr &ip) { return raw_t{ip().ls, ip().ms}; };
+    static IP_Addr from_raw(const raw_t &raw) { return IP_Addr(raw.ms, raw.ls); };
+    static u64i hash(const raw_t &raw) { return hashmnp::hash(raw.ms, raw.ls); };
+};
+
+#endif // GIA_IPDUAL_H
@@ -0,0 +1,47 @@
+#include "gia_ipenum.h"
+
+using namespace std;
+
+IPv4_Hosts::IPv4_Hosts(const IPv4_Addr &net, u32i mask_len, bool usable) {
+    if (mask_len > 32) mask_len = 32;
+    base = net() & v4mnp::gen_mask(mask_len)();
+    cnt = u64i(1) << (32 - mask_len);
+    if (usable && (mask_len <= 30)) { // RFC 3021 : /31 and /32 have no network and broadcast addresses
+        base++;
+        cnt -= 2;
+    }
+}
+
+IPv4_Subnets::IPv4_Subnets(const IPv4_Addr &net, u32i mask_len, u32i sub_len) {
+    if (mask_len > 32) mask_len = 32;
+    if (sub_len > 32) sub_len = 32;
+    base = net() & v4mnp::gen_mask(mask_len)();
+    shift = 32 - sub_len;
+    cnt = (sub_len < mask_len) ? 0 : u64i(1) << (sub_len - mask_len);
+}
+
+IPv6_Hosts::IPv6_Hosts(const IPv6_Addr &net, u32i mask_len) {
+    if (mask_len > 128) mask_len = 128;
+    IPv6_Addr interim {net};
+    interim &= v6mnp::gen_mask(mask_len);
+    ms = interim().ms;
+    ls = interim().ls;
+    u32i hbits = 128 - mask_len; // host bits
+    cnt = (hbits >= 63) ? u64i(INT64_MAX) : u64i(1) << hbits;
+}
+
+IPv6_Subnets::IPv6_Subnets(const IPv6_Addr &net, u32i mask_len, u32i sub_len) {
+    if (mask_len > 128) mask_len = 128;
+    if (sub_len > 128) sub_len = 128;
+    IPv6_Addr interim {net};
+    interim &= v6mnp::gen_mask(mask_len);
+    ms = interim().ms;
+    ls = interim().ls;
+    shift = 128 - sub_len;
+    if (sub_len < mask_len) {
+        cnt = 0;
+    } else {
+        u32i sbits = sub_len - mask_len; // subnet bits
+        cnt = (sbits >= 63) ? u64i(INT64_MAX) : u64i(1) << sbits;
+    }
+}
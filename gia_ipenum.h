@@ -0,0 +1,109 @@
+#ifndef GIA_IPENUM_H
+#define GIA_IPENUM_H
+
+#include <iterator>
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+template <class Rng, class Val>
+class ipenum_iter { // random-access iterator, element is computed from index on dereference, nothing is materialized
+    const Rng *rng {nullptr};
+    u64i idx {0};
+public:
+    using iterator_category = random_access_iterator_tag;
+    using value_type = Val;
+    using difference_type = int64_t;
+    using pointer = void;
+    using reference = Val;
+    ipenum_iter() {};
+    ipenum_iter(const Rng *_rng, u64i _idx) { rng = _rng; idx = _idx; };
+    Val operator*() const { return rng->at(idx); };
+    Val operator[](difference_type n) const { return rng->at(idx + n); };
+    u64i index() const { return idx; };
+    ipenum_iter& operator++() { idx++; return *this; };
+    ipenum_iter operator++(int) { ipenum_iter ret {*this}; idx++; return ret; };
+    ipenum_iter& operator--() { idx--; return *this; };
+    ipenum_iter operator--(int) { ipenum_iter ret {*this}; idx--; return ret; };
+    ipenum_iter& operator+=(difference_type n) { idx += n; return *this; };
+    ipenum_iter& operator-=(difference_type n) { idx -= n; return *this; };
+    ipenum_iter operator+(difference_type n) const { return ipenum_iter(rng, idx + n); };
+    ipenum_iter operator-(difference_type n) const { return ipenum_iter(rng, idx - n); };
+    friend ipenum_iter operator+(difference_type n, const ipenum_iter &it) { return it + n; };
+    difference_type operator-(const ipenum_iter &it) const { return difference_type(idx - it.idx); };
+    bool operator==(const ipenum_iter &it) const { return idx == it.idx; };
+    bool operator!=(const ipenum_iter &it) const { return idx != it.idx; };
+    bool operator<(const ipenum_iter &it) const { return idx < it.idx; };
+    bool operator>(const ipenum_iter &it) const { return idx > it.idx; };
+    bool operator<=(const ipenum_iter &it) const { return idx <= it.idx; };
+    bool operator>=(const ipenum_iter &it) const { return idx >= it.idx; };
+};
+
+class IPv4_Hosts { // hosts of prefix net/mask_len
+    u32i base {0}; // first host
+    u64i cnt {0}; // up to 2^32, so u64i
+public:
+    using iterator = ipenum_iter<IPv4_Hosts, IPv4_Addr>;
+    IPv4_Hosts(const IPv4_Addr &net, u32i mask_len, bool usable = false); // usable == true excludes network and broadcast addresses for /0-/30
+    IPv4_Addr at(u64i k) const { return IPv4_Addr(u32i(base + k)); }; // k-th host, O(1), k is not checked
+    IPv4_Addr operator[](u64i k) const { return at(k); };
+    u64i size() const { return cnt; };
+    bool empty() const { return cnt == 0; };
+    iterator begin() const { return iterator(this, 0); };
+    iterator end() const { return iterator(this, cnt); };
+};
+
+class IPv4_Subnets { // subnets /sub_len of prefix net/mask_len
+    u32i base {0}; // network address of prefix
+    u32i shift {0}; // 32 - sub_len
+    u64i cnt {0};
+public:
+    using iterator = ipenum_iter<IPv4_Subnets, IPv4_Addr>;
+    IPv4_Subnets(const IPv4_Addr &net, u32i mask_len, u32i sub_len); // empty range if sub_len < mask_len
+    IPv4_Addr at(u64i k) const { return IPv4_Addr(u32i(base | (k << shift))); }; // k-th subnet, O(1), k is not checked
+    IPv4_Addr operator[](u64i k) const { return at(k); };
+    u64i index_of(const IPv4_Addr &ip) const { return u64i(ip() - base) >> shift; }; // number of subnet, which contains ip
+    u32i sub_len() const { return 32 - shift; };
+    u64i size() const { return cnt; };
+    bool empty() const { return cnt == 0; };
+    iterator begin() const { return iterator(this, 0); };
+    iterator end() const { return iterator(this, cnt); };
+};
+
+class IPv6_Hosts { // hosts of prefix net/mask_len, for /0-/64 range is limited by 2^63-1 elements
+    u64i ms {0}, ls {0}; // network address of prefix
+    u64i cnt {0};
+public:
+    using iterator = ipenum_iter<IPv6_Hosts, IPv6_Addr>;
+    IPv6_Hosts(const IPv6_Addr &net, u32i mask_len);
+    IPv6_Addr at(u64i k) const { return IPv6_Addr(ms, ls | k); }; // k-th host, O(1), no carry, k is not checked
+    IPv6_Addr operator[](u64i k) const { return at(k); };
+    u64i size() const { return cnt; };
+    bool empty() const { return cnt == 0; };
+    iterator begin() const { return iterator(this, 0); };
+    iterator end() const { return iterator(this, cnt); };
+};
+
+class IPv6_Subnets { // subnets /sub_len of prefix net/mask_len, range is limited by 2^63-1 elements
+    u64i ms {0}, ls {0}; // network address of prefix
+    u32i shift {0}; // 128 - sub_len
+    u64i cnt {0};
+public:
+    using iterator = ipenum_iter<IPv6_Subnets, IPv6_Addr>;
+    IPv6_Subnets(const IPv6_Addr &net, u32i mask_len, u32i sub_len); // empty range if sub_len < mask_len
+    IPv6_Addr at(u64i k) const; // k-th subnet, O(1), no carry, k is not checked
+    IPv6_Addr operator[](u64i k) const { return at(k); };
+    u32i sub_len() const { return 128 - shift; };
+    u64i size() const { return cnt; };
+    bool empty() const { return cnt == 0; };
+    iterator begin() const { return iterator(this, 0); };
+    iterator end() const { return iterator(this, cnt); };
+};
+
+inline IPv6_Addr IPv6_Subnets::at(u64i k) const {
+    if (shift >= 64) return IPv6_Addr(ms | ((shift < 128) ? (k << (shift - 64)) : 0), ls);
+    if (shift == 0) return IPv6_Addr(ms, ls | k);
+    return IPv6_Addr(ms | (k >> (64 - shift)), ls | (k << shift));
+}
+
+#endif // GIA_IPENUM_H
@@ -0,0 +1,431 @@
+#include "gia_ipfilter.h"
+#include <algorithm>
+#include <cmath>
+#include <memory.h>
+
+using namespace std;
+
+struct flt_header { // fixed layout of serialized filter, payload follows right after
+    char magic[8];
+    u32i version;
+    u32i kind;
+    u64i seed;
+    u64i param[3]; // Bloom : blocks, keys. Fuse8 : segment length, segment count length, array length
+    u64i payload; // payload length in bytes
+    u64i reserved;
+};
+static_assert(sizeof(flt_header) == fltmnp::HEADER_LEN, "filter header must take one cache line");
+
+static const char FLT_MAGIC[8] {'G', 'I', 'A', 'F', 'L', 'T', 0, 0};
+static const u32i BLOOM_SALT[8] {0x47B6137B, 0x44974D91, 0x8824AD5B, 0xA2B7289D, 0x705495C7, 0x2DF1424B, 0x9EFC4947, 0x5C6BFB31};
+static const size_t BATCH {16}; // keys in flight during batch queries
+
+static vector<u8i> write_image(u32i kind, u64i seed, u64i p0, u64i p1, u64i p2, const void *payload, u64i plen) {
+    flt_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, FLT_MAGIC, sizeof(hdr.magic));
+    hdr.version = fltmnp::VERSION;
+    hdr.kind = kind;
+    hdr.seed = seed;
+    hdr.param[0] = p0;
+    hdr.param[1] = p1;
+    hdr.param[2] = p2;
+    hdr.payload = plen;
+    vector<u8i> ret(sizeof(hdr) + plen);
+    memcpy(ret.data(), &hdr, sizeof(hdr));
+    if (plen) memcpy(ret.data() + sizeof(hdr), payload, plen);
+    return ret;
+}
+
+static bool read_image(const u8i *image, size_t len, u32i kind, flt_header *hdr) {
+    if ((image == nullptr) || (len < sizeof(flt_header))) return false;
+    memcpy(hdr, image, sizeof(flt_header));
+    if (memcmp(hdr->magic, FLT_MAGIC, sizeof(hdr->magic)) != 0) return false;
+    if ((hdr->version != fltmnp::VERSION) || (hdr->kind != kind)) return false;
+    return hdr->payload <= (len - sizeof(flt_header));
+}
+
+bool Bloom_Filter::init(u64i capacity, u32i bits_per_key, u64i _seed) {
+    if (bits_per_key == 0) bits_per_key = 1;
+    nblocks = (capacity * bits_per_key + 511) / 512;
+    if (nblocks == 0) nblocks = 1;
+    try {
+        own.assign(nblocks * 8, 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        own.clear();
+        blocks = nullptr;
+        nblocks = 0;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        own.clear();
+        blocks = nullptr;
+        nblocks = 0;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    blocks = own.data();
+    seed = _seed;
+    cnt = 0;
+    readonly = false;
+    lerr = fltmnp::NoError;
+    return true;
+}
+
+Bloom_Filter& Bloom_Filter::operator=(const Bloom_Filter &other) {
+    if (this == &other) return *this;
+    try {
+        own = other.own;
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        own.clear();
+        blocks = nullptr;
+        nblocks = 0;
+        lerr = fltmnp::STL_Exception;
+        return *this;
+    }
+    blocks = other.own.empty() ? other.blocks : own.data(); // own storage is never empty when blocks point to it
+    nblocks = other.nblocks;
+    seed = other.seed;
+    cnt = other.cnt;
+    readonly = other.readonly;
+    lerr = other.lerr;
+    return *this;
+}
+
+Bloom_Filter& Bloom_Filter::operator=(Bloom_Filter &&other) noexcept {
+    if (this == &other) return *this;
+    own = move(other.own); // buffer changes owner, so blocks stay valid
+    blocks = other.blocks;
+    nblocks = other.nblocks;
+    seed = other.seed;
+    cnt = other.cnt;
+    readonly = other.readonly;
+    lerr = other.lerr;
+    other.own.clear();
+    other.blocks = nullptr;
+    other.nblocks = 0;
+    other.cnt = 0;
+    return *this;
+}
+
+void Bloom_Filter::insert_hash(u64i hash) {
+    if (readonly || (nblocks == 0)) { lerr = fltmnp::ReadOnly; return; }
+    hash ^= seed;
+    u64i *block = &own[fltmnp::mulhi(hash, nblocks) * 8];
+    u32i low = u32i(hash);
+    for (u32i idx = 0; idx < 8; idx++) block[idx] |= u64i(1) << ((low * BLOOM_SALT[idx]) >> 26);
+    cnt++;
+}
+
+bool Bloom_Filter::contains_hash(u64i hash) const {
+    if (nblocks == 0) return false;
+    hash ^= seed;
+    const u64i *block = &blocks[fltmnp::mulhi(hash, nblocks) * 8];
+    u32i low = u32i(hash);
+    u64i miss {0};
+    for (u32i idx = 0; idx < 8; idx++) miss |= ~block[idx] & (u64i(1) << ((low * BLOOM_SALT[idx]) >> 26));
+    return miss == 0;
+}
+
+template <class Addr>
+void Bloom_Filter::contains_batch(const Addr *arr, size_t n, u8i *out) const {
+    u64i hashes[BATCH];
+    for (size_t beg = 0; beg < n; beg += BATCH) {
+        size_t end = min(n, beg + BATCH);
+        for (size_t idx = beg; idx < end; idx++) { // all cache misses of batch are issued together
+            hashes[idx - beg] = fltmnp::key_of(arr[idx]);
+            if (nblocks) __builtin_prefetch(&blocks[fltmnp::mulhi(hashes[idx - beg] ^ seed, nblocks) * 8]);
+        }
+        for (size_t idx = beg; idx < end; idx++) out[idx] = contains_hash(hashes[idx - beg]);
+    }
+}
+
+void Bloom_Filter::contains(const IPv4_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+void Bloom_Filter::contains(const IPv6_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+void Bloom_Filter::contains(const MAC_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+
+vector<u8i> Bloom_Filter::serialize() const {
+    return write_image(fltmnp::Bloom, seed, nblocks, cnt, 0, blocks, nblocks * 64);
+}
+
+bool Bloom_Filter::view(const u8i *image, size_t len) {
+    flt_header hdr;
+    if (!read_image(image, len, fltmnp::Bloom, &hdr) || (hdr.payload != hdr.param[0] * 64) || (hdr.param[0] == 0) || ((uintptr_t)image & 7)) {
+        lerr = fltmnp::BadImage;
+        return false;
+    }
+    own = vector<u64i>();
+    blocks = (const u64i*)(image + sizeof(flt_header));
+    nblocks = hdr.param[0];
+    cnt = hdr.param[1];
+    seed = hdr.seed;
+    readonly = true;
+    lerr = fltmnp::NoError;
+    return true;
+}
+
+bool Bloom_Filter::load(const u8i *image, size_t len) {
+    flt_header hdr;
+    if (!read_image(image, len, fltmnp::Bloom, &hdr) || (hdr.payload != hdr.param[0] * 64) || (hdr.param[0] == 0)) {
+        lerr = fltmnp::BadImage;
+        return false;
+    }
+    if (!init(0, 1, hdr.seed)) return false;
+    try {
+        own.assign(hdr.param[0] * 8, 0);
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    memcpy(own.data(), image + sizeof(flt_header), hdr.payload);
+    blocks = own.data();
+    nblocks = hdr.param[0];
+    cnt = hdr.param[1];
+    return true;
+}
+
+Fuse_Filter& Fuse_Filter::operator=(const Fuse_Filter &other) {
+    if (this == &other) return *this;
+    try {
+        own = other.own;
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        own.clear();
+        fps = nullptr;
+        lerr = fltmnp::STL_Exception;
+        return *this;
+    }
+    fps = other.own.empty() ? other.fps : own.data(); // own storage is never empty when fps point to it
+    seed = other.seed;
+    segLen = other.segLen;
+    segLenMask = other.segLenMask;
+    segCountLen = other.segCountLen;
+    arrayLen = other.arrayLen;
+    lerr = other.lerr;
+    return *this;
+}
+
+Fuse_Filter& Fuse_Filter::operator=(Fuse_Filter &&other) noexcept {
+    if (this == &other) return *this;
+    own = move(other.own); // buffer changes owner, so fps stay valid
+    fps = other.fps;
+    seed = other.seed;
+    segLen = other.segLen;
+    segLenMask = other.segLenMask;
+    segCountLen = other.segCountLen;
+    arrayLen = other.arrayLen;
+    lerr = other.lerr;
+    other.own.clear();
+    other.fps = nullptr;
+    other.arrayLen = 0;
+    return *this;
+}
+
+void Fuse_Filter::positions(u64i hash, u32i *h0, u32i *h1, u32i *h2) const {
+    u64i hi = fltmnp::mulhi(hash, segCountLen);
+    *h0 = u32i(hi);
+    *h1 = *h0 + segLen;
+    *h2 = *h1 + segLen;
+    *h1 ^= u32i(hash >> 18) & segLenMask;
+    *h2 ^= u32i(hash) & segLenMask;
+}
+
+bool Fuse_Filter::contains_hash(u64i hash) const {
+    if (fps == nullptr) return false;
+    hash = fltmnp::mix64(hash + seed);
+    u32i h0, h1, h2;
+    positions(hash, &h0, &h1, &h2);
+    return (fingerprint(hash) ^ fps[h0] ^ fps[h1] ^ fps[h2]) == 0;
+}
+
+bool Fuse_Filter::build_hashes(vector<u64i> &keys) {
+    const u32i ARITY {3};
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    u64i n = keys.size();
+    if (n > 0xFFFFFFFF / 2) { lerr = fltmnp::BuildFailed; return false; }
+    segLen = (n == 0) ? 4 : u32i(1) << u32i(floor(log(double(n)) / log(3.33) + 2.25));
+    if (segLen > 262144) segLen = 262144;
+    segLenMask = segLen - 1;
+    double sizeFactor = (n <= 1) ? 0.0 : max(1.125, 0.875 + 0.25 * log(1000000.0) / log(double(n)));
+    int64_t capacity = int64_t(round(double(n) * sizeFactor));
+    int64_t segCount = (capacity + segLen - 1) / segLen - (ARITY - 1);
+    segCount = ((segCount + ARITY - 1) * segLen + segLen - 1) / segLen;
+    segCount = (segCount <= ARITY - 1) ? 1 : segCount - (ARITY - 1);
+    arrayLen = u32i((segCount + ARITY - 1) * segLen);
+    segCountLen = u32i(segCount * segLen);
+
+    vector<u8i> t2count; // (keys in slot << 2) | xor of position numbers
+    vector<u64i> t2hash; // xor of hashes in slot
+    vector<u32i> queue;
+    vector<u64i> stackHash;
+    vector<u32i> stackSlot;
+    try {
+        t2count.resize(arrayLen);
+        t2hash.resize(arrayLen);
+        queue.reserve(arrayLen);
+        stackHash.reserve(n);
+        stackSlot.reserve(n);
+        own.assign(arrayLen, 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    fps = nullptr;
+    for (u32i attempt = 0; attempt < 100; attempt++) {
+        seed = fltmnp::mix64(0x9E3779B97F4A7C15 + attempt);
+        fill(t2count.begin(), t2count.end(), 0);
+        fill(t2hash.begin(), t2hash.end(), 0);
+        queue.clear();
+        stackHash.clear();
+        stackSlot.clear();
+        bool overflow {false};
+        u32i pos[3];
+        for (auto && key : keys) {
+            u64i hash = fltmnp::mix64(key + seed);
+            positions(hash, &pos[0], &pos[1], &pos[2]);
+            for (u32i num = 0; num < 3; num++) {
+                if (t2count[pos[num]] >= 0xFC) overflow = true;
+                t2count[pos[num]] += 4;
+                t2count[pos[num]] ^= num;
+                t2hash[pos[num]] ^= hash;
+            }
+        }
+        if (overflow) continue;
+        for (u32i slot = 0; slot < arrayLen; slot++) {
+            if ((t2count[slot] >> 2) == 1) queue.push_back(slot);
+        }
+        while (!queue.empty()) { // peeling : slot with single key is owned by that key
+            u32i slot = queue.back();
+            queue.pop_back();
+            if ((t2count[slot] >> 2) != 1) continue;
+            u64i hash = t2hash[slot];
+            stackHash.push_back(hash);
+            stackSlot.push_back(slot);
+            positions(hash, &pos[0], &pos[1], &pos[2]);
+            for (u32i num = 0; num < 3; num++) {
+                t2count[pos[num]] -= 4;
+                t2count[pos[num]] ^= num;
+                t2hash[pos[num]] ^= hash;
+                if ((t2count[pos[num]] >> 2) == 1) queue.push_back(pos[num]);
+            }
+        }
+        if (stackHash.size() != n) continue;
+        fill(own.begin(), own.end(), 0);
+        for (size_t idx = n; idx > 0; idx--) { // reverse order of peeling
+            u64i hash = stackHash[idx - 1];
+            u32i slot = stackSlot[idx - 1];
+            positions(hash, &pos[0], &pos[1], &pos[2]);
+            own[slot] = 0;
+            own[slot] = fingerprint(hash) ^ own[pos[0]] ^ own[pos[1]] ^ own[pos[2]];
+        }
+        fps = own.data();
+        lerr = fltmnp::NoError;
+        return true;
+    }
+    own.clear();
+    lerr = fltmnp::BuildFailed;
+    return false;
+}
+
+template <class Addr>
+bool Fuse_Filter::build_from(const Addr *arr, size_t n) {
+    vector<u64i> keys;
+    try {
+        keys.resize(n);
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    for (size_t idx = 0; idx < n; idx++) keys[idx] = fltmnp::key_of(arr[idx]);
+    return build_hashes(keys);
+}
+
+bool Fuse_Filter::build(const IPv4_Addr *arr, size_t n) { return build_from(arr, n); }
+bool Fuse_Filter::build(const IPv6_Addr *arr, size_t n) { return build_from(arr, n); }
+bool Fuse_Filter::build(const MAC_Addr *arr, size_t n) { return build_from(arr, n); }
+
+template <class Addr>
+void Fuse_Filter::contains_batch(const Addr *arr, size_t n, u8i *out) const {
+    if (fps == nullptr) {
+        memset(out, 0, n);
+        return;
+    }
+    u64i hashes[BATCH];
+    u32i pos[BATCH][3];
+    for (size_t beg = 0; beg < n; beg += BATCH) {
+        size_t end = min(n, beg + BATCH);
+        for (size_t idx = beg; idx < end; idx++) { // all cache misses of batch are issued together
+            u64i hash = fltmnp::mix64(fltmnp::key_of(arr[idx]) + seed);
+            u32i *p = pos[idx - beg];
+            hashes[idx - beg] = hash;
+            positions(hash, &p[0], &p[1], &p[2]);
+            __builtin_prefetch(&fps[p[0]]);
+            __builtin_prefetch(&fps[p[1]]);
+            __builtin_prefetch(&fps[p[2]]);
+        }
+        for (size_t idx = beg; idx < end; idx++) {
+            const u32i *p = pos[idx - beg];
+            out[idx] = (fingerprint(hashes[idx - beg]) ^ fps[p[0]] ^ fps[p[1]] ^ fps[p[2]]) == 0;
+        }
+    }
+}
+
+void Fuse_Filter::contains(const IPv4_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+void Fuse_Filter::contains(const IPv6_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+void Fuse_Filter::contains(const MAC_Addr *arr, size_t n, u8i *out) const { contains_batch(arr, n, out); }
+
+vector<u8i> Fuse_Filter::serialize() const {
+    return write_image(fltmnp::Fuse8, seed, segLen, segCountLen, arrayLen, fps, (fps == nullptr) ? 0 : arrayLen);
+}
+
+bool Fuse_Filter::view(const u8i *image, size_t len) {
+    flt_header hdr;
+    if (!read_image(image, len, fltmnp::Fuse8, &hdr) || (hdr.payload != hdr.param[2]) || (hdr.param[0] == 0) || (hdr.param[0] & (hdr.param[0] - 1))
+        || (hdr.param[2] > 0xFFFFFFFF) || (hdr.param[1] + 2 * hdr.param[0] > hdr.param[2])) {
+        lerr = fltmnp::BadImage;
+        return false;
+    }
+    own = vector<u8i>();
+    seed = hdr.seed;
+    segLen = u32i(hdr.param[0]);
+    segLenMask = segLen - 1;
+    segCountLen = u32i(hdr.param[1]);
+    arrayLen = u32i(hdr.param[2]);
+    fps = image + sizeof(flt_header);
+    lerr = fltmnp::NoError;
+    return true;
+}
+
+bool Fuse_Filter::load(const u8i *image, size_t len) {
+    if (!view(image, len)) return false;
+    try {
+        own.assign(fps, fps + arrayLen);
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        fps = nullptr;
+        lerr = fltmnp::STL_Exception;
+        return false;
+    }
+    fps = own.data();
+    return true;
+}
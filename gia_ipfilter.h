@@ -0,0 +1,101 @@
+#ifndef GIA_IPFILTER_H
+#define GIA_IPFILTER_H
+
+#include "gia_iphash.h"
+
+using namespace std;
+
+class fltmnp {
+public:
+    static u64i mix64(u64i x) { return hashmnp::mix64(x); };
+    static u64i key_of(const IPv4_Addr &ip) { return mix64(u64i(ip()) | 0x0400000000000000); };
+    static u64i key_of(const IPv6_Addr &ip) { return mix64(ip().ms ^ mix64(ip().ls ^ 0x0600000000000000)); };
+    static u64i key_of(const MAC_Addr &mac) { return mix64(mac() | 0x4D00000000000000); };
+    static u64i mulhi(u64i a, u64i b) { return u64i(((unsigned __int128)a * b) >> 64); };
+    enum enKind : u32i {Bloom = 1, Fuse8 = 2};
+    enum enLastError : u8i {NoError = 0, BadImage = 1, BuildFailed = 2, ReadOnly = 3, STL_Exception = 4};
+    static const u32i VERSION {1};
+    static const size_t HEADER_LEN {64}; // payload starts at cache line boundary
+};
+
+class Bloom_Filter { // blocked Bloom filter : each key sets 8 bits in one 512-bit block, so query costs one cache miss
+    vector<u64i> own; // storage of filter built in memory
+    const u64i *blocks {nullptr}; // 8 words per block, own.data() or external image
+    u64i nblocks {0};
+    u64i seed {0};
+    u64i cnt {0}; // inserted keys
+    bool readonly {false};
+    mutable fltmnp::enLastError lerr {fltmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func Bloom_Filter::init() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func Bloom_Filter::init() says: exception."};
+    void insert_hash(u64i hash);
+    bool contains_hash(u64i hash) const;
+    template <class Addr> void contains_batch(const Addr *arr, size_t n, u8i *out) const;
+public:
+    Bloom_Filter() {};
+    Bloom_Filter(u64i capacity, u32i bits_per_key = 12, u64i _seed = 0) { init(capacity, bits_per_key, _seed); };
+    Bloom_Filter(const Bloom_Filter &other) { *this = other; };
+    Bloom_Filter(Bloom_Filter &&other) noexcept { *this = move(other); };
+    Bloom_Filter& operator=(const Bloom_Filter &other); // copy of view shares external image
+    Bloom_Filter& operator=(Bloom_Filter &&other) noexcept;
+    bool init(u64i capacity, u32i bits_per_key = 12, u64i _seed = 0); // 12 bits per key gives ~0.5% of false positives
+    void insert(const IPv4_Addr &ip) { insert_hash(fltmnp::key_of(ip)); };
+    void insert(const IPv6_Addr &ip) { insert_hash(fltmnp::key_of(ip)); };
+    void insert(const MAC_Addr &mac) { insert_hash(fltmnp::key_of(mac)); };
+    void insert(const IPv4_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) insert_hash(fltmnp::key_of(arr[idx])); };
+    void insert(const IPv6_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) insert_hash(fltmnp::key_of(arr[idx])); };
+    void insert(const MAC_Addr *arr, size_t n) { for (size_t idx = 0; idx < n; idx++) insert_hash(fltmnp::key_of(arr[idx])); };
+    bool contains(const IPv4_Addr &ip) const { return contains_hash(fltmnp::key_of(ip)); };
+    bool contains(const IPv6_Addr &ip) const { return contains_hash(fltmnp::key_of(ip)); };
+    bool contains(const MAC_Addr &mac) const { return contains_hash(fltmnp::key_of(mac)); };
+    void contains(const IPv4_Addr *arr, size_t n, u8i *out) const; // out[i] = 1 if arr[i] may be present
+    void contains(const IPv6_Addr *arr, size_t n, u8i *out) const;
+    void contains(const MAC_Addr *arr, size_t n, u8i *out) const;
+    u64i count() const { return cnt; };
+    size_t mem_bytes() const { return nblocks * 64; };
+    vector<u8i> serialize() const; // header + raw blocks
+    bool view(const u8i *image, size_t len); // zero-copy, image must outlive filter and be 8-byte aligned, filter becomes read-only
+    bool load(const u8i *image, size_t len); // copy of image, filter stays writable
+    fltmnp::enLastError last_err() const { return lerr; };
+};
+
+class Fuse_Filter { // immutable binary fuse filter with 8-bit fingerprints (~9 bits per key, ~0.4% of false positives), query costs three memory accesses
+    vector<u8i> own; // storage of filter built in memory
+    const u8i *fps {nullptr}; // fingerprints, own.data() or external image
+    u64i seed {0};
+    u32i segLen {0};
+    u32i segLenMask {0};
+    u32i segCountLen {0};
+    u32i arrayLen {0};
+    mutable fltmnp::enLastError lerr {fltmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func Fuse_Filter::build() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func Fuse_Filter::build() says: exception."};
+    void positions(u64i hash, u32i *h0, u32i *h1, u32i *h2) const;
+    static u8i fingerprint(u64i hash) { return u8i(hash ^ (hash >> 32)); };
+    bool contains_hash(u64i hash) const;
+    bool build_hashes(vector<u64i> &keys); // keys are consumed
+    template <class Addr> bool build_from(const Addr *arr, size_t n);
+    template <class Addr> void contains_batch(const Addr *arr, size_t n, u8i *out) const;
+public:
+    Fuse_Filter() {};
+    Fuse_Filter(const Fuse_Filter &other) { *this = other; };
+    Fuse_Filter(Fuse_Filter &&other) noexcept { *this = move(other); };
+    Fuse_Filter& operator=(const Fuse_Filter &other); // copy of view shares external image
+    Fuse_Filter& operator=(Fuse_Filter &&other) noexcept;
+    bool build(const IPv4_Addr *arr, size_t n);
+    bool build(const IPv6_Addr *arr, size_t n);
+    bool build(const MAC_Addr *arr, size_t n);
+    bool contains(const IPv4_Addr &ip) const { return contains_hash(fltmnp::key_of(ip)); };
+    bool contains(const IPv6_Addr &ip) const { return contains_hash(fltmnp::key_of(ip)); };
+    bool contains(const MAC_Addr &mac) const { return contains_hash(fltmnp::key_of(mac)); };
+    void contains(const IPv4_Addr *arr, size_t n, u8i *out) const; // out[i] = 1 if arr[i] may be present
+    void contains(const IPv6_Addr *arr, size_t n, u8i *out) const;
+    void contains(const MAC_Addr *arr, size_t n, u8i *out) const;
+    size_t mem_bytes() const { return arrayLen; };
+    vector<u8i> serialize() const; // header + raw fingerprints
+    bool view(const u8i *image, size_t len); // zero-copy, image must outlive filter
+    bool load(const u8i *image, size_t len); // copy of image
+    fltmnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_IPFILTER_H
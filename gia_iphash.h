@@ -0,0 +1,201 @@
+#ifndef GIA_IPHASH_H
+#define GIA_IPHASH_H
+
+#include <functional>
+#include "gia_ipmnp.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+class hashmnp {
+public:
+    static const u64i K1 {0xA0761D6478BD642F}, K2 {0xE7037ED1A0B428DB}, K3 {0x8EBC6AF09C88C6E3}, K4 {0x589965CC75374CC3};
+    static u64i fold(u64i a, u64i b) { unsigned __int128 r = (unsigned __int128)a * b; return u64i(r) ^ u64i(r >> 64); }; // multiply-xorshift of 128-bit product
+    static u64i mix64(u64i x) { x ^= x >> 33; x *= 0xFF51AFD7ED558CCD; x ^= x >> 33; x *= 0xC4CEB9FE1A85EC53; x ^= x >> 33; return x; }; // murmur3 finalizer
+    static u64i hash(u32i ipv4) { return fold(u64i(ipv4) ^ K1, K2); };
+    static u64i hash(u64i ms, u64i ls) { return fold(fold(ms ^ K1, ls ^ K2) ^ K3, K4); };
+    static u64i hash_48bits(u64i mac) { return fold(mac ^ K3, K2); };
+};
+
+namespace std {
+    template <> struct hash<IPv4_Addr> { size_t operator()(const IPv4_Addr &ip) const { return hashmnp::hash(ip()); }; };
+    template <> struct hash<IPv6_Addr> { size_t operator()(const IPv6_Addr &ip) const { return hashmnp::hash(ip().ms, ip().ls); }; };
+    template <> struct hash<MAC_Addr> { size_t operator()(const MAC_Addr &mac) const { return hashmnp::hash_48bits(mac()); }; };
+}
+
+struct ipkey_u128 { // compact IPv6 key, IPv6_Addr itself takes 24 bytes
+    u64i ls {0};
+    u64i ms {0};
+    bool operator==(const ipkey_u128 &other) const { return (ls == other.ls) && (ms == other.ms); };
+};
+
+template <class K> struct ipkey_traits; // raw key of minimal width, stored in flat tables instead of address object
+
+template <> struct ipkey_traits<IPv4_Addr> {
+    using raw_t = u32i;
+    static raw_t to_raw(const IPv4_Addr &ip) { return ip(); };
+    static IPv4_Addr from_raw(raw_t raw) { return IPv4_Addr(raw); };
+    static u64i hash(raw_t raw) { return hashmnp::hash(raw); };
+};
+
+template <> struct ipkey_traits<IPv6_Addr> {
+    using raw_t = ipkey_u128;
+    static raw_t to_raw(const IPv6_Addr &ip) { return raw_t{ip().ls, ip().ms}; };
+    static IPv6_Addr from_raw(const raw_t &raw) { return IPv6_Addr(raw.ms, raw.ls); };
+    static u64i hash(const raw_t &raw) { return hashmnp::hash(raw.ms, raw.ls); };
+};
+
+template <> struct ipkey_traits<MAC_Addr> {
+    using raw_t = u64i;
+    static raw_t to_raw(const MAC_Addr &mac) { return mac(); };
+    static MAC_Addr from_raw(raw_t raw) { return MAC_Addr(raw); };
+    static u64i hash(raw_t raw) { return hashmnp::hash_48bits(raw); };
+};
+
+class ipflat_group { // 16 control bytes probed at once
+public:
+    static constexpr size_t WIDTH {16};
+    static constexpr int8_t EMPTY {-128}, DELETED {-2}; // full slots keep 7 bits of hash (0 - 127)
+#ifdef __SSE2__
+    static u32i match(const int8_t *ctrl, int8_t h2) { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ctrl), _mm_set1_epi8(h2))); };
+    static u32i match_empty(const int8_t *ctrl) { return match(ctrl, EMPTY); };
+    static u32i match_free(const int8_t *ctrl) { return _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128((const __m128i*)ctrl), _mm_set1_epi8(-1))); }; // empty or deleted
+#else
+    static u32i match(const int8_t *ctrl, int8_t h2) { u32i ret {0}; for (u32i idx = 0; idx < WIDTH; idx++) ret |= u32i(ctrl[idx] == h2) << idx; return ret; };
+    static u32i match_empty(const int8_t *ctrl) { return match(ctrl, EMPTY); };
+    static u32i match_free(const int8_t *ctrl) { u32i ret {0}; for (u32i idx = 0; idx < WIDTH; idx++) ret |= u32i(ctrl[idx] < -1) << idx; return ret; };
+#endif
+};
+
+template <class K, class Slot>
+class ipflat_core { // open addressing table with SIMD group probing (swiss table layout), Slot must have member "key" of raw type
+protected:
+    using traits = ipkey_traits<K>;
+    using raw_t = typename traits::raw_t;
+    static constexpr size_t NPOS {SIZE_MAX};
+    vector<int8_t> ctrl; // capacity + WIDTH, tail mirrors first group
+    vector<Slot> slots;
+    size_t mask {0}; // capacity - 1
+    size_t sz {0};
+    size_t growthLeft {0};
+    void set_ctrl(size_t idx, int8_t val) { ctrl[idx] = val; if (idx < ipflat_group::WIDTH) ctrl[mask + 1 + idx] = val; };
+    size_t find_idx(const raw_t &raw) const;
+    size_t free_idx(u64i hash) const; // first empty or deleted slot of probe sequence
+    size_t insert_idx(const raw_t &raw, bool *inserted); // index of existing or new slot
+    void rehash(size_t cap);
+public:
+    size_t size() const { return sz; };
+    bool empty() const { return sz == 0; };
+    size_t capacity() const { return slots.size(); };
+    void reserve(size_t cnt) { size_t cap {ipflat_group::WIDTH}; while (cap * 7 / 8 < cnt) cap *= 2; if (cap > slots.size()) rehash(cap); };
+    void clear() { ctrl.clear(); slots.clear(); mask = sz = growthLeft = 0; };
+    bool contains(const K &key) const { return find_idx(traits::to_raw(key)) != NPOS; };
+    bool erase(const K &key);
+};
+
+template <class K, class Slot>
+size_t ipflat_core<K,Slot>::find_idx(const raw_t &raw) const {
+    if (slots.empty()) return NPOS;
+    u64i hash = traits::hash(raw);
+    int8_t h2 = hash & 0x7F;
+    size_t pos = (hash >> 7) & mask;
+    size_t step {0};
+    while (true) {
+        const int8_t *grp = &ctrl[pos];
+        u32i bits = ipflat_group::match(grp, h2);
+        while (bits) {
+            size_t idx = (pos + __builtin_ctz(bits)) & mask;
+            if (slots[idx].key == raw) return idx;
+            bits &= bits - 1;
+        }
+        if (ipflat_group::match_empty(grp)) return NPOS;
+        step += ipflat_group::WIDTH;
+        pos = (pos + step) & mask; // triangular probing visits every group
+    }
+}
+
+template <class K, class Slot>
+size_t ipflat_core<K,Slot>::free_idx(u64i hash) const {
+    size_t pos = (hash >> 7) & mask;
+    size_t step {0};
+    while (true) {
+        u32i bits = ipflat_group::match_free(&ctrl[pos]);
+        if (bits) return (pos + __builtin_ctz(bits)) & mask;
+        step += ipflat_group::WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+template <class K, class Slot>
+size_t ipflat_core<K,Slot>::insert_idx(const raw_t &raw, bool *inserted) {
+    size_t idx = find_idx(raw);
+    if (idx != NPOS) { *inserted = false; return idx; }
+    u64i hash = traits::hash(raw);
+    if (slots.empty()) rehash(ipflat_group::WIDTH);
+    idx = free_idx(hash);
+    if ((growthLeft == 0) && (ctrl[idx] == ipflat_group::EMPTY)) {
+        rehash((sz * 2 >= (mask + 1) * 7 / 8) ? (mask + 1) * 2 : mask + 1); // grow, or only drop tombstones
+        idx = free_idx(hash);
+    }
+    if (ctrl[idx] == ipflat_group::EMPTY) growthLeft--;
+    set_ctrl(idx, int8_t(hash & 0x7F));
+    slots[idx].key = raw;
+    sz++;
+    *inserted = true;
+    return idx;
+}
+
+template <class K, class Slot>
+void ipflat_core<K,Slot>::rehash(size_t cap) {
+    vector<int8_t> oldCtrl;
+    vector<Slot> oldSlots;
+    oldCtrl.swap(ctrl);
+    oldSlots.swap(slots);
+    ctrl.assign(cap + ipflat_group::WIDTH, ipflat_group::EMPTY);
+    slots.resize(cap);
+    mask = cap - 1;
+    for (size_t idx = 0; idx < oldSlots.size(); idx++) {
+        if (oldCtrl[idx] < 0) continue;
+        size_t dst = free_idx(traits::hash(oldSlots[idx].key));
+        set_ctrl(dst, oldCtrl[idx]);
+        slots[dst] = move(oldSlots[idx]);
+    }
+    growthLeft = cap * 7 / 8 - sz;
+}
+
+template <class K, class Slot>
+bool ipflat_core<K,Slot>::erase(const K &key) {
+    size_t idx = find_idx(traits::to_raw(key));
+    if (idx == NPOS) return false;
+    set_ctrl(idx, ipflat_group::DELETED);
+    slots[idx] = Slot();
+    sz--;
+    return true;
+}
+
+template <class K, class V> struct ipflat_map_slot { typename ipkey_traits<K>::raw_t key; V val; };
+template <class K> struct ipflat_set_slot { typename ipkey_traits<K>::raw_t key; };
+
+template <class K, class V>
+class IP_FlatMap : public ipflat_core<K, ipflat_map_slot<K,V>> { // K is IPv4_Addr, IPv6_Addr, IP_Addr (gia_ipdual.h) or MAC_Addr, V must be default constructible
+    using core = ipflat_core<K, ipflat_map_slot<K,V>>;
+public:
+    V* find(const K &key) { size_t idx = core::find_idx(core::traits::to_raw(key)); return (idx == core::NPOS) ? nullptr : &core::slots[idx].val; };
+    const V* find(const K &key) const { size_t idx = core::find_idx(core::traits::to_raw(key)); return (idx == core::NPOS) ? nullptr : &core::slots[idx].val; };
+    bool insert(const K &key, const V &val) { bool ins; size_t idx = core::insert_idx(core::traits::to_raw(key), &ins); if (ins) core::slots[idx].val = val; return ins; }; // false if key exists
+    void insert_or_assign(const K &key, const V &val) { bool ins; core::slots[core::insert_idx(core::traits::to_raw(key), &ins)].val = val; };
+    V& operator[](const K &key) { bool ins; return core::slots[core::insert_idx(core::traits::to_raw(key), &ins)].val; };
+    template <class Func> void for_each(Func func) { for (size_t idx = 0; idx < core::slots.size(); idx++) if (core::ctrl[idx] >= 0) func(core::traits::from_raw(core::slots[idx].key), core::slots[idx].val); };
+};
+
+template <class K>
+class IP_FlatSet : public ipflat_core<K, ipflat_set_slot<K>> { // K is IPv4_Addr, IPv6_Addr, IP_Addr (gia_ipdual.h) or MAC_Addr
+    using core = ipflat_core<K, ipflat_set_slot<K>>;
+public:
+    bool insert(const K &key) { bool ins; core::insert_idx(core::traits::to_raw(key), &ins); return ins; }; // false if key exists
+    template <class Func> void for_each(Func func) const { for (size_t idx = 0; idx < core::slots.size(); idx++) if (core::ctrl[idx] >= 0) func(core::traits::from_raw(core::slots[idx].key)); };
+};
+
+#endif // GIA_IPHASH_H
@@ -1,4 +1,5 @@
 #include "gia_ipmnp.h"
+#include "gia_stats.h"
 #include <memory.h>
 //#include <iostream>
 
@@ -53,21 +54,23 @@ string v4mnp::sub_str(const string &str, u32i pos, u32i len) {
 }
 
 bool v4mnp::valid_addr(const string &ipstr, IPv4_Addr *ret) {
+    GIA_COUNT(V4_Parse);
+    GIA_TIMER(H_V4_Parse);
     if (ret != nullptr) { ret->as_u32i = 0x0; ret->lerr = BadSyntax; }
     size_t len {ipstr.length()};
-    if ((len > 15) || (len < 7)) return false;
+    if ((len > 15) || (len < 7)) return GIA_FAIL(V4_FailLength);
     size_t dotpos[3];
     size_t index {0}; // [index] in dotsPos array
     u32i dots {0}; // dots counter
     for (auto && ch : ipstr) { // check for permitted symbols and dots counting
-        if ((ch > '9') || ((ch < '0') && (ch != '.'))) return false;
+        if ((ch > '9') || ((ch < '0') && (ch != '.'))) return GIA_FAIL(V4_FailSymbol);
         if (ch == '.') {
-            if (dots <= 3) dotpos[dots] = index;
+            if (dots < 3) dotpos[dots] = index; // fourth dot fails the count below
             dots++;
         }
         index++;
     }
-    if (dots != 3) return false;
+    if (dots != 3) return GIA_FAIL(V4_FailDots);
     string ss[4] {
         sub_str(ipstr, dotpos[2] + 1, len - dotpos[2] - 1),
         sub_str(ipstr, dotpos[1] + 1, dotpos[2] - dotpos[1] - 1),
@@ -79,10 +82,10 @@ bool v4mnp::valid_addr(const string &ipstr, IPv4_Addr *ret) {
         if ((!ss[oct].empty()) && (ss[oct].length() <= 3)) {
             octets[oct] = dstr_to_u32i(ss[oct]);
         } else {
-            return false;
+            return GIA_FAIL(V4_FailOctet);
         }
     }
-    if ((octets[0] > 255) || (octets[1] > 255) || (octets[2] > 255) || (octets[3] > 255)) return false;
+    if ((octets[0] > 255) || (octets[1] > 255) || (octets[2] > 255) || (octets[3] > 255)) return GIA_FAIL(V4_FailOctet);
     if (ret != nullptr) {
         for (auto i = 0; i <= 3; i++) {
             ret->as_u32i |= (octets[i] << (8 * i));
@@ -103,7 +106,7 @@ bool v4mnp::valid_mask(const string &maskstr, IPv4_Mask *ret) {
     if (shift != 32) { // looking for binary zeros
         for ( ; shift < 32; shift++)
             if (!((interim.as_u32i >> shift) & 1))
-                return false;
+                return GIA_FAIL(V4_FailMask);
     }
     if (ret != nullptr) { *ret = interim; ret->lerr = NoError; }
     return true;
@@ -216,7 +219,6 @@ vector<string> v6mnp::xtts_split(const string &text, char spl) {
                     }
                 } else {
                     try {
-                        cerr << EX_EXCEPT << endl;
                         ret.push_back("");
                     }
                     catch (...) {
@@ -227,7 +229,6 @@ vector<string> v6mnp::xtts_split(const string &text, char spl) {
         }
         if ((idx == lastIdx) && (text[idx] != ':')) {
             try {
-                cerr << EX_EXCEPT << endl;
                 ret.push_back(v4mnp::sub_str(text, start, idx - start + 1));
             }
             catch (...) {
@@ -249,20 +250,23 @@ bool v6mnp::valid_addr(const string &ipstr, IPv6_Addr *ret) {
     u32i dblColons {0}; // times of double colons repeating
     u32i colons {0}; // single colons count
 
+    GIA_COUNT(V6_Parse);
+    GIA_TIMER(H_V6_Parse);
     // length check;
-    if ((fullLen < 2) || (fullLen > 45)) return false;
+    if ((fullLen < 2) || (fullLen > 45)) return GIA_FAIL(V6_FailLength);
     // repeating of double colon check
     dblColons = word_cnt(ipstr, "::");
-    if (dblColons > 1) return false;
+    if (dblColons > 1) return GIA_FAIL(V6_FailColons);
     // colon count check
     colons = word_cnt(ipstr, ":");
-    if ((colons > 7) || (colons < 2)) return false;
+    if ((colons > 7) || (colons < 2)) return GIA_FAIL(V6_FailColons);
     // dots count check
     v4dots = word_cnt(ipstr, ".");
-    if (((v4dots >= 1) && (v4dots <= 2)) || (v4dots > 3)) return false;
+    if (((v4dots >= 1) && (v4dots <= 2)) || (v4dots > 3)) return GIA_FAIL(V6_FailDots);
     if (v4dots == 3) v4embed = true;
-    if (v4embed && (!dblColons) && (colons < 6)) return false; // in case "a:b:a:255.100.3.3"
-    if ((!dblColons) && (colons < 7)) return false;
+    if (v4embed) GIA_COUNT(V6_Embedded4); // embedded address is also counted by v4mnp::valid_addr() below
+    if (v4embed && (!dblColons) && (colons < 6)) return GIA_FAIL(V6_FailEmbedded4); // in case "a:b:a:255.100.3.3"
+    if ((!dblColons) && (colons < (v4embed ? 6u : 7u))) return GIA_FAIL(V6_FailColons); // embedded ipv4 takes place of two hextets
     if (ipstr == "::") return true;
     if (ipstr == "::1") {
         if (ret != nullptr) (*ret).as_u8i[0] = 1;
@@ -279,7 +283,7 @@ bool v6mnp::valid_addr(const string &ipstr, IPv6_Addr *ret) {
                 break;
             }
         }
-        if (badsymb) return false;
+        if (badsymb) return GIA_FAIL(V6_FailSymbol);
     }
 
     // if ipv4 is mapped, checking for correctness of ipv4
@@ -295,11 +299,11 @@ bool v6mnp::valid_addr(const string &ipstr, IPv6_Addr *ret) {
         if (v4mnp::valid_addr(v4mnp::sub_str(ipstr, idx, fullLen - idx), &ipv4)) {
             interim.as_u32i[0] = ipv4();
             leftToFill -= 2;
-        } else return false;
+        } else return GIA_FAIL(V6_FailEmbedded4);
     }
 
     // check for ipv4 dots in wrong places
-    if ((v4embed) && (word_cnt(v4mnp::sub_str(ipstr, 0, fullLen - v4Len), "."))) return false;
+    if ((v4embed) && (word_cnt(v4mnp::sub_str(ipstr, 0, fullLen - v4Len), "."))) return GIA_FAIL(V6_FailDots);
 
     // splitting hextets
     vector <string> xttVec;
@@ -313,14 +317,14 @@ bool v6mnp::valid_addr(const string &ipstr, IPv6_Addr *ret) {
         xttVec = xtts_split(ipstr, ':');
     }
     size_t vecLen = xttVec.size(); // vector length
-    if (vecLen > leftToFill) return false;
-    if ((!dblColons) && (vecLen < leftToFill)) return false;
+    if (vecLen > leftToFill) return GIA_FAIL(V6_FailHextets);
+    if ((!dblColons) && (vecLen < leftToFill)) return GIA_FAIL(V6_FailHextets);
 
     // checking hextets, and multiplying double colon hextets
     u32i nextIdx {8 - leftToFill}; // next hextet to fill
     for (auto it = xttVec.rbegin(); it != xttVec.rend(); it++) {
-        if ((*it).empty()) return false;
-        if ((*it).length() > 4) return false; // check for each hextet length
+        if ((*it).empty()) return GIA_FAIL(V6_FailHextets);
+        if ((*it).length() > 4) return GIA_FAIL(V6_FailHextets); // check for each hextet length
         u32i decimal;
         if (*it != ":") { // colon symbol is used as marker of repeating zeroes group
             decimal = hstr_to_u16i(*it);
@@ -345,7 +349,7 @@ bool v6mnp::valid_mask(const string &maskstr, IPv6_Mask *ret) {
     if (shift != 64) { // found last binary one in previous loop; looking for binary zeros in least signif. part
         for ( ; shift < 64; shift++)
             if (!((interim.as_u128i.ls >> shift) & 1))
-                return false;
+                return GIA_FAIL(V6_FailMask);
     }
     // here, if no binary ones was found in least signif. part
     shift = 0;
@@ -355,7 +359,7 @@ bool v6mnp::valid_mask(const string &maskstr, IPv6_Mask *ret) {
     if (shift != 64) { // looking for binary zeros in most signif. part
         for ( ; shift < 64; shift++)
             if (!((interim.as_u128i.ms >> shift) & 1))
-                return false;
+                return GIA_FAIL(V6_FailMask);
     }
     if (ret != nullptr) { *ret = interim; ret->lerr = NoError; }
     return true;
@@ -402,13 +406,7 @@ IPv6_Addr v6mnp::gen_link_local(u64i iface_id) {
 }
 
 IPv6_Addr v6mnp::gen_link_local(const MAC_Addr &mac) {
-    u8i _as_u8i[8];
-    _as_u8i[7] = mac.as_u8i[macmnp::oct1] | 0b00000010;
-    *((u16i*)(&_as_u8i[5])) = *((u16i*)(&mac.as_u8i[macmnp::oct3]));
-    *((u16i*)(&_as_u8i[3])) = 0xFFFE;
-    _as_u8i[2] = mac.as_u8i[macmnp::oct4];
-    *((u16i*)(&_as_u8i[0])) = *((u16i*)(&mac.as_u8i[macmnp::oct6]));
-    return IPv6_Addr{0xFE80000000000000, *((u64i*)(&_as_u8i[0])), false};
+    return IPv6_Addr{0xFE80000000000000, eui64_iid(mac), false};
 }
 
 IPv4_Addr::IPv4_Addr(u8i oct1, u8i oct2, u8i oct3, u8i oct4) {
@@ -431,6 +429,8 @@ IPv4_Addr::IPv4_Addr(const array<u8i,4> &arr) {
 }
 
 string IPv4_Addr::to_str() const {
+    GIA_COUNT(V4_Format);
+    GIA_TIMER(H_V4_Format);
     string ret;
     try {
         ret.reserve(17);
@@ -453,10 +453,8 @@ string IPv4_Addr::to_str() const {
 }
 
 array<u8i,4> IPv4_Addr::to_media_tx() const {
-    array <u8i,4> ret;
-    for (u32i idx = 0; idx < 4; idx++) {
-        ret[3 - idx] = as_u8i[idx];
-    }
+    array<u8i,4> ret;
+    to_wire(ret.data());
     return ret;
 }
 
@@ -531,7 +529,7 @@ IPv6_Addr::IPv6_Addr(u16i xtt1, u16i xtt2, u16i xtt3, u16i xtt4, u16i xtt5, u16i
 }
 
 bool IPv6_Addr::getzg(u32i *beg, u32i *end) const {
-    struct { u32i beg, end, len; } zrGrp[3] {{0,0,0}, {0,0,0}, {0,0,0}}, zrBestGrp; // groups of zeroed hextets
+    struct { u32i beg, end, len; } zrGrp[4] {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}}, zrBestGrp; // groups of zeroed hextets, at most four in "0:1:0:1:0:1:0:1"
     u32i cur {0}; // current group number
     bool start {true}; // start of zeroes sequence ?
     bool preZr {false}; // previous hextet was zero?
@@ -555,7 +553,7 @@ bool IPv6_Addr::getzg(u32i *beg, u32i *end) const {
         }
     } while (idx > 0);
     zrBestGrp = zrGrp[0];
-    for (u32i i = 1; i < 3; i++) {
+    for (u32i i = 1; i < 4; i++) {
         if ((zrGrp[i].beg - zrGrp[i].end) > (zrBestGrp.beg - zrBestGrp.end)) {
             zrBestGrp = zrGrp[i];
         }
@@ -572,6 +570,8 @@ bool IPv6_Addr::getzg(u32i *beg, u32i *end) const {
 }
 
 string IPv6_Addr::to_str(u32i fmt) const {
+    GIA_COUNT(V6_Format);
+    GIA_TIMER(H_V6_Format);
     const char *useSet = ((fmt & v6mnp::UPPER_VIEW) == v6mnp::UPPER_VIEW) ? v6mnp::HEX_UPP : v6mnp::HEX_LOW;
     string ret;
     try {
@@ -603,7 +603,7 @@ string IPv6_Addr::to_str(u32i fmt) const {
     }
     if ((fmt & v6mnp::LEADZRS_VIEW) != v6mnp::LEADZRS_VIEW) { // deleting leading zeroes in each hextet
         for (u32i idx = 0; idx < 8; idx++) {
-            memcpy(&(full[idx][0]), &(full[idx][leadZr[idx]]), (6 - leadZr[idx]));
+            memmove(&(full[idx][0]), &(full[idx][leadZr[idx]]), (6 - leadZr[idx])); // ranges overlap
         }
     }
     bool v4 = (show_ipv4 && (as_u16i[v6mnp::xtt6] == 0xFFFF)) ? true : false;
@@ -630,16 +630,15 @@ string IPv6_Addr::to_str(u32i fmt) const {
         }
     }
     if (v4) {
+        GIA_COUNT(V6_FormatEmbedded4);
         ret.append(IPv4_Addr(as_u32i[0]).to_str());
     }
     return ret;
 }
 
 array<u8i,16> IPv6_Addr::to_media_tx() const {
-    array <u8i,16> ret;
-    for (u32i idx = 0; idx < 16; idx++) {
-        ret[15 - idx] = as_u8i[idx];
-    }
+    array<u8i,16> ret;
+    to_wire(ret.data());
     return ret;
 }
 
@@ -847,6 +846,8 @@ void IPv6_Addr::operator>>=(u32i shift) {
 }
 
 string MAC_Addr::to_str(u32i grp_len, bool caps, char sep) const {
+    GIA_COUNT(MAC_Format);
+    GIA_TIMER(H_MAC_Format);
     string ret;
     try {
         ret.reserve(18);
@@ -883,9 +884,7 @@ string MAC_Addr::to_str(u32i grp_len, bool caps, char sep) const {
 
 array<u8i,6> MAC_Addr::to_media_tx() const {
     array<u8i,6> ret;
-    for (u32i idx = 0; idx < 6; idx++) {
-        ret[5 - idx] = as_u8i[idx];
-    }
+    to_wire(ret.data());
     return ret;
 }
 
@@ -921,11 +920,13 @@ u64i macmnp::hstr_to_u64i(const string &str) { // string with hex digits must be
 }
 
 bool macmnp::valid_addr(const string &macstr, u32i grp_len, char sep, MAC_Addr *ret) {
+    GIA_COUNT(MAC_Parse);
+    GIA_TIMER(H_MAC_Parse);
     if (ret != nullptr) *ret = u64i(0);
     size_t len {macstr.length()};
-    if ((len > 17) || (len < 12)) return false; // len(06:05:04:03:02:01) == 17
+    if ((len > 17) || (len < 12)) return GIA_FAIL(MAC_FailLength); // len(06:05:04:03:02:01) == 17
     if (grp_len != 6) {
-        if ((grp_len > 3) || (grp_len == 0) || (grp_len > 6)) return false;
+        if ((grp_len > 3) || (grp_len == 0) || (grp_len > 6)) return GIA_FAIL(MAC_FailGroup);
     }
     u64i _48bits;
     string interim; // cleaned from separators
@@ -934,11 +935,11 @@ bool macmnp::valid_addr(const string &macstr, u32i grp_len, char sep, MAC_Addr *
     }
     catch (bad_alloc) {
         cerr << EX_LOW_MEM << endl;
-        return false;
+        return GIA_FAIL(MAC_FailMemory);
     }
     catch (...) {
         cerr << EX_EXCEPT << endl;
-        return false;
+        return GIA_FAIL(MAC_FailMemory);
     }
     u32i hexCnt {0}; // counter of hex symbols total (must be <= 12)
     u32i gSymbs {0}; // counter of symbols in one group
@@ -955,22 +956,22 @@ bool macmnp::valid_addr(const string &macstr, u32i grp_len, char sep, MAC_Addr *
             }
         }
         if (ch != sep) {
-            if (badSymb) return false;
+            if (badSymb) return GIA_FAIL(MAC_FailSymbol);
             gSymbs++;
-            if (gSymbs > gSymbsMax) return false;
+            if (gSymbs > gSymbsMax) return GIA_FAIL(MAC_FailGroup);
             hexCnt++;
             if (hexCnt <= 12) {
                 interim.push_back(ch);
-            } else return false;
+            } else return GIA_FAIL(MAC_FailLength);
         } else {
             seps++;
-            if (seps > sepsMax) return false;
-            if ((gSymbs < gSymbsMax) || (gSymbs > gSymbsMax)) return false;
+            if (seps > sepsMax) return GIA_FAIL(MAC_FailSeparator);
+            if ((gSymbs < gSymbsMax) || (gSymbs > gSymbsMax)) return GIA_FAIL(MAC_FailGroup);
             gSymbs = 0;
         }
     }
-    if (seps != sepsMax) return false;
-    if (interim.length() != 12) return false;
+    if (seps != sepsMax) return GIA_FAIL(MAC_FailSeparator);
+    if (interim.length() != 12) return GIA_FAIL(MAC_FailLength);
     _48bits = hstr_to_u64i(interim);
     if (ret != nullptr) ret->as_48bits = _48bits;
     return true;
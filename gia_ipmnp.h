@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 
 #define DEFSEP ':'
@@ -45,6 +46,9 @@ public:
     static IPv4_Addr to_IPv4(const string &ipstr); // ip string to IPv4_Addr object
     static u32i mask_len(u32i bitmask); // integer mask to mask length
     static IPv4_Mask gen_mask(u32i mask_len); // generate mask object by mask length
+    static const u32i PTR_SIZE {29}; // buffer for "255.255.255.255.in-addr.arpa" and terminating zero
+    static bool from_ptr_name(const string &name, IPv4_Addr *ret = nullptr); // "4.3.2.1.in-addr.arpa", trailing dot and any case of suffix are allowed
+    static size_t to_ptr_names(const IPv4_Addr &net, u32i mask_len, char *out, size_t max_names); // names of prefix addresses, PTR_SIZE bytes per name, returns count
     enum enOctets {oct1 = 3, oct2 = 2, oct3 = 1, oct4 = 0};
     enum enLastError : u8i {NoError = 0, BadSyntax = 1, BadIndex = 2, STL_Exception = 3};
 
@@ -73,6 +77,15 @@ public:
     static IPv6_Mask gen_mask(u32i mask_len); // generate bitmask from mask length
     static IPv6_Addr gen_link_local(u64i iface_id); // generate link-local address
     static IPv6_Addr gen_link_local(const MAC_Addr &mac); // generate link-local address
+    static void gen_link_local(const MAC_Addr *macs, size_t n, IPv6_Addr *out);
+    static u64i eui64_iid(const MAC_Addr &mac); // modified EUI-64 interface id, U/L bit inverted - RFC 4291 appendix A
+    static IPv6_Addr gen_eui64(const IPv6_Addr &prefix, const MAC_Addr &mac); // upper 64 bits of prefix and EUI-64 interface id, SLAAC
+    static void gen_eui64(const IPv6_Addr &prefix, const MAC_Addr *macs, size_t n, IPv6_Addr *out);
+    static void gen_eui64_wire(const IPv6_Addr &prefix, const u8i *macs, size_t n, u8i *out); // 6 bytes per MAC, 16 bytes per address, network order
+    static const u32i PTR_SIZE {73}; // 72 symbols of "b.a.9.8 ... 0.ip6.arpa" and terminating zero
+    static bool from_ptr_name(const string &name, IPv6_Addr *ret = nullptr); // 32 nibbles, trailing dot and any case are allowed
+    static size_t to_ptr_names(const IPv6_Addr &net, u32i mask_len, char *out, size_t max_names); // names of prefix addresses, PTR_SIZE bytes per name, returns count
+    static void to_ptr_names(const IPv6_Addr *arr, size_t n, char *out); // PTR_SIZE bytes per name
     static void set_fmt(u32i fmt) { _fmt = fmt; }; // setting format using format flags
     static u32i what_fmt() { return _fmt; }; // return current format
     enum enHextets {xtt1 = 7, xtt2 = 6, xtt3 = 5, xtt4 = 4, xtt5 = 3, xtt6 = 2, xtt7 = 1, xtt8 = 0};
@@ -101,6 +114,11 @@ public:
     static MAC_Addr to_MAC(const string &macstr);
     static MAC_Addr gen_mcast(const IPv4_Addr &ip);
     static MAC_Addr gen_mcast(const IPv6_Addr &ip);
+    static void gen_mcast(const IPv4_Addr *in, size_t n, MAC_Addr *out);
+    static void gen_mcast(const IPv6_Addr *in, size_t n, MAC_Addr *out);
+    static bool from_eui64(const IPv6_Addr &ip, MAC_Addr *ret = nullptr); // false if interface id has no ff:fe in the middle
+    static size_t from_eui64(const IPv6_Addr *in, size_t n, MAC_Addr *out); // other rows get 0, returns count of EUI-64 rows
+    static size_t from_eui64_wire(const u8i *in, size_t n, u8i *out); // 16 bytes per address, 6 bytes per MAC, network order
     static void set_fmt(u32i grp_len, bool caps, char sep = DEFSEP);
     static char what_sep() { return _def_sep; };
     static u32i what_grp_len() { return _def_grp_len; };
@@ -129,6 +147,8 @@ public:
     string to_str(u32i grp_len, bool caps, char sep = DEFSEP) const;
     string to_str() const { return to_str(macmnp::what_grp_len(), macmnp::what_caps(), macmnp::what_sep()); };
     array<u8i,6> to_media_tx() const;
+    void to_wire(u8i *out) const { u64i val = __builtin_bswap64(as_48bits << 16); memcpy(out, &val, 6); }; // 6 bytes in transmission order
+    static MAC_Addr from_wire(const u8i *in) { u64i val {0}; memcpy(&val, in, 6); return MAC_Addr(__builtin_bswap64(val) >> 16); };
     macmnp::enLastError last_err() const { return lerr; };
     void set_nic(u32i nic) { *((u16i*)&as_48bits) = *((u16i*)&nic); as_u8i[macmnp::oct4] = ((u8i*)&nic)[macmnp::oct4]; };
     void set_oui(u32i oui) { *((u32i*)&as_u8i[macmnp::oct3]) = oui; as_48bits &= 0xFFFFFFFFFFFF; };
@@ -190,7 +210,10 @@ public:
     IPv4_Addr(const array<u8i,4> &arr);
     IPv4_Addr(const string &ipstr) { lerr = (v4mnp::valid_addr(ipstr, this)) ? v4mnp::NoError : v4mnp::BadSyntax; };
     string to_str() const;
+    size_t to_ptr_name(char *out) const; // reverse DNS name into buffer of v4mnp::PTR_SIZE bytes, returns length w/o terminating zero
     array<u8i,4> to_media_tx() const;
+    void to_wire(u8i *out) const { u32i val = __builtin_bswap32(as_u32i); memcpy(out, &val, 4); }; // 4 bytes in network order
+    static IPv4_Addr from_wire(const u8i *in) { u32i val; memcpy(&val, in, 4); return IPv4_Addr(__builtin_bswap32(val)); };
     v4mnp::enLastError last_err() const { return lerr; };
     bool is_unknown() const { return as_u32i == 0; }; // 0.0.0.0/32
     bool is_this_host() const { return as_u32i == 0; }; // aka "This host on this network" - RFC 1112
@@ -281,7 +304,10 @@ public:
     IPv6_Addr(const string &ipstr) { lerr = (v6mnp::valid_addr(ipstr, this)) ? v6mnp::NoError : v6mnp::BadSyntax; };
     string to_str(u32i fmt) const;
     string to_str() const { return to_str(v6mnp::what_fmt()); };
+    size_t to_ptr_name(char *out, bool caps = false) const; // nibble-reversed name into buffer of v6mnp::PTR_SIZE bytes, always 72 symbols
     array<u8i,16> to_media_tx() const;
+    void to_wire(u8i *out) const { u64i val[2] {__builtin_bswap64(as_u128i.ms), __builtin_bswap64(as_u128i.ls)}; memcpy(out, val, 16); }; // 16 bytes in network order
+    static IPv6_Addr from_wire(const u8i *in) { u64i val[2]; memcpy(val, in, 16); return IPv6_Addr(__builtin_bswap64(val[0]), __builtin_bswap64(val[1])); };
     v6mnp::enLastError last_err() const { return lerr; };
     bool is_unspec() const { return !(as_u128i.ls | as_u128i.ms); }; // ::1/128 - RFC 4291
     bool is_loopback() const { return (as_u128i.ls | as_u128i.ms) == 1; }; // ::/128 - RFC 4291
@@ -0,0 +1,419 @@
+#include "gia_ipset.h"
+#include <algorithm>
+
+using namespace std;
+
+IPv4_Bitmap::IPv4_Bitmap() {
+    try {
+        bits.assign(WORDS, 0);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        bits.clear();
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        bits.clear();
+    }
+}
+
+bool IPv4_Bitmap::insert(const IPv4_Addr &ip) {
+    if (bits.empty()) return false;
+    u64i &word = bits[ip() >> 6];
+    u64i bit = u64i(1) << (ip() & 63);
+    if (word & bit) return false;
+    word |= bit;
+    card++;
+    return true;
+}
+
+bool IPv4_Bitmap::erase(const IPv4_Addr &ip) {
+    if (bits.empty()) return false;
+    u64i &word = bits[ip() >> 6];
+    u64i bit = u64i(1) << (ip() & 63);
+    if (!(word & bit)) return false;
+    word &= ~bit;
+    card--;
+    return true;
+}
+
+void IPv4_Bitmap::clear() {
+    fill(bits.begin(), bits.end(), 0);
+    card = 0;
+}
+
+void IPv4_Bitmap::operator|=(const IPv4_Bitmap &other) {
+    if (bits.size() != other.bits.size()) return;
+    u64i cnt {0};
+    for (u64i idx = 0; idx < bits.size(); idx++) {
+        bits[idx] |= other.bits[idx];
+        cnt += __builtin_popcountll(bits[idx]);
+    }
+    card = cnt;
+}
+
+void IPv4_Bitmap::operator&=(const IPv4_Bitmap &other) {
+    if (bits.size() != other.bits.size()) return;
+    u64i cnt {0};
+    for (u64i idx = 0; idx < bits.size(); idx++) {
+        bits[idx] &= other.bits[idx];
+        cnt += __builtin_popcountll(bits[idx]);
+    }
+    card = cnt;
+}
+
+bool IPv4_Bitmap::next(const IPv4_Addr &from, IPv4_Addr *ret) const {
+    if (bits.empty()) return false;
+    u64i word = from() >> 6;
+    u64i val = bits[word] & (~u64i(0) << (from() & 63));
+    while (!val) {
+        if (++word == bits.size()) return false;
+        val = bits[word];
+    }
+    if (ret != nullptr) *ret = IPv4_Addr(u32i((word << 6) | __builtin_ctzll(val)));
+    return true;
+}
+
+bool roar_cont::contains(u16i val) const {
+    switch (type) {
+    case ARRAY:
+        return binary_search(vals.begin(), vals.end(), val);
+    case BITMAP:
+        return (bits[val >> 6] >> (val & 63)) & 1;
+    case RUN: {
+        size_t lo {0}, hi {vals.size() / 2}; // looking for last run with start <= val
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (vals[2 * mid] <= val) lo = mid + 1; else hi = mid;
+        }
+        if (lo == 0) return false;
+        return u32i(val) <= u32i(vals[2 * (lo - 1)]) + vals[2 * (lo - 1) + 1];
+    }
+    }
+    return false;
+}
+
+bool roar_cont::insert(u16i val) {
+    if (type == RUN) (card < ARRAY_MAX) ? to_array() : to_bitmap();
+    if (type == ARRAY) {
+        auto it = lower_bound(vals.begin(), vals.end(), val);
+        if ((it != vals.end()) && (*it == val)) return false;
+        if (card < ARRAY_MAX) {
+            vals.insert(it, val);
+            card++;
+            return true;
+        }
+        to_bitmap();
+    }
+    u64i &word = bits[val >> 6];
+    u64i bit = u64i(1) << (val & 63);
+    if (word & bit) return false;
+    word |= bit;
+    card++;
+    return true;
+}
+
+bool roar_cont::erase(u16i val) {
+    if (type == RUN) (card <= ARRAY_MAX) ? to_array() : to_bitmap();
+    if (type == ARRAY) {
+        auto it = lower_bound(vals.begin(), vals.end(), val);
+        if ((it == vals.end()) || (*it != val)) return false;
+        vals.erase(it);
+        card--;
+        return true;
+    }
+    u64i &word = bits[val >> 6];
+    u64i bit = u64i(1) << (val & 63);
+    if (!(word & bit)) return false;
+    word &= ~bit;
+    card--;
+    if (card < ARRAY_MIN) to_array();
+    return true;
+}
+
+void roar_cont::to_array() {
+    if (type == ARRAY) return;
+    vector<u16i> interim;
+    interim.reserve(card);
+    if (type == BITMAP) {
+        for (u32i word = 0; word < BITMAP_WORDS; word++) {
+            u64i val = bits[word];
+            while (val) {
+                interim.push_back(u16i((word << 6) | __builtin_ctzll(val)));
+                val &= val - 1;
+            }
+        }
+    } else {
+        for (size_t idx = 0; idx < vals.size(); idx += 2) {
+            for (u32i val = vals[idx]; val <= u32i(vals[idx]) + vals[idx + 1]; val++) interim.push_back(u16i(val));
+        }
+    }
+    vals.swap(interim);
+    bits = vector<u64i>();
+    type = ARRAY;
+}
+
+void roar_cont::to_bitmap() {
+    if (type == BITMAP) return;
+    bits.assign(BITMAP_WORDS, 0);
+    if (type == ARRAY) {
+        for (auto && val : vals) bits[val >> 6] |= u64i(1) << (val & 63);
+    } else {
+        for (size_t idx = 0; idx < vals.size(); idx += 2) {
+            for (u32i val = vals[idx]; val <= u32i(vals[idx]) + vals[idx + 1]; val++) bits[val >> 6] |= u64i(1) << (val & 63);
+        }
+    }
+    vals = vector<u16i>();
+    type = BITMAP;
+}
+
+u32i roar_cont::runs_count() const {
+    u32i ret {0};
+    switch (type) {
+    case ARRAY:
+        for (size_t idx = 0; idx < vals.size(); idx++) {
+            if ((idx == 0) || (vals[idx] != vals[idx - 1] + 1)) ret++;
+        }
+        break;
+    case BITMAP: {
+        u64i carry {0}; // highest bit of previous word
+        for (u32i word = 0; word < BITMAP_WORDS; word++) {
+            ret += __builtin_popcountll(bits[word] & ~((bits[word] << 1) | carry)); // first bits of runs
+            carry = bits[word] >> 63;
+        }
+        break;
+    }
+    case RUN:
+        ret = vals.size() / 2;
+    }
+    return ret;
+}
+
+bool roar_cont::run_optimize() {
+    u32i runs = runs_count();
+    size_t runBytes = size_t(runs) * 4;
+    size_t plainBytes = (card <= ARRAY_MAX) ? size_t(card) * 2 : BITMAP_WORDS * 8;
+    if (runBytes >= plainBytes) {
+        if (type == RUN) (card <= ARRAY_MAX) ? to_array() : to_bitmap();
+        return false;
+    }
+    if (type == RUN) return true;
+    vector<u16i> interim;
+    interim.reserve(size_t(runs) * 2);
+    u32i start {0}, prev {0};
+    bool first {true};
+    auto add = [&](u32i val) {
+        if (first) {
+            start = prev = val;
+            first = false;
+        } else if (val == prev + 1) {
+            prev = val;
+        } else {
+            interim.push_back(u16i(start));
+            interim.push_back(u16i(prev - start));
+            start = prev = val;
+        }
+    };
+    if (type == ARRAY) {
+        for (auto && val : vals) add(val);
+    } else {
+        for (u32i word = 0; word < BITMAP_WORDS; word++) {
+            u64i val = bits[word];
+            while (val) {
+                add((word << 6) | __builtin_ctzll(val));
+                val &= val - 1;
+            }
+        }
+    }
+    if (!first) {
+        interim.push_back(u16i(start));
+        interim.push_back(u16i(prev - start));
+    }
+    vals.swap(interim);
+    vals.shrink_to_fit();
+    bits = vector<u64i>();
+    type = RUN;
+    return true;
+}
+
+bool roar_cont::next(u32i from, u16i *ret) const {
+    if (from > 0xFFFF) return false;
+    switch (type) {
+    case ARRAY: {
+        auto it = lower_bound(vals.begin(), vals.end(), u16i(from));
+        if (it == vals.end()) return false;
+        *ret = *it;
+        return true;
+    }
+    case BITMAP: {
+        u32i word = from >> 6;
+        u64i val = bits[word] & (~u64i(0) << (from & 63));
+        while (!val) {
+            if (++word == BITMAP_WORDS) return false;
+            val = bits[word];
+        }
+        *ret = u16i((word << 6) | __builtin_ctzll(val));
+        return true;
+    }
+    case RUN:
+        for (size_t idx = 0; idx < vals.size(); idx += 2) {
+            if (u32i(vals[idx]) + vals[idx + 1] < from) continue;
+            *ret = u16i(max(from, u32i(vals[idx])));
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t IPv4_Roaring::find_key(u16i key) const {
+    auto it = lower_bound(keys.begin(), keys.end(), key);
+    return ((it != keys.end()) && (*it == key)) ? size_t(it - keys.begin()) : keys.size();
+}
+
+bool IPv4_Roaring::insert(const IPv4_Addr &ip) {
+    u16i key = ip() >> 16;
+    auto it = lower_bound(keys.begin(), keys.end(), key);
+    size_t idx = it - keys.begin();
+    if ((it == keys.end()) || (*it != key)) {
+        keys.insert(it, key);
+        conts.insert(conts.begin() + idx, roar_cont());
+    }
+    return conts[idx].insert(u16i(ip()));
+}
+
+bool IPv4_Roaring::erase(const IPv4_Addr &ip) {
+    size_t idx = find_key(ip() >> 16);
+    if (idx == keys.size()) return false;
+    if (!conts[idx].erase(u16i(ip()))) return false;
+    if (conts[idx].card == 0) {
+        keys.erase(keys.begin() + idx);
+        conts.erase(conts.begin() + idx);
+    }
+    return true;
+}
+
+bool IPv4_Roaring::contains(const IPv4_Addr &ip) const {
+    size_t idx = find_key(ip() >> 16);
+    return (idx != keys.size()) && conts[idx].contains(u16i(ip()));
+}
+
+u64i IPv4_Roaring::cardinality() const {
+    u64i ret {0};
+    for (auto && cont : conts) ret += cont.card;
+    return ret;
+}
+
+void IPv4_Roaring::run_optimize() {
+    for (auto && cont : conts) cont.run_optimize();
+}
+
+size_t IPv4_Roaring::mem_bytes() const {
+    size_t ret = keys.capacity() * sizeof(u16i);
+    for (auto && cont : conts) ret += cont.mem_bytes();
+    return ret;
+}
+
+static roar_cont cont_union(const roar_cont &a, const roar_cont &b) {
+    roar_cont ret;
+    if ((a.type == roar_cont::ARRAY) && (b.type == roar_cont::ARRAY) && (a.card + b.card <= roar_cont::ARRAY_MAX)) {
+        ret.vals.reserve(a.card + b.card);
+        set_union(a.vals.begin(), a.vals.end(), b.vals.begin(), b.vals.end(), back_inserter(ret.vals));
+        ret.card = ret.vals.size();
+        return ret;
+    }
+    ret = a;
+    ret.to_bitmap();
+    roar_cont other {b};
+    other.to_bitmap();
+    u32i cnt {0};
+    for (u32i word = 0; word < roar_cont::BITMAP_WORDS; word++) {
+        ret.bits[word] |= other.bits[word];
+        cnt += __builtin_popcountll(ret.bits[word]);
+    }
+    ret.card = cnt;
+    if (cnt <= roar_cont::ARRAY_MAX) ret.to_array();
+    return ret;
+}
+
+static roar_cont cont_intersect(const roar_cont &a, const roar_cont &b) {
+    roar_cont ret;
+    if ((a.type == roar_cont::ARRAY) && (b.type == roar_cont::ARRAY)) {
+        set_intersection(a.vals.begin(), a.vals.end(), b.vals.begin(), b.vals.end(), back_inserter(ret.vals));
+    } else if ((a.type == roar_cont::ARRAY) || (b.type == roar_cont::ARRAY)) {
+        const roar_cont &arr = (a.type == roar_cont::ARRAY) ? a : b;
+        const roar_cont &oth = (a.type == roar_cont::ARRAY) ? b : a;
+        for (auto && val : arr.vals) if (oth.contains(val)) ret.vals.push_back(val);
+    } else {
+        ret = a;
+        ret.to_bitmap();
+        roar_cont other {b};
+        other.to_bitmap();
+        u32i cnt {0};
+        for (u32i word = 0; word < roar_cont::BITMAP_WORDS; word++) {
+            ret.bits[word] &= other.bits[word];
+            cnt += __builtin_popcountll(ret.bits[word]);
+        }
+        ret.card = cnt;
+        if (cnt <= roar_cont::ARRAY_MAX) ret.to_array();
+        return ret;
+    }
+    ret.card = ret.vals.size();
+    return ret;
+}
+
+void IPv4_Roaring::operator|=(const IPv4_Roaring &other) {
+    vector<u16i> rkeys;
+    vector<roar_cont> rconts;
+    rkeys.reserve(keys.size() + other.keys.size());
+    rconts.reserve(keys.size() + other.keys.size());
+    size_t ia {0}, ib {0};
+    while ((ia < keys.size()) || (ib < other.keys.size())) {
+        if ((ib == other.keys.size()) || ((ia < keys.size()) && (keys[ia] < other.keys[ib]))) {
+            rkeys.push_back(keys[ia]);
+            rconts.push_back(move(conts[ia++]));
+        } else if ((ia == keys.size()) || (other.keys[ib] < keys[ia])) {
+            rkeys.push_back(other.keys[ib]);
+            rconts.push_back(other.conts[ib++]);
+        } else {
+            rkeys.push_back(keys[ia]);
+            rconts.push_back(cont_union(conts[ia++], other.conts[ib++]));
+        }
+    }
+    keys.swap(rkeys);
+    conts.swap(rconts);
+}
+
+void IPv4_Roaring::operator&=(const IPv4_Roaring &other) {
+    vector<u16i> rkeys;
+    vector<roar_cont> rconts;
+    size_t ia {0}, ib {0};
+    while ((ia < keys.size()) && (ib < other.keys.size())) {
+        if (keys[ia] < other.keys[ib]) {
+            ia++;
+        } else if (other.keys[ib] < keys[ia]) {
+            ib++;
+        } else {
+            roar_cont cont {cont_intersect(conts[ia++], other.conts[ib++])};
+            if (cont.card != 0) {
+                rkeys.push_back(keys[ia - 1]);
+                rconts.push_back(move(cont));
+            }
+        }
+    }
+    keys.swap(rkeys);
+    conts.swap(rconts);
+}
+
+bool IPv4_Roaring::next(const IPv4_Addr &from, IPv4_Addr *ret) const {
+    u16i key = from() >> 16;
+    u16i low;
+    size_t idx = lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+    for ( ; idx < keys.size(); idx++) {
+        u32i start = (keys[idx] == key) ? (from() & 0xFFFF) : 0;
+        if (conts[idx].next(start, &low)) {
+            if (ret != nullptr) *ret = IPv4_Addr((u32i(keys[idx]) << 16) | low);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,101 @@
+#ifndef GIA_IPSET_H
+#define GIA_IPSET_H
+
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+class IPv4_Bitmap { // flat bitmap over whole IPv4 space, 2^32 bits (512 MiB)
+    vector<u64i> bits;
+    u64i card {0};
+    static inline const char EX_LOW_MEM[] = {"func IPv4_Bitmap::IPv4_Bitmap() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func IPv4_Bitmap::IPv4_Bitmap() says: exception."};
+public:
+    static const u64i WORDS {u64i(1) << 26};
+    IPv4_Bitmap();
+    bool valid() const { return !bits.empty(); }; // false if memory was not allocated, then set stays empty
+    bool insert(const IPv4_Addr &ip); // true if ip was not present
+    bool erase(const IPv4_Addr &ip); // true if ip was present
+    bool contains(const IPv4_Addr &ip) const { return !bits.empty() && ((bits[ip() >> 6] >> (ip() & 63)) & 1); };
+    u64i cardinality() const { return card; };
+    void clear();
+    void operator|=(const IPv4_Bitmap &other);
+    void operator&=(const IPv4_Bitmap &other);
+    bool next(const IPv4_Addr &from, IPv4_Addr *ret) const; // smallest address >= from
+    template <class Func> void for_each(Func func) const; // in address order
+};
+
+template <class Func>
+void IPv4_Bitmap::for_each(Func func) const {
+    for (u64i word = 0; word < bits.size(); word++) {
+        u64i val = bits[word];
+        while (val) {
+            func(IPv4_Addr(u32i((word << 6) | __builtin_ctzll(val))));
+            val &= val - 1;
+        }
+    }
+}
+
+class roar_cont { // container of 16-bit values in roaring-style set
+public:
+    enum enType : u8i {ARRAY = 0, BITMAP = 1, RUN = 2};
+    static const u32i ARRAY_MAX {4096}; // above this array is larger than bitmap
+    static const u32i ARRAY_MIN {2048}; // below this bitmap turns back into array, gap stops flipping on insert/erase around ARRAY_MAX
+    static const u32i BITMAP_WORDS {1024};
+    enType type {ARRAY};
+    u32i card {0};
+    vector<u16i> vals; // ARRAY : sorted values, RUN : pairs (start, length - 1)
+    vector<u64i> bits; // BITMAP : 2^16 bits
+    bool contains(u16i val) const;
+    bool insert(u16i val);
+    bool erase(u16i val);
+    void to_array();
+    void to_bitmap();
+    bool run_optimize(); // converts to RUN, if it is smaller
+    u32i runs_count() const;
+    bool next(u32i from, u16i *ret) const; // smallest value >= from
+    size_t mem_bytes() const { return vals.capacity() * sizeof(u16i) + bits.capacity() * sizeof(u64i) + sizeof(roar_cont); };
+    template <class Func> void for_each(u32i high, Func func) const;
+};
+
+template <class Func>
+void roar_cont::for_each(u32i high, Func func) const {
+    switch (type) {
+    case ARRAY:
+        for (auto && val : vals) func(IPv4_Addr(high | val));
+        break;
+    case BITMAP:
+        for (u32i word = 0; word < BITMAP_WORDS; word++) {
+            u64i val = bits[word];
+            while (val) {
+                func(IPv4_Addr(high | (word << 6) | __builtin_ctzll(val)));
+                val &= val - 1;
+            }
+        }
+        break;
+    case RUN:
+        for (size_t idx = 0; idx < vals.size(); idx += 2) {
+            for (u32i val = vals[idx]; val <= u32i(vals[idx]) + vals[idx + 1]; val++) func(IPv4_Addr(high | val));
+        }
+    }
+}
+
+class IPv4_Roaring { // compressed set : chunks by /16, each chunk is array, bitmap or run container
+    vector<u16i> keys; // sorted high 16 bits
+    vector<roar_cont> conts;
+    size_t find_key(u16i key) const; // index in keys, or keys.size()
+public:
+    bool insert(const IPv4_Addr &ip); // true if ip was not present
+    bool erase(const IPv4_Addr &ip); // true if ip was present
+    bool contains(const IPv4_Addr &ip) const;
+    u64i cardinality() const;
+    void clear() { keys.clear(); conts.clear(); };
+    void run_optimize(); // converts containers with long sequences to RUN form
+    size_t mem_bytes() const;
+    void operator|=(const IPv4_Roaring &other);
+    void operator&=(const IPv4_Roaring &other);
+    bool next(const IPv4_Addr &from, IPv4_Addr *ret) const; // smallest address >= from
+    template <class Func> void for_each(Func func) const { for (size_t idx = 0; idx < keys.size(); idx++) conts[idx].for_each(u32i(keys[idx]) << 16, func); }; // in address order
+};
+
+#endif // GIA_IPSET_H
@@ -0,0 +1,249 @@
+#include "gia_ipsort.h"
+#include <atomic>
+#include <memory.h>
+#include <thread>
+
+using namespace std;
+
+template <class K> struct radix_key;
+
+template <> struct radix_key<u32i> {
+    static constexpr u32i BYTES {4};
+    static u32i byte(u32i key, u32i idx) { return (key >> (idx * 8)) & 0xFF; };
+    static bool less(u32i a, u32i b) { return a < b; };
+    static u32i diff_bytes(u32i a, u32i b) { return (a == b) ? 0 : (39 - __builtin_clz(a ^ b)) / 8; }; // bytes from lowest up to highest differing one
+};
+
+template <> struct radix_key<u64i> {
+    static constexpr u32i BYTES {8};
+    static u32i byte(u64i key, u32i idx) { return (key >> (idx * 8)) & 0xFF; };
+    static bool less(u64i a, u64i b) { return a < b; };
+    static u32i diff_bytes(u64i a, u64i b) { return (a == b) ? 0 : (71 - __builtin_clzll(a ^ b)) / 8; };
+};
+
+template <> struct radix_key<ipkey_u128> {
+    static constexpr u32i BYTES {16};
+    static u32i byte(const ipkey_u128 &key, u32i idx) { return (idx < 8) ? (key.ls >> (idx * 8)) & 0xFF : (key.ms >> ((idx - 8) * 8)) & 0xFF; };
+    static bool less(const ipkey_u128 &a, const ipkey_u128 &b) { return (a.ms < b.ms) || ((a.ms == b.ms) && (a.ls < b.ls)); };
+    static u32i diff_bytes(const ipkey_u128 &a, const ipkey_u128 &b) { return (a.ms != b.ms) ? 8 + radix_key<u64i>::diff_bytes(a.ms, b.ms) : radix_key<u64i>::diff_bytes(a.ls, b.ls); };
+};
+
+template <class K>
+static void insertion_sort(K *keys, size_t n) {
+    for (size_t idx = 1; idx < n; idx++) {
+        K key = keys[idx];
+        size_t pos = idx;
+        for (; (pos > 0) && radix_key<K>::less(key, keys[pos - 1]); pos--) keys[pos] = keys[pos - 1];
+        keys[pos] = key;
+    }
+}
+
+template <class K>
+static K* lsd_sort(K *src, K *dst, size_t n, u32i bytes) { // sorts by bytes [0, bytes), returns buffer which holds result
+    if (n < sortmnp::SMALL) {
+        insertion_sort(src, n);
+        return src;
+    }
+    size_t hist[radix_key<K>::BYTES][256];
+    memset(hist, 0, sizeof(hist));
+    for (size_t idx = 0; idx < n; idx++) { // all histograms in one pass
+        for (u32i byte = 0; byte < bytes; byte++) hist[byte][radix_key<K>::byte(src[idx], byte)]++;
+    }
+    for (u32i byte = 0; byte < bytes; byte++) {
+        size_t *cnt = hist[byte];
+        if (cnt[radix_key<K>::byte(src[0], byte)] == n) continue; // all keys share this byte
+        size_t sum {0};
+        for (u32i dig = 0; dig < 256; dig++) {
+            size_t tmp = cnt[dig];
+            cnt[dig] = sum;
+            sum += tmp;
+        }
+        for (size_t idx = 0; idx < n; idx++) dst[cnt[radix_key<K>::byte(src[idx], byte)]++] = src[idx];
+        swap(src, dst);
+    }
+    return src;
+}
+
+template <class Func>
+static void run_threads(u32i threads, Func func) { // func(tid) for every tid, inline if thread can not be started
+    vector<thread> pool;
+    u32i tid {1};
+    try {
+        for (; tid < threads; tid++) pool.emplace_back(func, tid);
+    }
+    catch (...) {
+        for (; tid < threads; tid++) func(tid);
+    }
+    func(0);
+    for (auto && thr : pool) thr.join();
+}
+
+template <class K>
+static void par_sort(K *keys, K *tmp, size_t n, u32i threads) { // MSD partition by top varying byte, then LSD inside each of 256 buckets
+    size_t chunk = (n + threads - 1) / threads;
+    vector<K> mins(threads, keys[0]), maxs(threads, keys[0]);
+    run_threads(threads, [&](u32i tid) {
+        for (size_t idx = tid * chunk; idx < min(n, (tid + 1) * chunk); idx++) {
+            if (radix_key<K>::less(keys[idx], mins[tid])) mins[tid] = keys[idx];
+            if (radix_key<K>::less(maxs[tid], keys[idx])) maxs[tid] = keys[idx];
+        }
+    });
+    K low = mins[0], high = maxs[0];
+    for (u32i tid = 1; tid < threads; tid++) {
+        if (radix_key<K>::less(mins[tid], low)) low = mins[tid];
+        if (radix_key<K>::less(high, maxs[tid])) high = maxs[tid];
+    }
+    u32i bytes = radix_key<K>::diff_bytes(low, high); // keys between low and high share all higher bytes
+    if (bytes == 0) return;
+    u32i top = bytes - 1;
+    vector<array<size_t,256>> offs(threads);
+    run_threads(threads, [&](u32i tid) {
+        offs[tid].fill(0);
+        for (size_t idx = tid * chunk; idx < min(n, (tid + 1) * chunk); idx++) offs[tid][radix_key<K>::byte(keys[idx], top)]++;
+    });
+    array<size_t,257> bounds;
+    size_t sum {0};
+    for (u32i dig = 0; dig < 256; dig++) {
+        bounds[dig] = sum;
+        for (u32i tid = 0; tid < threads; tid++) {
+            size_t tmpCnt = offs[tid][dig];
+            offs[tid][dig] = sum;
+            sum += tmpCnt;
+        }
+    }
+    bounds[256] = n;
+    run_threads(threads, [&](u32i tid) {
+        for (size_t idx = tid * chunk; idx < min(n, (tid + 1) * chunk); idx++) tmp[offs[tid][radix_key<K>::byte(keys[idx], top)]++] = keys[idx];
+    });
+    atomic<u32i> next {0};
+    run_threads(threads, [&](u32i) {
+        for (u32i dig = next++; dig < 256; dig = next++) {
+            size_t beg = bounds[dig], cnt = bounds[dig + 1] - beg;
+            if (cnt == 0) continue;
+            K *res = lsd_sort(tmp + beg, keys + beg, cnt, top);
+            if (res != keys + beg) memcpy(keys + beg, res, cnt * sizeof(K));
+        }
+    });
+}
+
+template <class K>
+static void sort_keys(K *keys, K *tmp, size_t n, u32i threads) {
+    if ((threads > 1) && (n >= sortmnp::PAR_MIN)) {
+        par_sort(keys, tmp, n, threads);
+        return;
+    }
+    K *res = lsd_sort(keys, tmp, n, radix_key<K>::BYTES);
+    if (res != keys) memcpy(keys, res, n * sizeof(K));
+}
+
+template <class K>
+static bool radix_sort_keys(K *keys, size_t n, u32i threads, const char *ex_low_mem, const char *ex_except) {
+    if (n < 2) return true;
+    vector<K> tmp;
+    try {
+        tmp.resize(n);
+    }
+    catch (bad_alloc) {
+        cerr << ex_low_mem << endl;
+        return false;
+    }
+    catch (...) {
+        cerr << ex_except << endl;
+        return false;
+    }
+    sort_keys(keys, tmp.data(), n, threads);
+    return true;
+}
+
+template <class K>
+static size_t unique_keys(K *keys, size_t n, u32i *counts) {
+    if (n == 0) return 0;
+    size_t last {0};
+    u32i cnt {1};
+    for (size_t idx = 1; idx < n; idx++) {
+        if (keys[idx] == keys[last]) {
+            cnt++;
+            continue;
+        }
+        if (counts) counts[last] = cnt;
+        keys[++last] = keys[idx];
+        cnt = 1;
+    }
+    if (counts) counts[last] = cnt;
+    return last + 1;
+}
+
+bool sortmnp::radix_sort(u32i *keys, size_t n, u32i threads) { return radix_sort_keys(keys, n, threads, EX_LOW_MEM, EX_EXCEPT); }
+bool sortmnp::radix_sort(u64i *keys, size_t n, u32i threads) { return radix_sort_keys(keys, n, threads, EX_LOW_MEM, EX_EXCEPT); }
+bool sortmnp::radix_sort(ipkey_u128 *keys, size_t n, u32i threads) { return radix_sort_keys(keys, n, threads, EX_LOW_MEM, EX_EXCEPT); }
+size_t sortmnp::unique(u32i *keys, size_t n, u32i *counts) { return unique_keys(keys, n, counts); }
+size_t sortmnp::unique(u64i *keys, size_t n, u32i *counts) { return unique_keys(keys, n, counts); }
+size_t sortmnp::unique(ipkey_u128 *keys, size_t n, u32i *counts) { return unique_keys(keys, n, counts); }
+
+template <class A, class K>
+bool sortmnp::sort_addrs(A *arr, size_t n, u32i threads, size_t *uniq, vector<u32i> *counts) {
+    using traits = ipkey_traits<A>;
+    if (counts) counts->clear();
+    if (n == 0) {
+        if (uniq) *uniq = 0;
+        return true;
+    }
+    vector<K> keys, tmp;
+    try {
+        keys.resize(n);
+        tmp.resize(n);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        return false;
+    }
+    for (size_t idx = 0; idx < n; idx++) keys[idx] = traits::to_raw(arr[idx]); // sorting 4, 8 or 16-byte keys instead of padded objects
+    sort_keys(keys.data(), tmp.data(), n, threads);
+    if (uniq == nullptr) {
+        for (size_t idx = 0; idx < n; idx++) arr[idx] = traits::from_raw(keys[idx]);
+        return true;
+    }
+    u32i *cnts {nullptr}; // counters are written in place, at most n of them
+    if (counts) {
+        tmp = vector<K>(); // buffer of sort goes away before counters take as much
+        try {
+            counts->resize(n);
+        }
+        catch (...) {
+            cerr << EX_LOW_MEM << endl;
+            counts->clear();
+            return false;
+        }
+        cnts = counts->data();
+    }
+    size_t last {0};
+    u32i cnt {1};
+    arr[0] = traits::from_raw(keys[0]);
+    for (size_t idx = 1; idx < n; idx++) { // unique, counting and conversion in one pass
+        if (keys[idx] == keys[idx - 1]) {
+            cnt++;
+            continue;
+        }
+        if (cnts) cnts[last] = cnt;
+        arr[++last] = traits::from_raw(keys[idx]);
+        cnt = 1;
+    }
+    if (cnts) cnts[last] = cnt;
+    *uniq = last + 1;
+    if (counts) {
+        counts->resize(*uniq);
+        counts->shrink_to_fit(); // non-binding, keeps vector on failure
+    }
+    return true;
+}
+
+bool sortmnp::sort(IPv4_Addr *arr, size_t n, u32i threads) { return sort_addrs<IPv4_Addr,u32i>(arr, n, threads, nullptr, nullptr); }
+bool sortmnp::sort(IPv6_Addr *arr, size_t n, u32i threads) { return sort_addrs<IPv6_Addr,ipkey_u128>(arr, n, threads, nullptr, nullptr); }
+bool sortmnp::sort(MAC_Addr *arr, size_t n, u32i threads) { return sort_addrs<MAC_Addr,u64i>(arr, n, threads, nullptr, nullptr); }
+bool sortmnp::sort_unique(IPv4_Addr *arr, size_t *n, u32i threads, vector<u32i> *counts) { return sort_addrs<IPv4_Addr,u32i>(arr, *n, threads, n, counts); }
+bool sortmnp::sort_unique(IPv6_Addr *arr, size_t *n, u32i threads, vector<u32i> *counts) { return sort_addrs<IPv6_Addr,ipkey_u128>(arr, *n, threads, n, counts); }
+bool sortmnp::sort_unique(MAC_Addr *arr, size_t *n, u32i threads, vector<u32i> *counts) { return sort_addrs<MAC_Addr,u64i>(arr, *n, threads, n, counts); }
@@ -0,0 +1,29 @@
+#ifndef GIA_IPSORT_H
+#define GIA_IPSORT_H
+
+#include "gia_iphash.h"
+
+using namespace std;
+
+class sortmnp { // radix sort over raw keys : no comparisons, constant bytes are skipped, parallel mode partitions by top varying byte
+    static inline const char EX_LOW_MEM[] = {"func sortmnp::sort() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func sortmnp::sort() says: exception."};
+    template <class A, class K> static bool sort_addrs(A *arr, size_t n, u32i threads, size_t *uniq, vector<u32i> *counts);
+public:
+    static constexpr size_t SMALL {64}; // below this insertion sort is used
+    static constexpr size_t PAR_MIN {1 << 16}; // below this threads are not started
+    static bool radix_sort(u32i *keys, size_t n, u32i threads = 1);
+    static bool radix_sort(u64i *keys, size_t n, u32i threads = 1); // MAC keys take 6 passes at most
+    static bool radix_sort(ipkey_u128 *keys, size_t n, u32i threads = 1);
+    static size_t unique(u32i *keys, size_t n, u32i *counts = nullptr); // sorted input, returns count of unique keys, counts[i] - occurrences of keys[i]
+    static size_t unique(u64i *keys, size_t n, u32i *counts = nullptr);
+    static size_t unique(ipkey_u128 *keys, size_t n, u32i *counts = nullptr);
+    static bool sort(IPv4_Addr *arr, size_t n, u32i threads = 1); // false if memory was not allocated, array is not changed then
+    static bool sort(IPv6_Addr *arr, size_t n, u32i threads = 1);
+    static bool sort(MAC_Addr *arr, size_t n, u32i threads = 1);
+    static bool sort_unique(IPv4_Addr *arr, size_t *n, u32i threads = 1, vector<u32i> *counts = nullptr); // n becomes count of unique addresses
+    static bool sort_unique(IPv6_Addr *arr, size_t *n, u32i threads = 1, vector<u32i> *counts = nullptr);
+    static bool sort_unique(MAC_Addr *arr, size_t *n, u32i threads = 1, vector<u32i> *counts = nullptr);
+};
+
+#endif // GIA_IPSORT_H
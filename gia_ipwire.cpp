@@ -0,0 +1,144 @@
+#include "gia_ipwire.h"
+#include "gia_ipcol.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_WIRE_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// strided fields are loaded one by one : gathers lose to plain loads as soon as packets are not in cache,
+// packed fields (stride equal to field length) are swapped by shuffles, kernels return count of rows done
+#ifdef GIA_WIRE_X86
+
+__attribute__((target("avx2"))) static size_t v4_packed_avx2(const u8i *base, size_t n, u32i *out) {
+    const __m256i shuf = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t full = n & ~size_t(7);
+    for (size_t row = 0; row < full; row += 8) {
+        _mm256_storeu_si256((__m256i*)(out + row), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(base + row * 4)), shuf));
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t v6_packed_avx2(const u8i *base, size_t n, u64i *hi, u64i *lo) {
+    const __m256i shuf = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t full = n & ~size_t(3);
+    for (size_t row = 0; row < full; row += 4) {
+        __m256i rows01 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(base + row * 16)), shuf); // hi0 lo0 hi1 lo1
+        __m256i rows23 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(base + row * 16 + 32)), shuf);
+        __m256i vhi = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(rows01, rows23), 0xD8); // hi0 hi2 hi1 hi3 -> hi0 hi1 hi2 hi3
+        __m256i vlo = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(rows01, rows23), 0xD8);
+        _mm256_storeu_si256((__m256i*)(hi + row), vhi);
+        _mm256_storeu_si256((__m256i*)(lo + row), vlo);
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t mac_packed_avx2(const u8i *base, size_t n, u64i *out) {
+    const __m128i shuf = _mm_setr_epi8(5, 4, 3, 2, 1, 0, -1, -1, 11, 10, 9, 8, 7, 6, -1, -1);
+    size_t done {0};
+    for (; done + 3 <= n; done += 2) { // 16 bytes are loaded for 2 rows of 6 bytes, so third row must exist
+        _mm_storeu_si128((__m128i*)(out + done), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(base + done * 6)), shuf));
+    }
+    return done;
+}
+
+#endif // GIA_WIRE_X86
+
+void wiremnp::v4_from_wire(const u8i *base, size_t stride, size_t n, u32i *out) {
+    size_t done {0};
+#ifdef GIA_WIRE_X86
+    if ((stride == 4) && (colmnp::level() >= colmnp::AVX2)) done = v4_packed_avx2(base, n, out);
+#endif
+    for (size_t row = done; row < n; row++) out[row] = IPv4_Addr::from_wire(base + row * stride)();
+}
+
+void wiremnp::v6_from_wire(const u8i *base, size_t stride, size_t n, u64i *hi, u64i *lo) {
+    size_t done {0};
+#ifdef GIA_WIRE_X86
+    if ((stride == 16) && (colmnp::level() >= colmnp::AVX2)) done = v6_packed_avx2(base, n, hi, lo);
+#endif
+    for (size_t row = done; row < n; row++) {
+        u64i val[2];
+        memcpy(val, base + row * stride, 16);
+        hi[row] = __builtin_bswap64(val[0]);
+        lo[row] = __builtin_bswap64(val[1]);
+    }
+}
+
+void wiremnp::mac_from_wire(const u8i *base, size_t stride, size_t n, u64i *out) {
+    size_t done {0};
+#ifdef GIA_WIRE_X86
+    if ((stride == 6) && (colmnp::level() >= colmnp::AVX2)) done = mac_packed_avx2(base, n, out);
+#endif
+    for (size_t row = done; row < n; row++) out[row] = MAC_Addr::from_wire(base + row * stride)();
+}
+
+void wiremnp::from_wire(const u8i *base, size_t stride, size_t n, IPv4_Addr *out) {
+    u32i buf[BATCH];
+    for (size_t row = 0; row < n; row += BATCH) {
+        size_t cnt = min(BATCH, n - row);
+        v4_from_wire(base + row * stride, stride, cnt, buf);
+        for (size_t idx = 0; idx < cnt; idx++) out[row + idx] = IPv4_Addr(buf[idx]);
+    }
+}
+
+void wiremnp::from_wire(const u8i *base, size_t stride, size_t n, IPv6_Addr *out) {
+    u64i hi[BATCH], lo[BATCH];
+    for (size_t row = 0; row < n; row += BATCH) {
+        size_t cnt = min(BATCH, n - row);
+        v6_from_wire(base + row * stride, stride, cnt, hi, lo);
+        for (size_t idx = 0; idx < cnt; idx++) out[row + idx] = IPv6_Addr(hi[idx], lo[idx]);
+    }
+}
+
+void wiremnp::from_wire(const u8i *base, size_t stride, size_t n, MAC_Addr *out) {
+    u64i buf[BATCH];
+    for (size_t row = 0; row < n; row += BATCH) {
+        size_t cnt = min(BATCH, n - row);
+        mac_from_wire(base + row * stride, stride, cnt, buf);
+        for (size_t idx = 0; idx < cnt; idx++) out[row + idx] = MAC_Addr(buf[idx]);
+    }
+}
+
+void wiremnp::from_wire(const u8i *const *pkts, size_t offset, size_t n, IPv4_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = IPv4_Addr::from_wire(pkts[row] + offset);
+}
+
+void wiremnp::from_wire(const u8i *const *pkts, size_t offset, size_t n, IPv6_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = IPv6_Addr::from_wire(pkts[row] + offset);
+}
+
+void wiremnp::from_wire(const u8i *const *pkts, size_t offset, size_t n, MAC_Addr *out) {
+    for (size_t row = 0; row < n; row++) out[row] = MAC_Addr::from_wire(pkts[row] + offset);
+}
+
+void wiremnp::v4_to_wire(const u32i *vals, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 4;
+    for (size_t row = 0; row < n; row++) IPv4_Addr(vals[row]).to_wire(out + row * stride);
+}
+
+void wiremnp::v6_to_wire(const u64i *hi, const u64i *lo, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 16;
+    for (size_t row = 0; row < n; row++) IPv6_Addr(hi[row], lo[row]).to_wire(out + row * stride);
+}
+
+void wiremnp::mac_to_wire(const u64i *vals, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 6;
+    for (size_t row = 0; row < n; row++) MAC_Addr(vals[row]).to_wire(out + row * stride);
+}
+
+void wiremnp::to_wire(const IPv4_Addr *arr, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 4;
+    for (size_t row = 0; row < n; row++) arr[row].to_wire(out + row * stride);
+}
+
+void wiremnp::to_wire(const IPv6_Addr *arr, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 16;
+    for (size_t row = 0; row < n; row++) arr[row].to_wire(out + row * stride);
+}
+
+void wiremnp::to_wire(const MAC_Addr *arr, size_t n, u8i *out, size_t stride) {
+    if (stride == 0) stride = 6;
+    for (size_t row = 0; row < n; row++) arr[row].to_wire(out + row * stride);
+}
@@ -0,0 +1,32 @@
+#ifndef GIA_IPWIRE_H
+#define GIA_IPWIRE_H
+
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+class wiremnp { // bulk conversion of address fields between packet buffers (network order) and host values
+public:
+    enum enOffsets : u32i {ETH_DST = 0, ETH_SRC = 6, IPV4_SRC = 12, IPV4_DST = 16, IPV6_SRC = 8, IPV6_DST = 24}; // from start of own header
+    static constexpr size_t BATCH {256}; // rows converted at once by object versions
+    // row i is at base + i * stride, field offset is already added to base
+    static void v4_from_wire(const u8i *base, size_t stride, size_t n, u32i *out);
+    static void v6_from_wire(const u8i *base, size_t stride, size_t n, u64i *hi, u64i *lo); // hi - ms, lo - ls
+    static void mac_from_wire(const u8i *base, size_t stride, size_t n, u64i *out);
+    static void from_wire(const u8i *base, size_t stride, size_t n, IPv4_Addr *out);
+    static void from_wire(const u8i *base, size_t stride, size_t n, IPv6_Addr *out);
+    static void from_wire(const u8i *base, size_t stride, size_t n, MAC_Addr *out);
+    // packets in separate buffers, field at pkts[i] + offset
+    static void from_wire(const u8i *const *pkts, size_t offset, size_t n, IPv4_Addr *out);
+    static void from_wire(const u8i *const *pkts, size_t offset, size_t n, IPv6_Addr *out);
+    static void from_wire(const u8i *const *pkts, size_t offset, size_t n, MAC_Addr *out);
+    // row i is written to out + i * stride, stride = 0 means packed rows
+    static void v4_to_wire(const u32i *vals, size_t n, u8i *out, size_t stride = 0);
+    static void v6_to_wire(const u64i *hi, const u64i *lo, size_t n, u8i *out, size_t stride = 0);
+    static void mac_to_wire(const u64i *vals, size_t n, u8i *out, size_t stride = 0);
+    static void to_wire(const IPv4_Addr *arr, size_t n, u8i *out, size_t stride = 0);
+    static void to_wire(const IPv6_Addr *arr, size_t n, u8i *out, size_t stride = 0);
+    static void to_wire(const MAC_Addr *arr, size_t n, u8i *out, size_t stride = 0);
+};
+
+#endif // GIA_IPWIRE_H
@@ -0,0 +1,391 @@
+#include "gia_logscan.h"
+#include "gia_ipcol.h"
+#include "gia_ipsort.h"
+#include <cctype>
+#include <memory.h>
+#include <mutex>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_SCAN_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const array<u8i,256> SYMB_CLASS = [] { // 1 - address symbol, 2 - word symbol which breaks boundary
+    array<u8i,256> ret {};
+    for (u32i ch = 0; ch < 256; ch++) {
+        if (isxdigit(ch) || (ch == '.') || (ch == ':') || (ch == '-')) ret[ch] = 1;
+        else if (isalpha(ch) || (ch == '_')) ret[ch] = 2;
+    }
+    return ret;
+}();
+
+#ifdef GIA_SCAN_X86
+__attribute__((target("avx2"))) static u32i class_mask_avx2(const u8i *text) { // 32 bytes
+    __m256i ch = _mm256_loadu_si256((const __m256i*)text);
+    __m256i low = _mm256_or_si256(ch, _mm256_set1_epi8(0x20)); // letters to lower case
+    __m256i dgt = _mm256_sub_epi8(ch, _mm256_set1_epi8('-')); // '-' ... ':' except '/'
+    __m256i isDgt = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(dgt, _mm256_set1_epi8(13)), dgt), _mm256_xor_si256(_mm256_cmpeq_epi8(ch, _mm256_set1_epi8('/')), _mm256_set1_epi8(-1)));
+    __m256i hex = _mm256_sub_epi8(low, _mm256_set1_epi8('a'));
+    __m256i isHex = _mm256_cmpeq_epi8(_mm256_min_epu8(hex, _mm256_set1_epi8(5)), hex);
+    return _mm256_movemask_epi8(_mm256_or_si256(isDgt, isHex));
+}
+#endif
+
+void scanmnp::class_mask(const u8i *text, size_t len, u64i *mask) {
+#ifdef GIA_SCAN_X86
+    if ((len == 64) && (colmnp::level() >= colmnp::AVX2)) {
+        *mask = u64i(class_mask_avx2(text)) | (u64i(class_mask_avx2(text + 32)) << 32);
+        return;
+    }
+#endif
+    u64i ret {0};
+    for (size_t idx = 0; idx < len; idx++) ret |= u64i(SYMB_CLASS[text[idx]] & 1) << idx;
+    *mask = ret;
+}
+
+struct scan_local { // per-thread counters, added to scan_stats once per chunk
+    u64i tokens {0}, parsed {0};
+    string tok; // reused, so parsers do not allocate for most candidates
+};
+
+static bool try_v4(const u8i *text, size_t len, scan_local &loc, IPv4_Addr *ret) {
+    if ((len < 7) || (len > 15)) return false;
+    u32i dots {0};
+    for (size_t idx = 0; idx < len; idx++) {
+        if (text[idx] == '.') dots++;
+        else if ((text[idx] < '0') || (text[idx] > '9')) return false;
+    }
+    if (dots != 3) return false;
+    loc.parsed++;
+    loc.tok.assign((const char*)text, len);
+    return v4mnp::valid_addr(loc.tok, ret);
+}
+
+static void check_token(const u8i *data, size_t size, size_t tb, size_t te, u32i file, scan_local &loc, vector<scan_hit> &out) {
+    if ((te < size) && (SYMB_CLASS[data[te]] == 2)) return; // part of word
+    while ((tb < te) && ((data[tb] == '.') || (data[tb] == '-'))) tb++;
+    while ((te > tb) && ((data[te - 1] == '.') || (data[te - 1] == '-'))) te--;
+    if ((te - tb >= 2) && (data[tb] == ':') && (data[tb + 1] != ':')) tb++; // "port:10.0.0.1"
+    if ((te - tb >= 2) && (data[te - 1] == ':') && (data[te - 2] != ':')) te--; // "10.0.0.1:"
+    if ((tb > 0) && (SYMB_CLASS[data[tb - 1]] == 2)) return; // part of word, e.g. "std::" or "id=fe10.0.0.1", but not "ip:10.0.0.1"
+    size_t len = te - tb;
+    if ((len < 3) || (len > scanmnp::MAX_TOKEN)) return;
+    loc.tokens++;
+    const u8i *text = data + tb;
+    u32i dots {0}, colons {0}, dashes {0}, digits {0};
+    bool dblColon {false};
+    for (size_t idx = 0; idx < len; idx++) {
+        switch (text[idx]) {
+        case '.': dots++; break;
+        case ':': colons++; if ((idx > 0) && (text[idx - 1] == ':')) dblColon = true; break;
+        case '-': dashes++; break;
+        default: digits++;
+        }
+    }
+    if (digits == 0) return;
+    scan_hit hit {tb, 0, 0, file, 0};
+    if ((len == 17) && (dots == 0) && ((colons == 5) != (dashes == 5))) { // aa:bb:cc:dd:ee:ff or aa-bb-cc-dd-ee-ff
+        MAC_Addr mac;
+        loc.parsed++;
+        loc.tok.assign((const char*)text, len);
+        if (macmnp::valid_addr(loc.tok, 1, (colons == 5) ? ':' : '-', &mac)) {
+            hit.ls = mac();
+            hit.family = scanmnp::MAC;
+            out.push_back(hit);
+            return;
+        }
+    }
+    if ((len == 14) && (dots == 2) && (colons == 0) && (dashes == 0)) { // aabb.ccdd.eeff
+        MAC_Addr mac;
+        loc.parsed++;
+        loc.tok.assign((const char*)text, len);
+        if (macmnp::valid_addr(loc.tok, 2, '.', &mac)) {
+            hit.ls = mac();
+            hit.family = scanmnp::MAC;
+            out.push_back(hit);
+            return;
+        }
+    }
+    if ((colons >= 2) && (colons <= 7) && (dashes == 0) && ((dots == 0) || (dots == 3)) && (dblColon || (colons == 7)) && (len <= 45)) { // same early checks as v6mnp::valid_addr()
+        IPv6_Addr ip;
+        loc.parsed++;
+        loc.tok.assign((const char*)text, len);
+        if (v6mnp::valid_addr(loc.tok, &ip)) {
+            hit.ms = ip().ms;
+            hit.ls = ip().ls;
+            hit.family = scanmnp::IPv6;
+            out.push_back(hit);
+            return;
+        }
+    }
+    if (dots < 3) return;
+    size_t beg {0};
+    for (size_t idx = 0; idx <= len; idx++) { // IPv4 between ':' or '-', e.g. "10.0.0.1:8080"
+        if ((idx < len) && (text[idx] != ':') && (text[idx] != '-')) continue;
+        IPv4_Addr ip;
+        if (try_v4(text + beg, idx - beg, loc, &ip)) {
+            hit.offset = tb + beg;
+            hit.ls = ip();
+            hit.family = scanmnp::IPv4;
+            out.push_back(hit);
+        }
+        beg = idx + 1;
+    }
+}
+
+static void scan_range(const u8i *data, size_t size, size_t beg, size_t end, u32i file, scan_local &loc, vector<scan_hit> &out) { // tokens are runs of class bits
+    constexpr size_t NONE {SIZE_MAX};
+    size_t tokBeg {NONE};
+    u64i carry {0}; // previous byte was address symbol
+    for (size_t pos = beg; pos < end; pos += 64) {
+        size_t len = min<size_t>(64, end - pos);
+        u64i mask;
+        scanmnp::class_mask(data + pos, (pos + 64 <= size) ? 64 : len, &mask);
+        if (len < 64) mask &= (u64i(1) << len) - 1;
+        if ((mask == 0) && (tokBeg == NONE)) continue;
+        u64i edges = mask ^ ((mask << 1) | carry);
+        carry = mask >> 63;
+        while (edges) {
+            size_t at = pos + __builtin_ctzll(edges);
+            if (tokBeg == NONE) tokBeg = at;
+            else {
+                check_token(data, size, tokBeg, at, file, loc, out);
+                tokBeg = NONE;
+            }
+            edges &= edges - 1;
+        }
+    }
+    if (tokBeg != NONE) check_token(data, size, tokBeg, end, file, loc, out);
+}
+
+static size_t chunk_start(const u8i *data, size_t size, size_t idx) { // same function for end of chunk idx - 1, so bounds always agree
+    size_t pos = idx * scanmnp::CHUNK;
+    if (pos == 0) return 0;
+    if (pos >= size) return size;
+    const u8i *nl = (const u8i*)memchr(data + pos - 1, '\n', size - pos + 1);
+    return nl ? nl - data + 1 : size;
+}
+
+bool Log_Scanner::add_file(const string &path) {
+    try {
+        files.emplace_back(new MMap_File);
+        if (!files.back()->open(path)) {
+            files.pop_back();
+            lerr = scanmnp::IOError;
+            return false;
+        }
+        files.back()->advise_seq();
+        srcs.push_back({files.back()->data(), files.back()->size()});
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    lerr = scanmnp::NoError;
+    return true;
+}
+
+bool Log_Scanner::add_buffer(const u8i *data, size_t size) {
+    try {
+        srcs.push_back({data, size});
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    lerr = scanmnp::NoError;
+    return true;
+}
+
+struct alignas(64) steal_slot { // chunks [next, end) of one thread, others take from the same front when idle
+    atomic<size_t> next {0};
+    size_t end {0};
+};
+
+void Log_Scanner::run(u32i threads, const function<void(u32i, u32i, const u8i*, size_t, size_t, size_t)> &work) {
+    vector<pair<u32i,size_t>> chunks; // file, chunk index
+    for (u32i file = 0; file < srcs.size(); file++) {
+        if (srcs[file].data == nullptr) continue;
+        size_t cnt = (srcs[file].size + scanmnp::CHUNK - 1) / scanmnp::CHUNK;
+        for (size_t idx = 0; idx < cnt; idx++) chunks.push_back({file, idx});
+    }
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    threads = max<u32i>(1, min<size_t>(threads, chunks.size()));
+    vector<steal_slot> slots(threads);
+    size_t per = chunks.size() / threads, rest = chunks.size() % threads, from {0};
+    for (u32i tid = 0; tid < threads; tid++) {
+        slots[tid].next = from;
+        from += per + (tid < rest);
+        slots[tid].end = from;
+    }
+    auto body = [&](u32i tid) {
+        for (u32i step = 0; step < threads; step++) { // own range first, then ranges of others
+            steal_slot &victim = slots[(tid + step) % threads];
+            for (size_t idx = victim.next++; idx < victim.end; idx = victim.next++) {
+                const src &sr = srcs[chunks[idx].first];
+                size_t beg = chunk_start(sr.data, sr.size, chunks[idx].second), end = chunk_start(sr.data, sr.size, chunks[idx].second + 1);
+                if (beg < end) work(tid, chunks[idx].first, sr.data, sr.size, beg, end);
+                st.bytes += end - beg;
+            }
+        }
+    };
+    vector<thread> pool;
+    u32i tid {1};
+    try {
+        for (; tid < threads; tid++) pool.emplace_back(body, tid);
+    }
+    catch (...) {} // fewer threads, the rest is stolen
+    body(0);
+    for (auto && thr : pool) thr.join();
+}
+
+static void add_stats(scan_stats &st, scan_local &loc, const vector<scan_hit> &hits) {
+    st.tokens += loc.tokens;
+    st.parsed += loc.parsed;
+    loc.tokens = loc.parsed = 0;
+    u64i cnt[3] {0, 0, 0};
+    for (auto && hit : hits) cnt[(hit.family == scanmnp::IPv4) ? 0 : (hit.family == scanmnp::IPv6) ? 1 : 2]++;
+    for (u32i fam = 0; fam < 3; fam++) st.hits[fam] += cnt[fam];
+}
+
+bool Log_Scanner::scan(const Scan_Sink &sink, u32i threads) {
+    mutex mtx;
+    atomic<bool> failed {false};
+    try {
+        run(threads, [&](u32i, u32i file, const u8i *data, size_t size, size_t beg, size_t end) {
+            thread_local scan_local loc;
+            thread_local vector<scan_hit> hits;
+            if (failed) return; // rest of chunks is skipped after error
+            hits.clear();
+            try {
+                scan_range(data, size, beg, end, file, loc, hits);
+            }
+            catch (...) {
+                failed = true;
+            }
+            add_stats(st, loc, hits);
+            if (hits.empty()) return;
+            lock_guard<mutex> lock(mtx);
+            if (failed) return; // sink is not called again once it has thrown
+            try {
+                sink(hits.data(), hits.size());
+            }
+            catch (...) {
+                failed = true;
+            }
+        });
+    }
+    catch (...) {
+        failed = true;
+    }
+    if (failed) {
+        cerr << EX_EXCEPT << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    lerr = scanmnp::NoError;
+    return true;
+}
+
+template <class K>
+static void compact(vector<K> &keys, size_t *limit) { // sort and unique in place, limit grows with unique keys
+    sortmnp::radix_sort(keys.data(), keys.size());
+    keys.resize(sortmnp::unique(keys.data(), keys.size()));
+    *limit = max(scanmnp::COMPACT, keys.size() * 2);
+}
+
+template <class A>
+static void merge_sets(vector<vector<typename ipkey_traits<A>::raw_t>> &parts, u32i threads, vector<A> *out) {
+    using traits = ipkey_traits<A>;
+    size_t total {0};
+    for (auto && part : parts) total += part.size();
+    vector<typename traits::raw_t> keys;
+    keys.reserve(total);
+    for (auto && part : parts) {
+        keys.insert(keys.end(), part.begin(), part.end());
+        vector<typename traits::raw_t>().swap(part);
+    }
+    sortmnp::radix_sort(keys.data(), keys.size(), threads);
+    keys.resize(sortmnp::unique(keys.data(), keys.size()));
+    out->resize(keys.size());
+    for (size_t idx = 0; idx < keys.size(); idx++) (*out)[idx] = traits::from_raw(keys[idx]);
+}
+
+bool Log_Scanner::scan_unique(vector<IPv4_Addr> *v4, vector<IPv6_Addr> *v6, vector<MAC_Addr> *macs, u32i threads) {
+    struct sets {
+        vector<u32i> v4;
+        vector<ipkey_u128> v6;
+        vector<u64i> mac;
+        size_t lim4 {scanmnp::COMPACT}, lim6 {scanmnp::COMPACT}, limMac {scanmnp::COMPACT};
+    };
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    atomic<bool> failed {false};
+    try {
+        vector<sets> per(threads);
+        run(threads, [&](u32i tid, u32i file, const u8i *data, size_t size, size_t beg, size_t end) {
+            thread_local scan_local loc;
+            thread_local vector<scan_hit> hits;
+            hits.clear();
+            sets &own = per[tid];
+            try {
+                scan_range(data, size, beg, end, file, loc, hits);
+                for (auto && hit : hits) {
+                    if ((hit.family == scanmnp::IPv4) && v4) own.v4.push_back(u32i(hit.ls));
+                    else if ((hit.family == scanmnp::IPv6) && v6) own.v6.push_back({hit.ls, hit.ms});
+                    else if ((hit.family == scanmnp::MAC) && macs) own.mac.push_back(hit.ls);
+                }
+                if (own.v4.size() >= own.lim4) compact(own.v4, &own.lim4);
+                if (own.v6.size() >= own.lim6) compact(own.v6, &own.lim6);
+                if (own.mac.size() >= own.limMac) compact(own.mac, &own.limMac);
+            }
+            catch (...) {
+                failed = true;
+            }
+            add_stats(st, loc, hits);
+        });
+        if (!failed) {
+            vector<vector<u32i>> p4;
+            vector<vector<ipkey_u128>> p6;
+            vector<vector<u64i>> pm;
+            for (auto && own : per) {
+                p4.push_back(move(own.v4));
+                p6.push_back(move(own.v6));
+                pm.push_back(move(own.mac));
+            }
+            if (v4) merge_sets(p4, threads, v4);
+            if (v6) merge_sets(p6, threads, v6);
+            if (macs) merge_sets(pm, threads, macs);
+        }
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        failed = true;
+    }
+    if (failed) {
+        cerr << EX_EXCEPT << endl;
+        lerr = scanmnp::STL_Exception;
+        return false;
+    }
+    lerr = scanmnp::NoError;
+    return true;
+}
+
+size_t Log_Scanner::extract(const u8i *text, size_t len, vector<scan_hit> *out) {
+    scan_local loc;
+    size_t was = out->size();
+    scan_range(text, len, 0, len, 0, loc, *out);
+    return out->size() - was;
+}
@@ -0,0 +1,57 @@
+#ifndef GIA_LOGSCAN_H
+#define GIA_LOGSCAN_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "gia_mmap.h"
+
+using namespace std;
+
+class scanmnp {
+public:
+    static constexpr size_t CHUNK {1 << 22}; // nominal chunk, real bounds are moved to the next newline
+    static constexpr size_t MAX_TOKEN {64}; // longer runs of address symbols are not candidates
+    static constexpr size_t COMPACT {1 << 20}; // per-thread keys are sorted and deduplicated when this many gathered
+    enum enFamily : u32i {IPv4 = 4, IPv6 = 6, MAC = 48}; // same values as pakmnp::enFamily
+    enum enLastError : u8i {NoError = 0, IOError = 1, STL_Exception = 2};
+    static void class_mask(const u8i *text, size_t len, u64i *mask); // bit per byte of [0-9A-Fa-f.:-], len <= 64
+};
+
+struct scan_hit {
+    u64i offset; // of first symbol in file
+    u64i ms, ls; // value as in pakmnp keys : IPv4 and MAC are in ls
+    u32i file; // index in order of add_file()
+    u32i family; // scanmnp::enFamily
+};
+
+struct scan_stats {
+    atomic<u64i> bytes {0};
+    atomic<u64i> tokens {0}; // runs of address symbols between word boundaries
+    atomic<u64i> parsed {0}; // candidates passed to library parsers
+    atomic<u64i> hits[3] {}; // IPv4, IPv6, MAC
+};
+
+using Scan_Sink = function<void(const scan_hit *hits, size_t n)>; // hits of one chunk in file order, calls are serialized
+
+class Log_Scanner { // address extraction from mapped files, chunks are shared between threads by work stealing
+    struct src { const u8i *data; size_t size; };
+    vector<unique_ptr<MMap_File>> files;
+    vector<src> srcs;
+    scan_stats st;
+    scanmnp::enLastError lerr {scanmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func Log_Scanner::scan() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func Log_Scanner::scan() says: exception."};
+    void run(u32i threads, const function<void(u32i tid, u32i file, const u8i *data, size_t size, size_t beg, size_t end)> &work);
+public:
+    bool add_file(const string &path);
+    bool add_buffer(const u8i *data, size_t size); // buffer must outlive scanner
+    size_t file_count() const { return srcs.size(); };
+    bool scan(const Scan_Sink &sink, u32i threads = 0); // threads = 0 means hardware concurrency
+    bool scan_unique(vector<IPv4_Addr> *v4, vector<IPv6_Addr> *v6, vector<MAC_Addr> *macs, u32i threads = 0); // sorted sets, nullptr skips family
+    const scan_stats& stats() const { return st; };
+    scanmnp::enLastError last_err() const { return lerr; };
+    static size_t extract(const u8i *text, size_t len, vector<scan_hit> *out); // single buffer in calling thread, offsets from text
+};
+
+#endif // GIA_LOGSCAN_H
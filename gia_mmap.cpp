@@ -0,0 +1,66 @@
+#include "gia_mmap.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdio>
+
+using namespace std;
+
+MMap_File& MMap_File::operator=(MMap_File &&other) {
+    if (this != &other) {
+        close();
+        ptr = other.ptr;
+        len = other.len;
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+    return *this;
+}
+
+bool MMap_File::open(const string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping stays valid
+    if (map == MAP_FAILED) {
+        cerr << EX_OPEN << endl;
+        return false;
+    }
+    ptr = (const u8i*)map;
+    len = st.st_size;
+    return true;
+}
+
+void MMap_File::close() {
+    if (ptr != nullptr) munmap((void*)ptr, len);
+    ptr = nullptr;
+    len = 0;
+}
+
+void MMap_File::advise_seq() const {
+    if (ptr != nullptr) madvise((void*)ptr, len, MADV_SEQUENTIAL);
+}
+
+void MMap_File::advise_rand() const {
+    if (ptr != nullptr) madvise((void*)ptr, len, MADV_RANDOM);
+}
+
+bool MMap_File::save(const string &path, const u8i *data, size_t size) {
+    string tmp {path + ".tmp"};
+    FILE *file = fopen(tmp.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool ok = (size == 0) || (fwrite(data, 1, size, file) == size);
+    ok = (fflush(file) == 0) && ok;
+    ok = (fsync(fileno(file)) == 0) && ok;
+    ok = (fclose(file) == 0) && ok;
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
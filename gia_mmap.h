@@ -0,0 +1,31 @@
+#ifndef GIA_MMAP_H
+#define GIA_MMAP_H
+
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+class MMap_File { // read-only mapping of whole file (POSIX)
+    const u8i *ptr {nullptr};
+    size_t len {0};
+    static inline const char EX_OPEN[] = {"func MMap_File::open() says: can not map file."};
+public:
+    MMap_File() {};
+    MMap_File(const string &path) { open(path); };
+    MMap_File(const MMap_File &) = delete;
+    MMap_File& operator=(const MMap_File &) = delete;
+    MMap_File(MMap_File &&other) { ptr = other.ptr; len = other.len; other.ptr = nullptr; other.len = 0; };
+    MMap_File& operator=(MMap_File &&other);
+    ~MMap_File() { close(); };
+    bool open(const string &path); // empty file is opened, but data() returns nullptr
+    void close();
+    bool is_open() const { return ptr != nullptr; };
+    const u8i* data() const { return ptr; };
+    size_t size() const { return len; };
+    void advise_seq() const; // hint for sequential reading
+    void advise_rand() const; // hint for random lookups
+    static bool save(const string &path, const u8i *data, size_t size); // writes to temporary file, then renames it atomically
+    static bool save(const string &path, const vector<u8i> &data) { return save(path, data.data(), data.size()); };
+};
+
+#endif // GIA_MMAP_H
@@ -0,0 +1,161 @@
+#include "gia_nat64.h"
+#include "gia_ipcol.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_NAT64_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+void NAT64_Xlat::setup(const IPv6_Addr &prefix, u32i pfx_len) {
+    IPv6_Addr pfx = prefix;
+    lerr = nat64mnp::NoError;
+    if (!nat64mnp::valid_len(pfx_len)) lerr = nat64mnp::BadPrefixLen;
+    else if ((pfx_len == 96) && (pfx().ls & 0xFF00000000000000)) lerr = nat64mnp::BadPrefix;
+    if (lerr != nat64mnp::NoError) {
+        pfx = IPv6_Addr(nat64mnp::WKP_MS, nat64mnp::WKP_LS);
+        pfx_len = 96;
+    }
+    IPv6_Mask mask = v6mnp::gen_mask(pfx_len);
+    pfxLen = pfx_len;
+    pfxMs = pfx().ms & mask().ms;
+    pfxLs = pfx().ls & mask().ls;
+    cmpMs = mask().ms;
+    cmpLs = mask().ls | 0xFF00000000000000; // u-octet
+    switch (pfx_len) {
+        case 32: msShift = 0; lsMask = 0; lsShift = 0; break;
+        case 40: msShift = 8; lsMask = 0xFF; lsShift = 48; break;
+        case 48: msShift = 16; lsMask = 0xFFFF; lsShift = 40; break;
+        case 56: msShift = 24; lsMask = 0xFFFFFF; lsShift = 32; break;
+        case 64: msShift = 32; lsMask = 0xFFFFFFFF; lsShift = 24; break;
+        default: msShift = 63; lsMask = 0xFFFFFFFF; lsShift = 0; // u64i shifted by 63 keeps no bits of IPv4
+    }
+    for (u32i oct = 0; oct < 4; oct++) {
+        u32i pos = pfx_len / 8 + oct;
+        bytePos[oct] = u8i(((pfx_len < 96) && (pos >= 8)) ? pos + 1 : pos); // jump over u-octet
+    }
+    IPv6_Addr(pfxMs, pfxLs).to_wire(pfxWire);
+    IPv6_Addr(cmpMs, cmpLs).to_wire(cmpWire);
+    memset(shufToV6, 0x80, sizeof(shufToV6)); // high bit of pshufb index gives zero byte
+    memset(shufToV4, 0x80, sizeof(shufToV4));
+    for (u32i lane = 0; lane < 4; lane++) {
+        for (u32i oct = 0; oct < 4; oct++) {
+            shufToV6[lane * 16 + bytePos[oct]] = u8i(lane * 4 + oct);
+            shufToV4[lane * 16 + lane * 4 + oct] = bytePos[oct];
+        }
+    }
+}
+
+bool NAT64_Xlat::to_v4(const IPv6_Addr &ip, IPv4_Addr *ret) const {
+    if (!matches(ip)) {
+        *ret = IPv4_Addr(u32i(0));
+        return false;
+    }
+    *ret = IPv4_Addr(u32i(((ip().ms << msShift) & 0xFFFFFFFF) | ((ip().ls >> lsShift) & lsMask)));
+    return true;
+}
+
+void NAT64_Xlat::to_v6(const IPv4_Addr *in, size_t n, IPv6_Addr *out) const {
+    for (size_t row = 0; row < n; row++) out[row] = to_v6(in[row]);
+}
+
+size_t NAT64_Xlat::to_v4(const IPv6_Addr *in, size_t n, IPv4_Addr *out) const {
+    size_t ret {0};
+    for (size_t row = 0; row < n; row++) ret += to_v4(in[row], &out[row]);
+    return ret;
+}
+
+// kernels return count of rows done, the rest is left to scalar code
+#ifdef GIA_NAT64_X86
+
+__attribute__((target("avx2"))) static size_t to_v6_avx2(const u8i *in, size_t n, u8i *out, const u8i *shuf, const u8i *pfx) {
+    const __m256i shufLo = _mm256_load_si256((const __m256i*)shuf), shufHi = _mm256_load_si256((const __m256i*)(shuf + 32));
+    const __m256i base = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)pfx));
+    size_t full = n & ~size_t(3);
+    for (size_t row = 0; row < full; row += 4) { // 4 IPv4 in one load, each lane builds one IPv6
+        __m256i src = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(in + row * 4)));
+        _mm256_storeu_si256((__m256i*)(out + row * 16), _mm256_or_si256(_mm256_shuffle_epi8(src, shufLo), base));
+        _mm256_storeu_si256((__m256i*)(out + row * 16 + 32), _mm256_or_si256(_mm256_shuffle_epi8(src, shufHi), base));
+    }
+    return full;
+}
+
+__attribute__((target("avx2"))) static size_t to_v4_avx2(const u8i *in, size_t n, u8i *out, const u8i *shuf, const u8i *pfx, const u8i *cmp, size_t *cnt) {
+    const __m256i pattern = _mm256_load_si256((const __m256i*)shuf);
+    const __m256i base = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)pfx));
+    const __m256i mask = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)cmp));
+    const __m256i gather = _mm256_setr_epi32(0, 5, 0, 0, 0, 0, 0, 0); // dword 0 of lane 0 and dword 1 of lane 1
+    size_t full = n & ~size_t(1);
+    for (size_t row = 0; row < full; row += 2) {
+        __m256i src = _mm256_loadu_si256((const __m256i*)(in + row * 16));
+        u32i eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(src, mask), base));
+        u64i both = _mm_cvtsi128_si64(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(src, pattern), gather)));
+        u64i keep = (((eq & 0xFFFF) == 0xFFFF) ? 0xFFFFFFFFull : 0) | (((eq >> 16) == 0xFFFF) ? 0xFFFFFFFF00000000ull : 0);
+        both &= keep;
+        memcpy(out + row * 4, &both, 8);
+        *cnt += __builtin_popcountll(keep) / 32;
+    }
+    return full;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static size_t to_v6_avx512(const u8i *in, size_t n, u8i *out, const u8i *shuf, const u8i *pfx) {
+    const __m512i pattern = _mm512_load_si512((const void*)shuf);
+    const __m512i base = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)pfx));
+    size_t full = n & ~size_t(3);
+    for (size_t row = 0; row < full; row += 4) {
+        __m512i src = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)(in + row * 4)));
+        _mm512_storeu_si512((void*)(out + row * 16), _mm512_or_si512(_mm512_shuffle_epi8(src, pattern), base));
+    }
+    return full;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static size_t to_v4_avx512(const u8i *in, size_t n, u8i *out, const u8i *shuf, const u8i *pfx, const u8i *cmp, size_t *cnt) {
+    const __m512i pattern = _mm512_load_si512((const void*)shuf);
+    const __m512i base = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)pfx));
+    const __m512i mask = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i*)cmp));
+    const __m512i gather = _mm512_setr_epi32(0, 5, 10, 15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0); // dword j of lane j
+    size_t full = n & ~size_t(3);
+    for (size_t row = 0; row < full; row += 4) {
+        __m512i src = _mm512_loadu_si512((const void*)(in + row * 16));
+        u64i eq = _mm512_cmpeq_epi8_mask(_mm512_and_si512(src, mask), base);
+        __mmask16 keep {0};
+        for (u32i lane = 0; lane < 4; lane++) keep |= u32i(((eq >> (lane * 16)) & 0xFFFF) == 0xFFFF) << lane;
+        __m512i rows = _mm512_maskz_mov_epi32(keep, _mm512_permutexvar_epi32(gather, _mm512_shuffle_epi8(src, pattern)));
+        _mm_storeu_si128((__m128i*)(out + row * 4), _mm512_castsi512_si128(rows));
+        *cnt += __builtin_popcount(keep);
+    }
+    return full;
+}
+
+#endif // GIA_NAT64_X86
+
+void NAT64_Xlat::to_v6_wire(const u8i *in, size_t n, u8i *out) const {
+    size_t done {0};
+#ifdef GIA_NAT64_X86
+    colmnp::enLevel lvl = colmnp::level();
+    if (lvl == colmnp::AVX512) done = to_v6_avx512(in, n, out, shufToV6, pfxWire);
+    else if (lvl == colmnp::AVX2) done = to_v6_avx2(in, n, out, shufToV6, pfxWire);
+#endif
+    for (size_t row = done; row < n; row++) {
+        u8i *dst = out + row * 16;
+        memcpy(dst, pfxWire, 16);
+        for (u32i oct = 0; oct < 4; oct++) dst[bytePos[oct]] = in[row * 4 + oct];
+    }
+}
+
+size_t NAT64_Xlat::to_v4_wire(const u8i *in, size_t n, u8i *out) const {
+    size_t done {0}, ret {0};
+#ifdef GIA_NAT64_X86
+    colmnp::enLevel lvl = colmnp::level();
+    if (lvl == colmnp::AVX512) done = to_v4_avx512(in, n, out, shufToV4, pfxWire, cmpWire, &ret);
+    else if (lvl == colmnp::AVX2) done = to_v4_avx2(in, n, out, shufToV4, pfxWire, cmpWire, &ret);
+#endif
+    for (size_t row = done; row < n; row++) {
+        const u8i *src = in + row * 16;
+        bool match {true};
+        for (u32i idx = 0; idx < 16; idx++) match &= ((src[idx] & cmpWire[idx]) == pfxWire[idx]);
+        for (u32i oct = 0; oct < 4; oct++) out[row * 4 + oct] = match ? src[bytePos[oct]] : 0;
+        ret += match;
+    }
+    return ret;
+}
@@ -0,0 +1,48 @@
+#ifndef GIA_NAT64_H
+#define GIA_NAT64_H
+
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+// IPv4-embedded IPv6 addresses of RFC 6052 : NAT64 translation and DNS64 synthesis (A -> AAAA) over any of six prefix lengths,
+// for /32 - /56 IPv4 bits straddle u-octet (bits 64 - 71), which is always zero
+
+class nat64mnp {
+public:
+    static const u64i WKP_MS {0x0064FF9B00000000}, WKP_LS {0x0000000000000000}; // well-known prefix 64:ff9b::/96
+    static bool valid_len(u32i pfx_len) { return (pfx_len == 32) || (pfx_len == 40) || (pfx_len == 48) || (pfx_len == 56) || (pfx_len == 64) || (pfx_len == 96); };
+    enum enLastError : u8i {NoError = 0, BadPrefixLen = 1, BadPrefix = 2}; // BadPrefix - u-octet of /96 prefix is not zero
+};
+
+class NAT64_Xlat { // translator for one NAT64 prefix, immutable after construction, safe to share between threads
+    u64i pfxMs {nat64mnp::WKP_MS}, pfxLs {nat64mnp::WKP_LS}; // prefix bits only
+    u64i cmpMs {~0ull}, cmpLs {0xFFFFFFFF00000000}; // prefix and u-octet bits, compared on extraction
+    u32i pfxLen {96};
+    u32i msShift {63}, lsShift {0}; // IPv4 bits above u-octet are (ipv4 >> msShift), below are (ipv4 & lsMask) << lsShift
+    u64i lsMask {0xFFFFFFFF};
+    u8i bytePos[4] {12, 13, 14, 15}; // wire positions of IPv4 octets
+    alignas(64) u8i pfxWire[16] {}; // prefix in network order
+    alignas(64) u8i cmpWire[16] {}; // compare mask in network order
+    alignas(64) u8i shufToV6[64] {}; // pshufb patterns : lane j builds IPv6 of j-th IPv4 from 16 loaded bytes
+    alignas(64) u8i shufToV4[64] {}; // lane j puts its IPv4 octets to dword j
+    nat64mnp::enLastError lerr {nat64mnp::NoError};
+    void setup(const IPv6_Addr &prefix, u32i pfx_len);
+public:
+    NAT64_Xlat() { setup(IPv6_Addr(nat64mnp::WKP_MS, nat64mnp::WKP_LS), 96); }; // 64:ff9b::/96
+    NAT64_Xlat(const IPv6_Addr &prefix, u32i pfx_len) { setup(prefix, pfx_len); }; // on error falls back to 64:ff9b::/96, see last_err()
+    nat64mnp::enLastError last_err() const { return lerr; };
+    IPv6_Addr prefix() const { return IPv6_Addr(pfxMs, pfxLs); };
+    u32i prefix_len() const { return pfxLen; };
+    bool matches(const IPv6_Addr &ip) const { return ((ip().ms & cmpMs) == pfxMs) && ((ip().ls & cmpLs) == pfxLs); }; // prefix and zero u-octet
+    IPv6_Addr to_v6(const IPv4_Addr &ip) const { return IPv6_Addr(pfxMs | (u64i(ip()) >> msShift), pfxLs | ((ip() & lsMask) << lsShift)); }; // suffix is zero
+    bool to_v4(const IPv6_Addr &ip, IPv4_Addr *ret) const; // false and 0.0.0.0 if address is not under prefix
+    // batches : rows not under prefix get 0.0.0.0, return count of translated rows
+    void to_v6(const IPv4_Addr *in, size_t n, IPv6_Addr *out) const;
+    size_t to_v4(const IPv6_Addr *in, size_t n, IPv4_Addr *out) const;
+    // packed network order rows : 4 bytes per IPv4, 16 bytes per IPv6, shuffles with AVX2 / AVX-512 (see colmnp::level())
+    void to_v6_wire(const u8i *in, size_t n, u8i *out) const;
+    size_t to_v4_wire(const u8i *in, size_t n, u8i *out) const;
+};
+
+#endif // GIA_NAT64_H
@@ -0,0 +1,369 @@
+#include "gia_oui.h"
+#include "gia_stats.h"
+#include <algorithm>
+#include <fstream>
+#include <memory.h>
+
+using namespace std;
+
+struct oui_header { // fixed layout of compiled database, levels and string pool follow right after
+    char magic[8];
+    u32i version;
+    u32i poolLen;
+    u64i seed;
+    u32i cnt[ouimnp::LEVELS];
+    u32i buckets[ouimnp::LEVELS];
+    u8i reserved[16];
+};
+static_assert(sizeof(oui_header) == ouimnp::HEADER_LEN, "database header must take one cache line");
+static_assert(sizeof(oui_entry) == 16, "entry layout is part of file format");
+
+static const char OUI_MAGIC[8] {'G', 'I', 'A', 'O', 'U', 'I', 0, 0};
+static const size_t BATCH {16}; // keys in flight during batch lookup
+static const u32i BUILD_ATTEMPTS {16}; // seeds tried before giving up
+static const u32i MAX_PILOT {0xFFFF};
+
+static size_t pilots_bytes(u32i buckets) { return (size_t(buckets) * sizeof(u16i) + 7) & ~size_t(7); } // entries stay 8-byte aligned
+
+static bool parse_hex(const string &str, u64i *ret, u32i *digits) { // separators '-', ':', '.' and blanks are skipped
+    u64i val {0};
+    u32i cnt {0};
+    for (auto && chr : str) {
+        u32i dig;
+        if ((chr >= '0') && (chr <= '9')) dig = chr - '0';
+        else if ((chr >= 'A') && (chr <= 'F')) dig = chr - 'A' + 10;
+        else if ((chr >= 'a') && (chr <= 'f')) dig = chr - 'a' + 10;
+        else if ((chr == '-') || (chr == ':') || (chr == '.') || (chr == ' ') || (chr == '\t')) continue;
+        else return false;
+        if (++cnt > 12) return false;
+        val = (val << 4) | dig;
+    }
+    if (cnt == 0) return false;
+    *ret = val;
+    *digits = cnt;
+    return true;
+}
+
+static string trim(const string &str) {
+    size_t beg = str.find_first_not_of(" \t\r\n");
+    if (beg == string::npos) return {};
+    return str.substr(beg, str.find_last_not_of(" \t\r\n") - beg + 1);
+}
+
+static vector<string> csv_split(const string &line) { // quoted fields with "" escapes
+    vector<string> ret(1);
+    bool quoted {false};
+    for (size_t idx = 0; idx < line.size(); idx++) {
+        char chr = line[idx];
+        if (quoted) {
+            if (chr != '"') ret.back() += chr;
+            else if ((idx + 1 < line.size()) && (line[idx + 1] == '"')) { ret.back() += '"'; idx++; }
+            else quoted = false;
+        }
+        else if (chr == '"') quoted = true;
+        else if (chr == ',') ret.emplace_back();
+        else ret.back() += chr;
+    }
+    return ret;
+}
+
+bool OUI_Compiler::add(u64i prefix, u32i len, const string &vendor) {
+    for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+        if (ouimnp::PREFIX_LEN[lvl] != len) continue;
+        if ((prefix >> len) || vendor.empty() || (vendor.size() > 0xFFFF)) return false;
+        try {
+            return prefixes[lvl].emplace(prefix, vendor).second;
+        }
+        catch (...) {
+            lerr = ouimnp::STL_Exception;
+            return false;
+        }
+    }
+    return false;
+}
+
+bool OUI_Compiler::parse_csv_line(const string &line) { // Registry,Assignment,Organization Name,Organization Address
+    if (line.compare(0, 3, "MA-") && line.compare(0, 4, "IAB,")) return false;
+    vector<string> fields = csv_split(line);
+    if (fields.size() < 3) return false;
+    u64i prefix;
+    u32i digits;
+    if (!parse_hex(fields[1], &prefix, &digits)) return false;
+    return add(prefix, digits * 4, trim(fields[2]));
+}
+
+size_t OUI_Compiler::parse(istream &text) {
+    size_t ret {0};
+    string line, name;
+    u64i oui {0};
+    bool pending {false}; // "(hex)" line was seen, waiting for "(base 16)" line
+    try {
+        while (getline(text, line)) {
+            size_t pos;
+            u64i val;
+            u32i digits;
+            if ((pos = line.find("(hex)")) != string::npos) {
+                if (pending && add(oui, 24, name)) ret++;
+                pending = parse_hex(line.substr(0, pos), &val, &digits) && (digits == 6);
+                if (pending) {
+                    oui = val;
+                    name = trim(line.substr(pos + 5));
+                }
+            }
+            else if (pending && ((pos = line.find("(base 16)")) != string::npos)) {
+                pending = false;
+                string range = trim(line.substr(0, pos));
+                size_t dash = range.find('-');
+                if (dash == string::npos) { // MA-L repeats its OUI
+                    if (add(oui, 24, name)) ret++;
+                    continue;
+                }
+                u64i low, high;
+                if (!parse_hex(range.substr(0, dash), &low, &digits) || !parse_hex(range.substr(dash + 1), &high, &digits) || (high < low)) continue;
+                u64i span = high - low + 1;
+                u32i len = (span == (u64i(1) << 20)) ? 28 : (span == (u64i(1) << 12)) ? 36 : 0; // MA-M or MA-S block
+                if (len && add(((oui << 24) | low) >> (48 - len), len, name)) ret++;
+            }
+            else if (parse_csv_line(line)) ret++;
+        }
+        if (pending && add(oui, 24, name)) ret++;
+    }
+    catch (...) {
+        lerr = ouimnp::STL_Exception;
+    }
+    return ret;
+}
+
+size_t OUI_Compiler::parse_file(const string &path) {
+    ifstream text {path};
+    if (!text) {
+        lerr = ouimnp::BadFile;
+        return 0;
+    }
+    return parse(text);
+}
+
+// hash-and-displace : keys are spread into buckets, largest buckets are placed first, each bucket gets
+// the smallest pilot which sends all its keys to free slots
+static bool place_level(const vector<u64i> &keys, u32i level, u64i seed, u32i nbuckets, vector<u16i> &pilots, vector<u32i> &slotKey) {
+    u64i cnt = keys.size();
+    vector<u64i> hashes(cnt);
+    vector<pair<u32i,u32i>> order(cnt); // (bucket, key index)
+    for (u64i idx = 0; idx < cnt; idx++) {
+        hashes[idx] = ouimnp::hash(keys[idx], level, seed);
+        order[idx] = {u32i(ouimnp::mulhi(hashes[idx], nbuckets)), u32i(idx)};
+    }
+    sort(order.begin(), order.end());
+    vector<pair<u32i,u32i>> spans; // (begin in order, size)
+    for (u32i beg = 0; beg < cnt;) {
+        u32i end = beg;
+        while ((end < cnt) && (order[end].first == order[beg].first)) end++;
+        spans.push_back({beg, end - beg});
+        beg = end;
+    }
+    stable_sort(spans.begin(), spans.end(), [](const pair<u32i,u32i> &a, const pair<u32i,u32i> &b) { return a.second > b.second; });
+    pilots.assign(nbuckets, 0);
+    slotKey.assign(cnt, UINT32_MAX);
+    vector<u64i> slots;
+    for (auto && span : spans) {
+        bool placed {false};
+        for (u32i pilot = 0; (pilot <= MAX_PILOT) && !placed; pilot++) {
+            slots.clear();
+            placed = true;
+            for (u32i idx = span.first; idx < span.first + span.second; idx++) {
+                u64i slot = ouimnp::slot_of(hashes[order[idx].second], pilot, cnt);
+                if ((slotKey[slot] != UINT32_MAX) || (find(slots.begin(), slots.end(), slot) != slots.end())) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (!placed) continue;
+            pilots[order[span.first].first] = pilot;
+            for (u32i idx = 0; idx < span.second; idx++) slotKey[slots[idx]] = order[span.first + idx].second;
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+vector<u8i> OUI_Compiler::build() {
+    vector<u8i> ret;
+    try {
+        map<string,u32i> names; // string pool without duplicates, vendors own many blocks
+        string pool;
+        oui_header hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, OUI_MAGIC, sizeof(hdr.magic));
+        hdr.version = ouimnp::VERSION;
+        vector<u64i> keys[ouimnp::LEVELS];
+        vector<u16i> pilots[ouimnp::LEVELS];
+        vector<u32i> slotKey[ouimnp::LEVELS];
+        vector<u32i> offs[ouimnp::LEVELS];
+        for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+            for (auto && [key, name] : prefixes[lvl]) {
+                auto ins = names.emplace(name, u32i(pool.size()));
+                if (ins.second) pool += name;
+                keys[lvl].push_back(key);
+                offs[lvl].push_back(ins.first->second);
+            }
+            hdr.cnt[lvl] = keys[lvl].size();
+            hdr.buckets[lvl] = (hdr.cnt[lvl] == 0) ? 0 : hdr.cnt[lvl] / ouimnp::BUCKET_KEYS + 1;
+        }
+        if (pool.size() > UINT32_MAX) {
+            lerr = ouimnp::BuildFailed;
+            return ret;
+        }
+        hdr.poolLen = pool.size();
+        bool built {false};
+        for (u32i attempt = 0; (attempt < BUILD_ATTEMPTS) && !built; attempt++) {
+            hdr.seed = hashmnp::mix64(attempt + 1);
+            built = true;
+            for (u32i lvl = 0; (lvl < ouimnp::LEVELS) && built; lvl++) {
+                if (hdr.cnt[lvl]) built = place_level(keys[lvl], lvl, hdr.seed, hdr.buckets[lvl], pilots[lvl], slotKey[lvl]);
+            }
+        }
+        if (!built) {
+            lerr = ouimnp::BuildFailed;
+            return ret;
+        }
+        size_t total = sizeof(hdr) + pool.size();
+        for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) total += pilots_bytes(hdr.buckets[lvl]) + size_t(hdr.cnt[lvl]) * sizeof(oui_entry);
+        ret.assign(total, 0);
+        u8i *dst = ret.data();
+        memcpy(dst, &hdr, sizeof(hdr));
+        dst += sizeof(hdr);
+        for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+            if (hdr.buckets[lvl]) memcpy(dst, pilots[lvl].data(), pilots[lvl].size() * sizeof(u16i));
+            dst += pilots_bytes(hdr.buckets[lvl]);
+            for (u32i slot = 0; slot < hdr.cnt[lvl]; slot++) {
+                u32i key = slotKey[lvl][slot];
+                oui_entry ent {keys[lvl][key], offs[lvl][key], u32i(prefixes[lvl].at(keys[lvl][key]).size())};
+                memcpy(dst, &ent, sizeof(ent));
+                dst += sizeof(ent);
+            }
+        }
+        if (!pool.empty()) memcpy(dst, pool.data(), pool.size());
+        lerr = ouimnp::NoError;
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        ret.clear();
+        lerr = ouimnp::STL_Exception;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        ret.clear();
+        lerr = ouimnp::STL_Exception;
+    }
+    return ret;
+}
+
+bool OUI_DB::open(const string &path) {
+    base = nullptr;
+    if (!file.open(path)) {
+        lerr = ouimnp::BadFile;
+        return false;
+    }
+    file.advise_rand();
+    return view(file.data(), file.size());
+}
+
+bool OUI_DB::view(const u8i *image, size_t len) {
+    base = nullptr;
+    lerr = ouimnp::BadImage;
+    oui_header hdr;
+    if ((image == nullptr) || (len < sizeof(hdr)) || (uintptr_t(image) & 7)) return false;
+    memcpy(&hdr, image, sizeof(hdr));
+    if ((memcmp(hdr.magic, OUI_MAGIC, sizeof(hdr.magic)) != 0) || (hdr.version != ouimnp::VERSION)) return false;
+    size_t pos = sizeof(hdr);
+    for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+        if ((hdr.cnt[lvl] == 0) != (hdr.buckets[lvl] == 0)) return false;
+        size_t need = pilots_bytes(hdr.buckets[lvl]) + size_t(hdr.cnt[lvl]) * sizeof(oui_entry);
+        if (need > len - pos) return false;
+        pilots[lvl] = (const u16i*)(image + pos);
+        entries[lvl] = (const oui_entry*)(image + pos + pilots_bytes(hdr.buckets[lvl]));
+        for (u32i slot = 0; slot < hdr.cnt[lvl]; slot++) {
+            const oui_entry &ent = entries[lvl][slot];
+            if ((u64i(ent.nameOff) + ent.nameLen > hdr.poolLen) || (ent.key >> ouimnp::PREFIX_LEN[lvl])) return false;
+        }
+        cnt[lvl] = hdr.cnt[lvl];
+        buckets[lvl] = hdr.buckets[lvl];
+        pos += need;
+    }
+    if (hdr.poolLen > len - pos) return false;
+    pool = (const char*)(image + pos);
+    seed = hdr.seed;
+    base = image;
+    lerr = ouimnp::NoError;
+    return true;
+}
+
+const oui_entry* OUI_DB::probe(u32i level, u64i key) const {
+    if (cnt[level] == 0) return nullptr;
+    u64i hsh = ouimnp::hash(key, level, seed);
+    u16i pilot = pilots[level][ouimnp::mulhi(hsh, buckets[level])];
+    const oui_entry *ent = &entries[level][ouimnp::slot_of(hsh, pilot, cnt[level])];
+    return (ent->key == key) ? ent : nullptr;
+}
+
+string_view OUI_DB::vendor(const MAC_Addr &mac, u32i *prefix_len) const {
+    GIA_COUNT(OUI_Lookup);
+    GIA_TIMER(H_OUI_Lookup);
+    if (base == nullptr) return {};
+    for (u32i lvl = ouimnp::LEVELS; lvl-- > 0;) {
+        const oui_entry *ent = probe(lvl, mac() >> (48 - ouimnp::PREFIX_LEN[lvl]));
+        if (ent == nullptr) continue;
+        if (prefix_len) *prefix_len = ouimnp::PREFIX_LEN[lvl];
+        return string_view(pool + ent->nameOff, ent->nameLen);
+    }
+    GIA_COUNT(OUI_Miss);
+    return {};
+}
+
+string_view OUI_DB::vendor_oui(u32i oui) const {
+    GIA_COUNT(OUI_Lookup);
+    if (base == nullptr) return {};
+    const oui_entry *ent = probe(ouimnp::MA_L, oui & 0xFFFFFF);
+    GIA_COUNT_IF(OUI_Miss, ent == nullptr);
+    return (ent == nullptr) ? string_view() : string_view(pool + ent->nameOff, ent->nameLen);
+}
+
+void OUI_DB::vendor(const MAC_Addr *arr, size_t n, string_view *out) const {
+    GIA_COUNT_N(OUI_Lookup, n);
+    if (base == nullptr) {
+        for (size_t idx = 0; idx < n; idx++) out[idx] = {};
+        return;
+    }
+    u64i slots[BATCH][ouimnp::LEVELS];
+    for (size_t beg = 0; beg < n; beg += BATCH) {
+        size_t end = min(n, beg + BATCH);
+        for (size_t idx = beg; idx < end; idx++) { // hashes, pilots are fetched
+            for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+                if (cnt[lvl] == 0) continue;
+                u64i hsh = ouimnp::hash(arr[idx]() >> (48 - ouimnp::PREFIX_LEN[lvl]), lvl, seed);
+                slots[idx - beg][lvl] = hsh;
+                __builtin_prefetch(&pilots[lvl][ouimnp::mulhi(hsh, buckets[lvl])]);
+            }
+        }
+        for (size_t idx = beg; idx < end; idx++) { // slots, entries are fetched
+            for (u32i lvl = 0; lvl < ouimnp::LEVELS; lvl++) {
+                if (cnt[lvl] == 0) continue;
+                u64i hsh = slots[idx - beg][lvl];
+                slots[idx - beg][lvl] = ouimnp::slot_of(hsh, pilots[lvl][ouimnp::mulhi(hsh, buckets[lvl])], cnt[lvl]);
+                __builtin_prefetch(&entries[lvl][slots[idx - beg][lvl]]);
+            }
+        }
+        for (size_t idx = beg; idx < end; idx++) {
+            out[idx] = {};
+            for (u32i lvl = ouimnp::LEVELS; lvl-- > 0;) {
+                if (cnt[lvl] == 0) continue;
+                const oui_entry &ent = entries[lvl][slots[idx - beg][lvl]];
+                if (ent.key != (arr[idx]() >> (48 - ouimnp::PREFIX_LEN[lvl]))) continue;
+                out[idx] = string_view(pool + ent.nameOff, ent.nameLen);
+                break;
+            }
+            GIA_COUNT_IF(OUI_Miss, out[idx].empty());
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef GIA_OUI_H
+#define GIA_OUI_H
+
+#include <istream>
+#include <map>
+#include <string_view>
+#include "gia_iphash.h"
+#include "gia_mmap.h"
+
+using namespace std;
+
+class ouimnp {
+public:
+    enum enLevel : u32i {MA_L = 0, MA_M = 1, MA_S = 2}; // 24, 28 and 36-bit prefixes
+    static constexpr u32i LEVELS {3};
+    static constexpr u32i PREFIX_LEN[LEVELS] {24, 28, 36};
+    static constexpr u32i VERSION {1};
+    static constexpr size_t HEADER_LEN {64};
+    static constexpr u32i BUCKET_KEYS {4}; // average keys per bucket of perfect hash
+    enum enLastError : u8i {NoError = 0, BadFile = 1, BadImage = 2, BuildFailed = 3, STL_Exception = 4};
+    static u64i hash(u64i key, u32i level, u64i seed) { return hashmnp::mix64(key ^ (u64i(level + 1) << 40) ^ seed); };
+    static u64i mulhi(u64i a, u64i b) { return u64i(((unsigned __int128)a * b) >> 64); };
+    static u64i slot_of(u64i hash, u16i pilot, u64i cnt) { return mulhi(hashmnp::mix64(hash ^ (u64i(pilot) * hashmnp::K1)), cnt); };
+};
+
+struct oui_entry { // slot of perfect hash table in image
+    u64i key; // prefix value, right aligned
+    u32i nameOff; // in string pool
+    u32i nameLen;
+};
+
+class OUI_Compiler { // IEEE registry (MA-L, MA-M, MA-S in txt or csv form) to binary image for OUI_DB
+    map<u64i,string> prefixes[ouimnp::LEVELS]; // first assignment wins for duplicate prefixes
+    ouimnp::enLastError lerr {ouimnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func OUI_Compiler::build() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func OUI_Compiler::build() says: exception."};
+    bool parse_csv_line(const string &line);
+public:
+    bool add(u64i prefix, u32i len, const string &vendor); // len is 24, 28 or 36, prefix is right aligned
+    size_t parse(istream &text); // returns count of accepted records
+    size_t parse_file(const string &path);
+    size_t count() const { return prefixes[0].size() + prefixes[1].size() + prefixes[2].size(); };
+    vector<u8i> build(); // empty on failure
+    ouimnp::enLastError last_err() const { return lerr; };
+};
+
+class OUI_DB { // vendor lookup over compiled image, O(1) per prefix length, no copies of image
+    MMap_File file;
+    const u8i *base {nullptr};
+    u64i seed {0};
+    u32i cnt[ouimnp::LEVELS] {};
+    u32i buckets[ouimnp::LEVELS] {};
+    const u16i *pilots[ouimnp::LEVELS] {};
+    const oui_entry *entries[ouimnp::LEVELS] {};
+    const char *pool {nullptr};
+    ouimnp::enLastError lerr {ouimnp::NoError};
+    const oui_entry* probe(u32i level, u64i key) const;
+public:
+    OUI_DB() {};
+    OUI_DB(const string &path) { open(path); };
+    OUI_DB(const OUI_DB &) = delete;
+    OUI_DB& operator=(const OUI_DB &) = delete;
+    bool open(const string &path); // maps compiled file
+    bool view(const u8i *image, size_t len); // image must outlive database and be 8-byte aligned
+    bool is_open() const { return base != nullptr; };
+    string_view vendor(const MAC_Addr &mac, u32i *prefix_len = nullptr) const; // longest matching prefix, empty if unknown
+    string_view vendor_oui(u32i oui) const; // MA-L only, oui as returned by MAC_Addr::get_oui()
+    void vendor(const MAC_Addr *arr, size_t n, string_view *out) const;
+    size_t count() const { return size_t(cnt[0]) + cnt[1] + cnt[2]; };
+    ouimnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_OUI_H
@@ -0,0 +1,269 @@
+#include "gia_pcap.h"
+#include "gia_ipwire.h"
+
+using namespace std;
+
+static constexpr u32i PCAP_US {0xA1B2C3D4}, PCAP_NS {0xA1B23C4D};
+static constexpr u32i NG_SHB {0x0A0D0D0A}, NG_IDB {1}, NG_SPB {3}, NG_EPB {6}, NG_BYTE_ORDER {0x1A2B3C4D};
+static constexpr u16i NG_OPT_END {0}, NG_OPT_TSRESOL {9};
+
+static u16i be16(const u8i *ptr) { return (u16i(ptr[0]) << 8) | ptr[1]; }
+
+void pcap_batch::clear() {
+    ts.clear();
+    wireLen.clear();
+    vlan.clear();
+    family.clear();
+    proto.clear();
+    srcMac.clear();
+    dstMac.clear();
+    src4.clear();
+    dst4.clear();
+    src6.clear();
+    dst6.clear();
+}
+
+void pcap_batch::reserve(size_t n) {
+    ts.reserve(n);
+    wireLen.reserve(n);
+    vlan.reserve(n);
+    family.reserve(n);
+    proto.reserve(n);
+    srcMac.reserve(n);
+    dstMac.reserve(n);
+    src4.reserve(n);
+    dst4.reserve(n);
+    src6.reserve(n);
+    dst6.reserve(n);
+}
+
+void PCap_Reader::add_packet(pcap_batch *batch, u32i link, u64i ts, const u8i *pkt, u32i capLen, u32i wireLen) {
+    MAC_Addr smac, dmac;
+    u16i vlan {pcapmnp::NO_VLAN};
+    const u8i *l3 {nullptr};
+    u32i l3len {0};
+    if (link == pcapmnp::Ethernet) {
+        if (capLen >= 14) {
+            dmac = MAC_Addr::from_wire(pkt);
+            smac = MAC_Addr::from_wire(pkt + 6);
+            u16i etype = be16(pkt + 12);
+            u32i off {14};
+            for (u32i tag = 0; (tag < pcapmnp::MAX_TAGS) && ((etype == pcapmnp::ET_VLAN) || (etype == pcapmnp::ET_QinQ)) && (off + 4 <= capLen); tag++) {
+                if (vlan == pcapmnp::NO_VLAN) vlan = be16(pkt + off) & 0x0FFF;
+                etype = be16(pkt + off + 2);
+                off += 4;
+            }
+            if ((etype == pcapmnp::ET_IPv4) || (etype == pcapmnp::ET_IPv6)) {
+                l3 = pkt + off;
+                l3len = capLen - off;
+            }
+        }
+    } else if ((link == pcapmnp::Raw) || (link == pcapmnp::RawIPv4) || (link == pcapmnp::RawIPv6)) {
+        l3 = pkt;
+        l3len = capLen;
+    }
+    u8i fam {0}, proto {0};
+    if ((l3len >= 20) && ((l3[0] >> 4) == 4)) {
+        fam = 4;
+        proto = l3[9];
+        batch->src4.push_back(IPv4_Addr::from_wire(l3 + wiremnp::IPV4_SRC));
+        batch->dst4.push_back(IPv4_Addr::from_wire(l3 + wiremnp::IPV4_DST));
+    } else {
+        batch->src4.push_back(IPv4_Addr());
+        batch->dst4.push_back(IPv4_Addr());
+    }
+    if ((l3len >= 40) && ((l3[0] >> 4) == 6)) {
+        fam = 6;
+        proto = l3[6];
+        batch->src6.push_back(IPv6_Addr::from_wire(l3 + wiremnp::IPV6_SRC));
+        batch->dst6.push_back(IPv6_Addr::from_wire(l3 + wiremnp::IPV6_DST));
+    } else {
+        batch->src6.push_back(IPv6_Addr());
+        batch->dst6.push_back(IPv6_Addr());
+    }
+    batch->ts.push_back(ts);
+    batch->wireLen.push_back(wireLen);
+    batch->vlan.push_back(vlan);
+    batch->family.push_back(fam);
+    batch->proto.push_back(proto);
+    batch->srcMac.push_back(smac);
+    batch->dstMac.push_back(dmac);
+}
+
+bool PCap_Reader::start() {
+    ng = swapped = nanos = false;
+    ifaces.clear();
+    total = 0;
+    if ((base == nullptr) || (len < 12)) {
+        lerr = pcapmnp::BadFormat;
+        return false;
+    }
+    u32i magic;
+    memcpy(&magic, base, 4);
+    if (magic == NG_SHB) {
+        ng = true;
+        first = pos = 0;
+        lerr = pcapmnp::NoError;
+        return true;
+    }
+    if ((magic == PCAP_US) || (magic == PCAP_NS)) {
+        nanos = (magic == PCAP_NS);
+    } else if ((magic == __builtin_bswap32(PCAP_US)) || (magic == __builtin_bswap32(PCAP_NS))) {
+        swapped = true;
+        nanos = (magic == __builtin_bswap32(PCAP_NS));
+    } else {
+        lerr = pcapmnp::BadFormat;
+        return false;
+    }
+    if (len < 24) {
+        lerr = pcapmnp::BadFormat;
+        return false;
+    }
+    link = rd32(base + 20) & 0x0FFFFFFF; // upper bits describe FCS
+    first = pos = 24;
+    lerr = pcapmnp::NoError;
+    return true;
+}
+
+bool PCap_Reader::open(const string &path) {
+    if (!file.open(path)) {
+        lerr = pcapmnp::IOError;
+        return false;
+    }
+    file.advise_seq();
+    base = file.data();
+    len = file.size();
+    return start();
+}
+
+bool PCap_Reader::view(const u8i *image, size_t size) {
+    file.close();
+    base = image;
+    len = size;
+    return start();
+}
+
+void PCap_Reader::rewind() {
+    start();
+}
+
+bool PCap_Reader::ng_section(const u8i *blk, u32i blkLen) {
+    if (blkLen < 28) return false;
+    u32i order;
+    memcpy(&order, blk + 8, 4);
+    if (order == NG_BYTE_ORDER) swapped = false;
+    else if (order == __builtin_bswap32(NG_BYTE_ORDER)) swapped = true;
+    else return false;
+    ifaces.clear();
+    return true;
+}
+
+bool PCap_Reader::ng_iface(const u8i *blk, u32i blkLen) {
+    if (blkLen < 20) return false;
+    iface ifc {rd16(blk + 8), 1000000, false}; // microseconds by default
+    for (u32i off = 16; off + 4 <= blkLen - 4; ) {
+        u16i code = rd16(blk + off), optLen = rd16(blk + off + 2);
+        if (code == NG_OPT_END) break;
+        if ((code == NG_OPT_TSRESOL) && (optLen >= 1)) {
+            u8i res = blk[off + 4];
+            ifc.tsBinary = res & 0x80;
+            u32i exp = res & 0x7F;
+            if (ifc.tsBinary) {
+                if (exp > 63) return false;
+                ifc.tsUnits = u64i(1) << exp;
+            } else {
+                if (exp > 19) return false;
+                ifc.tsUnits = 1;
+                for (u32i idx = 0; idx < exp; idx++) ifc.tsUnits *= 10;
+            }
+        }
+        off += 4 + ((optLen + 3) & ~3u);
+    }
+    ifaces.push_back(ifc);
+    return true;
+}
+
+static u64i to_nanos(u64i ticks, u64i units, bool binary) {
+    if (units == 1000000000) return ticks;
+    if (binary) return u64i(((unsigned __int128)ticks * 1000000000) >> __builtin_ctzll(units));
+    if ((1000000000 % units) == 0) return ticks * (1000000000 / units);
+    return ticks / (units / 1000000000);
+}
+
+size_t PCap_Reader::next(pcap_batch *batch, size_t max) {
+    batch->clear();
+    if (lerr != pcapmnp::NoError) return 0;
+    try {
+        batch->reserve(max);
+        while (batch->size() < max) {
+            if (!ng) {
+                if (pos + 16 > len) {
+                    if (pos != len) lerr = pcapmnp::Truncated;
+                    break;
+                }
+                const u8i *rec = base + pos;
+                u32i capLen = rd32(rec + 8);
+                if (capLen > len - pos - 16) {
+                    lerr = pcapmnp::Truncated;
+                    break;
+                }
+                u64i ts = u64i(rd32(rec)) * 1000000000 + u64i(rd32(rec + 4)) * (nanos ? 1 : 1000);
+                add_packet(batch, link, ts, rec + 16, capLen, rd32(rec + 12));
+                pos += 16 + size_t(capLen);
+                continue;
+            }
+            if (pos + 12 > len) {
+                if (pos != len) lerr = pcapmnp::Truncated;
+                break;
+            }
+            const u8i *blk = base + pos;
+            u32i type;
+            memcpy(&type, blk, 4);
+            if ((type == NG_SHB) && !ng_section(blk, u32i(min<size_t>(len - pos, 28)))) { // byte order is known only from section header itself
+                lerr = pcapmnp::BadFormat;
+                break;
+            }
+            type = rd32(blk);
+            u32i blkLen = rd32(blk + 4);
+            if ((blkLen < 12) || (blkLen & 3)) {
+                lerr = pcapmnp::BadFormat;
+                break;
+            }
+            if (blkLen > len - pos) {
+                lerr = pcapmnp::Truncated;
+                break;
+            }
+            bool good {true};
+            if (type == NG_IDB) good = ng_iface(blk, blkLen);
+            else if (type == NG_EPB) {
+                u32i ifid = (blkLen >= 32) ? rd32(blk + 8) : u32i(ifaces.size());
+                u32i capLen = (blkLen >= 32) ? rd32(blk + 20) : 0;
+                good = (ifid < ifaces.size()) && (capLen <= blkLen - 32);
+                if (good) {
+                    const iface &ifc = ifaces[ifid];
+                    u64i ticks = (u64i(rd32(blk + 12)) << 32) | rd32(blk + 16);
+                    add_packet(batch, ifc.link, to_nanos(ticks, ifc.tsUnits, ifc.tsBinary), blk + 28, capLen, rd32(blk + 24));
+                }
+            } else if (type == NG_SPB) {
+                good = (blkLen >= 16) && !ifaces.empty();
+                if (good) {
+                    u32i wireLen = rd32(blk + 8);
+                    add_packet(batch, ifaces[0].link, 0, blk + 12, min(wireLen, blkLen - 16), wireLen); // no timestamp in simple packet
+                }
+            }
+            if (!good) {
+                lerr = pcapmnp::BadFormat;
+                break;
+            }
+            pos += blkLen;
+        }
+    }
+    catch (...) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = pcapmnp::STL_Exception;
+        batch->clear();
+        return 0;
+    }
+    total += batch->size();
+    return batch->size();
+}
@@ -0,0 +1,64 @@
+#ifndef GIA_PCAP_H
+#define GIA_PCAP_H
+
+#include "gia_ipcol.h"
+#include "gia_mmap.h"
+
+using namespace std;
+
+class pcapmnp {
+public:
+    enum enLink : u32i {Ethernet = 1, Raw = 101, RawIPv4 = 228, RawIPv6 = 229}; // LINKTYPE_ values
+    enum enEtherType : u16i {ET_IPv4 = 0x0800, ET_IPv6 = 0x86DD, ET_VLAN = 0x8100, ET_QinQ = 0x88A8};
+    enum enLastError : u8i {NoError = 0, IOError = 1, BadFormat = 2, Truncated = 3, STL_Exception = 4};
+    static constexpr u16i NO_VLAN {0xFFFF};
+    static constexpr size_t BATCH {4096}; // default packets per batch
+    static constexpr u32i MAX_TAGS {2}; // VLAN tags walked before giving up on frame
+};
+
+struct pcap_batch { // one row per packet in every column, absent fields are zero
+    vector<u64i> ts; // nanoseconds since epoch
+    vector<u32i> wireLen; // original length of packet
+    vector<u16i> vlan; // outer VLAN id or pcapmnp::NO_VLAN
+    vector<u8i> family; // 4, 6 or 0 for non-IP packets
+    vector<u8i> proto; // IPv4 protocol or IPv6 next header
+    MACColumn srcMac, dstMac;
+    IPv4Column src4, dst4;
+    IPv6Column src6, dst6;
+    size_t size() const { return ts.size(); };
+    void clear();
+    void reserve(size_t n);
+};
+
+class PCap_Reader { // streaming reader of classic pcap and pcapng over mapped file, headers are decoded in place
+    struct iface { u32i link; u64i tsUnits; bool tsBinary; }; // ticks per second, power of 2 if tsBinary
+    MMap_File file;
+    const u8i *base {nullptr};
+    size_t len {0};
+    size_t pos {0}; // next record or block
+    size_t first {0}; // first record of classic pcap
+    bool ng {false};
+    bool swapped {false}; // file byte order differs from host
+    u32i link {0}; // classic pcap only
+    bool nanos {false}; // classic pcap only
+    vector<iface> ifaces; // interfaces of current pcapng section
+    u64i total {0};
+    pcapmnp::enLastError lerr {pcapmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func PCap_Reader::next() says: not enough memory."};
+    u16i rd16(const u8i *ptr) const { u16i val; memcpy(&val, ptr, 2); return swapped ? __builtin_bswap16(val) : val; };
+    u32i rd32(const u8i *ptr) const { u32i val; memcpy(&val, ptr, 4); return swapped ? __builtin_bswap32(val) : val; };
+    bool start();
+    bool ng_section(const u8i *blk, u32i blkLen);
+    bool ng_iface(const u8i *blk, u32i blkLen);
+    static void add_packet(pcap_batch *batch, u32i link, u64i ts, const u8i *pkt, u32i capLen, u32i wireLen);
+public:
+    bool open(const string &path);
+    bool view(const u8i *image, size_t size); // image must outlive reader
+    size_t next(pcap_batch *batch, size_t max = pcapmnp::BATCH); // clears batch, returns count of packets, 0 at the end or on error
+    void rewind();
+    bool is_ng() const { return ng; };
+    u64i packets() const { return total; }; // read so far
+    pcapmnp::enLastError last_err() const { return lerr; };
+};
+
+#endif // GIA_PCAP_H
@@ -0,0 +1,324 @@
+#include "gia_pfxdb.h"
+#include "gia_stats.h"
+#include <memory.h>
+
+using namespace std;
+
+struct pfx_header { // fixed layout of database image, tree, offsets and data follow right after
+    char magic[8];
+    u32i version;
+    u32i nodeCnt;
+    u32i recCnt;
+    u32i leafCnt;
+    u64i dataLen;
+    u8i reserved[32];
+};
+static_assert(sizeof(pfx_header) == pfxmnp::HEADER_LEN, "database header must take one cache line");
+
+static const char PFX_MAGIC[8] {'G', 'I', 'A', 'P', 'F', 'X', 0, 0};
+static const u32i TERM {0x80000000}; // marks record (or NO_VALUE) among temporary node indexes of writer
+static const size_t BATCH {8}; // lookups walked in lockstep
+
+static u32i bit_at(u64i ms, u64i ls, u32i depth) { return (depth < 64) ? (ms >> (63 - depth)) & 1 : (ls >> (127 - depth)) & 1; }
+
+bool PfxDB_Writer::insert_bits(u64i ms, u64i ls, u32i len, const string &rec) {
+    try {
+        auto ins = recIdx.emplace(rec, u32i(recs.size()));
+        if (ins.second) {
+            if (recs.size() >= TERM - 1) {
+                recIdx.erase(ins.first);
+                lerr = pfxmnp::STL_Exception;
+                return false;
+            }
+            recs.push_back(rec);
+        }
+        u32i node {0};
+        for (u32i depth = 0; depth < len; depth++) {
+            u32i bit = bit_at(ms, ls, depth);
+            if (nodes[node].child[bit] == pfxmnp::NO_VALUE) {
+                nodes[node].child[bit] = nodes.size();
+                nodes.emplace_back();
+            }
+            node = nodes[node].child[bit];
+        }
+        nodes[node].rec = ins.first->second;
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        lerr = pfxmnp::STL_Exception;
+        return false;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        lerr = pfxmnp::STL_Exception;
+        return false;
+    }
+    lerr = pfxmnp::NoError;
+    return true;
+}
+
+bool PfxDB_Writer::insert(const IPv4_Addr &net, u32i mask_len, const string &rec) {
+    if (mask_len > 32) {
+        lerr = pfxmnp::BadPrefix;
+        return false;
+    }
+    return insert_bits(0, pfxmnp::MAPPED_LS | net(), mask_len + 96, rec);
+}
+
+bool PfxDB_Writer::insert(const IPv6_Addr &net, u32i mask_len, const string &rec) {
+    if (mask_len > 128) {
+        lerr = pfxmnp::BadPrefix;
+        return false;
+    }
+    return insert_bits(net().ms, net().ls, mask_len, rec);
+}
+
+u32i PfxDB_Writer::leaf_of(u32i rec, u32i len) {
+    auto ins = leafIdx.emplace((u64i(len) << 32) | rec, u32i(leaves.size() / 2));
+    if (ins.second) {
+        leaves.push_back(rec);
+        leaves.push_back(len);
+    }
+    return ins.first->second;
+}
+
+// post-order : prefixes are pushed down to leaves, subtrees ending in the same prefix collapse into its leaf
+u32i PfxDB_Writer::emit(u32i node, u32i depth, u32i inherited, vector<u32i> &out) {
+    if (node == pfxmnp::NO_VALUE) return (inherited == pfxmnp::NO_VALUE) ? pfxmnp::NO_VALUE : (TERM | inherited);
+    const wr_node &wn = nodes[node];
+    u32i leaf = (wn.rec == pfxmnp::NO_VALUE) ? inherited : leaf_of(wn.rec, depth);
+    u32i left = emit(wn.child[0], depth + 1, leaf, out);
+    u32i right = emit(wn.child[1], depth + 1, leaf, out);
+    if ((left == right) && (left & TERM)) return left;
+    out.push_back(left);
+    out.push_back(right);
+    return out.size() / 2 - 1;
+}
+
+vector<u8i> PfxDB_Writer::build() {
+    vector<u8i> ret;
+    try {
+        vector<u32i> tmp;
+        leaves.clear();
+        leafIdx.clear();
+        u32i root = emit(0, 0, pfxmnp::NO_VALUE, tmp);
+        if (root & TERM) { // whole space resolves to one value
+            tmp.push_back(root);
+            tmp.push_back(root);
+        }
+        u64i cnt = tmp.size() / 2;
+        u64i lcnt = leaves.size() / 2;
+        if ((cnt + 1 + lcnt > UINT32_MAX) || (recs.size() >= UINT32_MAX)) {
+            lerr = pfxmnp::STL_Exception;
+            return ret;
+        }
+        pfx_header hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, PFX_MAGIC, sizeof(hdr.magic));
+        hdr.version = pfxmnp::VERSION;
+        hdr.nodeCnt = cnt;
+        hdr.recCnt = recs.size();
+        hdr.leafCnt = lcnt;
+        for (auto && rec : recs) hdr.dataLen += rec.size();
+        if (hdr.dataLen > UINT32_MAX) {
+            lerr = pfxmnp::STL_Exception;
+            return ret;
+        }
+        ret.resize(sizeof(hdr) + cnt * 8 + lcnt * 8 + (recs.size() + 1) * 4 + hdr.dataLen);
+        memcpy(ret.data(), &hdr, sizeof(hdr));
+        u32i *dst = (u32i*)(ret.data() + sizeof(hdr));
+        for (u64i idx = 0; idx < cnt; idx++) { // root was emitted last, order is reversed so root becomes node 0
+            for (u32i side = 0; side < 2; side++) {
+                u32i val = tmp[(cnt - 1 - idx) * 2 + side];
+                if (val == pfxmnp::NO_VALUE) val = cnt;
+                else if (val & TERM) val = cnt + 1 + (val & ~TERM);
+                else val = cnt - 1 - val;
+                memcpy(dst++, &val, sizeof(val));
+            }
+        }
+        memcpy(dst, leaves.data(), lcnt * 8);
+        dst += lcnt * 2;
+        u32i off {0};
+        for (auto && rec : recs) {
+            memcpy(dst++, &off, sizeof(off));
+            off += rec.size();
+        }
+        memcpy(dst++, &off, sizeof(off));
+        char *chr = (char*)dst;
+        for (auto && rec : recs) {
+            memcpy(chr, rec.data(), rec.size());
+            chr += rec.size();
+        }
+        lerr = pfxmnp::NoError;
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        ret.clear();
+        lerr = pfxmnp::STL_Exception;
+    }
+    catch (...) {
+        cerr << EX_EXCEPT << endl;
+        ret.clear();
+        lerr = pfxmnp::STL_Exception;
+    }
+    return ret;
+}
+
+bool PfxDB_Writer::save(const string &path) {
+    vector<u8i> image = build();
+    if (image.empty()) return false;
+    if (!MMap_File::save(path, image)) {
+        lerr = pfxmnp::BadFile;
+        return false;
+    }
+    return true;
+}
+
+bool PfxDB::open(const string &path) {
+    nodes = nullptr;
+    if (!file.open(path)) {
+        lerr = pfxmnp::BadFile;
+        return false;
+    }
+    file.advise_rand();
+    return view(file.data(), file.size());
+}
+
+bool PfxDB::view(const u8i *image, size_t len) {
+    nodes = nullptr;
+    lerr = pfxmnp::BadImage;
+    pfx_header hdr;
+    if ((image == nullptr) || (len < sizeof(hdr)) || (uintptr_t(image) & 3)) return false;
+    memcpy(&hdr, image, sizeof(hdr));
+    if ((memcmp(hdr.magic, PFX_MAGIC, sizeof(hdr.magic)) != 0) || (hdr.version != pfxmnp::VERSION) || (hdr.nodeCnt == 0)) return false;
+    if ((u64i(hdr.nodeCnt) + 1 + hdr.leafCnt > UINT32_MAX) || (hdr.recCnt == UINT32_MAX)) return false;
+    u64i need = u64i(hdr.nodeCnt) * 8 + u64i(hdr.leafCnt) * 8 + (u64i(hdr.recCnt) + 1) * 4 + hdr.dataLen;
+    if (need > len - sizeof(hdr)) return false;
+    const u32i *tree = (const u32i*)(image + sizeof(hdr));
+    const u32i *leafs = tree + u64i(hdr.nodeCnt) * 2;
+    const u32i *offsets = leafs + u64i(hdr.leafCnt) * 2;
+    for (u64i idx = 0; idx < u64i(hdr.nodeCnt) * 2; idx++) {
+        if (tree[idx] > hdr.nodeCnt + hdr.leafCnt) return false;
+    }
+    for (u32i idx = 0; idx < hdr.leafCnt; idx++) {
+        if ((leafs[idx * 2] >= hdr.recCnt) || (leafs[idx * 2 + 1] > 128)) return false;
+    }
+    if (offsets[0] != 0) return false;
+    for (u32i idx = 0; idx < hdr.recCnt; idx++) {
+        if (offsets[idx + 1] < offsets[idx]) return false;
+    }
+    if (offsets[hdr.recCnt] != hdr.dataLen) return false;
+    nodeCnt = hdr.nodeCnt;
+    leafCnt = hdr.leafCnt;
+    recCnt = hdr.recCnt;
+    leaves = leafs;
+    offs = offsets;
+    data = (const char*)(offsets + recCnt + 1);
+    u32i val {0}, depth {0};
+    for (; (val < nodeCnt) && (depth < 96); depth++) val = tree[val * 2 + bit_at(0, pfxmnp::MAPPED_LS, depth)];
+    v4Start = val;
+    v4Depth = depth;
+    nodes = tree;
+    lerr = pfxmnp::NoError;
+    return true;
+}
+
+u32i PfxDB::v4_walk(u32i ip) const {
+    u32i val = v4Start;
+    for (u32i depth = v4Depth; (val < nodeCnt) && (depth < 128); depth++) val = nodes[val * 2 + ((ip >> (127 - depth)) & 1)];
+    return val;
+}
+
+string_view PfxDB::lookup(const IPv4_Addr &ip, u32i *prefix_len) const {
+    GIA_COUNT(PfxDB_Lookup);
+    GIA_TIMER(H_PfxDB_Lookup);
+    if (nodes == nullptr) return {};
+    u32i val = v4_walk(ip());
+    GIA_COUNT_IF(PfxDB_Miss, val <= nodeCnt);
+    if (val <= nodeCnt) return {}; // no data, or tree deeper than address
+    if (prefix_len) *prefix_len = (leaf_len(val) > 96) ? leaf_len(val) - 96 : 0; // IPv6 prefix above ::ffff:0:0/96 covers whole IPv4
+    return record(val);
+}
+
+string_view PfxDB::lookup(const IPv6_Addr &ip, u32i *prefix_len) const {
+    GIA_COUNT(PfxDB_Lookup);
+    GIA_TIMER(H_PfxDB_Lookup);
+    if (nodes == nullptr) return {};
+    u64i ms = ip().ms, ls = ip().ls;
+    u32i val {0};
+    if (ip.is_mapped_ipv4() && (ms == 0) && ((ls >> 48) == 0)) val = v4_walk(u32i(ls)); // shortcut over the first 96 levels
+    else {
+        for (u32i depth = 0; (val < nodeCnt) && (depth < 128); depth++) val = nodes[val * 2 + bit_at(ms, ls, depth)];
+    }
+    GIA_COUNT_IF(PfxDB_Miss, val <= nodeCnt);
+    if (val <= nodeCnt) return {};
+    if (prefix_len) *prefix_len = leaf_len(val);
+    return record(val);
+}
+
+void PfxDB::lookup(const IPv4_Addr *arr, size_t n, string_view *out) const {
+    GIA_COUNT_N(PfxDB_Lookup, n);
+    if (nodes == nullptr) {
+        for (size_t idx = 0; idx < n; idx++) out[idx] = {};
+        return;
+    }
+    u32i vals[BATCH];
+    for (size_t beg = 0; beg < n; beg += BATCH) {
+        size_t cnt = min(BATCH, n - beg);
+        for (size_t lane = 0; lane < cnt; lane++) vals[lane] = v4Start;
+        for (u32i depth = v4Depth; depth < 128; depth++) { // lanes advance together, so their cache misses overlap
+            bool active {false};
+            for (size_t lane = 0; lane < cnt; lane++) {
+                if (vals[lane] >= nodeCnt) continue;
+                vals[lane] = nodes[vals[lane] * 2 + ((arr[beg + lane]() >> (127 - depth)) & 1)];
+                if (vals[lane] < nodeCnt) __builtin_prefetch(&nodes[vals[lane] * 2]);
+                active = true;
+            }
+            if (!active) break;
+        }
+        for (size_t lane = 0; lane < cnt; lane++) {
+            GIA_COUNT_IF(PfxDB_Miss, vals[lane] <= nodeCnt);
+            out[beg + lane] = (vals[lane] <= nodeCnt) ? string_view() : record(vals[lane]);
+        }
+    }
+}
+
+void PfxDB::lookup(const IPv6_Addr *arr, size_t n, string_view *out) const {
+    GIA_COUNT_N(PfxDB_Lookup, n);
+    if (nodes == nullptr) {
+        for (size_t idx = 0; idx < n; idx++) out[idx] = {};
+        return;
+    }
+    u32i vals[BATCH];
+    for (size_t beg = 0; beg < n; beg += BATCH) {
+        size_t cnt = min(BATCH, n - beg);
+        for (size_t lane = 0; lane < cnt; lane++) vals[lane] = 0;
+        for (u32i depth = 0; depth < 128; depth++) {
+            bool active {false};
+            for (size_t lane = 0; lane < cnt; lane++) {
+                if (vals[lane] >= nodeCnt) continue;
+                vals[lane] = nodes[vals[lane] * 2 + bit_at(arr[beg + lane]().ms, arr[beg + lane]().ls, depth)];
+                if (vals[lane] < nodeCnt) __builtin_prefetch(&nodes[vals[lane] * 2]);
+                active = true;
+            }
+            if (!active) break;
+        }
+        for (size_t lane = 0; lane < cnt; lane++) {
+            GIA_COUNT_IF(PfxDB_Miss, vals[lane] <= nodeCnt);
+            out[beg + lane] = (vals[lane] <= nodeCnt) ? string_view() : record(vals[lane]);
+        }
+    }
+}
+
+bool PfxDB_Live::reload(const string &path) {
+    shared_ptr<PfxDB> fresh;
+    try {
+        fresh = make_shared<PfxDB>();
+    }
+    catch (...) {
+        return false;
+    }
+    if (!fresh->open(path)) return false;
+    atomic_store(&cur, shared_ptr<const PfxDB>(move(fresh)));
+    return true;
+}
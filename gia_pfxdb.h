@@ -0,0 +1,84 @@
+#ifndef GIA_PFXDB_H
+#define GIA_PFXDB_H
+
+#include <map>
+#include <memory>
+#include <string_view>
+#include "gia_mmap.h"
+
+using namespace std;
+
+class pfxmnp {
+public:
+    static constexpr u32i VERSION {2}; // 2 - leaves keep length of matched prefix
+    static constexpr size_t HEADER_LEN {64};
+    static constexpr u64i MAPPED_LS {0x0000FFFF00000000}; // IPv4 prefixes live in ::ffff:0:0/96 - RFC 4291
+    static constexpr u32i NO_VALUE {0xFFFFFFFF};
+    enum enLastError : u8i {NoError = 0, BadPrefix = 1, BadFile = 2, BadImage = 3, STL_Exception = 4};
+};
+
+class PfxDB_Writer { // builds prefix -> record image, records are opaque byte strings (country, ASN, site tag, ...)
+    struct wr_node {
+        u32i child[2] {pfxmnp::NO_VALUE, pfxmnp::NO_VALUE};
+        u32i rec {pfxmnp::NO_VALUE};
+    };
+    vector<wr_node> nodes {wr_node()};
+    vector<string> recs;
+    map<string,u32i> recIdx; // identical records are stored once
+    vector<u32i> leaves; // pairs of (record, prefix length) of tree leaves, filled by build()
+    map<u64i,u32i> leafIdx;
+    pfxmnp::enLastError lerr {pfxmnp::NoError};
+    static inline const char EX_LOW_MEM[] = {"func PfxDB_Writer::build() says: not enough memory."};
+    static inline const char EX_EXCEPT [] = {"func PfxDB_Writer::build() says: exception."};
+    bool insert_bits(u64i ms, u64i ls, u32i len, const string &rec);
+    u32i leaf_of(u32i rec, u32i len);
+    u32i emit(u32i node, u32i depth, u32i inherited, vector<u32i> &out);
+public:
+    bool insert(const IPv4_Addr &net, u32i mask_len, const string &rec); // same prefix again replaces record, longer prefixes win on lookup
+    bool insert(const IPv6_Addr &net, u32i mask_len, const string &rec);
+    size_t records() const { return recs.size(); };
+    vector<u8i> build(); // header, search tree, leaves, record offsets, record data
+    bool save(const string &path); // build() and atomic replace of file
+    pfxmnp::enLastError last_err() const { return lerr; };
+};
+
+class PfxDB { // zero-copy reader : lookups walk search tree directly in mapped image
+    MMap_File file;
+    const u32i *nodes {nullptr}; // pairs of (left, right) values : node index, nodeCnt for no data, nodeCnt + 1 + n for leaf n
+    const u32i *leaves {nullptr}; // pairs of (record, prefix length), length counts IPv4 prefixes from ::ffff:0:0/96
+    const u32i *offs {nullptr}; // recCnt + 1 offsets into data
+    const char *data {nullptr};
+    u32i nodeCnt {0};
+    u32i leafCnt {0};
+    u32i recCnt {0};
+    u32i v4Start {0}; // value after walking ::ffff:0:0/96
+    u32i v4Depth {0};
+    pfxmnp::enLastError lerr {pfxmnp::NoError};
+    string_view record(u32i val) const { if (val <= nodeCnt) return {}; u32i rec = leaves[(val - nodeCnt - 1) * 2]; return string_view(data + offs[rec], offs[rec + 1] - offs[rec]); };
+    u32i leaf_len(u32i val) const { return leaves[(val - nodeCnt - 1) * 2 + 1]; };
+    u32i v4_walk(u32i ip) const; // value after last 32 levels
+public:
+    PfxDB() {};
+    PfxDB(const string &path) { open(path); };
+    PfxDB(const PfxDB &) = delete;
+    PfxDB& operator=(const PfxDB &) = delete;
+    bool open(const string &path);
+    bool view(const u8i *image, size_t len); // image must outlive reader and be 4-byte aligned
+    bool is_open() const { return nodes != nullptr; };
+    string_view lookup(const IPv4_Addr &ip, u32i *prefix_len = nullptr) const; // empty if no prefix covers ip
+    string_view lookup(const IPv6_Addr &ip, u32i *prefix_len = nullptr) const; // IPv4-mapped addresses are looked up as IPv4
+    void lookup(const IPv4_Addr *arr, size_t n, string_view *out) const;
+    void lookup(const IPv6_Addr *arr, size_t n, string_view *out) const;
+    u32i node_count() const { return nodeCnt; };
+    u32i record_count() const { return recCnt; };
+    pfxmnp::enLastError last_err() const { return lerr; };
+};
+
+class PfxDB_Live { // hot reload : new file is mapped aside and swapped in atomically, readers keep old mapping until they drop it
+    shared_ptr<const PfxDB> cur;
+public:
+    bool reload(const string &path); // current database stays on failure
+    shared_ptr<const PfxDB> snapshot() const { return atomic_load(&cur); }; // string_view results are valid while snapshot is held
+};
+
+#endif // GIA_PFXDB_H
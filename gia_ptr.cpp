@@ -0,0 +1,184 @@
+#include "gia_ipmnp.h"
+#include "gia_ipcol.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define GIA_PTR_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// reverse DNS names : "4.3.2.1.in-addr.arpa" and "b.a.9.8.7.6.5.0.4.0.0.0.3.0.0.0.2.0.0.0.1.0.0.0.0.0.0.0.1.2.3.4.ip6.arpa" (RFC 1035, RFC 3596)
+
+static const char V4_SUFFIX[] {"in-addr.arpa"};
+static const char V6_SUFFIX[] {"ip6.arpa"};
+
+static bool same_nocase(const char *text, const char *patt, size_t len) { // patt is lower case
+    for (size_t idx = 0; idx < len; idx++) {
+        char symb = text[idx];
+        if ((symb >= 'A') && (symb <= 'Z')) symb += 'a' - 'A';
+        if (symb != patt[idx]) return false;
+    }
+    return true;
+}
+
+size_t IPv4_Addr::to_ptr_name(char *out) const {
+    char *pos = out;
+    for (u32i oct = 0; oct < 4; oct++) { // least significant octet goes first
+        u32i val = as_u8i[oct];
+        if (val >= 100) *pos++ = char('0' + val / 100);
+        if (val >= 10) *pos++ = char('0' + (val / 10) % 10);
+        *pos++ = char('0' + val % 10);
+        *pos++ = '.';
+    }
+    memcpy(pos, V4_SUFFIX, sizeof(V4_SUFFIX)); // with terminating zero
+    return pos - out + sizeof(V4_SUFFIX) - 1;
+}
+
+bool v4mnp::from_ptr_name(const string &name, IPv4_Addr *ret) {
+    if (ret != nullptr) *ret = IPv4_Addr(u32i(0));
+    size_t len = name.size();
+    if (len && (name[len - 1] == '.')) len--; // fully qualified
+    const size_t sufLen {sizeof(V4_SUFFIX) - 1};
+    if ((len < sufLen + 8) || (len > PTR_SIZE - 1) || !same_nocase(name.data() + len - sufLen, V4_SUFFIX, sufLen)) return false;
+    u32i val {0};
+    size_t pos {0};
+    for (u32i oct = 0; oct < 4; oct++) {
+        u32i octet {0}, digits {0};
+        while ((name[pos] >= '0') && (name[pos] <= '9') && (digits < 3)) {
+            octet = octet * 10 + (name[pos] - '0');
+            pos++;
+            digits++;
+        }
+        if (!digits || (octet > 255) || (name[pos] != '.')) return false;
+        pos++;
+        val |= octet << (8 * oct);
+    }
+    if (pos != len - sufLen) return false; // more than four labels
+    if (ret != nullptr) *ret = IPv4_Addr(val);
+    return true;
+}
+
+size_t v4mnp::to_ptr_names(const IPv4_Addr &net, u32i mask_len, char *out, size_t max_names) {
+    if (mask_len > 32) mask_len = 32;
+    u64i total = u64i(1) << (32 - mask_len);
+    size_t cnt = size_t(min<u64i>(total, max_names));
+    IPv4_Addr cur = net;
+    cur &= gen_mask(mask_len);
+    for (size_t idx = 0; idx < cnt; idx++, cur++) cur.to_ptr_name(out + idx * PTR_SIZE);
+    return cnt;
+}
+
+// 16 bytes are reversed, split into nibbles and turned into hex symbols by pshufb over hex table of to_str()
+#ifdef GIA_PTR_X86
+
+__attribute__((target("avx2"))) static void nibbles_avx2(const u8i *wire, const char *hex, char *out) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i low = _mm_set1_epi8(0x0F), dots = _mm_set1_epi8('.');
+    const __m128i table = _mm_loadu_si128((const __m128i*)hex);
+    __m128i bytes = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)wire), reverse);
+    __m128i lo = _mm_and_si128(bytes, low), hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), low);
+    __m128i first = _mm_shuffle_epi8(table, _mm_unpacklo_epi8(lo, hi)); // low nibble of byte goes before high one
+    __m128i second = _mm_shuffle_epi8(table, _mm_unpackhi_epi8(lo, hi));
+    _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(first, dots));
+    _mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi8(first, dots));
+    _mm_storeu_si128((__m128i*)(out + 32), _mm_unpacklo_epi8(second, dots));
+    _mm_storeu_si128((__m128i*)(out + 48), _mm_unpackhi_epi8(second, dots));
+}
+
+// 64 symbols as 32 words : nibble symbol in low byte, dot in high one ; returns false on bad symbol, out gets 16 bytes, least significant first
+__attribute__((target("avx2"))) static bool denibbles_avx2(const char *name, u8i *out) {
+    const __m256i dotWord = _mm256_set1_epi16(0x2E00), highByte = _mm256_set1_epi16(-256), lowByte = _mm256_set1_epi16(0x00FF);
+    __m256i first = _mm256_loadu_si256((const __m256i*)name), second = _mm256_loadu_si256((const __m256i*)(name + 32));
+    __m256i dotsOk = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_and_si256(first, highByte), dotWord), _mm256_cmpeq_epi16(_mm256_and_si256(second, highByte), dotWord));
+    __m256i symb = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(first, lowByte), _mm256_and_si256(second, lowByte)), 0xD8); // 32 symbols in order
+    __m256i digit = _mm256_sub_epi8(symb, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(symb, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit); // unsigned digit <= 9
+    __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    __m256i val = _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, isDigit);
+    if (((u32i)_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != 0xFFFFFFFF) || ((u32i)_mm256_movemask_epi8(dotsOk) != 0xFFFFFFFF)) return false;
+    __m256i pairs = _mm256_maddubs_epi16(val, _mm256_set1_epi16(0x1001)); // low nibble + 16 * high nibble
+    __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+    _mm_storeu_si128((__m128i*)out, bytes);
+    return true;
+}
+
+#endif // GIA_PTR_X86
+
+static void nibbles(const u8i *wire, const char *hex, char *out, bool simd) {
+#ifdef GIA_PTR_X86
+    if (simd) {
+        nibbles_avx2(wire, hex, out);
+        return;
+    }
+#endif
+    for (u32i idx = 0; idx < 16; idx++) {
+        u8i byte = wire[15 - idx];
+        out[idx * 4] = hex[byte & 0x0F];
+        out[idx * 4 + 1] = '.';
+        out[idx * 4 + 2] = hex[byte >> 4];
+        out[idx * 4 + 3] = '.';
+    }
+}
+
+size_t IPv6_Addr::to_ptr_name(char *out, bool caps) const {
+    u8i wire[16];
+    to_wire(wire);
+    nibbles(wire, caps ? v6mnp::HEX_UPP : v6mnp::HEX_LOW, out, colmnp::level() >= colmnp::AVX2);
+    memcpy(out + 64, V6_SUFFIX, sizeof(V6_SUFFIX));
+    return v6mnp::PTR_SIZE - 1;
+}
+
+void v6mnp::to_ptr_names(const IPv6_Addr *arr, size_t n, char *out) {
+    bool simd = (colmnp::level() >= colmnp::AVX2);
+    u8i wire[16];
+    for (size_t idx = 0; idx < n; idx++) {
+        char *name = out + idx * PTR_SIZE;
+        arr[idx].to_wire(wire);
+        nibbles(wire, HEX_LOW, name, simd);
+        memcpy(name + 64, V6_SUFFIX, sizeof(V6_SUFFIX));
+    }
+}
+
+size_t v6mnp::to_ptr_names(const IPv6_Addr &net, u32i mask_len, char *out, size_t max_names) {
+    if (mask_len > 128) mask_len = 128;
+    size_t cnt = (128 - mask_len >= 64) ? max_names : size_t(min<u64i>(u64i(1) << (128 - mask_len), max_names));
+    bool simd = (colmnp::level() >= colmnp::AVX2);
+    IPv6_Addr cur = net;
+    cur &= gen_mask(mask_len);
+    u8i wire[16];
+    for (size_t idx = 0; idx < cnt; idx++, cur++) {
+        char *name = out + idx * PTR_SIZE;
+        cur.to_wire(wire);
+        nibbles(wire, HEX_LOW, name, simd);
+        memcpy(name + 64, V6_SUFFIX, sizeof(V6_SUFFIX));
+    }
+    return cnt;
+}
+
+bool v6mnp::from_ptr_name(const string &name, IPv6_Addr *ret) {
+    if (ret != nullptr) { ret->as_u128i = {0x0, 0x0}; ret->lerr = BadSyntax; }
+    size_t len = name.size();
+    if (len && (name[len - 1] == '.')) len--;
+    if ((len != PTR_SIZE - 1) || !same_nocase(name.data() + 64, V6_SUFFIX, sizeof(V6_SUFFIX) - 1)) return false;
+    u64i half[2] {0, 0}; // ls, ms
+#ifdef GIA_PTR_X86
+    if (colmnp::level() >= colmnp::AVX2) {
+        if (!denibbles_avx2(name.data(), (u8i*)half)) return false; // little endian : first byte is least significant
+        if (ret != nullptr) { *ret = IPv6_Addr(half[1], half[0]); ret->lerr = NoError; }
+        return true;
+    }
+#endif
+    for (u32i nib = 0; nib < 32; nib++) {
+        char symb = name[nib * 2];
+        u64i val;
+        if ((symb >= '0') && (symb <= '9')) val = symb - '0';
+        else if ((symb >= 'a') && (symb <= 'f')) val = symb - 'a' + 10;
+        else if ((symb >= 'A') && (symb <= 'F')) val = symb - 'A' + 10;
+        else return false;
+        if (name[nib * 2 + 1] != '.') return false;
+        half[nib / 16] |= val << (4 * (nib % 16));
+    }
+    if (ret != nullptr) { *ret = IPv6_Addr(half[1], half[0]); ret->lerr = NoError; }
+    return true;
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include "gia_shard.h"
+
+using namespace std;
+
+u32i shardmnp::jump(u64i key, u32i shards) {
+    int64_t cur {-1}, next {0};
+    while (next < shards) {
+        cur = next;
+        key = key * 2862933555777941757ull + 1;
+        next = int64_t(double(cur + 1) * (double(1ll << 31) / double((key >> 33) + 1)));
+    }
+    return u32i(cur);
+}
+
+bool shard_keys::set_prefix(u32i v4_len, u32i v6_len, u32i mac_len) {
+    if ((v4_len > 32) || (v6_len > 128) || (mac_len > 48)) {
+        lerr = shardmnp::BadPrefix;
+        return false;
+    }
+    v4Len = v4_len;
+    v6Len = v6_len;
+    macLen = mac_len;
+    v4Mask = v4mnp::gen_mask(v4Len)();
+    IPv6_Mask mask = v6mnp::gen_mask(v6Len);
+    v6MaskMs = mask().ms;
+    v6MaskLs = mask().ls;
+    macMask = macLen ? (0xFFFFFFFFFFFFull << (48 - macLen)) & 0xFFFFFFFFFFFFull : 0;
+    lerr = shardmnp::NoError;
+    return true;
+}
+
+bool Jump_Shard::resize(u32i shards) {
+    if (!shards) {
+        lerr = shardmnp::NoShards;
+        return false;
+    }
+    cnt = shards;
+    return true;
+}
+
+template <class Addr>
+void Jump_Shard::shard_batch(const Addr *arr, size_t n, u32i *out) const {
+    u64i prev {0};
+    u32i prevShard {0};
+    for (size_t idx = 0; idx < n; idx++) {
+        u64i key = key_of(arr[idx]);
+        if (!idx || (key != prev)) prevShard = shardmnp::jump(key, cnt); // flows of one prefix often come in runs
+        prev = key;
+        out[idx] = prevShard;
+    }
+}
+
+void Jump_Shard::shard(const IPv4_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
+void Jump_Shard::shard(const IPv6_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
+void Jump_Shard::shard(const MAC_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
+
+bool Rendezvous_Shard::add_node(u32i id, double weight) {
+    if (!(weight > 0) || !isfinite(weight)) {
+        lerr = shardmnp::BadWeight;
+        return false;
+    }
+    if (find(ids.begin(), ids.end(), id) != ids.end()) {
+        lerr = shardmnp::DupNode;
+        return false;
+    }
+    ids.push_back(id);
+    seeds.push_back(hashmnp::mix64(u64i(id) ^ hashmnp::K3)); // score depends on node id, not on its position
+    weights.push_back(weight);
+    uniform = all_of(weights.begin(), weights.end(), [&](double val) { return val == weights[0]; });
+    lerr = shardmnp::NoError;
+    return true;
+}
+
+bool Rendezvous_Shard::remove_node(u32i id) {
+    auto it = find(ids.begin(), ids.end(), id);
+    if (it == ids.end()) {
+        lerr = shardmnp::NoNode;
+        return false;
+    }
+    size_t pos = it - ids.begin();
+    ids.erase(ids.begin() + pos);
+    seeds.erase(seeds.begin() + pos);
+    weights.erase(weights.begin() + pos);
+    uniform = all_of(weights.begin(), weights.end(), [&](double val) { return val == weights[0]; });
+    lerr = shardmnp::NoError;
+    return true;
+}
+
+bool Rendezvous_Shard::set_weight(u32i id, double weight) {
+    auto it = find(ids.begin(), ids.end(), id);
+    if (it == ids.end()) {
+        lerr = shardmnp::NoNode;
+        return false;
+    }
+    if (!(weight > 0) || !isfinite(weight)) {
+        lerr = shardmnp::BadWeight;
+        return false;
+    }
+    weights[it - ids.begin()] = weight;
+    uniform = all_of(weights.begin(), weights.end(), [&](double val) { return val == weights[0]; });
+    lerr = shardmnp::NoError;
+    return true;
+}
+
+u32i Rendezvous_Shard::pick(u64i key) const { // node with highest weight / -ln(u), u is uniform (0, 1) from hash of key and node
+    if (ids.empty()) return shardmnp::NO_SHARD;
+    size_t best {0};
+    if (uniform) {
+        u64i top {0};
+        for (size_t idx = 0; idx < ids.size(); idx++) {
+            u64i score = hashmnp::fold(key ^ seeds[idx], hashmnp::K2);
+            if (score > top) { top = score; best = idx; }
+        }
+        return ids[best];
+    }
+    double top {-1.0};
+    for (size_t idx = 0; idx < ids.size(); idx++) {
+        double unit = (double(hashmnp::fold(key ^ seeds[idx], hashmnp::K2) >> 11) + 0.5) * 0x1.0p-53;
+        double score = weights[idx] / -log(unit);
+        if (score > top) { top = score; best = idx; }
+    }
+    return ids[best];
+}
+
+template <class Addr>
+void Rendezvous_Shard::shard_batch(const Addr *arr, size_t n, u32i *out) const {
+    u64i prev {0};
+    u32i prevShard {shardmnp::NO_SHARD};
+    for (size_t idx = 0; idx < n; idx++) {
+        u64i key = key_of(arr[idx]);
+        if (!idx || (key != prev)) prevShard = pick(key);
+        prev = key;
+        out[idx] = prevShard;
+    }
+}
+
+void Rendezvous_Shard::shard(const IPv4_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
+void Rendezvous_Shard::shard(const IPv6_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
+void Rendezvous_Shard::shard(const MAC_Addr *arr, size_t n, u32i *out) const { shard_batch(arr, n, out); }
@@ -0,0 +1,68 @@
+#ifndef GIA_SHARD_H
+#define GIA_SHARD_H
+
+#include "gia_iphash.h"
+
+using namespace std;
+
+// consistent sharding of addresses over workers : jump hash (Lamping, Veach) for numbered shards, weighted rendezvous
+// hashing (highest random weight) for named nodes ; keys are hashes of address prefix, so whole /24 or /64 stays on one worker
+
+class shardmnp {
+public:
+    static constexpr u32i NO_SHARD {UINT32_MAX}; // sharder without nodes
+    enum enLastError : u8i {NoError = 0, BadPrefix = 1, NoShards = 2, BadWeight = 3, DupNode = 4, NoNode = 5};
+    static u32i jump(u64i key, u32i shards); // shard in [0, shards), only keys of removed last shard or keys for new last shard move
+};
+
+class shard_keys { // hashes of address prefixes, base of sharders
+protected:
+    u32i v4Len {32}, v6Len {128}, macLen {48};
+    u32i v4Mask {0xFFFFFFFF};
+    u64i v6MaskMs {~0ull}, v6MaskLs {~0ull}, macMask {0xFFFFFFFFFFFF};
+    mutable shardmnp::enLastError lerr {shardmnp::NoError};
+public:
+    bool set_prefix(u32i v4_len, u32i v6_len, u32i mac_len = 48); // e.g. 24 and 64, false and no change on bad length
+    u64i key_of(const IPv4_Addr &ip) const { return hashmnp::hash(ip() & v4Mask); };
+    u64i key_of(const IPv6_Addr &ip) const { return hashmnp::hash(ip().ms & v6MaskMs, ip().ls & v6MaskLs); };
+    u64i key_of(const MAC_Addr &mac) const { return hashmnp::hash_48bits(mac() & macMask); };
+    shardmnp::enLastError last_err() const { return lerr; };
+};
+
+class Jump_Shard : public shard_keys { // shards are numbers 0 .. count-1, growing or shrinking changes only the last one
+    u32i cnt {1};
+    template <class Addr> void shard_batch(const Addr *arr, size_t n, u32i *out) const;
+public:
+    Jump_Shard(u32i shards = 1) { resize(shards); };
+    bool resize(u32i shards); // false on zero
+    u32i count() const { return cnt; };
+    u32i shard(const IPv4_Addr &ip) const { return shardmnp::jump(key_of(ip), cnt); };
+    u32i shard(const IPv6_Addr &ip) const { return shardmnp::jump(key_of(ip), cnt); };
+    u32i shard(const MAC_Addr &mac) const { return shardmnp::jump(key_of(mac), cnt); };
+    // batches : runs of rows with the same key reuse shard of previous row
+    void shard(const IPv4_Addr *arr, size_t n, u32i *out) const;
+    void shard(const IPv6_Addr *arr, size_t n, u32i *out) const;
+    void shard(const MAC_Addr *arr, size_t n, u32i *out) const;
+};
+
+class Rendezvous_Shard : public shard_keys { // any node can join or leave, keys move only to joined node or from left one
+    vector<u32i> ids;
+    vector<u64i> seeds; // per node hash salt
+    vector<double> weights;
+    bool uniform {true}; // equal weights : highest hash wins, no logarithms
+    u32i pick(u64i key) const;
+    template <class Addr> void shard_batch(const Addr *arr, size_t n, u32i *out) const;
+public:
+    bool add_node(u32i id, double weight = 1.0); // share of keys is weight / sum of weights
+    bool remove_node(u32i id);
+    bool set_weight(u32i id, double weight);
+    size_t nodes() const { return ids.size(); };
+    u32i shard(const IPv4_Addr &ip) const { return pick(key_of(ip)); }; // id of node, NO_SHARD without nodes
+    u32i shard(const IPv6_Addr &ip) const { return pick(key_of(ip)); };
+    u32i shard(const MAC_Addr &mac) const { return pick(key_of(mac)); };
+    void shard(const IPv4_Addr *arr, size_t n, u32i *out) const;
+    void shard(const IPv6_Addr *arr, size_t n, u32i *out) const;
+    void shard(const MAC_Addr *arr, size_t n, u32i *out) const;
+};
+
+#endif // GIA_SHARD_H
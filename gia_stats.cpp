@@ -0,0 +1,149 @@
+#include <mutex>
+#include "gia_stats.h"
+
+using namespace std;
+
+static const char *COUNTER_NAMES[statmnp::COUNTERS] {
+    "v4.parse", "v4.fail.length", "v4.fail.symbol", "v4.fail.dots", "v4.fail.octet", "v4.fail.mask",
+    "v6.parse", "v6.embedded_v4", "v6.fail.length", "v6.fail.colons", "v6.fail.dots", "v6.fail.symbol", "v6.fail.embedded_v4", "v6.fail.hextets", "v6.fail.mask",
+    "mac.parse", "mac.fail.length", "mac.fail.group", "mac.fail.symbol", "mac.fail.separator", "mac.fail.memory",
+    "v4.format", "v6.format", "v6.format.embedded_v4", "mac.format",
+    "pfxdb.lookup", "pfxdb.miss", "oui.lookup", "oui.miss", "fdb.lookup", "fdb.miss", "fdb.probes"
+};
+
+static const char *HIST_NAMES[statmnp::HISTOGRAMS] {
+    "v4.parse", "v6.parse", "mac.parse", "v4.format", "v6.format", "mac.format", "pfxdb.lookup", "oui.lookup", "fdb.lookup"
+};
+
+const char* statmnp::name(enCounter cnt) {
+    return (cnt < COUNTERS) ? COUNTER_NAMES[cnt] : "";
+}
+
+const char* statmnp::name(enHist hist) {
+    return (hist < HISTOGRAMS) ? HIST_NAMES[hist] : "";
+}
+
+u64i stat_snapshot::calls(statmnp::enHist hist) const {
+    u64i ret {0};
+    for (u32i bucket = 0; bucket < statmnp::BUCKETS; bucket++) ret += this->hist[hist][bucket];
+    return ret;
+}
+
+u64i stat_snapshot::quantile(statmnp::enHist hist, double q) const {
+    u64i total = calls(hist);
+    if (total == 0) return 0;
+    u64i need = max<u64i>(1, u64i(q * total + 0.5)), seen {0};
+    for (u32i bucket = 0; bucket < statmnp::BUCKETS; bucket++) {
+        seen += this->hist[hist][bucket];
+        if (seen >= need) return u64i(1) << (bucket + 1);
+    }
+    return u64i(1) << statmnp::BUCKETS;
+}
+
+#ifdef GIA_STATS
+
+struct stat_registry {
+    mutex lock;
+    vector<statmnp::stat_block*> live;
+    statmnp::stat_block retired; // counts of finished threads
+    statmnp::stat_block spare; // shared by threads which could not get own block
+};
+
+static void zero(statmnp::stat_block *blk) {
+    for (auto && ctr : blk->cnt) ctr.store(0, memory_order_relaxed);
+    for (auto && row : blk->hist) for (auto && ctr : row) ctr.store(0, memory_order_relaxed);
+}
+
+static void add(stat_snapshot *snap, const statmnp::stat_block &blk) {
+    for (u32i idx = 0; idx < statmnp::COUNTERS; idx++) snap->counters[idx] += blk.cnt[idx].load(memory_order_relaxed);
+    for (u32i hist = 0; hist < statmnp::HISTOGRAMS; hist++) {
+        for (u32i bucket = 0; bucket < statmnp::BUCKETS; bucket++) snap->hist[hist][bucket] += blk.hist[hist][bucket].load(memory_order_relaxed);
+    }
+}
+
+static stat_registry& registry() { // built on first use, so it outlives thread_local holders of main thread
+    static stat_registry reg {};
+    return reg;
+}
+
+statmnp::holder::holder() {
+    stat_registry &reg = registry();
+    try {
+        blk = new stat_block;
+        zero(blk);
+        lock_guard<mutex> guard(reg.lock);
+        reg.live.push_back(blk);
+    }
+    catch (bad_alloc) {
+        cerr << EX_LOW_MEM << endl;
+        blk = &reg.spare;
+    }
+}
+
+statmnp::holder::~holder() {
+    stat_registry &reg = registry();
+    if (blk == &reg.spare) return;
+    lock_guard<mutex> guard(reg.lock);
+    for (u32i idx = 0; idx < COUNTERS; idx++) reg.retired.cnt[idx].fetch_add(blk->cnt[idx].load(memory_order_relaxed), memory_order_relaxed);
+    for (u32i hist = 0; hist < HISTOGRAMS; hist++) {
+        for (u32i bucket = 0; bucket < BUCKETS; bucket++) reg.retired.hist[hist][bucket].fetch_add(blk->hist[hist][bucket].load(memory_order_relaxed), memory_order_relaxed);
+    }
+    for (size_t idx = 0; idx < reg.live.size(); idx++) {
+        if (reg.live[idx] == blk) {
+            reg.live[idx] = reg.live.back();
+            reg.live.pop_back();
+            break;
+        }
+    }
+    delete blk;
+}
+
+bool statmnp::enabled() {
+    return true;
+}
+
+bool statmnp::latency() {
+#ifdef GIA_STATS_LATENCY
+    return true;
+#else
+    return false;
+#endif
+}
+
+stat_snapshot statmnp::snapshot() {
+    stat_snapshot ret;
+    stat_registry &reg = registry();
+    lock_guard<mutex> guard(reg.lock);
+    add(&ret, reg.retired);
+    add(&ret, reg.spare);
+    for (auto && blk : reg.live) add(&ret, *blk);
+    ret.threads = u32i(reg.live.size());
+    return ret;
+}
+
+void statmnp::reset() {
+    stat_registry &reg = registry();
+    lock_guard<mutex> guard(reg.lock);
+    zero(&reg.retired);
+    zero(&reg.spare);
+    for (auto && blk : reg.live) zero(blk);
+}
+
+#else // GIA_STATS
+
+bool statmnp::enabled() {
+    return false;
+}
+
+bool statmnp::latency() {
+    return false;
+}
+
+stat_snapshot statmnp::snapshot() {
+    return stat_snapshot();
+}
+
+void statmnp::reset() {
+}
+
+#endif // GIA_STATS
@@ -0,0 +1,92 @@
+#ifndef GIA_STATS_H
+#define GIA_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include "gia_ipmnp.h"
+
+using namespace std;
+
+// hot-path counters of parsers, formatters and lookups : compiled in only with -DGIA_STATS,
+// latency histograms need -DGIA_STATS_LATENCY as well, without switches macros below expand to nothing
+
+struct stat_snapshot;
+
+class statmnp {
+public:
+    enum enCounter : u32i {
+        V4_Parse, V4_FailLength, V4_FailSymbol, V4_FailDots, V4_FailOctet, V4_FailMask,
+        V6_Parse, V6_Embedded4, V6_FailLength, V6_FailColons, V6_FailDots, V6_FailSymbol, V6_FailEmbedded4, V6_FailHextets, V6_FailMask,
+        MAC_Parse, MAC_FailLength, MAC_FailGroup, MAC_FailSymbol, MAC_FailSeparator, MAC_FailMemory,
+        V4_Format, V6_Format, V6_FormatEmbedded4, MAC_Format,
+        PfxDB_Lookup, PfxDB_Miss, OUI_Lookup, OUI_Miss, FDB_Lookup, FDB_Miss, FDB_Probes,
+        COUNTERS
+    };
+    enum enHist : u32i {H_V4_Parse, H_V6_Parse, H_MAC_Parse, H_V4_Format, H_V6_Format, H_MAC_Format, H_PfxDB_Lookup, H_OUI_Lookup, H_FDB_Lookup, HISTOGRAMS};
+    static constexpr u32i BUCKETS {32}; // bucket 0 - below 2 ns, bucket i - [2^i, 2^(i+1)) ns, last one is open
+    static const char* name(enCounter cnt);
+    static const char* name(enHist hist);
+    static bool enabled(); // library was compiled with GIA_STATS
+    static bool latency(); // and with GIA_STATS_LATENCY
+    static stat_snapshot snapshot(); // all zeroes if GIA_STATS is off
+    static void reset(); // increments made by other threads at the same moment may be lost
+#ifdef GIA_STATS
+    struct alignas(64) stat_block { // one per thread, own cache lines, written only by owner
+        atomic<u64i> cnt[COUNTERS];
+        atomic<u64i> hist[HISTOGRAMS][BUCKETS];
+    };
+    static void bump(enCounter cnt, u64i val = 1) { // plain load and store : no other thread writes this block
+        atomic<u64i> &ctr = local().cnt[cnt];
+        ctr.store(ctr.load(memory_order_relaxed) + val, memory_order_relaxed);
+    };
+    static void record(enHist hist, u64i ns) {
+        u32i bucket = (ns < 2) ? 0 : min(BUCKETS - 1, u32i(63 - __builtin_clzll(ns)));
+        atomic<u64i> &ctr = local().hist[hist][bucket];
+        ctr.store(ctr.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    };
+    static u64i now_ns() { return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(); };
+private:
+    static inline const char EX_LOW_MEM[] = {"func statmnp::holder() says: not enough memory."};
+    struct holder { // registers block of thread on first use, folds it into retired totals on thread exit
+        stat_block *blk;
+        holder();
+        ~holder();
+    };
+    static stat_block& local() { thread_local holder hld; return *hld.blk; };
+#endif
+};
+
+struct stat_snapshot { // totals over live and finished threads
+    u64i counters[statmnp::COUNTERS] {};
+    u64i hist[statmnp::HISTOGRAMS][statmnp::BUCKETS] {};
+    u32i threads {0}; // live threads which touched counters
+    u64i operator[](statmnp::enCounter cnt) const { return counters[cnt]; };
+    u64i calls(statmnp::enHist hist) const; // timed calls
+    u64i quantile(statmnp::enHist hist, double q) const; // upper bound of bucket in ns, e.g. q = 0.99
+};
+
+#ifdef GIA_STATS
+#define GIA_COUNT(cnt) statmnp::bump(statmnp::cnt)
+#define GIA_COUNT_N(cnt, n) statmnp::bump(statmnp::cnt, (n))
+#define GIA_COUNT_IF(cnt, cond) statmnp::bump(statmnp::cnt, (cond) ? 1 : 0)
+#else
+#define GIA_COUNT(cnt) ((void)0)
+#define GIA_COUNT_N(cnt, n) ((void)0)
+#define GIA_COUNT_IF(cnt, cond) ((void)0)
+#endif
+#define GIA_FAIL(cnt) (GIA_COUNT(cnt), false) // return GIA_FAIL(reason);
+
+#if defined(GIA_STATS) && defined(GIA_STATS_LATENCY)
+class Stat_Timer { // scope latency into histogram
+    statmnp::enHist hist;
+    u64i start;
+public:
+    Stat_Timer(statmnp::enHist _hist) : hist(_hist), start(statmnp::now_ns()) {};
+    ~Stat_Timer() { statmnp::record(hist, statmnp::now_ns() - start); };
+};
+#define GIA_TIMER(hist) Stat_Timer gia_timer_##hist {statmnp::hist}
+#else
+#define GIA_TIMER(hist) ((void)0)
+#endif
+
+#endif // GIA_STATS_H
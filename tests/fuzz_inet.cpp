@@ -0,0 +1,246 @@
+// differential fuzzing of v4mnp / v6mnp parsers and formatters against glibc inet_pton() / inet_ntop()
+// usage : gia_fuzz_inet [--iters n] [--seed n] [--verbose]
+// built with -DGIA_LIBFUZZER (clang -fsanitize=fuzzer) main() is replaced by LLVMFuzzerTestOneInput()
+//
+// intentional divergences from glibc, counted but not treated as failures :
+//   parse.v4_leading_zero - "010.1.2.3", "::ffff:1.2.3.04" : octet with leading zeros is read as decimal, glibc refuses it
+//   parse.v6_single_zero  - "1:2:3:4:5:6:7::" : "::" in place of exactly one zero hextet is refused (RFC 5952 4.2.2), glibc accepts it
+//   format.v6_dotted_tail - "1::ffff:1.2.3.4" : dotted tail is printed whenever sixth hextet is ffff and show_ipv4 is set,
+//                           glibc does it for ::ffff:0:0/96 only
+//   format.v6_compat      - "::102:304" : deprecated IPv4-compatible ::/96 is printed as hextets, glibc prints "::1.2.3.4"
+// everything else is failure : different verdict or value of parsers, to_str() of any view not read back by both parsers,
+// IPv4 text or IETF view of IPv6 not equal to inet_ntop() outside of divergences above
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <map>
+#include <random>
+#include "../gia_ipmnp.h"
+
+using namespace std;
+
+struct fuzz_state {
+    u64i checks {0}, failures {0};
+    map<string, u64i> divergences;
+    bool verbose {false};
+};
+
+static fuzz_state state;
+
+static void fail(const char *what, const string &input, const string &detail) {
+    state.failures++;
+    if ((state.failures <= 20) || state.verbose) cerr << "FAIL " << what << " [" << input << "] " << detail << endl;
+}
+
+static void diverge(const char *what, const string &input) {
+    state.divergences[what]++;
+    if (state.verbose) cerr << "diverge " << what << " [" << input << "]" << endl;
+}
+
+static string strip_zeros(const string &str) { // drops leading zeros of every dotted octet : "010.1.002.0" -> "10.1.2.0"
+    string ret;
+    size_t tail = str.rfind(':');
+    tail = (tail == string::npos) ? 0 : tail + 1;
+    ret = str.substr(0, tail);
+    for (size_t idx = tail; idx < str.size(); idx++) {
+        bool octStart = (idx == tail) || (str[idx - 1] == '.');
+        if (octStart) {
+            while ((str[idx] == '0') && (idx + 1 < str.size()) && isdigit(u8i(str[idx + 1]))) idx++;
+        }
+        ret.push_back(str[idx]);
+    }
+    return ret;
+}
+
+static string fill_single(const string &str) { // "::" written as explicit zero hextet : "1:2:3:4:5:6:7::" -> "1:2:3:4:5:6:7:0"
+    size_t pos = str.find("::");
+    if ((pos == string::npos) || (str.size() == 2)) return str;
+    if (pos == 0) return "0" + str.substr(1);
+    if (pos + 2 == str.size()) return str.substr(0, pos + 1) + "0";
+    return str.substr(0, pos) + ":0:" + str.substr(pos + 2);
+}
+
+static void diff_parse_v4(const string &str) {
+    state.checks++;
+    IPv4_Addr gia;
+    in_addr libc;
+    bool giaOk = v4mnp::valid_addr(str, &gia);
+    bool libcOk = (inet_pton(AF_INET, str.c_str(), &libc) == 1);
+    if (giaOk && libcOk) {
+        if (gia() != ntohl(libc.s_addr)) fail("v4 value", str, gia.to_str());
+    } else if (giaOk) {
+        string plain = strip_zeros(str);
+        if ((plain != str) && (inet_pton(AF_INET, plain.c_str(), &libc) == 1) && (gia() == ntohl(libc.s_addr))) diverge("parse.v4_leading_zero", str);
+        else fail("v4 accepted, glibc refused", str, gia.to_str());
+    } else if (libcOk) {
+        fail("v4 refused, glibc accepted", str, "");
+    }
+}
+
+static void diff_parse_v6(const string &str) {
+    state.checks++;
+    IPv6_Addr gia;
+    u8i libc[16], wire[16];
+    bool giaOk = v6mnp::valid_addr(str, &gia);
+    bool libcOk = (inet_pton(AF_INET6, str.c_str(), libc) == 1);
+    if (giaOk) gia.to_wire(wire);
+    if (giaOk && libcOk) {
+        if (memcmp(wire, libc, 16)) fail("v6 value", str, gia.to_str(v6mnp::IETF_VIEW));
+    } else if (giaOk) {
+        string plain = strip_zeros(str);
+        if ((plain != str) && (inet_pton(AF_INET6, plain.c_str(), libc) == 1) && !memcmp(wire, libc, 16)) diverge("parse.v4_leading_zero", str);
+        else fail("v6 accepted, glibc refused", str, gia.to_str(v6mnp::IETF_VIEW));
+    } else if (libcOk) {
+        IPv6_Addr filled;
+        if (v6mnp::valid_addr(fill_single(str), &filled) && (filled == IPv6_Addr::from_wire(libc))) diverge("parse.v6_single_zero", str);
+        else fail("v6 refused, glibc accepted", str, "");
+    }
+}
+
+static void diff_format_v4(IPv4_Addr ip) {
+    state.checks++;
+    u8i wire[4];
+    char libc[INET_ADDRSTRLEN];
+    ip.to_wire(wire);
+    inet_ntop(AF_INET, wire, libc, sizeof(libc));
+    string gia = ip.to_str();
+    if (gia != libc) fail("v4 to_str", gia, libc);
+    IPv4_Addr back;
+    if (!v4mnp::valid_addr(gia, &back) || (back != ip)) fail("v4 round trip", gia, "");
+}
+
+static void diff_format_v6(IPv6_Addr ip) {
+    u8i wire[16], back[16];
+    char libc[INET6_ADDRSTRLEN];
+    ip.to_wire(wire);
+    inet_ntop(AF_INET6, wire, libc, sizeof(libc));
+    u16i xtt[8];
+    for (u32i idx = 0; idx < 8; idx++) xtt[idx] = (wire[idx * 2] << 8) | wire[idx * 2 + 1];
+    bool compat = !(xtt[0] | xtt[1] | xtt[2] | xtt[3] | xtt[4] | xtt[5]) && xtt[6];
+    bool mapped = !(xtt[0] | xtt[1] | xtt[2] | xtt[3] | xtt[4]) && (xtt[5] == 0xFFFF);
+    for (u32i tail = 0; tail < 2; tail++) {
+        if (tail) ip.setflag_show_ipv4();
+        else ip.unsetflag_show_ipv4();
+        for (u32i fmt = 0; fmt <= v6mnp::FULL_VIEW; fmt++) { // every combination of view flags
+            state.checks++;
+            string gia = ip.to_str(fmt);
+            IPv6_Addr parsed;
+            if (!v6mnp::valid_addr(gia, &parsed) || (parsed != ip)) fail("v6 round trip", gia, "view " + to_string(fmt));
+            if ((inet_pton(AF_INET6, gia.c_str(), back) != 1) || memcmp(wire, back, 16)) fail("v6 read by glibc", gia, "view " + to_string(fmt));
+            if (fmt != v6mnp::IETF_VIEW) continue;
+            if (gia == libc) continue;
+            if (compat) diverge("format.v6_compat", gia);
+            else if (!tail && mapped) continue; // dotted tail switched off on purpose
+            else if (tail && (xtt[5] == 0xFFFF) && !mapped) diverge("format.v6_dotted_tail", gia);
+            else fail("v6 to_str", gia, libc);
+        }
+    }
+}
+
+// random generators : structured values with many zero and ffff hextets, text made of plausible pieces and mutated
+
+static string gen_dec(mt19937_64 &rng) {
+    switch (rng() % 10) {
+        case 0: return "0" + to_string(rng() % 100);
+        case 1: return "00" + to_string(rng() % 10);
+        case 2: return to_string(rng() % 1000);
+        case 3: return "";
+        default: return to_string(rng() % 256);
+    }
+}
+
+static string gen_v4(mt19937_64 &rng) {
+    string ret;
+    u32i octets = (rng() % 10) ? 4 : 3 + rng() % 3;
+    for (u32i idx = 0; idx < octets; idx++) {
+        if (idx) ret.push_back('.');
+        ret += gen_dec(rng);
+    }
+    return ret;
+}
+
+static string gen_v6(mt19937_64 &rng) {
+    const char digits[] = "0123456789abcdefABCDEF";
+    string ret;
+    u32i hextets = rng() % 10, dbl = (rng() % 3) ? u32i(rng() % (hextets + 1)) : 100;
+    for (u32i idx = 0; idx < hextets; idx++) {
+        if (idx == dbl) ret += "::";
+        else if (idx) ret.push_back(':');
+        u32i len = 1 + rng() % ((rng() % 8) ? 4 : 6);
+        for (u32i dig = 0; dig < len; dig++) ret.push_back(digits[rng() % (sizeof(digits) - 1)]);
+    }
+    if (dbl == hextets) ret += "::";
+    if (rng() % 5 == 0) {
+        if (ret.empty() || (ret.back() != ':')) ret.push_back(':');
+        ret += gen_v4(rng);
+    }
+    return ret;
+}
+
+static string mutate(string str, mt19937_64 &rng) {
+    const char junk[] = " %g.:x0-/\t";
+    if (str.empty()) return str;
+    size_t pos = rng() % str.size();
+    switch (rng() % 12) {
+        case 0: str.insert(pos, 1, junk[rng() % (sizeof(junk) - 1)]); break;
+        case 1: str.erase(pos, 1); break;
+        case 2: str[pos] = junk[rng() % (sizeof(junk) - 1)]; break;
+    }
+    return str;
+}
+
+static IPv6_Addr gen_value(mt19937_64 &rng) {
+    u64i xtt[8];
+    for (auto && val : xtt) {
+        u32i kind = rng() % 6;
+        val = (kind < 3) ? 0 : (kind == 3) ? 0xFFFF : rng() & 0xFFFF;
+    }
+    return IPv6_Addr((xtt[0] << 48) | (xtt[1] << 32) | (xtt[2] << 16) | xtt[3], (xtt[4] << 48) | (xtt[5] << 32) | (xtt[6] << 16) | xtt[7]);
+}
+
+static void one_input(const string &str) { // whatever text : both parsers, then formatters on what was accepted
+    diff_parse_v4(str);
+    diff_parse_v6(str);
+    IPv4_Addr ip4;
+    IPv6_Addr ip6;
+    if (v4mnp::valid_addr(str, &ip4)) diff_format_v4(ip4);
+    if (v6mnp::valid_addr(str, &ip6)) diff_format_v6(ip6);
+}
+
+#ifdef GIA_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const u8i *data, size_t size) {
+    one_input(string(reinterpret_cast<const char*>(data), size));
+    if (state.failures) abort(); // libFuzzer keeps the crashing input
+    return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+    u64i iters {1000000}, seed {1};
+    for (int idx = 1; idx < argc; idx++) {
+        string arg = argv[idx];
+        bool more = (idx + 1 < argc);
+        if ((arg == "--iters") && more) iters = atoll(argv[++idx]);
+        else if ((arg == "--seed") && more) seed = atoll(argv[++idx]);
+        else if (arg == "--verbose") state.verbose = true;
+        else {
+            cerr << "usage : " << argv[0] << " [--iters n] [--seed n] [--verbose]" << endl;
+            return 2;
+        }
+    }
+    mt19937_64 rng(seed);
+    for (u64i iter = 0; iter < iters; iter++) {
+        diff_format_v4(IPv4_Addr(u32i(rng())));
+        diff_format_v6(gen_value(rng));
+        one_input(mutate(gen_v4(rng), rng));
+        one_input(mutate(gen_v6(rng), rng));
+    }
+    cout << "checks      " << state.checks << endl;
+    for (auto && div : state.divergences) cout << "divergence  " << div.first << " " << div.second << endl;
+    cout << "failures    " << state.failures << endl;
+    return state.failures ? 1 : 0;
+}
+
+#endif // GIA_LIBFUZZER
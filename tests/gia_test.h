@@ -0,0 +1,45 @@
+#ifndef GIA_TEST_H
+#define GIA_TEST_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../gia_ipcol.h"
+
+using namespace std;
+
+// minimal self-contained test registry : GIA_TEST defines and registers case, CHECK records failure and goes on
+struct test_case {
+    const char *name;
+    void (*func)();
+};
+
+vector<test_case>& test_registry();
+bool test_register(const char *name, void (*func)());
+void test_fail(const char *file, int line, const string &what);
+
+#define GIA_TEST(name) \
+    static void name(); \
+    static const bool name##_reg = test_register(#name, name); \
+    static void name()
+
+#define CHECK(cond) do { if (!(cond)) test_fail(__FILE__, __LINE__, #cond); } while (0)
+#define CHECK_EQ(left, right) do { \
+    auto &&_lv = (left); auto &&_rv = (right); \
+    if (!(_lv == _rv)) test_fail(__FILE__, __LINE__, string(#left " == " #right " : ") + test_show(_lv) + " != " + test_show(_rv)); \
+} while (0)
+
+inline string test_show(const string &val) { return "\"" + val + "\""; }
+inline string test_show(const char *val) { return "\"" + string(val) + "\""; }
+inline string test_show(bool val) { return val ? "true" : "false"; }
+template <class T> string test_show(const T &val) { return to_string(val); }
+
+// batch kernels are checked at every SIMD level the CPU has, level without own kernel falls back to lower one
+template <class F> void each_level(F &&func) {
+    for (auto lvl : {colmnp::Scalar, colmnp::AVX2, colmnp::AVX512}) {
+        if (colmnp::set_level(lvl)) func();
+    }
+    colmnp::reset_level();
+}
+
+#endif // GIA_TEST_H
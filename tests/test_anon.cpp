@@ -0,0 +1,60 @@
+#include <random>
+#include "gia_test.h"
+#include "../gia_anon.h"
+#include "../gia_ipcol.h"
+
+using namespace std;
+
+static const u8i PAN_KEY[anonmnp::KEY_SIZE] {21, 34, 23, 141, 51, 164, 207, 128, 19, 10, 91, 22, 73, 144, 125, 16,
+                                             216, 152, 143, 131, 121, 121, 101, 39, 98, 87, 76, 45, 42, 132, 34, 2}; // key of Crypto-PAn sample
+
+GIA_TEST(anon_cryptopan_v4) { // rows of reference sample trace
+    const struct { const char *raw, *anon; } rows[] = {
+        {"128.11.68.132", "135.242.180.132"}, {"129.118.74.4", "134.136.186.123"}, {"130.132.252.244", "133.68.164.234"},
+        {"141.223.7.43", "141.167.8.160"}, {"192.102.249.13", "252.138.62.131"}, {"24.0.250.221", "100.15.198.226"},
+        {"4.3.88.225", "124.60.155.63"}, {"64.14.118.196", "0.255.183.58"}, {"207.25.71.27", "241.33.119.156"}};
+    each_level([&]() {
+        for (u32i bits : {0u, 16u, 24u}) {
+            Anon_PAn pan(PAN_KEY, bits);
+            CHECK_EQ(pan.last_err(), anonmnp::NoError);
+            for (auto && row : rows) CHECK_EQ(pan.anonymize(IPv4_Addr(row.raw)).to_str(), string(row.anon));
+        }
+    });
+    Anon_PAn bad(PAN_KEY, 30);
+    CHECK_EQ(bad.last_err(), anonmnp::BadCacheBits);
+}
+
+static u32i common_bits(u64i a, u64i b, u32i width) { return (a == b) ? width : __builtin_clzll(a ^ b) - (64 - width); }
+
+GIA_TEST(anon_prefix_preserving) {
+    mt19937_64 rng(49);
+    vector<IPv4_Addr> v4(300), v4Out(300);
+    vector<IPv6_Addr> v6(100), v6Out(100), v6Scalar(100);
+    vector<MAC_Addr> mac(100), macOut(100);
+    for (size_t idx = 0; idx < v4.size(); idx++) v4[idx] = IPv4_Addr(u32i((idx % 3) ? rng() : 0xC0A80000 | (rng() & 0xFFFF)));
+    for (size_t idx = 0; idx < v6.size(); idx++) v6[idx] = IPv6_Addr((idx % 2) ? rng() : 0x20010DB800000000ull | (rng() & 0xFFFF), rng());
+    for (size_t idx = 0; idx < mac.size(); idx++) mac[idx] = MAC_Addr((idx % 2) ? rng() : 0x001A2B000000ull | (rng() & 0xFFFFFF));
+    Anon_PAn pan(PAN_KEY);
+    pan.anonymize(v4.data(), v4.size(), v4Out.data());
+    pan.anonymize(v6.data(), v6.size(), v6Out.data());
+    pan.anonymize(mac.data(), mac.size(), macOut.data());
+    for (size_t idx = 1; idx < v4.size(); idx++) {
+        CHECK(v4Out[idx] == pan.anonymize(v4[idx]));
+        CHECK_EQ(common_bits(v4Out[idx](), v4Out[idx - 1](), 32), common_bits(v4[idx](), v4[idx - 1](), 32));
+    }
+    for (size_t idx = 1; idx < v6.size(); idx++) {
+        u32i same = common_bits(v6[idx]().ms, v6[idx - 1]().ms, 64), got = common_bits(v6Out[idx]().ms, v6Out[idx - 1]().ms, 64);
+        if (same == 64) { same += common_bits(v6[idx]().ls, v6[idx - 1]().ls, 64); got = (got < 64) ? got : 64 + common_bits(v6Out[idx]().ls, v6Out[idx - 1]().ls, 64); }
+        CHECK_EQ(got, same);
+    }
+    for (size_t idx = 0; idx < mac.size(); idx++) {
+        CHECK_EQ(macOut[idx].get_oui(), mac[idx].get_oui());
+        if (idx) CHECK_EQ(common_bits(macOut[idx](), macOut[idx - 1](), 48), common_bits(mac[idx](), mac[idx - 1](), 48));
+    }
+    colmnp::set_level(colmnp::Scalar); // portable AES gives the same mapping
+    Anon_PAn soft(PAN_KEY, 8, 0);
+    soft.anonymize(v6.data(), v6.size(), v6Scalar.data());
+    colmnp::reset_level();
+    for (size_t idx = 0; idx < v6.size(); idx++) CHECK(v6Scalar[idx] == v6Out[idx]);
+    CHECK(!(pan.anonymize(v6[0]) == v6[0]) && (pan.anonymize(v6[0]) == v6Out[0]));
+}
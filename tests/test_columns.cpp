@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipcol.h"
+
+using namespace std;
+
+// batch kernels are checked against scalar predicates at every level the CPU has
+
+static bool bit_of(const vector<u64i> &bits, size_t row) { return (bits[row / 64] >> (row % 64)) & 1; }
+
+GIA_TEST(ipcol_v4_select) {
+    mt19937 rng(1);
+    IPv4Column col;
+    const u32i special[] = {0x0A000001, 0xAC100001, 0xC0A80101, 0x7F000001, 0xA9FE0101, 0xE0000001, 0x64400001, 0xF0000001, 0xC6120001, 0xFFFFFFFF};
+    for (u32i idx = 0; idx < 1000; idx++) col.push_back(IPv4_Addr((idx % 3) ? u32i(rng()) : special[idx % 10] + (rng() & 0xFF)));
+    each_level([&]() {
+        vector<u64i> bits;
+        CHECK(col.select(colmnp::V4_Private, &bits));
+        for (size_t row = 0; row < col.size(); row++) CHECK_EQ(bit_of(bits, row), col.at(row).is_private());
+        CHECK(col.select(colmnp::V4_Mcast, &bits));
+        for (size_t row = 0; row < col.size(); row++) CHECK_EQ(bit_of(bits, row), col.at(row).is_mcast());
+        CHECK(col.in_prefix(IPv4_Addr(10, 0, 0, 0), 8, &bits));
+        for (size_t row = 0; row < col.size(); row++) CHECK_EQ(bit_of(bits, row), (col.at(row)() >> 24) == 10);
+    });
+}
+
+GIA_TEST(ipcol_v6_select) {
+    mt19937_64 rng(5);
+    IPv6Column col;
+    const char *special[] = {"::", "::1", "2001:db8::1", "2400:cb00::1", "3fff::1", "201f:ffff::1", "ff02::1", "fd00::1", "fe80::1", "::ffff:1.2.3.4",
+                             "::1:ffff:1.2.3.4", "64:ff9b::1.2.3.4", "64:ff9b:0:0:1::", "2001::1", "2002:c000:204::1", "febf::1", "fec0::1"};
+    for (u32i idx = 0; idx < 1000; idx++) {
+        IPv6_Addr ip = (idx % 3) ? IPv6_Addr(rng(), rng()) : IPv6_Addr(special[idx % size(special)]);
+        if ((idx % 3 == 0) && (idx > size(special) * 3)) ip = IPv6_Addr(ip().ms ^ (rng() & 0xFFFF), ip().ls ^ (rng() & 0xFFFF)); // near the prefixes
+        col.push_back(ip);
+    }
+    using pred = bool (IPv6_Addr::*)() const;
+    const pair<colmnp::enV6Class,pred> classes[] {
+        {colmnp::V6_Unspec, &IPv6_Addr::is_unspec}, {colmnp::V6_Loopback, &IPv6_Addr::is_loopback}, {colmnp::V6_GlobUcast, &IPv6_Addr::is_glob_ucast},
+        {colmnp::V6_Mcast, &IPv6_Addr::is_mcast}, {colmnp::V6_UniqLocal, &IPv6_Addr::is_uniq_local}, {colmnp::V6_LinkLocal, &IPv6_Addr::is_link_local},
+        {colmnp::V6_MappedIPv4, &IPv6_Addr::is_mapped_ipv4}, {colmnp::V6_WknownPfx, &IPv6_Addr::is_wknown_pfx}, {colmnp::V6_Teredo, &IPv6_Addr::is_teredo},
+        {colmnp::V6_Docum, &IPv6_Addr::is_docum}, {colmnp::V6_6to4, &IPv6_Addr::is_6to4},
+    };
+    each_level([&]() {
+        vector<u64i> bits;
+        for (auto && cls : classes) {
+            CHECK(col.select(cls.first, &bits));
+            size_t bad {0};
+            for (size_t row = 0; row < col.size(); row++) bad += bit_of(bits, row) != (col.at(row).*cls.second)();
+            CHECK_EQ(bad, size_t(0));
+        }
+    });
+}
+
+GIA_TEST(ipcol_v6_range) {
+    mt19937_64 rng(2);
+    IPv6Column col;
+    for (u32i idx = 0; idx < 777; idx++) col.push_back(IPv6_Addr(0x20010DB800000000ull | (rng() & 0xFF), rng()));
+    IPv6_Addr low(0x20010DB800000010ull, 0), high(0x20010DB800000080ull, ~0ull);
+    each_level([&]() {
+        vector<u64i> bits;
+        CHECK(col.in_range(low, high, &bits));
+        for (size_t row = 0; row < col.size(); row++) CHECK_EQ(bit_of(bits, row), (col.at(row) >= low) && (col.at(row) <= high));
+    });
+}
@@ -0,0 +1,62 @@
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipmnp.h"
+
+using namespace std;
+
+GIA_TEST(eui64_single) {
+    MAC_Addr mac(0x001A2B3C4D5Eull);
+    CHECK_EQ(v6mnp::eui64_iid(mac), 0x021A2BFFFE3C4D5Eull);
+    CHECK_EQ(v6mnp::gen_eui64(IPv6_Addr("2001:db8:1:2::"), mac).to_str(v6mnp::IETF_VIEW), string("2001:db8:1:2:21a:2bff:fe3c:4d5e"));
+    CHECK_EQ(v6mnp::gen_link_local(MAC_Addr(0x021A2B3C4D5Eull)).to_str(v6mnp::IETF_VIEW), string("fe80::1a:2bff:fe3c:4d5e")); // local bit is inverted, not set
+    MAC_Addr back;
+    CHECK(macmnp::from_eui64(v6mnp::gen_eui64(IPv6_Addr("2001:db8::"), mac), &back) && (back == mac));
+    CHECK(macmnp::from_eui64(IPv6_Addr("fe80::1a:2bff:fe3c:4d5e"), &back) && (back() == 0x021A2B3C4D5Eull));
+    CHECK(!macmnp::from_eui64(IPv6_Addr("fe80::1"), &back) && (back() == 0));
+}
+
+GIA_TEST(eui64_batch) {
+    mt19937_64 rng(47);
+    const size_t rows {77};
+    vector<MAC_Addr> macs(rows);
+    for (auto && mac : macs) mac = MAC_Addr(rng());
+    macs[3] = MAC_Addr(0x020000000000ull); // interface id with zero MAC bytes after inversion
+    IPv6_Addr prefix(0x20010DB8AAAA0001ull, 0x123);
+    vector<IPv6_Addr> addrs(rows);
+    v6mnp::gen_eui64(prefix, macs.data(), rows, addrs.data());
+    for (size_t row = 0; row < rows; row++) CHECK(addrs[row] == v6mnp::gen_eui64(prefix, macs[row]));
+    v6mnp::gen_link_local(macs.data(), rows, addrs.data());
+    CHECK(addrs[9] == v6mnp::gen_link_local(macs[9]));
+    addrs[5] = IPv6_Addr("fe80::1234"); // not EUI-64
+    vector<MAC_Addr> back(rows);
+    CHECK_EQ(macmnp::from_eui64(addrs.data(), rows, back.data()), rows - 1);
+    for (size_t row = 0; row < rows; row++) CHECK_EQ(back[row](), (row == 5) ? 0 : macs[row]());
+    vector<u8i> macWire(rows * 6), want(rows * 16), v6Wire(rows * 16);
+    for (size_t row = 0; row < rows; row++) {
+        macs[row].to_wire(&macWire[row * 6]);
+        v6mnp::gen_eui64(prefix, macs[row]).to_wire(&want[row * 16]);
+        addrs[row].to_wire(&v6Wire[row * 16]);
+    }
+    each_level([&]() {
+        vector<u8i> out(rows * 16), macOut(rows * 6, 0xAA);
+        v6mnp::gen_eui64_wire(prefix, macWire.data(), rows, out.data());
+        CHECK(out == want);
+        CHECK_EQ(macmnp::from_eui64_wire(v6Wire.data(), rows, macOut.data()), rows - 1);
+        for (size_t row = 0; row < rows; row++) CHECK_EQ(MAC_Addr::from_wire(&macOut[row * 6])(), back[row]());
+    });
+}
+
+GIA_TEST(mcast_mac_batch) {
+    mt19937 rng(48);
+    vector<IPv4_Addr> v4;
+    vector<IPv6_Addr> v6;
+    for (u32i idx = 0; idx < 40; idx++) {
+        v4.push_back(IPv4_Addr(0xE0000000 | (u32i(rng()) & 0x0FFFFFFF)));
+        v6.push_back(IPv6_Addr(0xFF02000000000000ull, 0x00000001FF000000ull | (rng() & 0xFFFFFF)));
+    }
+    vector<MAC_Addr> out(40);
+    macmnp::gen_mcast(v4.data(), v4.size(), out.data());
+    for (size_t idx = 0; idx < v4.size(); idx++) CHECK(out[idx] == macmnp::gen_mcast(v4[idx]));
+    macmnp::gen_mcast(v6.data(), v6.size(), out.data());
+    for (size_t idx = 0; idx < v6.size(); idx++) CHECK(out[idx] == macmnp::gen_mcast(v6[idx]));
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "gia_test.h"
+#include "../gia_fdb.h"
+
+using namespace std;
+
+static size_t home_of(u64i mac, u16i vlan, size_t mask) { // same hash as MAC_FDB, table with one shard
+    return hashmnp::fold(fdbmnp::to_key(MAC_Addr(mac), vlan) ^ hashmnp::K1, hashmnp::K2) & mask;
+}
+
+GIA_TEST(fdb_learn_codes) {
+    MAC_FDB fdb {1000, 2};
+    CHECK(fdb.valid());
+    vector<tuple<u64i,u16i,u32i,u32i>> moves;
+    fdb.set_move_func([&moves](const MAC_Addr &mac, u16i vlan, u32i from, u32i to) { moves.emplace_back(mac(), vlan, from, to); });
+    MAC_Addr mac(0x001A2B3C4D5Eull);
+    CHECK_EQ(fdb.learn(mac, 10, 1, 100), fdbmnp::Learned);
+    CHECK_EQ(fdb.learn(mac, 10, 1, 101), fdbmnp::Refreshed);
+    CHECK_EQ(fdb.learn(mac, 20, 2, 101), fdbmnp::Learned); // other VLAN is other entry
+    CHECK_EQ(fdb.learn(mac, 0x100A, 3, 102), fdbmnp::Moved); // VLAN is 12 bits
+    CHECK_EQ(moves.size(), size_t(1));
+    CHECK(moves[0] == make_tuple(u64i(0x001A2B3C4D5Eull), u16i(10), 1u, 3u));
+    u32i port {0};
+    CHECK(fdb.lookup(mac, 10, &port) && (port == 3));
+    CHECK(fdb.lookup(mac, 20, &port) && (port == 2));
+    CHECK(!fdb.lookup(mac, 30, &port) && (port == 2));
+    CHECK(fdb.lookup(mac, 20, nullptr));
+    CHECK_EQ(fdb.size(), size_t(2));
+    fdb.set_move_func(nullptr);
+    CHECK_EQ(fdb.learn(mac, 10, 4, 103), fdbmnp::Moved);
+    CHECK_EQ(moves.size(), size_t(1));
+    CHECK(fdb.remove(mac, 10) && !fdb.remove(mac, 10));
+    CHECK(!fdb.lookup(mac, 10, &port) && (fdb.size() == 1));
+}
+
+GIA_TEST(fdb_table_full) {
+    MAC_FDB fdb {12, 0}; // one shard of 16 slots, 3/4 of them usable
+    CHECK_EQ(fdb.capacity(), size_t(12));
+    for (u32i idx = 0; idx < 12; idx++) CHECK_EQ(fdb.learn(MAC_Addr(0x020000000000ull + idx), 1, idx, 0), fdbmnp::Learned);
+    CHECK_EQ(fdb.learn(MAC_Addr(0x020000000100ull), 1, 1, 0), fdbmnp::TableFull);
+    CHECK_EQ(fdb.learn(MAC_Addr(0x020000000005ull), 1, 5, 1), fdbmnp::Refreshed); // known entries still work
+    CHECK_EQ(fdb.learn(MAC_Addr(0x020000000005ull), 1, 9, 1), fdbmnp::Moved);
+    CHECK_EQ(fdb.size(), size_t(12));
+    CHECK(fdb.remove(MAC_Addr(0x020000000000ull), 1));
+    CHECK_EQ(fdb.learn(MAC_Addr(0x020000000100ull), 1, 1, 0), fdbmnp::Learned);
+    CHECK(!fdb.lookup(MAC_Addr(0x020000000200ull), 1, nullptr)); // full table still ends probe
+}
+
+GIA_TEST(fdb_remove_wrapped_chain) {
+    const size_t mask {15};
+    vector<u64i> macs; // three keys at last slot, so chain wraps, then keys at slots 0 and 1
+    for (u64i mac = 0x020000000000ull; macs.size() < 3; mac++) if (home_of(mac, 1, mask) == mask) macs.push_back(mac);
+    for (u64i mac = 0x020000000000ull; macs.size() < 4; mac++) if (home_of(mac, 1, mask) == 0) macs.push_back(mac);
+    for (u64i mac = 0x020000000000ull; macs.size() < 5; mac++) if (home_of(mac, 1, mask) == 1) macs.push_back(mac);
+    vector<u32i> order {0, 1, 2, 3, 4};
+    u32i rounds {0};
+    do { // every order of removal
+        MAC_FDB fdb {12, 0};
+        for (u32i idx = 0; idx < macs.size(); idx++) CHECK_EQ(fdb.learn(MAC_Addr(macs[idx]), 1, idx + 1, 0), fdbmnp::Learned);
+        for (u32i step = 0; step < order.size(); step++) {
+            CHECK(fdb.remove(MAC_Addr(macs[order[step]]), 1));
+            for (u32i rest = step + 1; rest < order.size(); rest++) {
+                u32i port {0};
+                CHECK(fdb.lookup(MAC_Addr(macs[order[rest]]), 1, &port) && (port == order[rest] + 1));
+            }
+            CHECK(!fdb.lookup(MAC_Addr(macs[order[step]]), 1, nullptr));
+            CHECK_EQ(fdb.size(), order.size() - step - 1);
+        }
+        rounds++;
+    } while (next_permutation(order.begin(), order.end()));
+    CHECK_EQ(rounds, 120u);
+}
+
+GIA_TEST(fdb_incremental_aging) {
+    MAC_FDB fdb {1000, 2}; // 4 shards of 512 slots
+    const u32i cnt {600};
+    for (u32i idx = 0; idx < cnt; idx++) CHECK_EQ(fdb.learn(MAC_Addr(0x020000000000ull + idx * 7919), idx % 4095, idx, (idx % 2) ? 1000 : 10), fdbmnp::Learned);
+    CHECK_EQ(fdb.age(1050, 100, 0), size_t(0));
+    size_t removed {0};
+    u32i calls {0};
+    for (; calls < 30; calls++) { // 100 checks per call, whole table is 2048 slots and slot is checked again after removal
+        size_t now = fdb.age(1050, 100, 100);
+        CHECK(now <= 100);
+        removed += now;
+        if ((calls == 0) || (calls == 19)) CHECK(removed < cnt / 2); // sweep goes on from where previous call stopped
+    }
+    CHECK_EQ(removed, size_t(cnt / 2));
+    CHECK_EQ(fdb.size(), size_t(cnt / 2));
+    for (u32i idx = 0; idx < cnt; idx++) CHECK_EQ(fdb.lookup(MAC_Addr(0x020000000000ull + idx * 7919), idx % 4095, nullptr), (idx % 2) == 1);
+    CHECK_EQ(fdb.age(1050, 100, 100000), size_t(0)); // nothing left to age
+    CHECK_EQ(fdb.age(2000, 100, 100000), size_t(cnt / 2)); // budget over whole table
+    CHECK_EQ(fdb.size(), size_t(0));
+}
+
+GIA_TEST(fdb_lookup_during_churn) {
+    MAC_FDB fdb {700, 0}; // one shard of 1024 slots filled to 3/4, so removals shift entries of long chains under readers
+    const u32i stable {300}, churn {450};
+    for (u32i idx = 0; idx < stable; idx++) fdb.learn(MAC_Addr(0x020000000000ull + idx), 1, idx, 0);
+    atomic<bool> done {false};
+    atomic<u64i> misses {0}, wrong {0}, found {0};
+    vector<thread> readers;
+    for (u32i num = 0; num < 2; num++) {
+        readers.emplace_back([&, num]() {
+            for (u32i idx = num; !done.load(memory_order_relaxed); idx = (idx + 1) % stable) {
+                u32i port {~0u};
+                if (!fdb.lookup(MAC_Addr(0x020000000000ull + idx), 1, &port)) misses++;
+                else if (port != idx) wrong++;
+                else found++;
+            }
+        });
+    }
+    for (u32i round = 0; round < 1000; round++) {
+        for (u32i idx = 0; idx < churn; idx++) fdb.learn(MAC_Addr(0x030000000000ull + idx), 2, idx, round);
+        for (u32i idx = 0; idx < stable; idx++) CHECK_EQ(fdb.learn(MAC_Addr(0x020000000000ull + idx), 1, idx, round + 1), fdbmnp::Refreshed);
+        if (round % 2) fdb.age(round + 1, 0, 4096); // only churn entries are older than now
+        else for (u32i idx = 0; idx < churn; idx++) fdb.remove(MAC_Addr(0x030000000000ull + idx), 2);
+    }
+    done = true;
+    for (auto && thr : readers) thr.join();
+    CHECK_EQ(misses.load(), u64i(0));
+    CHECK_EQ(wrong.load(), u64i(0));
+    CHECK(found.load() > 0);
+}
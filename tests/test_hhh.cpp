@@ -0,0 +1,98 @@
+#include <map>
+#include <random>
+#include "gia_test.h"
+#include "../gia_hhh.h"
+
+using namespace std;
+
+static vector<IPv4_Addr> hhh_stream(size_t n, u64i seed) { // 30% one host, 25% spread over 10.1/16, rest random
+    mt19937_64 rng(seed);
+    vector<IPv4_Addr> ret(n);
+    for (auto && ip : ret) {
+        u32i roll = rng() % 100, val = u32i(rng());
+        if (roll < 30) ip = IPv4_Addr(10, 1, 2, 3);
+        else if (roll < 55) ip = IPv4_Addr(0x0A010000 | (val & 0xFFFF));
+        else ip = IPv4_Addr(val);
+    }
+    return ret;
+}
+
+static bool has_item(const vector<hhh_item<IPv4_Addr>> &items, const char *pfx, u32i len) {
+    for (auto && item : items) if ((item.len == len) && (item.prefix == IPv4_Addr(pfx))) return true;
+    return false;
+}
+
+GIA_TEST(hhh_exact_v4) {
+    auto stream = hhh_stream(200000, 48);
+    HHH_Sketch<IPv4_Addr> sketch(256, false);
+    CHECK_EQ(sketch.last_err(), hhhmnp::NoError);
+    sketch.update(stream.data(), stream.size());
+    CHECK_EQ(sketch.count(), u64i(stream.size()));
+    auto items = sketch.query(0.2);
+    CHECK_EQ(items.size(), size_t(2));
+    CHECK(has_item(items, "10.1.2.3", 32));
+    CHECK(has_item(items, "10.1.0.0", 16)); // ~55% in prefix, ~25% without host above
+    CHECK(!has_item(items, "10.0.0.0", 8)); // only what is left of 10.1/16
+    u64i exact {0};
+    for (auto && ip : stream) exact += (ip() == IPv4_Addr(10, 1, 2, 3)());
+    for (auto && item : items) {
+        CHECK(item.lower <= item.upper);
+        if (item.len == 32) CHECK((item.lower <= exact) && (item.upper >= exact));
+    }
+    CHECK(sketch.estimate(IPv4_Addr(10, 1, 200, 7), 16) >= sketch.estimate(IPv4_Addr(10, 1, 2, 3), 32));
+    CHECK_EQ(sketch.estimate(IPv4_Addr(10, 1, 2, 3), 20), u64i(0)); // not a tracked level
+}
+
+GIA_TEST(hhh_sampled_merge) {
+    auto stream = hhh_stream(400000, 49);
+    HHH_Sketch<IPv4_Addr> first(256, true, 1), second(256, true, 2), whole(256, true, 3);
+    first.update(stream.data(), stream.size() / 2);
+    second.update(stream.data() + stream.size() / 2, stream.size() - stream.size() / 2);
+    whole.update(stream.data(), stream.size());
+    CHECK(first.merge(second));
+    CHECK_EQ(first.count(), whole.count());
+    for (auto sketch : {&first, &whole}) {
+        auto items = sketch->query(0.2);
+        CHECK(has_item(items, "10.1.2.3", 32));
+        CHECK(has_item(items, "10.1.0.0", 16));
+        CHECK(!has_item(items, "10.0.0.0", 8));
+    }
+    HHH_Sketch<IPv4_Addr> other({16, 24}, 256);
+    CHECK(!first.merge(other) && (first.last_err() == hhhmnp::Mismatch));
+    HHH_Sketch<IPv4_Addr> bad({24, 16}, 64);
+    CHECK_EQ(bad.last_err(), hhhmnp::BadLevels);
+    CHECK(bad.levels() == hhhmnp::def_levels(IPv4_Addr()));
+}
+
+GIA_TEST(hhh_v6_weighted) {
+    mt19937_64 rng(50);
+    HHH_Sketch<IPv6_Addr> sketch(128, false);
+    vector<IPv6_Addr> ips;
+    vector<u64i> bytes;
+    for (u32i idx = 0; idx < 50000; idx++) {
+        bool attack = (idx % 4 == 0);
+        ips.push_back(attack ? IPv6_Addr(0x20010DB800AA0000ull | (rng() & 0xFFFF), rng()) : IPv6_Addr(rng(), rng()));
+        bytes.push_back(attack ? 1500 : 100);
+    }
+    sketch.update(ips.data(), bytes.data(), ips.size());
+    auto items = sketch.query(0.5);
+    CHECK_EQ(items.size(), size_t(1));
+    CHECK((items.size() == 1) && (items[0].len == 48) && (items[0].prefix == IPv6_Addr("2001:db8:aa::")));
+    CHECK((items.size() == 1) && (items[0].lower <= 12500 * 1500) && (items[0].upper >= 12500 * 1500)); // bounds hold for weighted counts too
+    sketch.clear();
+    CHECK(sketch.query(0.1).empty() && (sketch.count() == 0));
+}
+
+GIA_TEST(hhh_bounds_weighted) { // every prefix, tracked or not, stays under its upper bound
+    mt19937_64 rng(51);
+    HHH_Sketch<IPv4_Addr> sketch({24, 32}, 32, false);
+    map<u32i, u64i> exact;
+    for (u32i idx = 0; idx < 20000; idx++) {
+        IPv4_Addr ip(0xC0000000 | u32i(rng() % 300) | ((idx % 3) ? 0 : 0x100));
+        u64i weight = 1 + rng() % ((idx % 7) ? 3 : 900);
+        sketch.update(ip, weight);
+        exact[ip()] += weight;
+    }
+    for (auto && row : exact) CHECK(sketch.estimate(IPv4_Addr(row.first), 32) >= row.second);
+    for (auto && item : sketch.query(0.0)) if (item.len == 32) CHECK(item.lower <= exact[item.prefix()]);
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "gia_test.h"
+#include "../gia_ingest.h"
+
+using namespace std;
+
+static string mixed_text(u32i cnt) {
+    string text;
+    for (u32i idx = 0; idx < cnt; idx++) {
+        text += (idx % 3 == 0) ? "10.0." + to_string(idx % 250) + ".1" : (idx % 3 == 1) ? "2001:db8::" + to_string(idx % 9000) : "not an address";
+        text += (idx % 7) ? "\n" : "\r\n";
+    }
+    return text;
+}
+
+struct ingest_totals { // what sink has seen
+    vector<u32i> v4;
+    vector<u64i> v6lo;
+    vector<u64i> seqs;
+    u64i lines {0}, bad {0};
+    Ingest_Sink sink() { return [this](const ingest_batch &batch) {
+        v4.insert(v4.end(), batch.v4.data(), batch.v4.data() + batch.v4.size());
+        v6lo.insert(v6lo.end(), batch.v6.data_lo(), batch.v6.data_lo() + batch.v6.size());
+        seqs.push_back(batch.seq);
+        lines += batch.lines;
+        bad += batch.bad;
+        return true;
+    }; };
+};
+
+GIA_TEST(ingest_pipeline_matches_single_chunk) {
+    string text = mixed_text(20000);
+    ingest_opts opts;
+    opts.buffer = 333; // lines cross chunk bounds
+    opts.workers = 2;
+    opts.ordered = true;
+    ingest_batch ref;
+    Ingest_Pipeline::parse_lines(text.data(), text.size(), opts, &ref);
+    ingest_totals got;
+    Ingest_Pipeline pipe(opts, got.sink());
+    istringstream in(text);
+    CHECK(pipe.run(in));
+    CHECK_EQ(got.lines, u64i(ref.lines));
+    CHECK_EQ(got.bad, u64i(ref.bad));
+    CHECK(got.v4 == vector<u32i>(ref.v4.data(), ref.v4.data() + ref.v4.size()));
+    CHECK(is_sorted(got.seqs.begin(), got.seqs.end()));
+    CHECK_EQ(pipe.stats().bytes, u64i(text.size()));
+    CHECK_EQ(pipe.stats().batches, u64i(got.seqs.size()));
+}
+
+GIA_TEST(ingest_unordered) {
+    string text = mixed_text(30000);
+    ingest_opts opts;
+    opts.buffer = 200;
+    opts.workers = 4;
+    opts.inflight = 3; // fewer chunks than workers
+    ingest_batch ref;
+    Ingest_Pipeline::parse_lines(text.data(), text.size(), opts, &ref);
+    ingest_totals got;
+    atomic<u64i> classified {0};
+    Ingest_Pipeline pipe(opts, got.sink(), [&classified](ingest_batch &batch) { classified += batch.v6.size(); });
+    istringstream in(text);
+    CHECK(pipe.run(in));
+    CHECK_EQ(got.lines, u64i(ref.lines));
+    CHECK_EQ(classified.load(), u64i(ref.v6.size()));
+    vector<u32i> v4(ref.v4.data(), ref.v4.data() + ref.v4.size());
+    vector<u64i> v6lo(ref.v6.data_lo(), ref.v6.data_lo() + ref.v6.size());
+    sort(v4.begin(), v4.end());
+    sort(v6lo.begin(), v6lo.end());
+    sort(got.v4.begin(), got.v4.end());
+    sort(got.v6lo.begin(), got.v6lo.end());
+    CHECK(got.v4 == v4);
+    CHECK(got.v6lo == v6lo);
+    sort(got.seqs.begin(), got.seqs.end());
+    for (size_t idx = 0; idx < got.seqs.size(); idx++) CHECK_EQ(got.seqs[idx], u64i(idx)); // every chunk once
+}
+
+GIA_TEST(ingest_csv_column) {
+    string text = "id,ip,mac\n1,10.0.0.1,00:1a:2b:3c:4d:5e\n2, 2001:db8::1 ,001a.2b3c.4d5f\n3\n4,,\n5,192.168.0.300,00-1A-2B-3C-4D-60\n";
+    ingest_opts opts;
+    opts.delim = ',';
+    opts.column = 1;
+    ingest_batch ips;
+    CHECK_EQ(Ingest_Pipeline::parse_lines(text.data(), text.size(), opts, &ips), 6u);
+    CHECK_EQ(ips.bad, 4u); // header, missing field, empty field, bad address
+    CHECK((ips.v4.size() == 1) && (ips.v4.at(0) == IPv4_Addr(10, 0, 0, 1)) && (ips.line4[0] == 1));
+    CHECK((ips.v6.size() == 1) && (ips.v6.at(0) == IPv6_Addr("2001:db8::1")) && (ips.line6[0] == 2));
+    opts.column = 2;
+    opts.family = ingmnp::MAC;
+    ingest_batch macs;
+    Ingest_Pipeline::parse_lines(text.data(), text.size(), opts, &macs);
+    CHECK_EQ(macs.macs.size(), size_t(3));
+    CHECK((macs.macs.at(1)() == 0x001A2B3C4D5Full) && (macs.lineMac[2] == 5));
+    string tsv = "a\tb\t10.1.1.1\n";
+    opts.delim = '\t';
+    opts.family = ingmnp::IPv4;
+    ingest_batch tab;
+    Ingest_Pipeline::parse_lines(tsv.data(), tsv.size(), opts, &tab);
+    CHECK((tab.v4.size() == 1) && (tab.bad == 0));
+    opts.delim = ',';
+    opts.column = 1;
+    opts.family = ingmnp::Auto;
+    opts.buffer = 64;
+    ingest_totals got;
+    Ingest_Pipeline pipe(opts, got.sink());
+    istringstream in(text);
+    CHECK(pipe.run(in));
+    CHECK((got.lines == 6) && (got.bad == 4) && (got.v4.size() == 1) && (got.v6lo.size() == 1));
+}
+
+GIA_TEST(ingest_long_line) {
+    string text = "10.0.0.1\n" + string(5000, ' ') + "10.0.0.2" + string(3000, '\t') + "\n10.0.0.3\n" + string(20000, 'x') + "\n10.0.0.4"; // no line break at the end
+    ingest_opts opts;
+    opts.buffer = 64; // line grows buffer several times
+    opts.workers = 2;
+    opts.ordered = true;
+    ingest_totals got;
+    Ingest_Pipeline pipe(opts, got.sink());
+    istringstream in(text);
+    CHECK(pipe.run(in));
+    CHECK(got.v4 == vector<u32i>({0x0A000001, 0x0A000002, 0x0A000003, 0x0A000004}));
+    CHECK((got.lines == 5) && (got.bad == 1));
+    CHECK_EQ(pipe.stats().bytes, u64i(text.size()));
+    istringstream strict(text);
+    strict.exceptions(ios::failbit | ios::badbit); // end of input is not error
+    ingest_totals again;
+    Ingest_Pipeline other(opts, again.sink());
+    CHECK(other.run(strict) && (other.last_err() == ingmnp::NoError));
+    CHECK(again.v4 == got.v4);
+}
+
+GIA_TEST(ingest_stop_and_errors) {
+    string text = mixed_text(50000);
+    ingest_opts opts;
+    opts.buffer = 256;
+    opts.workers = 2;
+    u32i calls {0};
+    Ingest_Pipeline pipe(opts, [&calls](const ingest_batch &) { return ++calls < 3; });
+    istringstream in(text);
+    CHECK(!pipe.run(in) && (pipe.last_err() == ingmnp::Stopped));
+    CHECK_EQ(calls, 3u);
+    CHECK(pipe.stats().bytes < text.size());
+    Ingest_Pipeline thrower(opts, [](const ingest_batch &) -> bool { throw runtime_error("sink"); });
+    istringstream again(text);
+    CHECK(!thrower.run(again) && (thrower.last_err() == ingmnp::STL_Exception));
+    string path = "gia_test_ingest.txt";
+    {
+        ofstream out(path, ios::binary);
+        out << text;
+    }
+    ingest_totals got;
+    opts.ordered = true;
+    Ingest_Pipeline file(opts, got.sink());
+    CHECK(file.run_file(path));
+    ingest_batch ref;
+    Ingest_Pipeline::parse_lines(text.data(), text.size(), opts, &ref);
+    CHECK((got.lines == ref.lines) && (got.v4.size() == ref.v4.size()) && (got.v6lo.size() == ref.v6.size()));
+    remove(path.c_str());
+    CHECK(!file.run_file(path) && (file.last_err() == ingmnp::IOError));
+}
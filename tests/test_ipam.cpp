@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipam.h"
+
+using namespace std;
+
+GIA_TEST(ipam_v4_exhaustion) {
+    IPv4_Pool pool {IPv4_Addr(10, 0, 0, 0), 24, 26};
+    vector<IPv4_Addr> nets;
+    IPv4_Addr net;
+    while (pool.alloc(26, &net)) nets.push_back(net);
+    CHECK_EQ(nets.size(), size_t(4));
+    CHECK_EQ(pool.last_err(), ipammnp::NoSpace);
+    CHECK_EQ(pool.utilization(), 1.0);
+    CHECK_EQ(pool.used_addrs(), u64i(256));
+    CHECK(!pool.alloc(25, &net) && (pool.last_err() == ipammnp::NoSpace));
+    CHECK(!pool.alloc(27, &net) && (pool.last_err() == ipammnp::BadPrefix)); // longer than max_len
+    CHECK(!pool.alloc(IPv4_Addr(10, 0, 0, 64), 26) && (pool.last_err() == ipammnp::Busy));
+    CHECK(!pool.alloc(IPv4_Addr(10, 0, 1, 0), 26) && (pool.last_err() == ipammnp::BadPrefix)); // outside of parent
+    CHECK(!pool.alloc(IPv4_Addr(10, 0, 0, 65), 26) && (pool.last_err() == ipammnp::BadPrefix)); // host bits
+    CHECK(pool.free(nets[2], 26));
+    CHECK(!pool.free(nets[2], 26) && (pool.last_err() == ipammnp::NotAllocated));
+    CHECK(pool.alloc(26, &net) && (net == nets[2])); // the only free block
+}
+
+GIA_TEST(ipam_v4_coalesce_to_root) {
+    IPv4_Pool pool {IPv4_Addr(192, 168, 0, 0), 16, 24};
+    mt19937 rng(27);
+    vector<pair<IPv4_Addr,u32i>> held;
+    for (u32i idx = 0; idx < 200; idx++) {
+        IPv4_Addr net;
+        u32i len = 18 + rng() % 7;
+        if (pool.alloc(len, &net)) held.push_back({net, len});
+    }
+    CHECK(!held.empty());
+    CHECK_EQ(pool.allocations().size(), held.size());
+    CHECK(!pool.alloc(16, nullptr) && (pool.last_err() == ipammnp::NoSpace));
+    shuffle(held.begin(), held.end(), rng);
+    for (auto && blk : held) CHECK(pool.free(blk.first, blk.second));
+    CHECK_EQ(pool.utilization(), 0.0);
+    CHECK(pool.allocations().empty());
+    IPv4_Addr root;
+    CHECK(pool.alloc(16, &root) && (root == IPv4_Addr(192, 168, 0, 0))); // buddies merged back into whole parent
+}
+
+GIA_TEST(ipam_keeps_big_blocks) {
+    IPv4_Pool pool {IPv4_Addr(10, 0, 0, 0), 24, 28};
+    IPv4_Addr net;
+    CHECK(pool.alloc(IPv4_Addr(10, 0, 0, 128), 28)); // right half is split already
+    CHECK(pool.alloc(28, &net) && (net == IPv4_Addr(10, 0, 0, 144))); // small block goes next to it
+    CHECK(pool.alloc(25, &net) && (net == IPv4_Addr(10, 0, 0, 0))); // left half stays whole
+}
+
+GIA_TEST(ipam_snapshot_roundtrip) {
+    IPv6_Pool pool {IPv6_Addr("2001:db8::"), 32, 48};
+    IPv6_Addr net;
+    for (u32i len : {40, 44, 48, 48, 36}) CHECK(pool.alloc(len, &net));
+    CHECK(pool.alloc(IPv6_Addr("2001:db8:ffff::"), 48));
+    auto snap = pool.snapshot();
+    IPv6_Pool copy;
+    CHECK(copy.restore(snap));
+    CHECK(copy.allocations() == pool.allocations());
+    CHECK_EQ(copy.utilization(), pool.utilization());
+    CHECK(!copy.alloc(IPv6_Addr("2001:db8:ffff::"), 48) && (copy.last_err() == ipammnp::Busy));
+    IPv4_Pool v4;
+    CHECK(!v4.restore(snap) && (v4.last_err() == ipammnp::BadSnapshot)); // other family
+    snap.pop_back();
+    CHECK(!copy.restore(snap) && (copy.last_err() == ipammnp::BadSnapshot));
+    IPv4_Pool src {IPv4_Addr(172, 16, 0, 0), 12, 24}, dst;
+    CHECK(src.alloc(IPv4_Addr(172, 31, 255, 0), 24) && src.alloc(16, nullptr));
+    CHECK(dst.restore(src.snapshot()));
+    CHECK(dst.allocations() == src.allocations());
+}
+
+GIA_TEST(ipam_bad_snapshot_keeps_pool) {
+    IPv4_Pool pool {IPv4_Addr(10, 0, 0, 0), 16, 24};
+    CHECK(pool.alloc(IPv4_Addr(10, 0, 5, 0), 24) && pool.alloc(20, nullptr));
+    auto before = pool.allocations();
+    vector<u8i> snap = IPv4_Pool(IPv4_Addr(192, 168, 0, 0), 16, 24).snapshot();
+    vector<u8i> busy(snap.begin(), snap.begin() + 24);
+    for (u64i val : {2, 0, 0, 0, 0, 0, 0, 0, 1, 1}) busy.push_back(u8i(val)); // count 2 : root, then its child
+    CHECK(!pool.restore(busy) && (pool.last_err() == ipammnp::BadSnapshot));
+    CHECK(pool.allocations() == before);
+    vector<u8i> lens = snap;
+    lens[7] = 60; // max_len
+    CHECK(!pool.restore(lens) && (pool.last_err() == ipammnp::BadSnapshot));
+    lens[7] = 8; // shorter than mask_len
+    CHECK(!pool.restore(lens) && (pool.last_err() == ipammnp::BadSnapshot));
+    CHECK(pool.allocations() == before);
+    CHECK(!pool.alloc(IPv4_Addr(10, 0, 5, 0), 24) && (pool.last_err() == ipammnp::Busy));
+    CHECK(pool.restore(snap) && pool.allocations().empty());
+    CHECK(pool.alloc(IPv4_Addr(192, 168, 7, 0), 24)); // prefix of snapshot
+    IPv6_Pool six {IPv6_Addr("2001:db8::"), 32, 48};
+    CHECK(six.alloc(IPv6_Addr("2001:db8:1::"), 48));
+    vector<u8i> snap6 = six.snapshot();
+    snap6[7] = 200;
+    IPv6_Pool other {IPv6_Addr("fd00::"), 8, 24};
+    CHECK(other.alloc(16, nullptr));
+    auto held = other.allocations();
+    CHECK(!other.restore(snap6) && (other.last_err() == ipammnp::BadSnapshot));
+    CHECK(other.allocations() == held);
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include "gia_test.h"
+#include "../gia_ipcodec.h"
+
+using namespace std;
+
+static vector<u64i> image_of(const ostringstream &os) { // reader wants 8-byte aligned image
+    string str = os.str();
+    vector<u64i> ret((str.size() + 7) / 8);
+    memcpy(ret.data(), str.data(), str.size());
+    return ret;
+}
+
+GIA_TEST(ipcodec_every_width) {
+    mt19937_64 rng(34);
+    ostringstream os;
+    ippak_writer wr(os, pakmnp::MAC);
+    vector<u64i> vals;
+    for (u32i width = 0; width <= 64; width++) { // one block per width of ls lane, ms keeps blocks in order
+        u64i low = width ? (u64i(1) << (width - 1)) - 1 : 0;
+        u64i val = 0;
+        for (u32i idx = 0; idx < pakmnp::BLOCK; idx++) {
+            if ((idx == 1) && width) val += low + 1; // delta with top bit of width set
+            else if (idx > 1) val += (rng() & low) >> 8; // rest keeps sum below 2^width
+            vals.push_back(val);
+            CHECK(wr.push(width, val));
+        }
+    }
+    CHECK(wr.finish());
+    CHECK(!wr.push(65, 0)); // finished already
+    vector<u64i> image = image_of(os);
+    ippak_reader rd;
+    CHECK(rd.view((const u8i*)image.data(), image.size() * 8, pakmnp::MAC));
+    CHECK_EQ(rd.count(), u64i(vals.size()));
+    CHECK_EQ(rd.block_count(), u64i(65));
+    u64i ms[pakmnp::BLOCK], ls[pakmnp::BLOCK];
+    for (u32i width = 0; width <= 64; width++) {
+        CHECK_EQ(u32i(rd.block(width).widthA), 0u);
+        CHECK_EQ(u32i(rd.block(width).widthB), width);
+        CHECK_EQ(rd.decode(width, ms, ls), pakmnp::BLOCK);
+        bool same {true};
+        for (u32i idx = 0; idx < pakmnp::BLOCK; idx++) same &= (ms[idx] == width) && (ls[idx] == vals[width * pakmnp::BLOCK + idx]);
+        CHECK(same);
+    }
+    CHECK_EQ(rd.decode(65, ms, ls), 0u);
+    CHECK(!rd.view((const u8i*)image.data(), image.size() * 8, pakmnp::IPv4) && (rd.last_err() == pakmnp::BadFamily));
+}
+
+GIA_TEST(ipcodec_v6_lanes) {
+    mt19937_64 rng(340);
+    vector<IPv6_Addr> addrs;
+    for (u32i idx = 0; idx < 3000; idx++) { // few /64s, so ms lane has both runs and jumps
+        u64i ms = 0x20010DB800000000ull | (rng() % 40);
+        addrs.push_back(IPv6_Addr(ms, (idx % 5) ? rng() % 1000 : rng()));
+    }
+    sort(addrs.begin(), addrs.end());
+    ostringstream os;
+    IP_PackWriter<IPv6_Addr> wr(os);
+    CHECK(wr.push(addrs.data(), addrs.size()));
+    CHECK(!wr.push(IPv6_Addr("2001:db8::")) && (wr.last_err() == pakmnp::NotSorted));
+    CHECK(!wr.finish()); // writer stays failed
+    ostringstream good;
+    IP_PackWriter<IPv6_Addr> ok(good);
+    CHECK(ok.push(addrs.data(), addrs.size()) && ok.finish());
+    vector<u64i> image = image_of(good);
+    IP_PackReader<IPv6_Addr> rd;
+    CHECK(rd.view((const u8i*)image.data(), image.size() * 8));
+    CHECK_EQ(rd.count(), u64i(addrs.size()));
+    CHECK_EQ(rd.block_count(), u64i((addrs.size() + pakmnp::BLOCK - 1) / pakmnp::BLOCK)); // last block is partial
+    vector<IPv6_Addr> back, blk(pakmnp::BLOCK);
+    u32i cnt;
+    while ((cnt = rd.next(blk.data())) > 0) back.insert(back.end(), blk.begin(), blk.begin() + cnt);
+    CHECK(back == addrs);
+    CHECK(rd.block_min(0) == addrs.front());
+    CHECK(rd.block_max(rd.block_count() - 1) == addrs.back());
+    rd.seek(1);
+    CHECK(rd.next(blk.data()) && (blk[0] == addrs[pakmnp::BLOCK]));
+    for (u32i idx = 0; idx < 500; idx++) CHECK(rd.contains(addrs[rng() % addrs.size()]));
+    CHECK(!rd.contains(IPv6_Addr("2001:db8::ffff:ffff:ffff:ffff:ffff")));
+    CHECK(!rd.contains(IPv6_Addr("::1")));
+    IP_PackReader<IPv4_Addr> v4;
+    CHECK(!v4.view((const u8i*)image.data(), image.size() * 8) && (v4.last_err() == pakmnp::BadFamily));
+    image.back() ^= 1; // trailer
+    CHECK(!rd.view((const u8i*)image.data(), image.size() * 8) && (rd.last_err() == pakmnp::BadImage));
+}
+
+GIA_TEST(ipcodec_find_block) {
+    ostringstream os;
+    ippak_writer wr(os, pakmnp::IPv4);
+    for (u64i val = 0; val < 10 * pakmnp::BLOCK; val++) CHECK(wr.push(0, val * 4));
+    CHECK(wr.finish());
+    vector<u64i> image = image_of(os);
+    ippak_reader rd;
+    CHECK(rd.view((const u8i*)image.data(), image.size() * 8, pakmnp::IPv4));
+    u64i span = pakmnp::BLOCK * 4;
+    CHECK_EQ(rd.find_block(0, 0), u64i(0));
+    CHECK_EQ(rd.find_block(0, span - 4), u64i(0)); // last value of block
+    CHECK_EQ(rd.find_block(0, span - 3), u64i(1)); // gap between blocks
+    CHECK_EQ(rd.find_block(0, 5 * span + 17), u64i(5));
+    CHECK_EQ(rd.find_block(0, 10 * span), u64i(10)); // past the end
+    CHECK_EQ(rd.find_block(1, 0), u64i(10));
+    IP_PackReader<IPv4_Addr> v4;
+    CHECK(v4.view((const u8i*)image.data(), image.size() * 8));
+    CHECK(v4.contains(IPv4_Addr(4000u)) && !v4.contains(IPv4_Addr(4001u)));
+    ippak_writer bad(os, 5);
+    CHECK(!bad.push(0, 0) && (bad.last_err() == pakmnp::BadFamily));
+    IP_PackReader<MAC_Addr> empty;
+    CHECK(!empty.view(nullptr, 0) && !empty.contains(MAC_Addr(0x001A2B3C4D5Eull)));
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <unordered_set>
+#include "gia_test.h"
+#include "../gia_ipdual.h"
+
+using namespace std;
+
+GIA_TEST(ipdual_parse_format) {
+    IP_Addr ip;
+    CHECK(dualmnp::valid_addr("192.0.2.1", &ip));
+    CHECK(ip.is_v4() && (ip.family() == 4) && (ip.bits() == 32));
+    CHECK_EQ(ip.v4()(), 0xC0000201u);
+    CHECK_EQ(ip.to_str(), string("192.0.2.1"));
+    CHECK(ip == dualmnp::to_IP("::ffff:192.0.2.1")); // mapped text is the same address
+    CHECK(dualmnp::valid_addr("2001:DB8::1", &ip));
+    CHECK(ip.is_v6() && (ip.family() == 6) && (ip.bits() == 128));
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("2001:db8::1"));
+    CHECK_EQ(ip.to_str(v6mnp::FULL_VIEW), string("2001:0DB8:0000:0000:0000:0000:0000:0001"));
+    CHECK(dualmnp::valid_addr("::", &ip) && ip.is_unspec() && ip.is_v6());
+    CHECK(!dualmnp::to_IP("0.0.0.0").is_unspec()); // ::ffff:0.0.0.0
+    for (const char *bad : {"", "1.2.3", "1::2::3", "256.1.1.1", "fe80::1%eth0"}) CHECK(!dualmnp::valid_addr(bad));
+    CHECK(dualmnp::to_IP("1.2.3.256").is_unspec());
+    CHECK(!IP_Addr(0, 0x0000FFFE01020304).is_v4() && !IP_Addr(1, 0x0000FFFF01020304).is_v4());
+}
+
+GIA_TEST(ipdual_compare_hash_wire) {
+    IP_Addr a(IPv4_Addr(10, 0, 0, 1)), b = IP_Addr::from_v4(0x0A000002), c(IPv6_Addr(0x20010DB800000000, 1));
+    CHECK((a < b) && (b < c) && (a <= a) && (c > a) && (c >= b) && (a != b));
+    CHECK_EQ(a.hash(), IP_Addr(a.v6()).hash());
+    CHECK(std::hash<IP_Addr>()(a) != std::hash<IP_Addr>()(b));
+    vector<IP_Addr> vec {c, b, a};
+    sort(vec.begin(), vec.end());
+    CHECK((vec[0] == a) && (vec[2] == c));
+    u8i buf[16];
+    CHECK_EQ(a.to_wire(buf), 4u);
+    CHECK(IP_Addr::from_wire(buf, 4) == a);
+    CHECK_EQ(c.to_wire(buf), 16u);
+    CHECK(IP_Addr::from_wire(buf, 16) == c);
+    unordered_set<IP_Addr> uset {a, b, c, a};
+    CHECK_EQ(uset.size(), size_t(3));
+    IP_FlatSet<IP_Addr> fset;
+    CHECK(fset.insert(a) && fset.insert(c) && !fset.insert(IP_Addr(IPv4_Addr(10, 0, 0, 1))));
+    CHECK(fset.contains(c) && !fset.contains(b));
+}
+
+GIA_TEST(ipdual_prefix) {
+    IP_Addr v4 = dualmnp::to_IP("10.1.2.3"), v6 = dualmnp::to_IP("2001:db8:1:2::5");
+    CHECK(v4.in_prefix(dualmnp::to_IP("10.0.0.0"), 8));
+    CHECK(!v4.in_prefix(dualmnp::to_IP("11.0.0.0"), 8));
+    CHECK(v4.in_prefix(dualmnp::to_IP("1.1.1.1"), 0)); // any IPv4
+    CHECK(!v4.in_prefix(dualmnp::to_IP("::"), 0)); // IPv6 network of own family length is not matched
+    CHECK(v6.in_prefix(dualmnp::to_IP("2001:db8::"), 32));
+    CHECK(!v6.in_prefix(dualmnp::to_IP("2001:db9::"), 32));
+    CHECK_EQ(v4.masked(16).to_str(), string("10.1.0.0"));
+    CHECK(v4.masked(16).is_v4());
+    CHECK_EQ(v4.masked(99).to_str(), string("10.1.2.3"));
+    CHECK_EQ(v6.masked(48).to_str(v6mnp::IETF_VIEW), string("2001:db8:1::"));
+    IP_Addr net = v4;
+    net &= dualmnp::gen_mask(24, true);
+    CHECK_EQ(net.to_str(), string("10.1.2.0"));
+    net = v6;
+    net &= dualmnp::gen_mask(64, false);
+    CHECK(net == v6.masked(64));
+    CHECK(dualmnp::to_IP("127.0.0.1").is_loopback() && dualmnp::to_IP("::1").is_loopback());
+    CHECK(dualmnp::to_IP("224.0.0.1").is_mcast() && dualmnp::to_IP("ff02::1").is_mcast() && !v4.is_mcast());
+    CHECK(dualmnp::to_IP("169.254.1.1").is_link_local() && dualmnp::to_IP("fe80::1").is_link_local());
+}
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include "gia_test.h"
+#include "../gia_ipenum.h"
+
+using namespace std;
+
+GIA_TEST(ipenum_v4_hosts) {
+    IPv4_Hosts all(IPv4_Addr(192, 168, 1, 77), 24), usable(IPv4_Addr(192, 168, 1, 77), 24, true);
+    CHECK_EQ(all.size(), u64i(256));
+    CHECK_EQ(all[0].to_str(), string("192.168.1.0"));
+    CHECK_EQ(usable.size(), u64i(254));
+    CHECK_EQ(usable.begin()[0].to_str(), string("192.168.1.1"));
+    CHECK_EQ((*(usable.end() - 1)).to_str(), string("192.168.1.254"));
+    CHECK_EQ(IPv4_Hosts(IPv4_Addr(10, 0, 0, 0), 31, true).size(), u64i(2)); // RFC 3021
+    CHECK_EQ(IPv4_Hosts(IPv4_Addr(10, 0, 0, 9), 32, true)[0].to_str(), string("10.0.0.9"));
+    IPv4_Hosts space(IPv4_Addr(1, 2, 3, 4), 0);
+    CHECK_EQ(space.size(), u64i(1) << 32);
+    CHECK_EQ(space[0xFFFFFFFF].to_str(), string("255.255.255.255"));
+    u64i cnt {0};
+    for (auto && ip : usable) cnt += (ip() >> 8) == 0xC0A801;
+    CHECK_EQ(cnt, u64i(254));
+    auto it = lower_bound(all.begin(), all.end(), IPv4_Addr(192, 168, 1, 100)); // random access over computed range
+    CHECK_EQ(it.index(), u64i(100));
+    CHECK_EQ(distance(all.begin(), all.end()), int64_t(256));
+    auto rit = reverse_iterator<IPv4_Hosts::iterator>(all.end());
+    CHECK_EQ((*rit).to_str(), string("192.168.1.255"));
+}
+
+GIA_TEST(ipenum_v4_subnets) {
+    IPv4_Subnets subs(IPv4_Addr(10, 20, 30, 40), 16, 24);
+    CHECK_EQ(subs.size(), u64i(256));
+    CHECK_EQ(subs.sub_len(), 24u);
+    CHECK_EQ(subs[0].to_str(), string("10.20.0.0"));
+    CHECK_EQ(subs[255].to_str(), string("10.20.255.0"));
+    CHECK_EQ(subs.index_of(IPv4_Addr(10, 20, 30, 40)), u64i(30));
+    CHECK(IPv4_Subnets(IPv4_Addr(10, 0, 0, 0), 24, 16).empty());
+    CHECK_EQ(IPv4_Subnets(IPv4_Addr(0, 0, 0, 0), 0, 32).size(), u64i(1) << 32);
+    CHECK_EQ(IPv4_Subnets(IPv4_Addr(10, 0, 0, 0), 8, 8).size(), u64i(1));
+}
+
+GIA_TEST(ipenum_v6_ranges) {
+    IPv6_Hosts hosts(IPv6_Addr("2001:db8::1234"), 120);
+    CHECK_EQ(hosts.size(), u64i(256));
+    CHECK_EQ(hosts[0x34].to_str(), string("2001:db8::1234"));
+    CHECK_EQ(IPv6_Hosts(IPv6_Addr("2001:db8::"), 64).size(), u64i(INT64_MAX)); // limited by iterator distance
+    IPv6_Subnets above(IPv6_Addr("2001:db8::"), 32, 48), across(IPv6_Addr("2001:db8::"), 60, 68), below(IPv6_Addr("2001:db8::"), 112, 120);
+    CHECK_EQ(above.size(), u64i(65536));
+    CHECK_EQ(above[0xABCD].to_str(), string("2001:db8:abcd::"));
+    CHECK_EQ(across.size(), u64i(256));
+    CHECK_EQ(across[0x3F].to_str(), string("2001:db8:0:3:f000::")); // subnet bits on both halves
+    CHECK_EQ(below[0x12].to_str(), string("2001:db8::1200"));
+    CHECK_EQ(IPv6_Subnets(IPv6_Addr("::"), 0, 0)[0].to_str(), string("::"));
+    CHECK(IPv6_Subnets(IPv6_Addr("2001:db8::"), 64, 48).empty());
+    CHECK_EQ(count_if(across.begin(), across.end(), [](const IPv6_Addr &net) { return net().ls == 0; }), int64_t(16));
+}
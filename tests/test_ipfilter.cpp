@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipfilter.h"
+#include "../gia_mmap.h"
+
+using namespace std;
+
+// keys are random, probes are other random values : every key must be found, probes only at about the configured rate
+
+static vector<IPv4_Addr> rand_v4(size_t n, u64i seed) {
+    mt19937 rng(seed);
+    vector<IPv4_Addr> ret(n);
+    for (auto && ip : ret) ip = IPv4_Addr(u32i(rng()));
+    return ret;
+}
+
+GIA_TEST(filter_bloom_members) {
+    auto keys = rand_v4(20000, 1), probes = rand_v4(100000, 2);
+    Bloom_Filter flt(keys.size());
+    flt.insert(keys.data(), keys.size());
+    CHECK_EQ(flt.count(), u64i(keys.size()));
+    vector<u8i> out(keys.size());
+    flt.contains(keys.data(), keys.size(), out.data());
+    size_t missed {0};
+    for (size_t idx = 0; idx < keys.size(); idx++) missed += !out[idx] || !flt.contains(keys[idx]);
+    CHECK_EQ(missed, size_t(0));
+    size_t fps {0};
+    for (auto && ip : probes) fps += flt.contains(ip);
+    CHECK(fps < probes.size() / 50); // ~0.5% at 12 bits per key
+    Bloom_Filter mixed(3);
+    mixed.insert(IPv6_Addr("2001:db8::1"));
+    mixed.insert(MAC_Addr(0x001A2B3C4D5Eull));
+    CHECK(mixed.contains(IPv6_Addr("2001:db8::1")) && mixed.contains(MAC_Addr(0x001A2B3C4D5Eull)));
+}
+
+GIA_TEST(filter_fuse_members) {
+    auto keys = rand_v4(50000, 3), probes = rand_v4(200000, 4);
+    keys.push_back(keys[0]); // duplicates are allowed
+    Fuse_Filter flt;
+    CHECK(flt.build(keys.data(), keys.size()));
+    vector<u8i> out(keys.size());
+    flt.contains(keys.data(), keys.size(), out.data());
+    size_t missed {0};
+    for (size_t idx = 0; idx < keys.size(); idx++) missed += !out[idx] || !flt.contains(keys[idx]);
+    CHECK_EQ(missed, size_t(0));
+    size_t fps {0};
+    for (auto && ip : probes) fps += flt.contains(ip);
+    CHECK(fps < probes.size() / 100); // ~0.4% with 8-bit fingerprints
+    CHECK(flt.mem_bytes() < keys.size() * 3 / 2); // ~9 bits per key
+    Fuse_Filter none;
+    CHECK(!none.contains(keys[0]));
+    CHECK(none.build((const IPv6_Addr*)nullptr, 0));
+}
+
+GIA_TEST(filter_image_roundtrip) {
+    auto keys = rand_v4(5000, 5), probes = rand_v4(20000, 6);
+    Bloom_Filter bloom(keys.size());
+    bloom.insert(keys.data(), keys.size());
+    Fuse_Filter fuse;
+    CHECK(fuse.build(keys.data(), keys.size()));
+    string path = "gia_test_filter.img";
+    CHECK(MMap_File::save(path, fuse.serialize()));
+    {
+        MMap_File file {path};
+        Fuse_Filter ro, copied;
+        CHECK(ro.view(file.data(), file.size()));
+        CHECK(copied.load(file.data(), file.size()));
+        for (auto && ip : keys) CHECK(ro.contains(ip) && copied.contains(ip));
+        for (auto && ip : probes) CHECK_EQ(ro.contains(ip), fuse.contains(ip));
+        CHECK(!ro.view(file.data(), file.size() - 1) && (ro.last_err() == fltmnp::BadImage));
+    }
+    CHECK(MMap_File::save(path, bloom.serialize()));
+    {
+        MMap_File file {path};
+        Bloom_Filter ro, copied;
+        CHECK(ro.view(file.data(), file.size()));
+        CHECK(copied.load(file.data(), file.size()));
+        CHECK_EQ(ro.count(), bloom.count());
+        for (auto && ip : probes) CHECK(ro.contains(ip) == bloom.contains(ip) && copied.contains(ip) == bloom.contains(ip));
+        ro.insert(probes[0]);
+        CHECK_EQ(ro.last_err(), fltmnp::ReadOnly); // view is read-only, loaded copy is not
+        copied.insert(probes[0]);
+        CHECK(copied.contains(probes[0]));
+        Fuse_Filter other;
+        CHECK(!other.view(file.data(), file.size()) && (other.last_err() == fltmnp::BadImage));
+    }
+    remove(path.c_str());
+}
+
+GIA_TEST(filter_copy_owns_storage) {
+    auto keys = rand_v4(2000, 7), more = rand_v4(2000, 8);
+    Bloom_Filter bloom;
+    {
+        Bloom_Filter src(keys.size() * 2);
+        src.insert(keys.data(), keys.size());
+        Bloom_Filter copy(src);
+        copy.insert(more.data(), more.size());
+        size_t seen {0};
+        for (auto && ip : more) seen += src.contains(ip);
+        CHECK(seen < more.size() / 10); // inserts into copy stay there
+        bloom = src; // src is gone after the block
+    }
+    for (auto && ip : keys) CHECK(bloom.contains(ip));
+    Bloom_Filter moved(move(bloom));
+    for (auto && ip : keys) CHECK(moved.contains(ip));
+    CHECK(!bloom.contains(keys[0]) && (bloom.mem_bytes() == 0));
+    Fuse_Filter fuse;
+    {
+        Fuse_Filter src;
+        CHECK(src.build(keys.data(), keys.size()));
+        Fuse_Filter copy(src);
+        fuse = copy;
+        vector<u8i> image = src.serialize();
+        Fuse_Filter view, viewCopy;
+        CHECK(view.view(image.data(), image.size()));
+        viewCopy = view; // shares image
+        for (auto && ip : keys) CHECK(viewCopy.contains(ip));
+    }
+    for (auto && ip : keys) CHECK(fuse.contains(ip));
+    Fuse_Filter taken;
+    taken = move(fuse);
+    for (auto && ip : keys) CHECK(taken.contains(ip));
+    CHECK(!fuse.contains(keys[0]));
+}
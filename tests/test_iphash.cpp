@@ -0,0 +1,73 @@
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include "gia_test.h"
+#include "../gia_iphash.h"
+
+using namespace std;
+
+GIA_TEST(iphash_std_hash) {
+    unordered_set<IPv4_Addr> v4 {IPv4_Addr(10, 0, 0, 1), IPv4_Addr(10, 0, 0, 2), IPv4_Addr(10, 0, 0, 1)};
+    unordered_set<IPv6_Addr> v6 {IPv6_Addr("2001:db8::1"), IPv6_Addr("2001:db8::1:0:0:1")};
+    unordered_set<MAC_Addr> macs {MAC_Addr(0x001A2B3C4D5Eull)};
+    CHECK_EQ(v4.size(), size_t(2));
+    CHECK_EQ(v6.size(), size_t(2));
+    CHECK(macs.count(MAC_Addr(0x001A2B3C4D5Eull)) == 1);
+    CHECK(hashmnp::hash(1u) != hashmnp::hash(2u));
+}
+
+GIA_TEST(iphash_flatmap_matches_std) {
+    mt19937_64 rng(30);
+    IP_FlatMap<IPv6_Addr, u32i> flat;
+    unordered_map<IPv6_Addr, u32i> ref;
+    for (u32i idx = 0; idx < 200000; idx++) {
+        IPv6_Addr ip(0x20010DB800000000ull, rng() % 20000); // small key space, so keys come back after erase
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            CHECK_EQ(flat.insert(ip, idx), ref.emplace(ip, idx).second);
+            break;
+        case 2:
+            CHECK_EQ(flat.erase(ip), ref.erase(ip) == 1);
+            break;
+        default:
+            flat[ip] += 1;
+            ref[ip] += 1;
+        }
+    }
+    CHECK_EQ(flat.size(), ref.size());
+    for (auto && kv : ref) {
+        const u32i *val = flat.find(kv.first);
+        CHECK(val && (*val == kv.second));
+    }
+    size_t seen {0};
+    flat.for_each([&](const IPv6_Addr &ip, u32i val) { seen++; CHECK(ref.count(ip) && (ref[ip] == val)); });
+    CHECK_EQ(seen, ref.size());
+    CHECK(flat.find(IPv6_Addr("2001:db9::")) == nullptr);
+}
+
+GIA_TEST(iphash_tombstones_are_reused) {
+    IP_FlatSet<IPv4_Addr> set;
+    set.reserve(1000);
+    size_t cap = set.capacity();
+    for (u32i round = 0; round < 200; round++) { // same population, keys change every round
+        for (u32i idx = 0; idx < 800; idx++) CHECK(set.insert(IPv4_Addr(round * 1000 + idx)));
+        for (u32i idx = 0; idx < 800; idx++) CHECK(set.erase(IPv4_Addr(round * 1000 + idx)));
+    }
+    CHECK(set.empty());
+    CHECK_EQ(set.capacity(), cap); // tombstones are dropped by rehash in place, table does not grow
+    CHECK(!set.erase(IPv4_Addr(5u)));
+    for (u32i idx = 0; idx < 100000; idx++) set.insert(IPv4_Addr(idx * 7919));
+    CHECK_EQ(set.size(), size_t(100000));
+    CHECK(set.capacity() * 7 / 8 >= set.size());
+    size_t found {0};
+    for (u32i idx = 0; idx < 100000; idx++) found += set.contains(IPv4_Addr(idx * 7919));
+    CHECK_EQ(found, size_t(100000));
+    set.clear();
+    CHECK(set.empty() && !set.contains(IPv4_Addr(0u)));
+    IP_FlatMap<MAC_Addr, u16i> ports;
+    ports.insert_or_assign(MAC_Addr(0x020000000001ull), 3);
+    ports.insert_or_assign(MAC_Addr(0x020000000001ull), 4);
+    CHECK(!ports.insert(MAC_Addr(0x020000000001ull), 5));
+    CHECK((ports.size() == 1) && (*ports.find(MAC_Addr(0x020000000001ull)) == 4));
+}
@@ -0,0 +1,175 @@
+#include "gia_test.h"
+#include "../gia_ipmnp.h"
+
+using namespace std;
+
+GIA_TEST(v4_parse_format) {
+    IPv4_Addr ip;
+    CHECK(v4mnp::valid_addr("192.168.1.10", &ip));
+    CHECK_EQ(ip(), 0xC0A8010Au);
+    CHECK_EQ(ip.to_str(), string("192.168.1.10"));
+    CHECK(v4mnp::valid_addr("0.0.0.0"));
+    CHECK(v4mnp::valid_addr("255.255.255.255"));
+    for (const char *bad : {"256.1.1.1", "1.2.3", "1.2.3.4.5", " 1.2.3.4", "1..2.3", "", "a.b.c.d"}) CHECK(!v4mnp::valid_addr(bad));
+    CHECK_EQ(IPv4_Addr(10, 0, 0, 1)(), 0x0A000001u);
+    CHECK_EQ(IPv4_Addr("300.1.1.1").last_err(), v4mnp::BadSyntax);
+    CHECK_EQ(v4mnp::to_u32i("1.2.3.4"), 0x01020304u);
+}
+
+GIA_TEST(v4_masks) {
+    IPv4_Mask mask;
+    CHECK(v4mnp::valid_mask("255.255.255.0", &mask));
+    CHECK_EQ(v4mnp::mask_len(mask()), 24u);
+    CHECK(!v4mnp::valid_mask("255.0.255.0"));
+    for (u32i len = 0; len <= 32; len++) CHECK_EQ(v4mnp::mask_len(v4mnp::gen_mask(len)()), len);
+    CHECK(v4mnp::gen_mask(20).can_be_mask());
+    CHECK(!IPv4_Addr(0xFF00FF00).can_be_mask());
+}
+
+GIA_TEST(v4_predicates) {
+    CHECK(IPv4_Addr(10, 1, 2, 3).is_private());
+    CHECK(IPv4_Addr(172, 31, 0, 1).is_private());
+    CHECK(!IPv4_Addr(172, 32, 0, 1).is_private());
+    CHECK(IPv4_Addr(127, 0, 0, 1).is_loopback());
+    CHECK(IPv4_Addr(169, 254, 9, 9).is_link_local());
+    CHECK(IPv4_Addr(224, 0, 0, 5).is_mcast() && IPv4_Addr(224, 0, 0, 5).is_lan_cblock());
+    CHECK(IPv4_Addr(232, 1, 1, 1).is_ssm_blk());
+    CHECK(IPv4_Addr(239, 1, 1, 1).is_adm_scp_blk());
+    CHECK(!IPv4_Addr(224, 0, 0, 5).is_ucast());
+    CHECK(IPv4_Addr(100, 64, 0, 1).is_shared());
+    CHECK(IPv4_Addr(198, 51, 100, 7).is_docum());
+    CHECK(IPv4_Addr(198, 19, 0, 1).is_benchm());
+    CHECK(IPv4_Addr(240, 0, 0, 1).is_reserved());
+    CHECK(IPv4_Addr(255, 255, 255, 255).is_lim_bcast());
+    CHECK(IPv4_Addr(8, 8, 8, 8).is_global_ucast());
+    CHECK(!IPv4_Addr(10, 8, 8, 8).is_global_ucast());
+}
+
+GIA_TEST(v4_operators) {
+    IPv4_Addr ip(10, 0, 0, 255);
+    ip++;
+    CHECK_EQ(ip.to_str(), string("10.0.1.0"));
+    ip -= 2;
+    CHECK_EQ(ip.to_str(), string("10.0.0.254"));
+    ip &= v4mnp::gen_mask(24);
+    CHECK_EQ(ip.to_str(), string("10.0.0.0"));
+    ip |= 7;
+    CHECK(ip == IPv4_Addr(10, 0, 0, 7));
+    CHECK(ip < IPv4_Addr(10, 0, 0, 8) && ip > IPv4_Addr(10, 0, 0, 6));
+    CHECK_EQ(ip[v4mnp::oct1], 10);
+    ip[7];
+    CHECK_EQ(ip.last_err(), v4mnp::BadIndex);
+    CHECK_EQ((~IPv4_Addr(0xFFFFFF00))(), 0xFFu);
+}
+
+GIA_TEST(v6_parse_format) {
+    IPv6_Addr ip;
+    CHECK(v6mnp::valid_addr("2001:0db8:0:0:1:0:0:1", &ip));
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("2001:db8::1:0:0:1")); // RFC 5952 : first of equal zero runs
+    CHECK_EQ(ip.to_str(v6mnp::UPPER_VIEW), string("2001:DB8::1:0:0:1"));
+    CHECK_EQ(ip.to_str(v6mnp::EXPAND_VIEW), string("2001:db8:0:0:1:0:0:1"));
+    CHECK_EQ(ip.to_str(v6mnp::FULL_VIEW), string("2001:0DB8:0000:0000:0001:0000:0000:0001"));
+    CHECK(v6mnp::valid_addr("1:0:0:2:0:0:0:3", &ip));
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("1:0:0:2::3")); // longest run
+    CHECK(v6mnp::valid_addr("2001:db8:0:1:1:1:1:1", &ip));
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("2001:db8:0:1:1:1:1:1")); // single zero is not compressed
+    CHECK(v6mnp::valid_addr("FE80::1", &ip));
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("fe80::1"));
+    CHECK(v6mnp::valid_addr("::", &ip) && ip.is_unspec());
+    CHECK(v6mnp::valid_addr("::ffff:1.2.3.4", &ip));
+    CHECK_EQ(ip().ls, 0x0000FFFF01020304ull);
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("::ffff:1.2.3.4"));
+    CHECK(v6mnp::valid_addr("0:0:0:0:0:ffff:1.2.3.4", &ip)); // six hextets and dotted tail w/o "::"
+    CHECK_EQ(ip().ls, 0x0000FFFF01020304ull);
+    CHECK(v6mnp::valid_addr("0:1:0:1:0:1:0:0", &ip)); // four zero runs
+    CHECK_EQ(ip.to_str(v6mnp::IETF_VIEW), string("0:1:0:1:0:1::"));
+    for (const char *bad : {"2001:db8:::1", "12345::", "1:2:3:4:5:6:7:8:9", "fe80::1%eth0", "1::2::3", "g::1", ""}) CHECK(!v6mnp::valid_addr(bad));
+    u128i val = v6mnp::to_u128i("2001:db8::ff");
+    CHECK(val.ms == 0x20010DB800000000ull && val.ls == 0xFF);
+}
+
+GIA_TEST(v6_masks_and_gen) {
+    for (u32i len = 0; len <= 128; len++) CHECK_EQ(v6mnp::mask_len(v6mnp::gen_mask(len)), len);
+    IPv6_Mask mask;
+    CHECK(v6mnp::valid_mask("ffff:ffff:ffff:ffff::", &mask));
+    CHECK_EQ(v6mnp::mask_len(mask), 64u);
+    CHECK(!v6mnp::valid_mask("ffff::ffff"));
+    CHECK_EQ(v6mnp::gen_link_local(MAC_Addr(0x001A2B3C4D5Eull)).to_str(v6mnp::IETF_VIEW), string("fe80::21a:2bff:fe3c:4d5e"));
+}
+
+GIA_TEST(v6_predicates) {
+    CHECK(IPv6_Addr("::1").is_loopback());
+    CHECK(IPv6_Addr("ff02::1").is_mcast());
+    CHECK(IPv6_Addr("fd00::1").is_uniq_local());
+    CHECK(IPv6_Addr("fe80::1").is_link_local());
+    CHECK(IPv6_Addr("2001:db8::1").is_docum());
+    CHECK(IPv6_Addr("2002::1").is_6to4());
+    CHECK(IPv6_Addr("64:ff9b::1").is_wknown_pfx());
+    CHECK(IPv6_Addr("64:ff9b:1::1").is_lu_trans());
+    CHECK(IPv6_Addr("2001::1").is_teredo());
+    CHECK(IPv6_Addr("::ffff:1.2.3.4").is_mapped_ipv4());
+    CHECK(!IPv6_Addr("2001:db8::1").is_mcast());
+}
+
+GIA_TEST(v6_operators) {
+    IPv6_Addr ip(0, ~0ull);
+    ip++;
+    CHECK(ip == IPv6_Addr(1, 0));
+    ip--;
+    CHECK(ip == IPv6_Addr(0, ~0ull));
+    ip += 2;
+    CHECK(ip == IPv6_Addr(1, 1));
+    ip -= IPv6_Addr(0, 2);
+    CHECK(ip == IPv6_Addr(0, ~0ull));
+    CHECK((IPv6_Addr(0, 1) << 64) == IPv6_Addr(1, 0));
+    CHECK((IPv6_Addr(1, 0) >> 1) == IPv6_Addr(0, 0x8000000000000000ull));
+    CHECK(IPv6_Addr(1, 0) > IPv6_Addr(0, ~0ull));
+    CHECK(IPv6_Addr(0, 5) <= IPv6_Addr(0, 5));
+    IPv6_Addr net("2001:db8:1:2:3:4:5:6");
+    net &= v6mnp::gen_mask(48);
+    CHECK_EQ(net.to_str(v6mnp::IETF_VIEW), string("2001:db8:1::"));
+    CHECK_EQ(net[v6mnp::xtt3], 1);
+}
+
+GIA_TEST(mac_parse_format) {
+    MAC_Addr mac;
+    CHECK(macmnp::valid_addr("00:1a:2b:3c:4d:5e", 1, ':', &mac));
+    CHECK_EQ(mac(), 0x001A2B3C4D5Eull);
+    CHECK(macmnp::valid_addr("00-1A-2B-3C-4D-5E", 1, '-'));
+    CHECK(macmnp::valid_addr("001a.2b3c.4d5e", 2, '.'));
+    CHECK(!macmnp::valid_addr("0:1a:2b:3c:4d:5e", 1, ':'));
+    CHECK(!macmnp::valid_addr("00:1a:2b:3c:4d", 1, ':'));
+    CHECK_EQ(mac.to_str(1, true, ':'), string("00:1A:2B:3C:4D:5E"));
+    CHECK_EQ(mac.to_str(1, false, '-'), string("00-1a-2b-3c-4d-5e"));
+    CHECK_EQ(mac.to_str(2, false, '.'), string("001a.2b3c.4d5e"));
+    CHECK_EQ(mac.get_oui(), 0x001A2Bu);
+    CHECK_EQ(mac.get_nic(), 0x3C4D5Eu);
+}
+
+GIA_TEST(mac_predicates_operators) {
+    CHECK(MAC_Addr(0xFFFFFFFFFFFFull).is_bcast());
+    CHECK(MAC_Addr(0x01005E000001ull).is_mcast());
+    CHECK(MAC_Addr(0x021A2B3C4D5Eull).is_laa());
+    CHECK(MAC_Addr(0x001A2B3C4D5Eull).is_uaa() && MAC_Addr(0x001A2B3C4D5Eull).is_ucast());
+    CHECK_EQ(macmnp::gen_mcast(IPv4_Addr(224, 129, 2, 3))(), 0x01005E010203ull); // low 23 bits only
+    CHECK_EQ(macmnp::gen_mcast(IPv6_Addr("ff02::1:ff00:1"))(), 0x3333FF000001ull);
+    MAC_Addr mac(0xFFFFFFFFFFFFull);
+    mac += 1;
+    CHECK_EQ(mac(), 0ull); // 48 bits wrap
+    mac -= 1;
+    CHECK(mac.is_bcast());
+}
+
+GIA_TEST(wire_round_trip) {
+    u8i buf[16];
+    IPv4_Addr(192, 0, 2, 1).to_wire(buf);
+    CHECK(buf[0] == 192 && buf[3] == 1);
+    CHECK(IPv4_Addr::from_wire(buf) == IPv4_Addr(192, 0, 2, 1));
+    IPv6_Addr ip("2001:db8::1");
+    ip.to_wire(buf);
+    CHECK(buf[0] == 0x20 && buf[1] == 0x01 && buf[15] == 1);
+    CHECK(IPv6_Addr::from_wire(buf) == ip);
+    MAC_Addr(0x001A2B3C4D5Eull).to_wire(buf);
+    CHECK(buf[0] == 0x00 && buf[1] == 0x1A && buf[5] == 0x5E);
+    CHECK(MAC_Addr::from_wire(buf) == MAC_Addr(0x001A2B3C4D5Eull));
+}
@@ -0,0 +1,91 @@
+#include <random>
+#include <set>
+#include "gia_test.h"
+#include "../gia_ipset.h"
+
+using namespace std;
+
+GIA_TEST(ipset_cont_array_bitmap_boundary) {
+    roar_cont cont;
+    for (u32i val = 0; val < roar_cont::ARRAY_MAX; val++) CHECK(cont.insert(u16i(val * 3)));
+    CHECK_EQ(cont.type, roar_cont::ARRAY);
+    CHECK(!cont.insert(u16i(0)));
+    CHECK(cont.insert(u16i(1))); // 4097th value
+    CHECK_EQ(cont.type, roar_cont::BITMAP);
+    CHECK_EQ(cont.card, roar_cont::ARRAY_MAX + 1);
+    CHECK(cont.erase(u16i(1)) && cont.insert(u16i(1)) && cont.erase(u16i(1))); // stays bitmap around ARRAY_MAX
+    CHECK_EQ(cont.type, roar_cont::BITMAP);
+    u32i val {0};
+    while (cont.card >= roar_cont::ARRAY_MIN) CHECK(cont.erase(u16i(3 * val++)));
+    CHECK_EQ(cont.type, roar_cont::ARRAY);
+    CHECK_EQ(cont.vals.size(), size_t(roar_cont::ARRAY_MIN - 1));
+    for (u32i idx = 0; idx < roar_cont::ARRAY_MAX; idx++) CHECK_EQ(cont.contains(u16i(3 * idx)), idx >= val);
+    u16i low;
+    CHECK(cont.next(0, &low) && (low == u16i(3 * val)));
+}
+
+GIA_TEST(ipset_cont_runs) {
+    roar_cont cont;
+    for (u32i val = 100; val < 20100; val++) cont.insert(u16i(val));
+    for (u32i val = 30000; val < 30010; val++) cont.insert(u16i(val));
+    CHECK_EQ(cont.type, roar_cont::BITMAP);
+    CHECK_EQ(cont.runs_count(), 2u);
+    CHECK(cont.run_optimize());
+    CHECK_EQ(cont.type, roar_cont::RUN);
+    CHECK_EQ(cont.vals.size(), size_t(4));
+    CHECK(cont.contains(100) && cont.contains(20099) && cont.contains(30009));
+    CHECK(!cont.contains(99) && !cont.contains(20100) && !cont.contains(30010));
+    u16i low;
+    CHECK(cont.next(20100, &low) && (low == 30000));
+    CHECK(!cont.next(30010, &low));
+    u32i seen {0};
+    cont.for_each(0, [&seen](const IPv4_Addr &) { seen++; });
+    CHECK_EQ(seen, cont.card);
+    CHECK(cont.erase(u16i(5000))); // edits leave RUN form
+    CHECK_EQ(cont.type, roar_cont::BITMAP);
+    CHECK(!cont.contains(5000) && (cont.card == 20009));
+    roar_cont sparse;
+    for (u32i val = 0; val < 100; val++) sparse.insert(u16i(val * 7));
+    CHECK(!sparse.run_optimize() && (sparse.type == roar_cont::ARRAY)); // runs of one value are not smaller
+}
+
+GIA_TEST(ipset_roaring_matches_std_set) {
+    mt19937 rng(28);
+    IPv4_Roaring rs, other;
+    set<u32i> ref, refOther;
+    for (u32i idx = 0; idx < 60000; idx++) { // dense /16 goes over ARRAY_MAX, others stay sparse
+        u32i ip = (idx % 2) ? (0x0A000000 | (rng() & 0x3FFF)) : rng();
+        CHECK_EQ(rs.insert(IPv4_Addr(ip)), ref.insert(ip).second);
+        u32i ip2 = (idx % 3) ? (0x0A000000 | (rng() & 0xFFFF)) : rng();
+        other.insert(IPv4_Addr(ip2));
+        refOther.insert(ip2);
+    }
+    for (u32i idx = 0; idx < 20000; idx++) {
+        u32i ip = 0x0A000000 | (rng() & 0x3FFF);
+        CHECK_EQ(rs.erase(IPv4_Addr(ip)), ref.erase(ip) == 1);
+    }
+    CHECK_EQ(rs.cardinality(), u64i(ref.size()));
+    size_t before = rs.mem_bytes();
+    rs.run_optimize();
+    CHECK(rs.mem_bytes() <= before);
+    vector<u32i> listed;
+    rs.for_each([&listed](const IPv4_Addr &ip) { listed.push_back(ip()); });
+    CHECK(listed == vector<u32i>(ref.begin(), ref.end()));
+    IPv4_Addr nxt;
+    CHECK(rs.next(IPv4_Addr(0x0A001000), &nxt) && (nxt() == *ref.lower_bound(0x0A001000)));
+    IPv4_Roaring both {rs}, any {rs};
+    both &= other;
+    any |= other;
+    set<u32i> refBoth, refAny {ref};
+    for (auto ip : refOther) {
+        if (ref.count(ip)) refBoth.insert(ip);
+        refAny.insert(ip);
+    }
+    CHECK_EQ(both.cardinality(), u64i(refBoth.size()));
+    CHECK_EQ(any.cardinality(), u64i(refAny.size()));
+    for (auto ip : refBoth) CHECK(both.contains(IPv4_Addr(ip)));
+    for (u32i idx = 0; idx < 5000; idx++) {
+        u32i ip = 0x0A000000 | (rng() & 0xFFFF);
+        CHECK_EQ(any.contains(IPv4_Addr(ip)), refAny.count(ip) == 1);
+    }
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipsort.h"
+
+using namespace std;
+
+static bool key_less(const ipkey_u128 &a, const ipkey_u128 &b) { return (a.ms < b.ms) || ((a.ms == b.ms) && (a.ls < b.ls)); }
+
+GIA_TEST(ipsort_raw_keys) {
+    mt19937_64 rng(4);
+    for (u32i threads : {1u, 2u, 5u}) {
+        vector<u64i> keys(100000);
+        for (auto && key : keys) key = rng() & 0xFFFFFFFFFFFFull & ~0xFF0000ull; // constant byte is skipped
+        vector<u64i> ref = keys;
+        sort(ref.begin(), ref.end());
+        CHECK(sortmnp::radix_sort(keys.data(), keys.size(), threads));
+        CHECK(keys == ref);
+        vector<u32i> k32(70000);
+        for (auto && key : k32) key = u32i(rng());
+        vector<u32i> r32 = k32;
+        sort(r32.begin(), r32.end());
+        CHECK(sortmnp::radix_sort(k32.data(), k32.size(), threads));
+        CHECK(k32 == r32);
+        vector<ipkey_u128> k128(70000);
+        for (auto && key : k128) key = {rng(), rng() & 0xFF00000000000003ull}; // ms varies in top and low bytes
+        vector<ipkey_u128> r128 = k128;
+        sort(r128.begin(), r128.end(), key_less);
+        CHECK(sortmnp::radix_sort(k128.data(), k128.size(), threads));
+        CHECK(k128 == r128);
+    }
+    u32i one {7};
+    CHECK(sortmnp::radix_sort(&one, 1) && sortmnp::radix_sort(&one, 0, 4) && (one == 7));
+}
+
+GIA_TEST(ipsort_addresses) {
+    mt19937_64 rng(35);
+    for (u32i threads : {1u, 4u}) {
+        vector<IPv4_Addr> v4((sortmnp::PAR_MIN * 2));
+        for (auto && ip : v4) ip = IPv4_Addr(u32i(rng()));
+        vector<IPv4_Addr> r4 = v4;
+        sort(r4.begin(), r4.end());
+        CHECK(sortmnp::sort(v4.data(), v4.size(), threads));
+        CHECK(v4 == r4);
+        vector<MAC_Addr> macs((sortmnp::PAR_MIN * 2));
+        for (auto && mac : macs) mac = MAC_Addr((rng() % 3) ? (0x001A2B000000ull | (rng() & 0xFFFFFF)) : (rng() >> 16)); // one OUI for most of them
+        vector<MAC_Addr> rm = macs;
+        sort(rm.begin(), rm.end());
+        CHECK(sortmnp::sort(macs.data(), macs.size(), threads));
+        CHECK(macs == rm);
+        for (bool sameMs : {false, true}) { // top varying byte is in upper half, then in lower one
+            vector<IPv6_Addr> v6((sortmnp::PAR_MIN * 2));
+            for (auto && ip : v6) ip = IPv6_Addr(sameMs ? 0x20010DB800000000ull : (0x2001000000000000ull | (rng() >> 20)), rng());
+            vector<IPv6_Addr> r6 = v6;
+            sort(r6.begin(), r6.end());
+            CHECK(sortmnp::sort(v6.data(), v6.size(), threads));
+            CHECK(v6 == r6);
+        }
+    }
+}
+
+GIA_TEST(ipsort_threads_over_buckets) {
+    mt19937_64 rng(350);
+    vector<u32i> keys(sortmnp::PAR_MIN + 17); // size is not multiple of thread count
+    for (auto && key : keys) key = (u32i(rng() % 3) << 24) | (rng() & 0xFFFF); // three values of top varying byte
+    vector<u32i> ref = keys;
+    sort(ref.begin(), ref.end());
+    CHECK(sortmnp::radix_sort(keys.data(), keys.size(), 16));
+    CHECK(keys == ref);
+    vector<IPv6_Addr> v6(sortmnp::PAR_MIN);
+    for (auto && ip : v6) ip = IPv6_Addr(0x20010DB800000000ull, 0x100 | (rng() & 1)); // one byte with two values
+    vector<IPv6_Addr> r6 = v6;
+    sort(r6.begin(), r6.end());
+    CHECK(sortmnp::sort(v6.data(), v6.size(), 64));
+    CHECK(v6 == r6);
+    vector<MAC_Addr> same(sortmnp::PAR_MIN, MAC_Addr(0x001A2B3C4D5Eull)); // no varying byte at all
+    size_t n = same.size();
+    vector<u32i> counts;
+    CHECK(sortmnp::sort_unique(same.data(), &n, 8, &counts));
+    CHECK((n == 1) && (same[0] == MAC_Addr(0x001A2B3C4D5Eull)) && (counts == vector<u32i>{u32i(sortmnp::PAR_MIN)}));
+}
+
+template <class A, class Gen>
+static void check_sort_unique(Gen gen, u32i threads) {
+    vector<A> addrs((sortmnp::PAR_MIN * 2));
+    map<A,u32i> ref;
+    for (auto && addr : addrs) {
+        addr = gen();
+        ref[addr]++;
+    }
+    size_t n = addrs.size();
+    vector<u32i> counts;
+    CHECK(sortmnp::sort_unique(addrs.data(), &n, threads, &counts));
+    CHECK_EQ(n, ref.size());
+    CHECK_EQ(counts.size(), n);
+    bool same {n == ref.size()};
+    size_t idx {0};
+    for (auto it = ref.begin(); same && (it != ref.end()); ++it, idx++) same = (addrs[idx] == it->first) && (counts[idx] == it->second);
+    CHECK(same);
+    size_t m = n;
+    CHECK(sortmnp::sort_unique(addrs.data(), &m, threads) && (m == n)); // without counts
+}
+
+GIA_TEST(ipsort_unique_counts) {
+    mt19937_64 rng(351);
+    for (u32i threads : {1u, 3u}) {
+        check_sort_unique<IPv4_Addr>([&rng]() { return IPv4_Addr(u32i(0x0A000000 | (rng() % 5000))); }, threads);
+        check_sort_unique<MAC_Addr>([&rng]() { return MAC_Addr(0x020000000000ull | (rng() % 3000)); }, threads);
+        check_sort_unique<IPv6_Addr>([&rng]() { return IPv6_Addr(0x20010DB800000000ull | (rng() % 7), rng() % 900); }, threads);
+    }
+    vector<u64i> keys {1, 1, 2, 5, 5, 5, 9};
+    vector<u32i> counts(keys.size());
+    CHECK_EQ(sortmnp::unique(keys.data(), keys.size(), counts.data()), size_t(4));
+    CHECK((vector<u64i>(keys.begin(), keys.begin() + 4) == vector<u64i>{1, 2, 5, 9}) && (vector<u32i>(counts.begin(), counts.begin() + 4) == vector<u32i>{2, 1, 3, 1}));
+    CHECK_EQ(sortmnp::unique(keys.data(), 0), size_t(0));
+    size_t none {0};
+    CHECK(sortmnp::sort_unique((IPv4_Addr*)nullptr, &none, 2) && (none == 0));
+}
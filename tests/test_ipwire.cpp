@@ -0,0 +1,104 @@
+#include <cstring>
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipwire.h"
+
+using namespace std;
+
+GIA_TEST(ipwire_strided) {
+    mt19937 rng(3);
+    const size_t rows {100}, stride {60};
+    vector<u8i> pkts(rows * stride);
+    for (auto && byte : pkts) byte = u8i(rng());
+    vector<IPv4_Addr> v4(rows);
+    vector<IPv6_Addr> v6(rows);
+    vector<MAC_Addr> macs(rows);
+    wiremnp::from_wire(pkts.data() + 12, stride, rows, v4.data());
+    wiremnp::from_wire(pkts.data() + 8, stride, rows, v6.data());
+    wiremnp::from_wire(pkts.data() + 6, stride, rows, macs.data());
+    for (size_t row = 0; row < rows; row++) {
+        CHECK(v4[row] == IPv4_Addr::from_wire(pkts.data() + row * stride + 12));
+        CHECK(v6[row] == IPv6_Addr::from_wire(pkts.data() + row * stride + 8));
+        CHECK(macs[row] == MAC_Addr::from_wire(pkts.data() + row * stride + 6));
+    }
+    vector<u8i> packed(rows * 16);
+    wiremnp::to_wire(v6.data(), rows, packed.data());
+    for (size_t row = 0; row < rows; row++) CHECK(memcmp(packed.data() + row * 16, pkts.data() + row * stride + 8, 16) == 0);
+    vector<u8i> back(rows * stride);
+    wiremnp::to_wire(v4.data(), rows, back.data() + 12, stride);
+    wiremnp::to_wire(macs.data(), rows, back.data() + 6, stride);
+    bool same {true};
+    for (size_t row = 0; row < rows; row++) {
+        same = same && (memcmp(back.data() + row * stride + 12, pkts.data() + row * stride + 12, 4) == 0);
+        same = same && (memcmp(back.data() + row * stride + 6, pkts.data() + row * stride + 6, 6) == 0);
+    }
+    CHECK(same);
+    vector<const u8i*> ptrs(rows);
+    for (size_t row = 0; row < rows; row++) ptrs[row] = pkts.data() + (rows - 1 - row) * stride; // separate buffers, reversed
+    vector<IPv4_Addr> pv4(rows);
+    vector<IPv6_Addr> pv6(rows);
+    vector<MAC_Addr> pmacs(rows);
+    wiremnp::from_wire(ptrs.data(), 12, rows, pv4.data());
+    wiremnp::from_wire(ptrs.data(), 8, rows, pv6.data());
+    wiremnp::from_wire(ptrs.data(), 6, rows, pmacs.data());
+    for (size_t row = 0; row < rows; row++) CHECK((pv4[row] == v4[rows - 1 - row]) && (pv6[row] == v6[rows - 1 - row]) && (pmacs[row] == macs[rows - 1 - row]));
+}
+
+// buffers are sized exactly, so kernel reading or writing past the last row is caught by sanitizers
+GIA_TEST(ipwire_packed_kernels) {
+    mt19937 rng(38);
+    for (size_t n = 0; n <= 70; n++) {
+        vector<u8i> w4(n * 4), w6(n * 16), wm(n * 6);
+        for (auto && byte : w4) byte = u8i(rng());
+        for (auto && byte : w6) byte = u8i(rng());
+        for (auto && byte : wm) byte = u8i(rng());
+        each_level([&]() {
+            vector<u32i> v4(n);
+            vector<u64i> hi(n), lo(n), mac(n);
+            wiremnp::v4_from_wire(w4.data(), 4, n, v4.data());
+            wiremnp::v6_from_wire(w6.data(), 16, n, hi.data(), lo.data());
+            wiremnp::mac_from_wire(wm.data(), 6, n, mac.data());
+            bool same {true};
+            for (size_t row = 0; row < n; row++) {
+                same = same && (v4[row] == IPv4_Addr::from_wire(w4.data() + row * 4)());
+                same = same && (IPv6_Addr(hi[row], lo[row]) == IPv6_Addr::from_wire(w6.data() + row * 16));
+                same = same && (mac[row] == MAC_Addr::from_wire(wm.data() + row * 6)());
+            }
+            CHECK(same);
+            vector<u8i> b4(n * 4), b6(n * 16), bm(n * 6);
+            wiremnp::v4_to_wire(v4.data(), n, b4.data());
+            wiremnp::v6_to_wire(hi.data(), lo.data(), n, b6.data());
+            wiremnp::mac_to_wire(mac.data(), n, bm.data());
+            CHECK((b4 == w4) && (b6 == w6) && (bm == wm));
+        });
+    }
+}
+
+GIA_TEST(ipwire_packed_batches) {
+    mt19937 rng(380);
+    const size_t rows {wiremnp::BATCH * 2 + 5}; // object versions convert in batches, last one is partial
+    vector<u8i> w4(rows * 4), w6(rows * 16), wm(rows * 6);
+    for (auto && byte : w4) byte = u8i(rng());
+    for (auto && byte : w6) byte = u8i(rng());
+    for (auto && byte : wm) byte = u8i(rng());
+    each_level([&]() {
+        vector<IPv4_Addr> v4(rows);
+        vector<IPv6_Addr> v6(rows);
+        vector<MAC_Addr> macs(rows);
+        wiremnp::from_wire(w4.data(), 4, rows, v4.data());
+        wiremnp::from_wire(w6.data(), 16, rows, v6.data());
+        wiremnp::from_wire(wm.data(), 6, rows, macs.data());
+        bool same {true};
+        for (size_t row = 0; row < rows; row++) {
+            same = same && (v4[row] == IPv4_Addr::from_wire(w4.data() + row * 4));
+            same = same && (v6[row] == IPv6_Addr::from_wire(w6.data() + row * 16));
+            same = same && (macs[row] == MAC_Addr::from_wire(wm.data() + row * 6));
+        }
+        CHECK(same);
+        vector<u8i> b4(rows * 4), b6(rows * 16), bm(rows * 6);
+        wiremnp::to_wire(v4.data(), rows, b4.data());
+        wiremnp::to_wire(v6.data(), rows, b6.data());
+        wiremnp::to_wire(macs.data(), rows, bm.data());
+        CHECK((b4 == w4) && (b6 == w6) && (bm == wm));
+    });
+}
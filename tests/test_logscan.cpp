@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <set>
+#include "gia_test.h"
+#include "../gia_logscan.h"
+
+using namespace std;
+
+static vector<scan_hit> extract_of(const string &text) {
+    vector<scan_hit> ret;
+    Log_Scanner::extract((const u8i*)text.data(), text.size(), &ret);
+    return ret;
+}
+
+GIA_TEST(logscan_extract_tokens) {
+    string text = "from 10.0.0.1:8080 to [2001:db8::1]:443 mac 00:1a:2b:3c:4d:5e, 00-1A-2B-3C-4D-5F and 001a.2b3c.4d60 "
+                  "port:192.168.1.7 id=fe10.0.0.1 x10.0.0.2 std::vector 999.1.1.1 1.2.3.4-5.6.7.8 ::ffff:1.2.3.4 end 10.9.8.7.";
+    struct { const char *tok; u32i family; } want[] {
+        {"10.0.0.1", scanmnp::IPv4}, {"2001:db8::1", scanmnp::IPv6}, {"00:1a:2b:3c:4d:5e", scanmnp::MAC}, {"00-1A-2B-3C-4D-5F", scanmnp::MAC},
+        {"001a.2b3c.4d60", scanmnp::MAC}, {"192.168.1.7", scanmnp::IPv4}, {"1.2.3.4", scanmnp::IPv4}, {"5.6.7.8", scanmnp::IPv4},
+        {"::ffff:1.2.3.4", scanmnp::IPv6}, {"10.9.8.7", scanmnp::IPv4},
+    };
+    each_level([&] {
+        vector<scan_hit> hits = extract_of(text);
+        CHECK_EQ(hits.size(), size(want));
+        for (size_t idx = 0; (idx < hits.size()) && (idx < size(want)); idx++) {
+            CHECK_EQ(hits[idx].offset, u64i(text.find(want[idx].tok)));
+            CHECK_EQ(hits[idx].family, want[idx].family);
+        }
+    });
+    vector<scan_hit> hits = extract_of(text);
+    CHECK_EQ(hits.size(), size(want));
+    if (hits.size() != size(want)) return;
+    CHECK_EQ(hits[0].ls, u64i(IPv4_Addr("10.0.0.1")()));
+    CHECK((hits[1].ms == IPv6_Addr("2001:db8::1")().ms) && (hits[1].ls == 1));
+    CHECK_EQ(hits[2].ls, u64i(0x001A2B3C4D5Eull));
+    CHECK_EQ(hits[3].ls, u64i(0x001A2B3C4D5Full));
+    CHECK_EQ(hits[4].ls, u64i(0x001A2B3C4D60ull));
+    CHECK((hits[8].ms == 0) && (hits[8].ls == 0x0000FFFF01020304ull));
+    CHECK(extract_of(string(70, 'a') + ".10.0.0.1").empty()); // longer than MAX_TOKEN
+    CHECK(extract_of("cafe:babe 1.2.3 dead::beef::1").empty());
+}
+
+GIA_TEST(logscan_block_edges) {
+    each_level([] {
+        for (size_t at = 0; at < 140; at++) { // token moves over 64-byte blocks of class mask
+            string text = string(at, ' ') + "2001:db8::77 10.1.2.3" + string(at % 7, ' ');
+            vector<scan_hit> hits = extract_of(text);
+            CHECK((hits.size() == 2) && (hits[0].offset == at) && (hits[1].offset == at + 13));
+            text = string(at, 'z') + "10.1.2.3"; // word symbol right before
+            CHECK(extract_of(text).size() == (at ? 0u : 1u));
+        }
+    });
+}
+
+GIA_TEST(logscan_chunk_bounds) {
+    string text;
+    for (u32i idx = 0; text.size() < scanmnp::CHUNK - 5; idx++) {
+        text += "conn 10." + to_string(idx % 256) + "." + to_string(idx / 256 % 256) + ".1 from 2001:db8::" + to_string(idx % 9999) + " ok\n";
+    }
+    text.resize(scanmnp::CHUNK - 5);
+    text += "\n172.16.31.40 crosses\n"; // token spans chunk offset
+    while (text.size() < 2 * scanmnp::CHUNK + 1000) text += "mac 02:00:00:00:" + to_string(10 + text.size() % 90) + ":01 seen\n";
+    text += "last 203.0.113.9"; // no newline at the end
+    vector<scan_hit> ref = extract_of(text);
+    for (u32i threads : {1u, 3u, 8u}) {
+        Log_Scanner scn;
+        CHECK(scn.add_buffer((const u8i*)text.data(), text.size()));
+        CHECK(scn.add_buffer((const u8i*)"::1", 3));
+        vector<scan_hit> got;
+        CHECK(scn.scan([&got](const scan_hit *hits, size_t n) { got.insert(got.end(), hits, hits + n); }, threads));
+        sort(got.begin(), got.end(), [](const scan_hit &a, const scan_hit &b) { return (a.file < b.file) || ((a.file == b.file) && (a.offset < b.offset)); });
+        CHECK_EQ(got.size(), ref.size() + 1);
+        bool same {got.size() == ref.size() + 1};
+        for (size_t idx = 0; same && (idx < ref.size()); idx++) same = (got[idx].offset == ref[idx].offset) && (got[idx].ls == ref[idx].ls) && (got[idx].family == ref[idx].family) && (got[idx].file == 0);
+        CHECK(same);
+        CHECK((got.back().file == 1) && (got.back().family == scanmnp::IPv6));
+        CHECK_EQ(scn.stats().bytes.load(), u64i(text.size() + 3));
+        CHECK_EQ(scn.stats().hits[0] + scn.stats().hits[1] + scn.stats().hits[2], u64i(got.size()));
+    }
+    set<u32i> refV4;
+    set<u64i> refMac;
+    for (auto && hit : ref) {
+        if (hit.family == scanmnp::IPv4) refV4.insert(u32i(hit.ls));
+        else if (hit.family == scanmnp::MAC) refMac.insert(hit.ls);
+    }
+    CHECK(refV4.count(IPv4_Addr("172.16.31.40")()) && refV4.count(IPv4_Addr("203.0.113.9")()));
+    Log_Scanner scn;
+    scn.add_buffer((const u8i*)text.data(), text.size());
+    vector<IPv4_Addr> v4;
+    vector<MAC_Addr> macs;
+    CHECK(scn.scan_unique(&v4, nullptr, &macs, 4));
+    CHECK_EQ(v4.size(), refV4.size());
+    CHECK(is_sorted(v4.begin(), v4.end()) && (v4.front()() == *refV4.begin()));
+    CHECK((macs.size() == refMac.size()) && (macs.size() > 1));
+    CHECK(!scn.add_file("gia_test_missing.log") && (scn.last_err() == scanmnp::IOError));
+}
+
+GIA_TEST(logscan_sink_throws) {
+    string text;
+    while (text.size() < 3 * scanmnp::CHUNK) text += "src 10.0.0." + to_string(text.size() % 250) + " dst 2001:db8::1\n"; // hits in every chunk
+    for (u32i threads : {1u, 4u}) {
+        Log_Scanner scn;
+        scn.add_buffer((const u8i*)text.data(), text.size());
+        atomic<u32i> calls {0};
+        CHECK(!scn.scan([&calls](const scan_hit *, size_t) { calls++; throw runtime_error("sink"); }, threads));
+        CHECK_EQ(scn.last_err(), scanmnp::STL_Exception);
+        CHECK_EQ(calls.load(), 1u);
+    }
+}
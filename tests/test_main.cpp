@@ -0,0 +1,38 @@
+#include <cstring>
+#include "gia_test.h"
+
+using namespace std;
+
+static unsigned long long failures {0};
+static const char *current {""};
+
+vector<test_case>& test_registry() {
+    static vector<test_case> cases;
+    return cases;
+}
+
+bool test_register(const char *name, void (*func)()) {
+    test_registry().push_back({name, func});
+    return true;
+}
+
+void test_fail(const char *file, int line, const string &what) {
+    failures++;
+    fprintf(stderr, "%s:%d: %s : CHECK(%s) failed\n", file, line, current, what.c_str());
+}
+
+// usage : gia_tests [substring] - runs cases whose name contains substring
+int main(int argc, char *argv[]) {
+    size_t run {0}, failed {0};
+    for (auto && tcase : test_registry()) {
+        if ((argc > 1) && (strstr(tcase.name, argv[1]) == nullptr)) continue;
+        current = tcase.name;
+        unsigned long long before = failures;
+        tcase.func();
+        run++;
+        if (failures != before) failed++;
+        printf("%s %s\n", (failures != before) ? "FAIL" : "ok  ", tcase.name);
+    }
+    printf("%zu cases, %zu failed, %llu checks failed\n", run, failed, failures);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#include <random>
+#include "gia_test.h"
+#include "../gia_nat64.h"
+
+using namespace std;
+
+GIA_TEST(nat64_rfc6052_table) { // RFC 6052 2.4 : 192.0.2.33 under each prefix length
+    const struct { const char *pfx; u32i len; const char *addr; } rows[] = {
+        {"2001:db8::", 32, "2001:db8:c000:221::"},
+        {"2001:db8:100::", 40, "2001:db8:1c0:2:21::"},
+        {"2001:db8:122::", 48, "2001:db8:122:c000:2:2100::"},
+        {"2001:db8:122:300::", 56, "2001:db8:122:3c0:0:221::"},
+        {"2001:db8:122:344::", 64, "2001:db8:122:344:c0:2:2100:0"},
+        {"2001:db8:122:344::", 96, "2001:db8:122:344::c000:221"}};
+    IPv4_Addr v4(192, 0, 2, 33);
+    for (auto && row : rows) {
+        NAT64_Xlat xlat(IPv6_Addr(row.pfx), row.len);
+        CHECK_EQ(xlat.last_err(), nat64mnp::NoError);
+        IPv6_Addr v6 = xlat.to_v6(v4);
+        CHECK_EQ(v6.to_str(v6mnp::IETF_VIEW), string(row.addr));
+        IPv4_Addr back;
+        CHECK(xlat.to_v4(v6, &back) && (back == v4));
+        CHECK(xlat.matches(v6));
+        IPv6_Addr uoct = v6;
+        uoct[v6mnp::xtt5] |= 0x0100; // u-octet must stay zero
+        CHECK(!xlat.matches(uoct) && !xlat.to_v4(uoct, &back) && (back() == 0));
+    }
+    NAT64_Xlat wkp;
+    CHECK_EQ(wkp.to_v6(v4).to_str(v6mnp::IETF_VIEW), string("64:ff9b::c000:221"));
+    CHECK(wkp.to_v6(v4).is_wknown_pfx());
+    CHECK_EQ(NAT64_Xlat(IPv6_Addr("2001:db8::"), 33).last_err(), nat64mnp::BadPrefixLen);
+    CHECK_EQ(NAT64_Xlat(IPv6_Addr("2001:db8::ff00:0:0:0"), 96).last_err(), nat64mnp::BadPrefix);
+    CHECK_EQ(NAT64_Xlat(IPv6_Addr("2001:db8::"), 33).prefix_len(), 96u);
+}
+
+GIA_TEST(nat64_batch_wire) {
+    mt19937 rng(45);
+    const size_t rows {103};
+    vector<IPv4_Addr> v4(rows);
+    for (auto && ip : v4) ip = IPv4_Addr(u32i(rng()));
+    for (u32i len : {32, 40, 48, 56, 64, 96}) {
+        NAT64_Xlat xlat(IPv6_Addr(0x20010DB8AABBCCDDull, 0x00EEFF0011223344ull), len);
+        vector<IPv6_Addr> v6(rows);
+        xlat.to_v6(v4.data(), rows, v6.data());
+        v6[7] = IPv6_Addr(0xFE80000000000000ull, 1); // foreign rows
+        v6[50] = IPv6_Addr(0x20010DB9AABBCCDDull, 0);
+        vector<IPv4_Addr> back(rows);
+        CHECK_EQ(xlat.to_v4(v6.data(), rows, back.data()), rows - 2);
+        for (size_t row = 0; row < rows; row++) CHECK_EQ(back[row](), ((row == 7) || (row == 50)) ? 0u : v4[row]());
+        vector<u8i> in4(rows * 4), want6(rows * 16);
+        for (size_t row = 0; row < rows; row++) {
+            v4[row].to_wire(&in4[row * 4]);
+            xlat.to_v6(v4[row]).to_wire(&want6[row * 16]);
+        }
+        vector<u8i> wire6(rows * 16);
+        for (size_t row = 0; row < rows; row++) v6[row].to_wire(&wire6[row * 16]);
+        each_level([&]() {
+            vector<u8i> out6(rows * 16), out4(rows * 4, 0xAA);
+            xlat.to_v6_wire(in4.data(), rows, out6.data());
+            CHECK(out6 == want6);
+            CHECK_EQ(xlat.to_v4_wire(wire6.data(), rows, out4.data()), rows - 2);
+            for (size_t row = 0; row < rows; row++) CHECK_EQ(IPv4_Addr::from_wire(&out4[row * 4])(), back[row]());
+        });
+    }
+}
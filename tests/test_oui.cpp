@@ -0,0 +1,101 @@
+#include <random>
+#include <sstream>
+#include "gia_test.h"
+#include "../gia_oui.h"
+
+using namespace std;
+
+GIA_TEST(oui_parse_txt_and_csv) {
+    OUI_Compiler cmp;
+    istringstream txt {
+        "OUI/MA-L                                                    Organization\r\n"
+        "company_id                                                  Organization\r\n"
+        "\r\n"
+        "00-1A-2B   (hex)\t\tAcme Networks\r\n"
+        "001A2B     (base 16)\t\tAcme Networks\r\n"
+        "\t\t\t\t1 Road\r\n"
+        "\r\n"
+        "70-B3-D5   (hex)\t\tSmall Devices\r\n"
+        "123000-123FFF     (base 16)\t\tSmall Devices\r\n"
+        "\r\n"
+        "8C-1F-64   (hex)\t\tMid Range\r\n"
+        "A00000-AFFFFF     (base 16)\t\tMid Range\r\n"
+        "\r\n"
+        "00-1A-2B   (hex)\t\tDuplicate\r\n" // first assignment wins
+        "00-00-0Z   (hex)\t\tBroken\r\n"
+        "11-22-33   (hex)\t\tLast One\r\n"}; // no "(base 16)" line at end of file
+    CHECK_EQ(cmp.parse(txt), size_t(4));
+    istringstream csv {
+        "Registry,Assignment,Organization Name,Organization Address\n"
+        "MA-L,F4A2B1,\"Quoted, \"\"Inc\"\"\",\"Somewhere\"\n"
+        "MA-M,F4A2B1C,Sub Block,Here\n"
+        "MA-S,70B3D5124,Tiny Block,There\n"
+        "MA-L,XYZ123,Bad Hex,Nowhere\n"
+        "MA-L,F4A2B1,Again,Nowhere\n"
+        "IAB,0050C2001,Old Iab,Elsewhere\n"};
+    CHECK_EQ(cmp.parse(csv), size_t(4));
+    CHECK_EQ(cmp.count(), size_t(8));
+    CHECK(!cmp.add(0x1000000, 24, "Too Wide"));
+    CHECK(!cmp.add(0x123, 20, "Bad Length"));
+    CHECK(!cmp.add(0x123456, 24, ""));
+    vector<u8i> image = cmp.build();
+    CHECK(!image.empty());
+    OUI_DB db;
+    CHECK(db.view(image.data(), image.size()));
+    CHECK_EQ(db.count(), size_t(8));
+    u32i len {0};
+    CHECK(db.vendor(MAC_Addr(0x001A2B000001ull), &len) == "Acme Networks");
+    CHECK_EQ(len, 24u);
+    CHECK(db.vendor(MAC_Addr(0x70B3D5123ABCull), &len) == "Small Devices");
+    CHECK_EQ(len, 36u);
+    CHECK(db.vendor(MAC_Addr(0x70B3D5124001ull), &len) == "Tiny Block");
+    CHECK(db.vendor(MAC_Addr(0x70B3D5125000ull)).empty());
+    CHECK(db.vendor(MAC_Addr(0x8C1F64A12345ull), &len) == "Mid Range");
+    CHECK_EQ(len, 28u);
+    CHECK(db.vendor(MAC_Addr(0xF4A2B1C00000ull), &len) == "Sub Block"); // longest prefix over MA-L
+    CHECK_EQ(len, 28u);
+    CHECK(db.vendor(MAC_Addr(0xF4A2B1000000ull), &len) == "Quoted, \"Inc\"");
+    CHECK_EQ(len, 24u);
+    CHECK(db.vendor(MAC_Addr(0x112233445566ull)) == "Last One");
+    CHECK(db.vendor(MAC_Addr(0x0050C2001FFFull)) == "Old Iab");
+    CHECK(db.vendor_oui(MAC_Addr(0x001A2BFFFFFFull).get_oui()) == "Acme Networks");
+    CHECK(db.vendor_oui(0x70B3D5).empty()); // only MA-S blocks under it
+}
+
+GIA_TEST(oui_build_many) {
+    mt19937_64 rng(32);
+    OUI_Compiler cmp;
+    vector<pair<u64i,u32i>> added;
+    for (u32i idx = 0; idx < 30000; idx++) {
+        u32i len = ouimnp::PREFIX_LEN[idx % ouimnp::LEVELS];
+        u64i prefix = rng() >> (64 - len);
+        if (cmp.add(prefix, len, "vendor-" + to_string(idx))) added.push_back({prefix, len});
+    }
+    vector<u8i> image = cmp.build();
+    CHECK(!image.empty());
+    OUI_DB db;
+    CHECK(db.view(image.data(), image.size()));
+    CHECK_EQ(db.count(), added.size());
+    vector<MAC_Addr> macs;
+    for (auto && pfx : added) {
+        MAC_Addr mac(pfx.first << (48 - pfx.second));
+        u32i len {0};
+        CHECK(!db.vendor(mac, &len).empty());
+        CHECK(len >= pfx.second); // random longer prefix may cover same address
+        macs.push_back(mac);
+    }
+    vector<string_view> out(macs.size());
+    db.vendor(macs.data(), macs.size(), out.data());
+    for (size_t idx = 0; idx < macs.size(); idx++) CHECK(out[idx] == db.vendor(macs[idx]));
+    image[0] ^= 0xFF; // magic
+    OUI_DB bad;
+    CHECK(!bad.view(image.data(), image.size()) && (bad.last_err() == ouimnp::BadImage) && !bad.is_open());
+    CHECK(bad.vendor(macs[0]).empty());
+    image[0] ^= 0xFF;
+    CHECK(!bad.view(image.data(), ouimnp::HEADER_LEN + 8)); // truncated
+    OUI_Compiler empty;
+    vector<u8i> none = empty.build();
+    OUI_DB nodb;
+    CHECK(!none.empty() && nodb.view(none.data(), none.size()) && (nodb.count() == 0));
+    CHECK(nodb.vendor(MAC_Addr(0x001A2B000001ull)).empty());
+}
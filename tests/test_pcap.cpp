@@ -0,0 +1,234 @@
+#include "gia_test.h"
+#include "../gia_pcap.h"
+
+using namespace std;
+
+struct cap_buf { // capture file built in memory, header fields in chosen byte order, packets as on wire
+    vector<u8i> bytes;
+    bool swap;
+    void put(const void *data, size_t n) { bytes.insert(bytes.end(), (const u8i*)data, (const u8i*)data + n); };
+    void put16(u16i val) { if (swap) val = __builtin_bswap16(val); put(&val, 2); };
+    void put32(u32i val) { if (swap) val = __builtin_bswap32(val); put(&val, 4); };
+    void pad() { while (bytes.size() & 3) bytes.push_back(0); };
+    void set32(size_t at, u32i val) { if (swap) val = __builtin_bswap32(val); memcpy(&bytes[at], &val, 4); };
+};
+
+static vector<u8i> eth(u64i dst, u64i src, vector<u16i> tags, u16i etype, const vector<u8i> &l3) { // tags are TPID, TCI pairs
+    vector<u8i> ret(12);
+    MAC_Addr(dst).to_wire(ret.data());
+    MAC_Addr(src).to_wire(ret.data() + 6);
+    tags.push_back(etype);
+    for (auto && val : tags) {
+        ret.push_back(val >> 8);
+        ret.push_back(val & 0xFF);
+    }
+    ret.insert(ret.end(), l3.begin(), l3.end());
+    return ret;
+}
+
+static vector<u8i> ipv4(const char *src, const char *dst, u8i proto) {
+    vector<u8i> ret(28); // header and 8 bytes of payload
+    ret[0] = 0x45;
+    ret[9] = proto;
+    IPv4_Addr(src).to_wire(ret.data() + 12);
+    IPv4_Addr(dst).to_wire(ret.data() + 16);
+    return ret;
+}
+
+static vector<u8i> ipv6(const char *src, const char *dst, u8i next) {
+    vector<u8i> ret(40);
+    ret[0] = 0x60;
+    ret[6] = next;
+    IPv6_Addr(src).to_wire(ret.data() + 8);
+    IPv6_Addr(dst).to_wire(ret.data() + 24);
+    return ret;
+}
+
+static vector<vector<u8i>> frames() {
+    return {
+        eth(0x02000000000Bull, 0x02000000000Aull, {}, pcapmnp::ET_IPv4, ipv4("192.0.2.1", "198.51.100.7", 17)),
+        eth(0x02000000000Bull, 0x02000000000Cull, {pcapmnp::ET_VLAN, 100}, pcapmnp::ET_IPv4, ipv4("10.0.0.1", "10.0.0.2", 6)),
+        eth(0x02000000000Bull, 0x02000000000Dull, {pcapmnp::ET_QinQ, 0x2000 | 200, pcapmnp::ET_VLAN, 300}, pcapmnp::ET_IPv6, ipv6("2001:db8::1", "2001:db8::2", 58)),
+        eth(0xFFFFFFFFFFFFull, 0x02000000000Aull, {}, 0x0806, vector<u8i>(28)), // ARP
+        eth(0x02000000000Bull, 0x02000000000Aull, {pcapmnp::ET_VLAN, 1, pcapmnp::ET_VLAN, 2, pcapmnp::ET_VLAN, 3}, pcapmnp::ET_IPv4, ipv4("10.0.0.3", "10.0.0.4", 6)), // over MAX_TAGS
+        vector<u8i>(10, 0xEE), // runt frame
+    };
+}
+
+static void check_frames(const pcap_batch &bt, size_t from, size_t n) { // rows of batch against frames() from index
+    static const vector<vector<u8i>> frm = frames();
+    for (size_t row = 0; row < n; row++) {
+        size_t idx = from + row;
+        CHECK_EQ(bt.wireLen[row], u32i(frm[idx].size()));
+        CHECK_EQ(u32i(bt.family[row]), u32i(idx == 2 ? 6 : (idx < 2) ? 4 : 0));
+        CHECK_EQ(u32i(bt.proto[row]), u32i(idx == 0 ? 17 : idx == 1 ? 6 : idx == 2 ? 58 : 0));
+        CHECK_EQ(bt.vlan[row], u16i(idx == 1 ? 100 : idx == 2 ? 200 : idx == 4 ? 1 : pcapmnp::NO_VLAN));
+    }
+    for (size_t row = 0; row < n; row++) {
+        size_t idx = from + row;
+        if (idx == 0) CHECK((bt.src4.at(row) == IPv4_Addr("192.0.2.1")) && (bt.dst4.at(row) == IPv4_Addr("198.51.100.7")));
+        if (idx == 0) CHECK((bt.srcMac.at(row)() == 0x02000000000Aull) && (bt.dstMac.at(row)() == 0x02000000000Bull));
+        if (idx == 2) CHECK((bt.src6.at(row) == IPv6_Addr("2001:db8::1")) && (bt.dst6.at(row) == IPv6_Addr("2001:db8::2")));
+        if (idx == 2) CHECK(bt.src4.at(row)() == 0);
+        if (idx == 5) CHECK(bt.srcMac.at(row)() == 0);
+    }
+}
+
+static cap_buf classic(bool swap, bool nanos) {
+    cap_buf cap {{}, swap};
+    cap.put32(nanos ? 0xA1B23C4D : 0xA1B2C3D4);
+    cap.put16(2);
+    cap.put16(4);
+    cap.put32(0);
+    cap.put32(0);
+    cap.put32(65535);
+    cap.put32(pcapmnp::Ethernet);
+    u32i sec {1700000000};
+    for (auto && frm : frames()) {
+        cap.put32(sec++);
+        cap.put32(123);
+        cap.put32(frm.size());
+        cap.put32(frm.size());
+        cap.put(frm.data(), frm.size());
+    }
+    return cap;
+}
+
+GIA_TEST(pcap_classic_byte_orders) {
+    for (bool swap : {false, true}) {
+        for (bool nanos : {false, true}) {
+            cap_buf cap = classic(swap, nanos);
+            PCap_Reader rd;
+            CHECK(rd.view(cap.bytes.data(), cap.bytes.size()) && !rd.is_ng());
+            pcap_batch bt;
+            size_t seen {0};
+            for (size_t cnt; (cnt = rd.next(&bt, 4)) > 0; seen += cnt) {
+                CHECK_EQ(bt.size(), cnt);
+                CHECK_EQ(bt.ts[0], u64i(1700000000 + seen) * 1000000000 + (nanos ? 123 : 123000));
+                check_frames(bt, seen, cnt);
+            }
+            CHECK_EQ(seen, frames().size());
+            CHECK_EQ(rd.packets(), u64i(seen));
+            CHECK_EQ(rd.last_err(), pcapmnp::NoError);
+            rd.rewind();
+            CHECK_EQ(rd.next(&bt), frames().size());
+        }
+    }
+    cap_buf raw {{}, false};
+    raw.put32(0xA1B2C3D4);
+    raw.put(vector<u8i>(16).data(), 16);
+    raw.put32(pcapmnp::Raw | 0x10000000); // FCS bits
+    vector<u8i> pkt = ipv6("::1", "2001:db8::9", 6);
+    raw.put32(1);
+    raw.put32(0);
+    raw.put32(pkt.size());
+    raw.put32(1500);
+    raw.put(pkt.data(), pkt.size());
+    PCap_Reader rd;
+    pcap_batch bt;
+    CHECK(rd.view(raw.bytes.data(), raw.bytes.size()) && (rd.next(&bt) == 1));
+    CHECK((bt.family[0] == 6) && (bt.wireLen[0] == 1500) && (bt.dst6.at(0) == IPv6_Addr("2001:db8::9")) && (bt.vlan[0] == pcapmnp::NO_VLAN));
+}
+
+static void ng_block(cap_buf &cap, u32i type, const vector<u8i> &body) { // body is already in file byte order
+    cap.put32(type);
+    cap.put32(12 + ((body.size() + 3) & ~size_t(3)));
+    cap.put(body.data(), body.size());
+    cap.pad();
+    cap.put32(12 + ((body.size() + 3) & ~size_t(3)));
+}
+
+static vector<u8i> ng_fields(bool swap, initializer_list<u32i> vals, const vector<u8i> &tail = {}) {
+    cap_buf tmp {{}, swap};
+    for (auto val : vals) tmp.put32(val);
+    tmp.put(tail.data(), tail.size());
+    tmp.pad();
+    return tmp.bytes;
+}
+
+static void ng_section(cap_buf &cap) {
+    ng_block(cap, 0x0A0D0D0A, ng_fields(cap.swap, {0x1A2B3C4D, 1, 0xFFFFFFFF, 0xFFFFFFFF})); // major 1, minor 0 and unknown length
+}
+
+static void ng_iface(cap_buf &cap, u16i link, int tsresol) {
+    cap_buf tmp {{}, cap.swap};
+    tmp.put16(link);
+    tmp.put16(0);
+    tmp.put32(65535);
+    if (tsresol >= 0) {
+        tmp.put16(9);
+        tmp.put16(1);
+        tmp.put32(0); // value and padding
+        tmp.bytes[tmp.bytes.size() - 4] = u8i(tsresol);
+        tmp.put32(0); // opt_endofopt
+    }
+    ng_block(cap, 1, tmp.bytes);
+}
+
+static void ng_epb(cap_buf &cap, u32i ifid, u64i ticks, const vector<u8i> &pkt) {
+    ng_block(cap, 6, ng_fields(cap.swap, {ifid, u32i(ticks >> 32), u32i(ticks), u32i(pkt.size()), u32i(pkt.size())}, pkt));
+}
+
+static cap_buf pcapng(bool swap) {
+    cap_buf cap {{}, swap};
+    ng_section(cap);
+    ng_iface(cap, pcapmnp::Ethernet, -1); // microseconds
+    ng_iface(cap, pcapmnp::RawIPv6, 9); // nanoseconds
+    vector<vector<u8i>> frm = frames();
+    for (u32i idx = 0; idx < frm.size(); idx++) ng_epb(cap, 0, 1700000000000000ull + idx, frm[idx]);
+    ng_epb(cap, 1, 1700000000123456789ull, ipv6("2001:db8::a", "2001:db8::b", 17));
+    ng_block(cap, 3, ng_fields(swap, {u32i(frm[0].size())}, frm[0])); // simple packet on first interface
+    ng_section(cap); // new section drops interfaces
+    ng_iface(cap, pcapmnp::Ethernet, 0x80 | 10); // 1/1024 s
+    ng_epb(cap, 0, 1024 * 5 + 512, frm[1]);
+    return cap;
+}
+
+GIA_TEST(pcap_ng_byte_orders) {
+    for (bool swap : {false, true}) {
+        cap_buf cap = pcapng(swap);
+        PCap_Reader rd;
+        CHECK(rd.view(cap.bytes.data(), cap.bytes.size()) && rd.is_ng());
+        pcap_batch bt;
+        size_t cnt = rd.next(&bt);
+        CHECK_EQ(rd.last_err(), pcapmnp::NoError);
+        CHECK_EQ(cnt, frames().size() + 3);
+        if (cnt != frames().size() + 3) continue;
+        check_frames(bt, 0, frames().size());
+        CHECK_EQ(bt.ts[1], u64i(1700000000000001ull) * 1000);
+        size_t row = frames().size();
+        CHECK_EQ(bt.ts[row], u64i(1700000000123456789ull));
+        CHECK((bt.family[row] == 6) && (bt.proto[row] == 17) && (bt.src6.at(row) == IPv6_Addr("2001:db8::a")));
+        CHECK((bt.ts[row + 1] == 0) && (bt.family[row + 1] == 4) && (bt.src4.at(row + 1) == IPv4_Addr("192.0.2.1")));
+        CHECK_EQ(bt.ts[row + 2], u64i(5500000000));
+        CHECK_EQ(bt.vlan[row + 2], u16i(100));
+        CHECK_EQ(rd.next(&bt), size_t(0));
+    }
+    cap_buf bad = pcapng(false);
+    bad.set32(28 + 20 + 32 + 8, 7); // interface id of first packet, after section and two interface blocks
+    PCap_Reader rd;
+    pcap_batch bt;
+    CHECK(rd.view(bad.bytes.data(), bad.bytes.size()) && (rd.next(&bt) == 0) && (rd.last_err() == pcapmnp::BadFormat));
+}
+
+GIA_TEST(pcap_truncated) {
+    cap_buf full = classic(false, false);
+    PCap_Reader rd;
+    pcap_batch bt;
+    size_t first = 24 + 16 + frames()[0].size();
+    for (size_t cut : {first + 5, first + 16 + 3}) { // inside record header, inside packet
+        CHECK(rd.view(full.bytes.data(), cut));
+        CHECK_EQ(rd.next(&bt), size_t(1));
+        CHECK_EQ(rd.last_err(), pcapmnp::Truncated);
+        CHECK_EQ(rd.next(&bt), size_t(0));
+    }
+    cap_buf ng = pcapng(true);
+    CHECK(rd.view(ng.bytes.data(), ng.bytes.size() - 4));
+    CHECK_EQ(rd.next(&bt), frames().size() + 2);
+    CHECK_EQ(rd.last_err(), pcapmnp::Truncated);
+    CHECK(!rd.view(ng.bytes.data(), 8));
+    vector<u8i> junk(64, 0x55);
+    CHECK(!rd.view(junk.data(), junk.size()) && (rd.last_err() == pcapmnp::BadFormat));
+    CHECK((rd.next(&bt) == 0) && (bt.size() == 0));
+    CHECK(!rd.open("gia_test_missing.pcap") && (rd.last_err() == pcapmnp::IOError));
+}
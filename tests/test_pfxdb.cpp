@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <random>
+#include "gia_test.h"
+#include "../gia_pfxdb.h"
+
+using namespace std;
+
+static bool view_of(PfxDB_Writer &wr, vector<u8i> &image, PfxDB &db) {
+    image = wr.build();
+    return !image.empty() && db.view(image.data(), image.size());
+}
+
+GIA_TEST(pfxdb_roundtrip) {
+    PfxDB_Writer wr;
+    CHECK(wr.insert(IPv4_Addr(192, 0, 2, 0), 24, "doc-v4"));
+    CHECK(wr.insert(IPv6_Addr("2001:db8::"), 32, "doc-v6"));
+    CHECK(wr.insert(IPv6_Addr("2001:db8:1::"), 48, "doc-v6")); // same record is stored once
+    CHECK(!wr.insert(IPv4_Addr(10, 0, 0, 0), 33, "bad") && (wr.last_err() == pfxmnp::BadPrefix));
+    CHECK_EQ(wr.records(), size_t(2));
+    string path = "gia_test_pfx.db";
+    CHECK(wr.save(path));
+    PfxDB db {path};
+    CHECK(db.is_open());
+    CHECK_EQ(db.record_count(), 2u);
+    u32i len {0};
+    CHECK(db.lookup(IPv4_Addr(192, 0, 2, 77), &len) == "doc-v4");
+    CHECK_EQ(len, 24u);
+    CHECK(db.lookup(IPv6_Addr("2001:db8:1::5"), &len) == "doc-v6");
+    CHECK_EQ(len, 48u);
+    CHECK(db.lookup(IPv6_Addr("2001:db8:2::5"), &len) == "doc-v6");
+    CHECK_EQ(len, 32u);
+    CHECK(db.lookup(IPv4_Addr(192, 0, 3, 1)).empty());
+    CHECK(db.lookup(IPv6_Addr("2001:db9::")).empty());
+    vector<u8i> bad = wr.build();
+    bad[8] ^= 0xFF; // version
+    PfxDB other;
+    CHECK(!other.view(bad.data(), bad.size()) && (other.last_err() == pfxmnp::BadImage) && !other.is_open());
+    remove(path.c_str());
+}
+
+GIA_TEST(pfxdb_nested_prefix_len) {
+    PfxDB_Writer wr;
+    wr.insert(IPv4_Addr(10, 0, 0, 0), 8, "A");
+    wr.insert(IPv4_Addr(10, 128, 0, 0), 9, "B");
+    wr.insert(IPv4_Addr(10, 1, 2, 0), 24, "C");
+    wr.insert(IPv4_Addr(10, 1, 2, 128), 25, "A"); // same record as /8 under other prefix
+    wr.insert(IPv6_Addr("::"), 0, "default");
+    vector<u8i> image;
+    PfxDB db;
+    CHECK(view_of(wr, image, db));
+    struct { const char *ip; const char *rec; u32i len; } cases[] {
+        {"10.1.2.3", "C", 24}, {"10.1.2.200", "A", 25}, {"10.1.3.3", "A", 8}, {"10.200.2.3", "B", 9},
+        {"10.127.255.255", "A", 8}, {"11.0.0.1", "default", 0},
+    };
+    for (auto && cs : cases) {
+        u32i len {999}, len6 {999};
+        CHECK(db.lookup(IPv4_Addr(cs.ip), &len) == cs.rec);
+        CHECK_EQ(len, cs.len);
+        IPv6_Addr mapped(0, pfxmnp::MAPPED_LS | IPv4_Addr(cs.ip)());
+        CHECK(db.lookup(mapped, &len6) == cs.rec);
+        CHECK_EQ(len6, (cs.len ? cs.len + 96 : 0u));
+    }
+    u32i len {999};
+    CHECK(db.lookup(IPv6_Addr("2001:db8::1"), &len) == "default");
+    CHECK_EQ(len, 0u);
+}
+
+GIA_TEST(pfxdb_batch_matches_single) {
+    mt19937_64 rng(33);
+    PfxDB_Writer wr;
+    for (u32i idx = 0; idx < 3000; idx++) {
+        u32i len = 8 + rng() % 25;
+        wr.insert(IPv4_Addr(u32i(rng()) & v4mnp::gen_mask(len)()), len, "v4-" + to_string(idx % 300));
+        u32i len6 = 16 + rng() % 49;
+        IPv6_Addr net(0x2001000000000000 | (rng() >> 16), 0);
+        net &= v6mnp::gen_mask(len6);
+        wr.insert(net, len6, "v6-" + to_string(idx % 300));
+    }
+    vector<u8i> image;
+    PfxDB db;
+    CHECK(view_of(wr, image, db));
+    vector<IPv4_Addr> v4(5000);
+    vector<IPv6_Addr> v6(5000);
+    for (auto && ip : v4) ip = IPv4_Addr(u32i(rng()));
+    for (auto && ip : v6) ip = IPv6_Addr(0x2001000000000000 | (rng() >> 16), rng());
+    vector<string_view> out4(v4.size()), out6(v6.size());
+    db.lookup(v4.data(), v4.size(), out4.data());
+    db.lookup(v6.data(), v6.size(), out6.data());
+    size_t hits {0};
+    for (size_t idx = 0; idx < v4.size(); idx++) {
+        CHECK(out4[idx] == db.lookup(v4[idx]));
+        CHECK(out6[idx] == db.lookup(v6[idx]));
+        hits += !out4[idx].empty();
+    }
+    CHECK(hits > 0);
+    PfxDB closed;
+    closed.lookup(v4.data(), v4.size(), out4.data());
+    CHECK(out4[0].empty() && closed.lookup(v4[0]).empty());
+}
+
+GIA_TEST(pfxdb_live_reload) {
+    string path = "gia_test_live.db";
+    PfxDB_Writer first, second;
+    first.insert(IPv4_Addr(10, 0, 0, 0), 8, "old");
+    second.insert(IPv4_Addr(10, 0, 0, 0), 8, "new");
+    PfxDB_Live live;
+    CHECK(!live.snapshot());
+    CHECK(first.save(path) && live.reload(path));
+    auto held = live.snapshot();
+    CHECK(held->lookup(IPv4_Addr(10, 1, 1, 1)) == "old");
+    CHECK(second.save(path) && live.reload(path));
+    CHECK(live.snapshot()->lookup(IPv4_Addr(10, 1, 1, 1)) == "new");
+    CHECK(held->lookup(IPv4_Addr(10, 1, 1, 1)) == "old"); // old mapping lives while held
+    CHECK(!live.reload(path + ".missing"));
+    CHECK(live.snapshot()->lookup(IPv4_Addr(10, 1, 1, 1)) == "new");
+    remove(path.c_str());
+}
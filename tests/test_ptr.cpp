@@ -0,0 +1,52 @@
+#include <random>
+#include "gia_test.h"
+#include "../gia_ipmnp.h"
+
+using namespace std;
+
+GIA_TEST(ptr_v4) {
+    char buf[v4mnp::PTR_SIZE];
+    CHECK_EQ(IPv4_Addr(192, 0, 2, 1).to_ptr_name(buf), size_t(22));
+    CHECK_EQ(string(buf), string("1.2.0.192.in-addr.arpa"));
+    CHECK_EQ(IPv4_Addr(0xFFFFFFFF).to_ptr_name(buf), size_t(v4mnp::PTR_SIZE - 1));
+    CHECK_EQ(string(buf), string("255.255.255.255.in-addr.arpa"));
+    IPv4_Addr ip;
+    CHECK(v4mnp::from_ptr_name("1.2.0.192.IN-ADDR.ARPA.", &ip) && (ip == IPv4_Addr(192, 0, 2, 1)));
+    for (const char *bad : {"2.0.192.in-addr.arpa", "5.1.2.0.192.in-addr.arpa", "256.2.0.192.in-addr.arpa", "1.2.0.192.ip6.arpa", "1..0.192.in-addr.arpa", ""}) CHECK(!v4mnp::from_ptr_name(bad));
+    vector<char> zone(300 * v4mnp::PTR_SIZE);
+    CHECK_EQ(v4mnp::to_ptr_names(IPv4_Addr(10, 1, 2, 77), 24, zone.data(), 300), size_t(256));
+    CHECK_EQ(string(&zone[0]), string("0.2.1.10.in-addr.arpa"));
+    CHECK_EQ(string(&zone[255 * v4mnp::PTR_SIZE]), string("255.2.1.10.in-addr.arpa"));
+    CHECK_EQ(v4mnp::to_ptr_names(IPv4_Addr(10, 0, 0, 0), 8, zone.data(), 3), size_t(3));
+}
+
+GIA_TEST(ptr_v6) {
+    char buf[v6mnp::PTR_SIZE];
+    IPv6_Addr ip("2001:db8::567:89ab"); // RFC 3596 2.5
+    const string name {"b.a.9.8.7.6.5.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.8.b.d.0.1.0.0.2.ip6.arpa"};
+    each_level([&]() {
+        CHECK_EQ(ip.to_ptr_name(buf), size_t(72));
+        CHECK_EQ(string(buf), name);
+        ip.to_ptr_name(buf, true);
+        CHECK_EQ(string(buf, 64), string("B.A.9.8.7.6.5.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.8.B.D.0.1.0.0.2."));
+    });
+    IPv6_Addr back;
+    each_level([&]() {
+        CHECK(v6mnp::from_ptr_name(name, &back) && (back == ip));
+        CHECK(v6mnp::from_ptr_name("B.A.9.8.7.6.5.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.8.B.D.0.1.0.0.2.IP6.ARPA.", &back) && (back == ip));
+        CHECK(!v6mnp::from_ptr_name(name.substr(2)));
+        CHECK(!v6mnp::from_ptr_name("g" + name.substr(1)));
+        CHECK(!v6mnp::from_ptr_name(name.substr(0, 62) + "/." + name.substr(64)));
+        CHECK(!v6mnp::from_ptr_name(name.substr(0, 31) + ":" + name.substr(32)));
+        CHECK(!v6mnp::from_ptr_name(name.substr(0, 64) + "in6.arpa"));
+    });
+    mt19937_64 rng(46);
+    vector<IPv6_Addr> arr;
+    for (u32i idx = 0; idx < 50; idx++) arr.push_back(IPv6_Addr(rng(), rng()));
+    vector<char> names(arr.size() * v6mnp::PTR_SIZE);
+    v6mnp::to_ptr_names(arr.data(), arr.size(), names.data());
+    for (size_t idx = 0; idx < arr.size(); idx++) CHECK(v6mnp::from_ptr_name(&names[idx * v6mnp::PTR_SIZE], &back) && (back == arr[idx]));
+    CHECK_EQ(v6mnp::to_ptr_names(IPv6_Addr("2001:db8::1:ff"), 120, names.data(), 50), size_t(50));
+    CHECK(v6mnp::from_ptr_name(&names[49 * v6mnp::PTR_SIZE], &back) && (back == IPv6_Addr("2001:db8::1:31")));
+    CHECK_EQ(v6mnp::to_ptr_names(IPv6_Addr("2001:db8::1:ff"), 127, names.data(), 50), size_t(2));
+}
@@ -0,0 +1,67 @@
+#include <random>
+#include "gia_test.h"
+#include "../gia_shard.h"
+
+using namespace std;
+
+GIA_TEST(shard_jump_minimal_move) {
+    CHECK_EQ(shardmnp::jump(0, 1), 0u);
+    mt19937_64 rng(50);
+    vector<IPv4_Addr> ips(40000);
+    for (auto && ip : ips) ip = IPv4_Addr(u32i(rng()));
+    Jump_Shard ten(10), eleven(11);
+    vector<u32i> before(ips.size()), after(ips.size());
+    ten.shard(ips.data(), ips.size(), before.data());
+    eleven.shard(ips.data(), ips.size(), after.data());
+    size_t moved {0};
+    vector<size_t> load(11, 0);
+    for (size_t idx = 0; idx < ips.size(); idx++) {
+        CHECK(before[idx] < 10);
+        if (before[idx] != after[idx]) { moved++; CHECK_EQ(after[idx], 10u); } // only to new shard
+        CHECK_EQ(after[idx], eleven.shard(ips[idx]));
+        load[after[idx]]++;
+    }
+    CHECK((moved > ips.size() / 11 * 9 / 10) && (moved < ips.size() / 11 * 11 / 10));
+    for (auto cnt : load) CHECK((cnt > ips.size() / 11 * 9 / 10) && (cnt < ips.size() / 11 * 11 / 10));
+    CHECK(!ten.resize(0) && (ten.last_err() == shardmnp::NoShards) && (ten.count() == 10));
+}
+
+GIA_TEST(shard_prefix_keys) {
+    Jump_Shard jump(64);
+    CHECK(jump.set_prefix(24, 64, 24));
+    CHECK_EQ(jump.shard(IPv4_Addr("10.1.2.3")), jump.shard(IPv4_Addr("10.1.2.250")));
+    CHECK_EQ(jump.shard(IPv6_Addr("2001:db8:1:2::1")), jump.shard(IPv6_Addr("2001:db8:1:2:ffff::9")));
+    CHECK_EQ(jump.shard(MAC_Addr(0x001A2B000001ull)), jump.shard(MAC_Addr(0x001A2BFFFFFFull)));
+    CHECK(!jump.set_prefix(33, 64) && (jump.last_err() == shardmnp::BadPrefix));
+    size_t differ {0};
+    for (u32i net = 0; net < 256; net++) differ += jump.shard(IPv4_Addr(10, 1, u8i(net), 7)) != jump.shard(IPv4_Addr(10, 1, 0, 7));
+    CHECK(differ > 200); // other /24 go elsewhere
+}
+
+GIA_TEST(shard_rendezvous_weighted) {
+    mt19937_64 rng(51);
+    vector<IPv6_Addr> ips(60000);
+    for (auto && ip : ips) ip = IPv6_Addr(rng(), rng());
+    Rendezvous_Shard hrw;
+    vector<u32i> none(1);
+    hrw.shard(ips.data(), 1, none.data());
+    CHECK_EQ(none[0], shardmnp::NO_SHARD);
+    CHECK(hrw.add_node(100) && hrw.add_node(200) && hrw.add_node(300, 2.0));
+    CHECK(!hrw.add_node(200) && (hrw.last_err() == shardmnp::DupNode));
+    CHECK(!hrw.add_node(400, 0.0) && (hrw.last_err() == shardmnp::BadWeight));
+    vector<u32i> before(ips.size()), after(ips.size());
+    hrw.shard(ips.data(), ips.size(), before.data());
+    size_t heavy = count(before.begin(), before.end(), 300u);
+    CHECK((heavy > ips.size() * 45 / 100) && (heavy < ips.size() * 55 / 100)); // half of keys by weight
+    CHECK(hrw.remove_node(100));
+    hrw.shard(ips.data(), ips.size(), after.data());
+    for (size_t idx = 0; idx < ips.size(); idx++) if (before[idx] != 100) CHECK_EQ(after[idx], before[idx]); // only keys of removed node move
+    CHECK(hrw.add_node(100));
+    hrw.shard(ips.data(), ips.size(), after.data());
+    CHECK(after == before); // placement depends on ids, not on order of joining
+    CHECK(hrw.set_weight(300, 1.0) && !hrw.set_weight(999, 1.0));
+    size_t moved {0};
+    hrw.shard(ips.data(), ips.size(), after.data());
+    for (size_t idx = 0; idx < ips.size(); idx++) if (after[idx] != before[idx]) { moved++; CHECK_EQ(before[idx], 300u); } // lighter node only gives keys away
+    CHECK((moved > ips.size() * 12 / 100) && (moved < ips.size() * 22 / 100)); // from 1/2 to 1/3
+}
@@ -0,0 +1,42 @@
+#include <thread>
+#include "gia_test.h"
+#include "../gia_stats.h"
+
+using namespace std;
+
+// counters exist only in GIA_STATS builds, otherwise snapshot must stay empty
+
+GIA_TEST(stats_parse_reasons) {
+    statmnp::reset();
+    v4mnp::valid_addr("10.0.0.1");
+    v4mnp::valid_addr("10.0.0.256");
+    v6mnp::valid_addr("::ffff:192.0.2.1");
+    v6mnp::valid_addr("1::2::3");
+    macmnp::valid_addr("00-11-22-33-44-55", 1, ':');
+    IPv6_Addr(0, 0x0000FFFFC0000201ull).to_str(v6mnp::IETF_VIEW);
+    stat_snapshot snap = statmnp::snapshot();
+    if (!statmnp::enabled()) {
+        for (u32i idx = 0; idx < statmnp::COUNTERS; idx++) CHECK_EQ(snap.counters[idx], 0ull);
+        return;
+    }
+    CHECK_EQ(snap[statmnp::V4_Parse], 3ull); // embedded address of IPv6 as well
+    CHECK_EQ(snap[statmnp::V4_FailOctet], 1ull);
+    CHECK_EQ(snap[statmnp::V6_Parse], 2ull);
+    CHECK_EQ(snap[statmnp::V6_Embedded4], 1ull);
+    CHECK_EQ(snap[statmnp::V6_FailColons], 1ull);
+    CHECK_EQ(snap[statmnp::MAC_Parse], 1ull);
+    CHECK_EQ(snap[statmnp::MAC_FailSymbol], 1ull);
+    CHECK_EQ(snap[statmnp::V6_Format], 1ull);
+    CHECK_EQ(snap[statmnp::V6_FormatEmbedded4], 1ull);
+    CHECK_EQ(snap[statmnp::V4_Format], 1ull);
+    if (statmnp::latency()) CHECK_EQ(snap.calls(statmnp::H_V4_Parse), 3ull);
+}
+
+GIA_TEST(stats_threads_fold_on_exit) {
+    statmnp::reset();
+    vector<thread> pool;
+    for (u32i tid = 0; tid < 4; tid++) pool.emplace_back([]() { for (u32i idx = 0; idx < 1000; idx++) v4mnp::valid_addr("192.0.2.1"); });
+    for (auto && thr : pool) thr.join();
+    CHECK_EQ(statmnp::snapshot()[statmnp::V4_Parse], statmnp::enabled() ? 4000ull : 0ull);
+    CHECK_EQ(string(statmnp::name(statmnp::MAC_FailSeparator)), string("mac.fail.separator"));
+}
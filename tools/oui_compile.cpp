@@ -0,0 +1,29 @@
+// compiles IEEE MA-L / MA-M / MA-S registries (oui.txt, mam.txt, oui36.txt or their csv forms) into OUI_DB image
+// usage : oui_compile <output.db> <registry> [registry ...]
+
+#include "../gia_oui.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        cerr << "usage : " << argv[0] << " <output.db> <registry> [registry ...]" << endl;
+        return 2;
+    }
+    OUI_Compiler comp;
+    for (int idx = 2; idx < argc; idx++) {
+        size_t cnt = comp.parse_file(argv[idx]);
+        if (comp.last_err() != ouimnp::NoError) {
+            cerr << argv[idx] << " : can not read registry" << endl;
+            return 1;
+        }
+        cout << argv[idx] << " : " << cnt << " prefixes" << endl;
+    }
+    vector<u8i> image = comp.build();
+    if (image.empty() || !MMap_File::save(argv[1], image)) {
+        cerr << argv[1] << " : can not build database" << endl;
+        return 1;
+    }
+    cout << argv[1] << " : " << comp.count() << " prefixes, " << image.size() << " bytes" << endl;
+    return 0;
+}